@@ -30,8 +30,10 @@
 #include "coin.h"
 #include "zxmacros.h"
 #include "app_mode.h"
+#include "batch.h"
 
 #include "parser_impl.h"
+#include "parser.h"
 
 __Z_INLINE void handleGetAddrSecp256K1(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
     uint8_t len = extractHRP(rx, OFFSET_DATA);
@@ -56,7 +58,159 @@ __Z_INLINE void handleGetAddrSecp256K1(volatile uint32_t *flags, volatile uint32
     THROW(APDU_CODE_OK);
 }
 
+__Z_INLINE void handleGetAddrBatchSecp256K1(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    UNUSED(flags);
+
+    // P1: 0x00 public key and address, 0x01 public key only
+    // P2: 0x00 iterate over the account (Path[2]), 0x01 over the address index (Path[4])
+    const uint8_t pubKeyOnly = G_io_apdu_buffer[OFFSET_P1];
+    const uint8_t iterateAddressIndex = G_io_apdu_buffer[OFFSET_P2];
+    if (pubKeyOnly > 1 || iterateAddressIndex > 1) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+    const uint8_t pathIdx = iterateAddressIndex ? 4 : 2;
+
+    uint8_t len = extractHRP(rx, OFFSET_DATA);
+    extractHDPath(rx, OFFSET_DATA + 1 + len);
+
+    const uint32_t countOffset = OFFSET_DATA + 1 + len + sizeof(uint32_t) * HDPATH_LEN_DEFAULT;
+    if (rx < countOffset + 1) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+    uint32_t count = G_io_apdu_buffer[countOffset];
+    if (count == 0) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+
+    // Stay within the limits extractHDPath enforces, and do not overflow into the hardening bit
+    const uint32_t baseIndex = hdPath[pathIdx] & 0x7FFFFFFF;
+    const uint32_t maxIndex = app_mode_expert() ? 0x7FFFFFFF : 100;
+    if (baseIndex + count - 1 > maxIndex) {
+        count = maxIndex - baseIndex + 1;
+    }
+
+    app_fill_address_batch(pathIdx, (uint8_t) count, pubKeyOnly);
+
+    *tx = action_addrResponseLen;
+    THROW(APDU_CODE_OK);
+}
+
+#if BATCH_SIGNING
+__Z_INLINE void handleSignBatchSecp256K1(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    if (G_io_apdu_buffer[OFFSET_P2] != 0) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+
+    if (rx < OFFSET_DATA) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+
+    // Document being received, only P1=1 opens one
+    static bool docOpen = false;
+    static uint32_t docOffset = 0;
+    static uint32_t docPath[HDPATH_LEN_DEFAULT];
+    uint32_t added;
+    uint16_t replyLen;
+
+    switch (G_io_apdu_buffer[OFFSET_PAYLOAD_TYPE]) {
+        case 0:
+            // Init: [COUNT]
+            if (rx < OFFSET_DATA + 1) {
+                THROW(APDU_CODE_WRONG_LENGTH);
+            }
+            tx_initialize();
+            tx_reset();
+            docOpen = false;
+            docOffset = 0;
+            MEMZERO(docPath, sizeof(docPath));
+            if (batch_init(G_io_apdu_buffer[OFFSET_DATA]) != parser_ok) {
+                THROW(APDU_CODE_DATA_INVALID);
+            }
+            // There is no single signer to group messages by
+            parser_tx_obj.own_addr = NULL;
+            parser_tx_obj.format = parser_format_amino_json;
+            THROW(APDU_CODE_OK);
+
+        case 1:
+            // Document start: [PATH]
+            if (batch_isComplete()) {
+                THROW(APDU_CODE_DATA_INVALID);
+            }
+            extractHDPath(rx, OFFSET_DATA);
+            MEMCPY(docPath, hdPath, sizeof(docPath));
+            docOffset = tx_get_buffer_length();
+            docOpen = true;
+            tx_restart_digest();
+            THROW(APDU_CODE_OK);
+
+        case 2:
+        case 3:
+            if (!docOpen) {
+                THROW(APDU_CODE_DATA_INVALID);
+            }
+            added = tx_append(&(G_io_apdu_buffer[OFFSET_DATA]), rx - OFFSET_DATA);
+            if (added != rx - OFFSET_DATA) {
+                THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
+            }
+            if (G_io_apdu_buffer[OFFSET_PAYLOAD_TYPE] == 2) {
+                THROW(APDU_CODE_OK);
+            }
+            break;
+
+        case 4:
+            // Signature of an approved batch: [INDEX]
+            if (rx < OFFSET_DATA + 1) {
+                THROW(APDU_CODE_WRONG_LENGTH);
+            }
+            if (app_sign_batch_doc(G_io_apdu_buffer[OFFSET_DATA], &replyLen) != zxerr_ok || replyLen == 0) {
+                *tx = 0;
+                THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+            }
+            *tx = replyLen;
+            THROW(APDU_CODE_OK);
+
+        default:
+            THROW(APDU_CODE_INVALIDP1P2);
+    }
+
+    // Last chunk of a document
+    docOpen = false;
+    if (docOffset > tx_get_buffer_length()) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    tx_get_digest(digest);
+    // Only the doc is needed, earlier bytes stay where they are
+    const uint32_t docLen = tx_get_buffer_length() - docOffset;
+    const parser_error_t err = batch_addDoc(tx_get_range(docOffset, docLen), docOffset, docLen,
+                                            docPath, digest);
+    if (err != parser_ok) {
+        const char *error_msg = parser_getErrorDescription(err);
+        int error_msg_length = strlen(error_msg);
+        MEMCPY(G_io_apdu_buffer, error_msg, error_msg_length);
+        *tx += (error_msg_length);
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+
+    if (!batch_isComplete()) {
+        THROW(APDU_CODE_OK);
+    }
+
+    CHECK_APP_CANARY()
+    view_review_init(tx_batch_getItem, tx_batch_getNumItems, app_sign_batch);
+    view_review_show(0x03);
+    *flags |= IO_ASYNCH_REPLY;
+}
+#endif
+
 __Z_INLINE void handleSignSecp256K1(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    if (G_io_apdu_buffer[OFFSET_PAYLOAD_TYPE] == 0) {
+#if BATCH_SIGNING
+        // A single transaction replaces any pending batch
+        batch_reset();
+#endif
+    }
+
     if (!process_chunk(tx, rx)) {
         THROW(APDU_CODE_OK);
     }
@@ -68,6 +222,9 @@ __Z_INLINE void handleSignSecp256K1(volatile uint32_t *flags, volatile uint32_t
         THROW(APDU_CODE_DATA_INVALID);
     }
     parser_tx_obj.own_addr = (const char *) (G_io_apdu_buffer + VIEW_ADDRESS_OFFSET_SECP256K1);
+    // The APDU buffer now holds the address, the encoding was latched by the init chunk
+    parser_tx_obj.format = process_chunk_encoding() == PAYLOAD_ENCODING_PROTOBUF ?
+                           parser_format_protobuf : parser_format_amino_json;
 
     const char *error_msg = tx_parse();
 
@@ -107,20 +264,43 @@ void handleApdu(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
 
                 case INS_GET_ADDR_SECP256K1: {
                     if( os_global_pin_is_validated() != BOLOS_UX_OK ) {
+                        crypto_resetAddressCache();
                         THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
                     }
                     handleGetAddrSecp256K1(flags, tx, rx);
                     break;
                 }
 
+                case INS_GET_ADDR_BATCH_SECP256K1: {
+                    if( os_global_pin_is_validated() != BOLOS_UX_OK ) {
+                        crypto_resetAddressCache();
+                        THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                    }
+                    handleGetAddrBatchSecp256K1(flags, tx, rx);
+                    break;
+                }
+
                 case INS_SIGN_SECP256K1: {
                     if( os_global_pin_is_validated() != BOLOS_UX_OK ) {
+                        crypto_resetAddressCache();
                         THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
                     }
                     handleSignSecp256K1(flags, tx, rx);
                     break;
                 }
 
+#if BATCH_SIGNING
+                case INS_SIGN_BATCH_SECP256K1: {
+                    if( os_global_pin_is_validated() != BOLOS_UX_OK ) {
+                        crypto_resetAddressCache();
+                        batch_reset();
+                        THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                    }
+                    handleSignBatchSecp256K1(flags, tx, rx);
+                    break;
+                }
+#endif
+
                 default:
                     THROW(APDU_CODE_INS_NOT_SUPPORTED);
             }
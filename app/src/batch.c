@@ -0,0 +1,267 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "batch.h"
+#include <stdio.h>
+#include <string.h>
+#include <zxmacros.h>
+#include "common/parser.h"
+#include "ram_arena.h"
+
+#if BATCH_SIGNING
+
+// Page size used to fingerprint item values
+#define BATCH_HASH_VALUE_LEN    100
+
+typedef struct {
+    uint32_t offset;
+    uint32_t len;
+    uint32_t path[HDPATH_LEN_DEFAULT];
+    uint8_t digest[SHA256_DIGEST_SIZE];
+} batch_doc_t;
+
+typedef struct {
+    uint8_t count;
+    uint8_t added;
+    bool approved;
+
+    batch_doc_t docs[BATCH_MAX_DOCS];
+
+    // structure and values of the first doc
+    uint8_t numItems;
+    uint8_t keysDigest[SHA256_DIGEST_SIZE];
+    uint8_t itemDigest[BATCH_MAX_ITEMS][BATCH_ITEM_DIGEST_LEN];
+
+    // items whose value is not the same in all docs
+    uint8_t numDiffering;
+    uint8_t differing[BATCH_MAX_ITEMS];
+
+    // doc currently loaded in the parser (-1 = none)
+    int8_t parsedDoc;
+} batch_t;
+
+static batch_t batch;
+static parser_context_t batch_ctx;
+
+void batch_reset() {
+    MEMZERO(&batch, sizeof(batch));
+    parser_initContext(&batch_ctx);
+    batch.parsedDoc = -1;
+}
+
+parser_error_t batch_init(uint8_t count) {
+    batch_reset();
+    if (count == 0 || count > BATCH_MAX_DOCS) {
+        return parser_unexpected_number_items;
+    }
+    batch.count = count;
+    // Docs are parsed as they arrive
+    ram_arena_enter(ram_arena_review);
+    return parser_ok;
+}
+
+bool batch_isComplete() {
+    return batch.count > 0 && batch.added == batch.count;
+}
+
+// Hashes every page of an item's value, so items can be compared across docs
+static parser_error_t batch_itemDigest(uint8_t itemIdx, sha256_ctx_t *keysCtx, uint8_t *digest) {
+    char key[BATCH_HASH_VALUE_LEN];
+    char value[BATCH_HASH_VALUE_LEN];
+    uint8_t pageCount = 1;
+
+    sha256_ctx_t ctx;
+    sha256_init(&ctx);
+    for (uint8_t pageIdx = 0; pageIdx < pageCount; pageIdx++) {
+        CHECK_PARSER_ERR(parser_getItem(&batch_ctx, itemIdx,
+                                        key, sizeof(key),
+                                        value, sizeof(value),
+                                        pageIdx, &pageCount))
+        // Length prefixed, so page boundaries are part of the fingerprint
+        const uint8_t valueLen = (uint8_t) strlen(value);
+        sha256_update(&ctx, &valueLen, 1);
+        sha256_update(&ctx, (const uint8_t *) value, valueLen);
+    }
+    sha256_update(keysCtx, (const uint8_t *) key, strlen(key) + 1);
+
+    uint8_t fullDigest[SHA256_DIGEST_SIZE];
+    sha256_final(&ctx, fullDigest);
+    MEMCPY(digest, fullDigest, BATCH_ITEM_DIGEST_LEN);
+
+    return parser_ok;
+}
+
+static parser_error_t batch_loadDoc(const uint8_t *buffer, uint8_t docIdx) {
+    if (batch.parsedDoc == docIdx) {
+        return parser_ok;
+    }
+    batch.parsedDoc = -1;
+    CHECK_PARSER_ERR(parser_parse(&batch_ctx, buffer + batch.docs[docIdx].offset, batch.docs[docIdx].len))
+    batch.parsedDoc = docIdx;
+    return parser_ok;
+}
+
+parser_error_t batch_addDoc(const uint8_t *doc, uint32_t offset, uint32_t len,
+                            const uint32_t *path, const uint8_t *digest) {
+    if (batch.count == 0 || batch.added >= batch.count) {
+        return parser_unexpected_number_items;
+    }
+
+    const uint8_t docIdx = batch.added;
+    batch.docs[docIdx].offset = offset;
+    batch.docs[docIdx].len = len;
+
+    // The doc may still be cached in RAM, so it is parsed again from the full buffer on review
+    batch.parsedDoc = -1;
+    CHECK_PARSER_ERR(parser_parse(&batch_ctx, doc, len))
+    CHECK_PARSER_ERR(parser_validate(&batch_ctx))
+
+    uint8_t numItems = 0;
+    CHECK_PARSER_ERR(parser_getNumItems(&batch_ctx, &numItems))
+    if (numItems > BATCH_MAX_ITEMS || (docIdx > 0 && numItems != batch.numItems)) {
+        return parser_unexpected_number_items;
+    }
+
+    sha256_ctx_t keysCtx;
+    sha256_init(&keysCtx);
+    bool differs[BATCH_MAX_ITEMS];
+    MEMZERO(differs, sizeof(differs));
+    for (uint8_t i = 0; i < numItems; i++) {
+        uint8_t itemDigest[BATCH_ITEM_DIGEST_LEN];
+        CHECK_PARSER_ERR(batch_itemDigest(i, &keysCtx, itemDigest))
+        if (docIdx == 0) {
+            MEMCPY(batch.itemDigest[i], itemDigest, BATCH_ITEM_DIGEST_LEN);
+        } else {
+            differs[i] = MEMCMP(batch.itemDigest[i], itemDigest, BATCH_ITEM_DIGEST_LEN) != 0;
+        }
+    }
+
+    uint8_t keysDigest[SHA256_DIGEST_SIZE];
+    sha256_final(&keysCtx, keysDigest);
+    if (docIdx == 0) {
+        batch.numItems = numItems;
+        MEMCPY(batch.keysDigest, keysDigest, sizeof(keysDigest));
+    } else if (MEMCMP(batch.keysDigest, keysDigest, sizeof(keysDigest)) != 0) {
+        // Docs in a batch must have the same structure
+        return parser_unexpected_field;
+    }
+
+    // Keep the list of differing items sorted
+    for (uint8_t i = 0; i < numItems; i++) {
+        bool listed = false;
+        for (uint8_t j = 0; j < batch.numDiffering; j++) {
+            listed |= batch.differing[j] == i;
+        }
+        if (differs[i] && !listed) {
+            uint8_t j = batch.numDiffering++;
+            for (; j > 0 && batch.differing[j - 1] > i; j--) {
+                batch.differing[j] = batch.differing[j - 1];
+            }
+            batch.differing[j] = i;
+        }
+    }
+
+    MEMCPY(batch.docs[docIdx].path, path, sizeof(batch.docs[docIdx].path));
+    MEMCPY(batch.docs[docIdx].digest, digest, sizeof(batch.docs[docIdx].digest));
+    batch.added++;
+
+    return parser_ok;
+}
+
+parser_error_t batch_getNumItems(uint8_t *numItems) {
+    *numItems = 0;
+    if (!batch_isComplete()) {
+        return parser_no_data;
+    }
+    const uint16_t total = 1 + batch.numItems + (batch.count - 1) * batch.numDiffering;
+    if (total > 255) {
+        return parser_unexpected_number_items;
+    }
+    *numItems = (uint8_t) total;
+    return parser_ok;
+}
+
+parser_error_t batch_getItem(const uint8_t *buffer,
+                             uint8_t displayIdx,
+                             char *outKey, uint16_t outKeyLen,
+                             char *outVal, uint16_t outValLen,
+                             uint8_t pageIdx, uint8_t *pageCount) {
+    *pageCount = 0;
+    MEMZERO(outKey, outKeyLen);
+    MEMZERO(outVal, outValLen);
+
+    uint8_t numItems = 0;
+    CHECK_PARSER_ERR(batch_getNumItems(&numItems))
+    if (displayIdx >= numItems) {
+        return parser_display_idx_out_of_range;
+    }
+
+    if (displayIdx == 0) {
+        if (pageIdx > 0) {
+            return parser_display_page_out_of_range;
+        }
+        snprintf(outKey, outKeyLen, "Batch");
+        snprintf(outVal, outValLen, "%d transactions", batch.count);
+        *pageCount = 1;
+        return parser_ok;
+    }
+
+    // Items of the first doc, then the differing items of the others
+    uint8_t docIdx = 0;
+    uint8_t itemIdx = displayIdx - 1;
+    if (itemIdx >= batch.numItems) {
+        const uint8_t i = itemIdx - batch.numItems;
+        docIdx = 1 + i / batch.numDiffering;
+        itemIdx = batch.differing[i % batch.numDiffering];
+    }
+
+    CHECK_PARSER_ERR(batch_loadDoc(buffer, docIdx))
+    CHECK_PARSER_ERR(parser_getItem(&batch_ctx, itemIdx,
+                                    outKey, outKeyLen,
+                                    outVal, outValLen,
+                                    pageIdx, pageCount))
+
+    bool differs = false;
+    for (uint8_t j = 0; j < batch.numDiffering; j++) {
+        differs |= batch.differing[j] == itemIdx;
+    }
+    if (differs) {
+        // Tell the user which tx the value belongs to
+        char tmpKey[64];
+        snprintf(tmpKey, sizeof(tmpKey), "%s", outKey);
+        snprintf(outKey, outKeyLen, "#%d %s", docIdx + 1, tmpKey);
+    }
+
+    return parser_ok;
+}
+
+void batch_approve() {
+    batch.approved = batch_isComplete();
+}
+
+parser_error_t batch_getSigningData(uint8_t docIdx, const uint32_t **path, const uint8_t **digest) {
+    if (!batch.approved) {
+        return parser_no_data;
+    }
+    if (docIdx >= batch.count) {
+        return parser_value_out_of_range;
+    }
+    *path = batch.docs[docIdx].path;
+    *digest = batch.docs[docIdx].digest;
+    return parser_ok;
+}
+
+#endif
@@ -0,0 +1,78 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "coin.h"
+#include "sha256.h"
+#include "common/parser_common.h"
+
+// Not built on Nano S: the batch state and its parser context do not fit next to the review phase
+#if defined(TARGET_NANOS)
+#define BATCH_SIGNING           0
+#else
+#define BATCH_SIGNING           1
+#endif
+
+#define BATCH_MAX_DOCS          16
+#define BATCH_MAX_ITEMS         64
+
+// Items of the first document are remembered by a truncated SHA-256 of their rendered value
+#define BATCH_ITEM_DIGEST_LEN   16
+
+/// Starts a batch of count sign docs. Any previous batch is discarded
+parser_error_t batch_init(uint8_t count);
+
+/// Discards the current batch
+void batch_reset();
+
+/// Parses and validates the next sign doc.
+/// All docs of a batch must show the same items (same keys), only values may differ
+/// \param doc: the doc contents, only read during the call
+/// \param offset: position of the doc in the buffer later passed to batch_getItem
+/// \param len
+/// \param path: derivation path the doc will be signed with
+/// \param digest: SHA-256 of the doc
+parser_error_t batch_addDoc(const uint8_t *doc, uint32_t offset, uint32_t len,
+                            const uint32_t *path, const uint8_t *digest);
+
+/// Indicates that all docs have been added
+bool batch_isComplete();
+
+/// Combined review: a summary item, all items of the first doc,
+/// then for every other doc only the items whose value differs
+parser_error_t batch_getNumItems(uint8_t *numItems);
+
+parser_error_t batch_getItem(const uint8_t *buffer,
+                             uint8_t displayIdx,
+                             char *outKey, uint16_t outKeyLen,
+                             char *outVal, uint16_t outValLen,
+                             uint8_t pageIdx, uint8_t *pageCount);
+
+/// Marks the batch as approved by the user
+void batch_approve();
+
+/// Returns the path and digest to sign for a doc. Only available once the batch is approved
+parser_error_t batch_getSigningData(uint8_t docIdx, const uint32_t **path, const uint8_t **digest);
+
+#ifdef __cplusplus
+}
+#endif
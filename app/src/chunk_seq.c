@@ -0,0 +1,63 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "chunk_seq.h"
+
+uint8_t chunk_seq_read_header(const uint8_t *payload, uint32_t payloadLen, chunk_seq_header_t *header) {
+    if (payloadLen < CHUNK_SEQ_HEADER_LEN) {
+        return 0;
+    }
+    header->seq = (uint16_t) ((payload[0] << 8u) | payload[1]);
+    header->offset = ((uint32_t) payload[2] << 24u) |
+                     ((uint32_t) payload[3] << 16u) |
+                     ((uint32_t) payload[4] << 8u) |
+                     (uint32_t) payload[5];
+    return 1;
+}
+
+uint32_t chunk_seq_write_ack(uint8_t *out, uint16_t seq, uint32_t length) {
+    out[0] = (uint8_t) (seq >> 8u);
+    out[1] = (uint8_t) seq;
+    out[2] = (uint8_t) (length >> 24u);
+    out[3] = (uint8_t) (length >> 16u);
+    out[4] = (uint8_t) (length >> 8u);
+    out[5] = (uint8_t) length;
+    return CHUNK_SEQ_ACK_LEN;
+}
+
+chunk_seq_result_e chunk_seq_check(chunk_seq_read_fn read, uint32_t bufferLen,
+                                   uint32_t offset,
+                                   const uint8_t *data, uint32_t dataLen,
+                                   uint32_t *skip) {
+    *skip = 0;
+    if (offset > bufferLen) {
+        return chunk_seq_gap;
+    }
+
+    // Bytes we already have must be replayed unchanged
+    uint32_t overlap = bufferLen - offset;
+    if (overlap > dataLen) {
+        overlap = dataLen;
+    }
+    for (uint32_t i = 0; i < overlap; i++) {
+        if (read(offset + i) != data[i]) {
+            return chunk_seq_mismatch;
+        }
+    }
+
+    *skip = overlap;
+    return chunk_seq_append;
+}
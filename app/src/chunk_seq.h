@@ -0,0 +1,66 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Sequenced chunks start with [SEQ (2, big endian)][OFFSET (4, big endian)]
+// OFFSET is the running length of the transaction before this chunk
+#define CHUNK_SEQ_HEADER_LEN    6u
+// Acknowledgements are [SEQ (2)][LENGTH (4)], LENGTH being the bytes held by the device
+#define CHUNK_SEQ_ACK_LEN       6u
+
+typedef struct {
+    uint16_t seq;
+    uint32_t offset;
+} chunk_seq_header_t;
+
+typedef enum {
+    chunk_seq_append,       // the bytes after skip are new and must be appended
+    chunk_seq_gap,          // previous chunks are missing, the host must resend from the current length
+    chunk_seq_mismatch,     // replayed bytes differ from the ones already received
+} chunk_seq_result_e;
+
+/// Reads a byte already received (tx_get_byte on device)
+typedef uint8_t (*chunk_seq_read_fn)(uint32_t offset);
+
+/// Reads the header of a sequenced chunk
+/// \return 0 if the payload is too short to hold a header
+uint8_t chunk_seq_read_header(const uint8_t *payload, uint32_t payloadLen, chunk_seq_header_t *header);
+
+/// Writes an acknowledgement and returns its length
+uint32_t chunk_seq_write_ack(uint8_t *out, uint16_t seq, uint32_t length);
+
+/// Decides what to do with a chunk, so replays of chunks already received are harmless
+/// \param read reads the bytes received so far
+/// \param bufferLen
+/// \param offset offset of the chunk in the transaction
+/// \param data chunk contents
+/// \param dataLen
+/// \param skip (out) number of leading chunk bytes that were already received
+chunk_seq_result_e chunk_seq_check(chunk_seq_read_fn read, uint32_t bufferLen,
+                                   uint32_t offset,
+                                   const uint8_t *data, uint32_t dataLen,
+                                   uint32_t *skip);
+
+#ifdef __cplusplus
+}
+#endif
@@ -58,6 +58,10 @@ typedef enum {
 
 #define COIN_AMOUNT_MAXSIZE                 50
 
+// In non-expert mode, opaque values (encrypted wasm msgs, sign data) are shown
+// as their length and the first bytes of their SHA-256
+#define COIN_OPAQUE_DIGEST_LEN              8
+
 #define COIN_MAX_CHAINID_LEN                20
 #define INDEXING_TMP_KEYSIZE 70
 #define INDEXING_TMP_VALUESIZE 70
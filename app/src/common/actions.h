@@ -18,6 +18,7 @@
 #include <stdint.h>
 #include "crypto.h"
 #include "tx.h"
+#include "batch.h"
 #include "apdu_codes.h"
 #include <os_io_seproxyhal.h>
 #include "coin.h"
@@ -44,6 +45,37 @@ __Z_INLINE void app_sign() {
     }
 }
 
+#if BATCH_SIGNING
+__Z_INLINE zxerr_t app_sign_batch_doc(uint8_t docIdx, uint16_t *replyLen) {
+    const uint32_t *path = NULL;
+    const uint8_t *digest = NULL;
+    *replyLen = 0;
+
+    if (batch_getSigningData(docIdx, &path, &digest) != parser_ok) {
+        return zxerr_no_data;
+    }
+
+    MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+    return crypto_signDigest(path, digest, G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 3, replyLen);
+}
+
+__Z_INLINE void app_sign_batch() {
+    uint16_t replyLen = 0;
+
+    // A single approval covers every document in the batch, the first signature is returned right away
+    batch_approve();
+    zxerr_t err = app_sign_batch_doc(0, &replyLen);
+
+    if (err != zxerr_ok || replyLen == 0) {
+        set_code(G_io_apdu_buffer, 0, APDU_CODE_SIGN_VERIFY_ERROR);
+        io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
+    } else {
+        set_code(G_io_apdu_buffer, replyLen, APDU_CODE_OK);
+        io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, replyLen + 2);
+    }
+}
+#endif
+
 __Z_INLINE zxerr_t app_fill_address() {
     // Put data directly in the apdu buffer
     MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
@@ -58,6 +90,22 @@ __Z_INLINE zxerr_t app_fill_address() {
     return zxerr_ok;
 }
 
+__Z_INLINE zxerr_t app_fill_address_batch(uint8_t pathIdx, uint8_t count, bool pubKeyOnly) {
+    // Put data directly in the apdu buffer
+    MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+
+    action_addrResponseLen = 0;
+    zxerr_t err = crypto_fillAddressBatch(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 2,
+                                          pathIdx, count, pubKeyOnly,
+                                          &action_addrResponseLen);
+
+    if (err != zxerr_ok || action_addrResponseLen == 0 || G_io_apdu_buffer[0] == 0) {
+        THROW(APDU_CODE_EXECUTION_ERROR);
+    }
+
+    return zxerr_ok;
+}
+
 __Z_INLINE void app_reject() {
     MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
     set_code(G_io_apdu_buffer, 0, APDU_CODE_COMMAND_NOT_ALLOWED);
@@ -29,6 +29,11 @@
 #include "coin.h"
 #include "zxmacros.h"
 #include "app_mode.h"
+#include "chunk_seq.h"
+#include "tx_decompress.h"
+#include "tx_stream_check.h"
+#include "ram_arena.h"
+#include "parser.h"
 
 unsigned char G_io_seproxyhal_spi_buffer[IO_SEPROXYHAL_BUFFER_SIZE_B];
 
@@ -50,6 +55,10 @@ unsigned char io_event(unsigned char channel) {
             break;
 
         case SEPROXYHAL_TAG_TICKER_EVENT: { //
+            if (os_global_pin_is_validated() != BOLOS_UX_OK) {
+                // Device is locked
+                crypto_resetAddressCache();
+            }
             UX_TICKER_EVENT(G_io_seproxyhal_spi_buffer, {
                     if (UX_ALLOWED) {
                         UX_REDISPLAY();
@@ -117,12 +126,108 @@ void extractHDPath(uint32_t rx, uint32_t offset) {
     }
 }
 
-bool process_chunk(volatile uint32_t *tx, uint32_t rx) {
-    UNUSED(tx);
+// Sequence number of the last chunk accepted
+static uint16_t chunk_last_seq = 0;
+
+// Payload encoding chosen with P2 in the init chunk
+static uint8_t chunk_encoding = PAYLOAD_ENCODING_PLAIN;
+
+uint8_t process_chunk_encoding() {
+    return chunk_encoding;
+}
+
+// Chunk reception state lives in the ingest phase of the RAM arena
+#define chunk_check_ctx (ram_arena.ingest.check)
+#define chunk_decompress_ctx (ram_arena.ingest.decompress)
+
+// Rejects the transaction as soon as received bytes show it cannot be valid
+// Reply: [ERROR (1)][OFFSET (4)][error message]
+static void check_received_bytes(volatile uint32_t *tx) {
+    if (chunk_encoding == PAYLOAD_ENCODING_PROTOBUF) {
+        // The stream check is for JSON, a SignDoc is only checked once complete
+        return;
+    }
+
+    const parser_error_t err = tx_stream_check(&chunk_check_ctx, tx_get_byte, tx_get_buffer_length());
+    if (err == parser_ok) {
+        return;
+    }
+
+    G_io_apdu_buffer[0] = (uint8_t) err;
+    G_io_apdu_buffer[1] = (uint8_t) (chunk_check_ctx.offset >> 24u);
+    G_io_apdu_buffer[2] = (uint8_t) (chunk_check_ctx.offset >> 16u);
+    G_io_apdu_buffer[3] = (uint8_t) (chunk_check_ctx.offset >> 8u);
+    G_io_apdu_buffer[4] = (uint8_t) chunk_check_ctx.offset;
+    const char *error_msg = parser_getErrorDescription(err);
+    const uint32_t error_msg_length = strlen(error_msg);
+    MEMCPY(G_io_apdu_buffer + 5, error_msg, error_msg_length);
+    *tx = 5 + error_msg_length;
+    THROW(APDU_CODE_DATA_INVALID);
+}
+
+static bool process_sequenced_chunk(volatile uint32_t *tx, uint32_t rx, bool isLast) {
+    chunk_seq_header_t header;
+    if (!chunk_seq_read_header(G_io_apdu_buffer + OFFSET_DATA, rx - OFFSET_DATA, &header)) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+    uint8_t *data = G_io_apdu_buffer + OFFSET_DATA + CHUNK_SEQ_HEADER_LEN;
+    const uint32_t dataLen = rx - OFFSET_DATA - CHUNK_SEQ_HEADER_LEN;
+
+    // Replayed bytes are read where they are, so pending bytes are not flushed
+    uint32_t skip = 0;
+    switch (chunk_seq_check(tx_get_byte, tx_get_buffer_length(), header.offset, data, dataLen, &skip)) {
+        case chunk_seq_append: {
+            const uint32_t added = tx_append(data + skip, dataLen - skip);
+            if (added != dataLen - skip) {
+                THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
+            }
+            check_received_bytes(tx);
+            break;
+        }
+        case chunk_seq_gap:
+            // Tell the host where to resume from
+            *tx = chunk_seq_write_ack(G_io_apdu_buffer, chunk_last_seq, tx_get_buffer_length());
+            THROW(APDU_CODE_CONDITIONS_NOT_SATISFIED);
+        default:
+            THROW(APDU_CODE_DATA_INVALID);
+    }
+    chunk_last_seq = header.seq;
+
+    if (!isLast) {
+        *tx = chunk_seq_write_ack(G_io_apdu_buffer, header.seq, tx_get_buffer_length());
+        return false;
+    }
 
+    // The last chunk has to complete the transaction
+    if (header.offset + dataLen != tx_get_buffer_length()) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+    return true;
+}
+
+static void append_compressed_chunk(uint32_t rx, bool isLast) {
+    switch (decompress_chunk(&chunk_decompress_ctx,
+                             G_io_apdu_buffer + OFFSET_DATA, rx - OFFSET_DATA,
+                             tx_get_byte, tx_append)) {
+        case decompress_ok:
+            break;
+        case decompress_output_full:
+            THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
+        default:
+            THROW(APDU_CODE_DATA_INVALID);
+    }
+
+    if (isLast && !decompress_is_complete(&chunk_decompress_ctx)) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+}
+
+bool process_chunk(volatile uint32_t *tx, uint32_t rx) {
     const uint8_t payloadType = G_io_apdu_buffer[OFFSET_PAYLOAD_TYPE];
+    const uint8_t encoding = G_io_apdu_buffer[OFFSET_P2];
 
-    if (G_io_apdu_buffer[OFFSET_P2] != 0) {
+    if (encoding > PAYLOAD_ENCODING_PROTOBUF ||
+        (payloadType != 0 && encoding != chunk_encoding)) {
         THROW(APDU_CODE_INVALIDP1P2);
     }
 
@@ -130,25 +235,42 @@ bool process_chunk(volatile uint32_t *tx, uint32_t rx) {
         THROW(APDU_CODE_WRONG_LENGTH);
     }
 
+    // Chunks need the reception state set up by the init chunk
+    if (payloadType != 0 && ram_arena_phase() != ram_arena_ingest) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+
     uint32_t added;
     switch (payloadType) {
         case 0:
             tx_initialize();
             tx_reset();
+            chunk_last_seq = 0;
+            chunk_encoding = encoding;
+            ram_arena_enter(ram_arena_ingest);
+            decompress_init(&chunk_decompress_ctx);
+            tx_stream_check_init(&chunk_check_ctx, 0);
             extractHDPath(rx, OFFSET_DATA);
             return false;
         case 1:
-            added = tx_append(&(G_io_apdu_buffer[OFFSET_DATA]), rx - OFFSET_DATA);
-            if (added != rx - OFFSET_DATA) {
-                THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
-            }
-            return false;
         case 2:
-            added = tx_append(&(G_io_apdu_buffer[OFFSET_DATA]), rx - OFFSET_DATA);
-            if (added != rx - OFFSET_DATA) {
-                THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
+            if (encoding == PAYLOAD_ENCODING_COMPRESSED) {
+                append_compressed_chunk(rx, payloadType == 2);
+            } else {
+                added = tx_append(&(G_io_apdu_buffer[OFFSET_DATA]), rx - OFFSET_DATA);
+                if (added != rx - OFFSET_DATA) {
+                    THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
+                }
+            }
+            check_received_bytes(tx);
+            return payloadType == 2;
+        case 3:
+        case 4:
+            // Offsets of sequenced chunks refer to the decoded transaction
+            if (encoding == PAYLOAD_ENCODING_COMPRESSED) {
+                THROW(APDU_CODE_INVALIDP1P2);
             }
-            return true;
+            return process_sequenced_chunk(tx, rx, payloadType == 4);
     }
 
     THROW(APDU_CODE_INVALIDP1P2);
@@ -193,6 +315,7 @@ void app_init() {
     USB_power(1);
 
     app_mode_reset();
+    crypto_resetAddressCache();
     view_idle_show(0, NULL);
 
 #ifdef HAVE_BLE
@@ -30,9 +30,15 @@
 
 #define OFFSET_PAYLOAD_TYPE             OFFSET_P1
 
+#define PAYLOAD_ENCODING_PLAIN          0x00
+#define PAYLOAD_ENCODING_COMPRESSED     0x01
+#define PAYLOAD_ENCODING_PROTOBUF       0x02
+
 #define INS_GET_VERSION                 0x00
 #define INS_SIGN_SECP256K1              0x02
 #define INS_GET_ADDR_SECP256K1          0x04
+#define INS_GET_ADDR_BATCH_SECP256K1    0x06
+#define INS_SIGN_BATCH_SECP256K1        0x08
 
 void app_init();
 
@@ -42,6 +48,9 @@ void extractHDPath(uint32_t rx, uint32_t offset);
 
 bool process_chunk(volatile uint32_t *tx, uint32_t rx);
 
+/// Payload encoding (PAYLOAD_ENCODING_*) set by P2 of the last init chunk
+uint8_t process_chunk_encoding();
+
 void handleApdu(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx);
 
 __Z_INLINE void handle_getversion(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
@@ -24,6 +24,33 @@ extern "C" {
 
 const char *parser_getErrorDescription(parser_error_t err);
 
+/// Parsing state for one context. Device builds use a single static instance instead
+typedef struct {
+    parser_tx_t tx_obj;
+    display_cache_t display;
+    parser_scratch_t scratch;
+} parser_state_t;
+
+//// binds a context to the static parsing state used by device builds
+void parser_initContext(parser_context_t *ctx);
+
+//// binds a context to its own parsing state, so several contexts can be used concurrently
+void parser_bindState(parser_context_t *ctx, parser_state_t *state);
+
+//// selects the mode items are shown in, instead of the app setting. Meant for bound contexts
+void parser_setMode(parser_context_t *ctx, parser_mode_e mode);
+
+//// selects the format of the tx buffers parsed next (Amino JSON by default)
+void parser_setFormat(parser_context_t *ctx, parser_format_e format);
+
+//// selects how Amino JSON buffers parsed next are read (JSON_STREAMING_DEFAULT by default).
+//// Ignored where the token engine is not built (JSON_TOKEN_ENGINE)
+void parser_setEngine(parser_context_t *ctx, parser_engine_e engine);
+
+//// selects whether messages of known types are resolved from the token array (default) or traversed.
+//// Both show the same items. Ignored where the token engine is not built (JSON_TOKEN_ENGINE)
+void parser_setMsgRenderers(parser_context_t *ctx, bool enabled);
+
 //// parses a tx buffer
 parser_error_t parser_parse(parser_context_t *ctx,
                             const uint8_t *data,
@@ -36,12 +63,28 @@ parser_error_t parser_validate(const parser_context_t *ctx);
 parser_error_t parser_getNumItems(const parser_context_t *ctx, uint8_t *num_items);
 
 // retrieves a readable output for each field / page
+// if outVal is NULL, the item is only checked and measured (pageCount) using outValLen as page size
 parser_error_t parser_getItem(const parser_context_t *ctx,
                               uint8_t displayIdx,
                               char *outKey, uint16_t outKeyLen,
                               char *outVal, uint16_t outValLen,
                               uint8_t pageIdx, uint8_t *pageCount);
 
+/// Receives a page of an item. When err is not parser_ok, the item could not be rendered
+/// and outVal is meaningless. Returning an error stops parser_renderAll
+typedef parser_error_t (*parser_render_fn)(void *user,
+                                           uint8_t displayIdx,
+                                           const char *outKey, const char *outVal,
+                                           uint8_t pageIdx, uint8_t pageCount,
+                                           parser_error_t err);
+
+// renders every page of every item in a single walk, same output as parser_getItem
+// outValLen is the page width of the device model being shown
+parser_error_t parser_renderAll(const parser_context_t *ctx,
+                                char *outKey, uint16_t outKeyLen,
+                                char *outVal, uint16_t outValLen,
+                                parser_render_fn render, void *user);
+
 #ifdef __cplusplus
 }
 #endif
@@ -63,12 +63,17 @@ typedef enum {
     parser_json_missing_account_number,
     parser_json_missing_memo,
     parser_json_unexpected_error,
+    parser_json_too_deep,
 } parser_error_t;
 
+struct parser_tx_t;
+
 typedef struct {
     const uint8_t *buffer;
     uint16_t bufferLen;
     uint16_t offset;
+    // parsing state, set by parser_initContext or parser_bindState. NULL until then
+    struct parser_tx_t *tx_obj;
 } parser_context_t;
 
 #ifdef __cplusplus
@@ -16,17 +16,28 @@
 
 #include "tx.h"
 #include "apdu_codes.h"
-#include "buffering.h"
+#include "tx_buffer.h"
 #include "parser.h"
+#include "parser_cache.h"
+#include "sha256.h"
+#include "batch.h"
+#include "ram_arena.h"
 #include <string.h>
 #include "zxmacros.h"
 
 #if defined(TARGET_NANOX) || defined(TARGET_NANOS2)
 #define RAM_BUFFER_SIZE 8192
 #define FLASH_BUFFER_SIZE 16384
+#define FLASH_PAGE_SIZE 512
 #elif defined(TARGET_NANOS)
 #define RAM_BUFFER_SIZE 256
 #define FLASH_BUFFER_SIZE 8192
+#define FLASH_PAGE_SIZE 64
+#elif defined(APP_SIMULATOR)
+// Same as Nano X
+#define RAM_BUFFER_SIZE 8192
+#define FLASH_BUFFER_SIZE 16384
+#define FLASH_PAGE_SIZE 512
 #endif
 
 // Ram
@@ -39,58 +50,101 @@ typedef struct
 } storage_t;
 
 #if defined(TARGET_NANOS) || defined(TARGET_NANOX) || defined(TARGET_NANOS2)
-storage_t NV_CONST N_appdata_impl __attribute__((aligned(64)));
+// Page aligned, so the page batches written by tx_buffer are whole flash pages
+storage_t NV_CONST N_appdata_impl __attribute__((aligned(FLASH_PAGE_SIZE)));
 #define N_appdata (*(NV_VOLATILE storage_t *)PIC(&N_appdata_impl))
+#elif defined(APP_SIMULATOR)
+// Flash is plain RAM in the simulator
+static storage_t N_appdata;
 #endif
 
 parser_context_t ctx_parsed_tx;
 
+static tx_buffer_t tx_buffer;
+
+static void tx_flash_write(uint8_t *dst, const uint8_t *src, uint32_t len)
+{
+    MEMCPY_NV(dst, src, len);
+}
+
+// Digest of the transaction buffer, updated as chunks are appended
+static sha256_ctx_t tx_digest_ctx;
+
 void tx_initialize()
 {
-    buffering_init(
+    tx_buffer_init(
+        &tx_buffer,
         ram_buffer,
         sizeof(ram_buffer),
         (uint8_t *)N_appdata.buffer,
-        sizeof(N_appdata.buffer));
+        sizeof(N_appdata.buffer),
+        FLASH_PAGE_SIZE,
+        tx_flash_write);
+    sha256_init(&tx_digest_ctx);
+    parser_initContext(&ctx_parsed_tx);
 }
 
 void tx_reset()
 {
-    buffering_reset();
+    tx_buffer_reset(&tx_buffer);
+    sha256_init(&tx_digest_ctx);
 }
 
 uint32_t tx_append(unsigned char *buffer, uint32_t length)
 {
-    return buffering_append(buffer, length);
+    const uint32_t added = tx_buffer_append(&tx_buffer, buffer, length);
+    sha256_update(&tx_digest_ctx, buffer, added);
+    return added;
+}
+
+void tx_get_digest(uint8_t *digest)
+{
+    // Finalize a copy so the running digest is kept intact
+    sha256_ctx_t ctx;
+    MEMCPY(&ctx, &tx_digest_ctx, sizeof(ctx));
+    sha256_final(&ctx, digest);
+}
+
+void tx_restart_digest()
+{
+    sha256_init(&tx_digest_ctx);
 }
 
 uint32_t tx_get_buffer_length()
 {
-    return buffering_get_buffer()->pos;
+    return tx_buffer.len;
 }
 
 uint8_t *tx_get_buffer()
 {
-    return buffering_get_buffer()->data;
+    return (uint8_t *)tx_buffer_data(&tx_buffer);
 }
 
-static parser_tx_t tx_obj;
+const uint8_t *tx_get_range(uint32_t offset, uint32_t length)
+{
+    return tx_buffer_range(&tx_buffer, offset, length);
+}
 
-const char *tx_parse()
+uint8_t tx_get_byte(uint32_t offset)
 {
-    MEMZERO(&tx_obj, sizeof(tx_obj));
+    return tx_buffer_byte(&tx_buffer, offset);
+}
 
-    uint8_t err = parser_parse(&ctx_parsed_tx,
-                               tx_get_buffer(),
-                               tx_get_buffer_length());
+const char *tx_parse()
+{
+    // A resent payload goes straight to review
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    tx_get_digest(digest);
+
+    // Chunk reception is over, the arena now holds the display cache and parser temporaries
+    ram_arena_enter(ram_arena_review);
+
+    const parser_error_t err = parser_cache_parse(&ctx_parsed_tx,
+                                                  tx_get_buffer(),
+                                                  tx_get_buffer_length(),
+                                                  digest,
+                                                  NULL);
     zemu_log_stack("parse|parsed");
-
-    if (err != parser_ok)
-    {
-        return parser_getErrorDescription(err);
-    }
-
-    err = parser_validate(&ctx_parsed_tx);
     CHECK_APP_CANARY()
 
     if (err != parser_ok)
@@ -101,11 +155,6 @@ const char *tx_parse()
     return NULL;
 }
 
-void tx_parse_reset()
-{
-    MEMZERO(&tx_obj, sizeof(tx_obj));
-}
-
 zxerr_t tx_getNumItems(uint8_t *num_items)
 {
     parser_error_t err = parser_getNumItems(&ctx_parsed_tx, num_items);
@@ -149,3 +198,46 @@ zxerr_t tx_getItem(int8_t displayIdx,
 
     return zxerr_ok;
 }
+
+#if BATCH_SIGNING
+zxerr_t tx_batch_getNumItems(uint8_t *num_items)
+{
+    parser_error_t err = batch_getNumItems(num_items);
+
+    if (err != parser_ok)
+    {
+        return zxerr_no_data;
+    }
+
+    return zxerr_ok;
+}
+
+zxerr_t tx_batch_getItem(int8_t displayIdx,
+                         char *outKey, uint16_t outKeyLen,
+                         char *outVal, uint16_t outValLen,
+                         uint8_t pageIdx, uint8_t *pageCount)
+{
+    if (displayIdx < 0)
+    {
+        return zxerr_no_data;
+    }
+
+    parser_error_t err = batch_getItem(tx_get_buffer(),
+                                       displayIdx,
+                                       outKey, outKeyLen,
+                                       outVal, outValLen,
+                                       pageIdx, pageCount);
+
+    // Convert error codes
+    if (err == parser_no_data ||
+        err == parser_display_idx_out_of_range ||
+        err == parser_display_page_out_of_range)
+        return zxerr_no_data;
+
+    if (err != parser_ok)
+        return zxerr_unknown;
+
+    return zxerr_ok;
+}
+
+#endif
@@ -36,9 +36,24 @@ uint32_t tx_append(unsigned char *buffer, uint32_t length);
 uint32_t tx_get_buffer_length();
 
 /// Returns the raw json transaction buffer
+/// Bytes still cached in RAM are written to flash first, prefer tx_get_byte while receiving chunks
 /// \return
 uint8_t *tx_get_buffer();
 
+/// Returns a contiguous view of part of the transaction buffer
+/// Only bytes of the range still cached in RAM may be written to flash
+const uint8_t *tx_get_range(uint32_t offset, uint32_t length);
+
+/// Returns a byte of the transaction buffer, wherever it is currently stored
+uint8_t tx_get_byte(uint32_t offset);
+
+/// Returns the SHA-256 of the transaction buffer, hashed as it was appended
+/// \param digest (out) SHA256_DIGEST_SIZE bytes
+void tx_get_digest(uint8_t *digest);
+
+/// Restarts the digest from the current end of the buffer (next document of a batch)
+void tx_restart_digest();
+
 /// Parse message stored in transaction buffer
 /// This function should be called as soon as full buffer data is loaded.
 /// \return It returns NULL if data is valid or error message otherwise.
@@ -52,3 +67,12 @@ zxerr_t tx_getItem(int8_t displayIdx,
                    char *outKey, uint16_t outKeyLen,
                    char *outValue, uint16_t outValueLen,
                    uint8_t pageIdx, uint8_t *pageCount);
+
+/// Return the number of items of the combined batch review
+zxerr_t tx_batch_getNumItems(uint8_t *num_items);
+
+/// Gets an specific item from the combined batch review (including paging)
+zxerr_t tx_batch_getItem(int8_t displayIdx,
+                         char *outKey, uint16_t outKeyLen,
+                         char *outValue, uint16_t outValueLen,
+                         uint8_t pageIdx, uint8_t *pageCount);
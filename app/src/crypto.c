@@ -27,7 +27,28 @@ uint32_t hdPath[HDPATH_LEN_DEFAULT];
 uint8_t bech32_hrp_len;
 char bech32_hrp[MAX_BECH32_HRP_LEN + 1];
 
-#if defined(TARGET_NANOS) || defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+// Session cache of derived public keys and addresses, keyed by (hdPath, HRP)
+#if defined(TARGET_NANOS)
+#define ADDR_CACHE_SIZE          2
+#else
+#define ADDR_CACHE_SIZE          4
+#endif
+#define ADDR_CACHE_MAX_ADDR_LEN  64
+
+typedef struct {
+    bool valid;
+    uint32_t path[HDPATH_LEN_DEFAULT];
+    // A HRP may contain '1': its length tells which prefix of the address it is
+    uint8_t hrpLen;
+    uint8_t pubKey[PK_LEN_SECP256K1];
+    char addr[ADDR_CACHE_MAX_ADDR_LEN + 1];
+} addr_cache_entry_t;
+
+static addr_cache_entry_t addr_cache[ADDR_CACHE_SIZE];
+static uint8_t addr_cache_next;
+
+// The simulator provides software versions of the cx calls
+#if defined(TARGET_NANOS) || defined(TARGET_NANOX) || defined(TARGET_NANOS2) || defined(APP_SIMULATOR)
 #include "cx.h"
 
 zxerr_t crypto_extractPublicKey(const uint32_t path[HDPATH_LEN_DEFAULT], uint8_t *pubKey, uint16_t pubKeyLen) {
@@ -80,17 +101,11 @@ zxerr_t crypto_extractPublicKey(const uint32_t path[HDPATH_LEN_DEFAULT], uint8_t
     return err;
 }
 
-zxerr_t crypto_sign(uint8_t *signature,
-                   uint16_t signatureMaxlen,
-                   uint16_t *sigSize) {
-    uint8_t messageDigest[CX_SHA256_SIZE];
-    MEMZERO(messageDigest,sizeof(messageDigest));
-
-    // Hash it
-    const uint8_t *message = tx_get_buffer();
-    const uint16_t messageLen = tx_get_buffer_length();
-    cx_hash_sha256(message, messageLen, messageDigest, CX_SHA256_SIZE);
-
+zxerr_t crypto_signDigest(const uint32_t path[HDPATH_LEN_DEFAULT],
+                         const uint8_t *messageDigest,
+                         uint8_t *signature,
+                         uint16_t signatureMaxlen,
+                         uint16_t *sigSize) {
     cx_ecfp_private_key_t cx_privateKey;
     uint8_t privateKeyData[32];
     unsigned int info = 0;
@@ -103,7 +118,7 @@ zxerr_t crypto_sign(uint8_t *signature,
         {
             // Generate keys
             os_perso_derive_node_bip32(CX_CURVE_SECP256K1,
-                                       hdPath,
+                                       path,
                                        HDPATH_LEN_DEFAULT,
                                        privateKeyData, NULL);
 
@@ -133,6 +148,18 @@ zxerr_t crypto_sign(uint8_t *signature,
     return err;
 }
 
+zxerr_t crypto_sign(uint8_t *signature,
+                   uint16_t signatureMaxlen,
+                   uint16_t *sigSize) {
+    uint8_t messageDigest[CX_SHA256_SIZE];
+    MEMZERO(messageDigest,sizeof(messageDigest));
+
+    // The transaction has already been hashed while its chunks were received
+    tx_get_digest(messageDigest);
+
+    return crypto_signDigest(hdPath, messageDigest, signature, signatureMaxlen, sigSize);
+}
+
 #else
 
 void crypto_extractPublicKey(const uint32_t path[HDPATH_LEN_DEFAULT], uint8_t *pubKey, uint16_t pubKeyLen) {
@@ -185,11 +212,58 @@ void crypto_set_hrp(char *p) {
     }
 }
 
+void crypto_resetAddressCache() {
+    MEMZERO(addr_cache, sizeof(addr_cache));
+    addr_cache_next = 0;
+}
+
+static const addr_cache_entry_t *addr_cache_find() {
+    for (uint8_t i = 0; i < ADDR_CACHE_SIZE; i++) {
+        const addr_cache_entry_t *entry = &addr_cache[i];
+        if (entry->valid &&
+            MEMCMP(entry->path, hdPath, sizeof(entry->path)) == 0 &&
+            entry->hrpLen == bech32_hrp_len &&
+            MEMCMP(entry->addr, bech32_hrp, bech32_hrp_len) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void addr_cache_store(const uint8_t *pubKey, const char *addr) {
+    if (strlen(addr) > ADDR_CACHE_MAX_ADDR_LEN) {
+        return;
+    }
+
+    addr_cache_entry_t *entry = &addr_cache[addr_cache_next];
+    MEMCPY(entry->path, hdPath, sizeof(entry->path));
+    entry->hrpLen = bech32_hrp_len;
+    MEMCPY(entry->pubKey, pubKey, sizeof(entry->pubKey));
+    snprintf(entry->addr, sizeof(entry->addr), "%s", addr);
+    entry->valid = true;
+
+    addr_cache_next = (addr_cache_next + 1) % ADDR_CACHE_SIZE;
+}
+
 zxerr_t crypto_fillAddress(uint8_t *buffer, uint16_t buffer_len, uint16_t *addrResponseLen) {
     if (buffer_len < PK_LEN_SECP256K1 + 50) {
         return zxerr_buffer_too_small;
     }
 
+    char *addr = (char *) (buffer + PK_LEN_SECP256K1);
+
+    const addr_cache_entry_t *cached = addr_cache_find();
+    if (cached != NULL) {
+        const size_t addrLen = strlen(cached->addr);
+        if (addrLen >= (size_t) (buffer_len - PK_LEN_SECP256K1)) {
+            return zxerr_buffer_too_small;
+        }
+        MEMCPY(buffer, cached->pubKey, PK_LEN_SECP256K1);
+        MEMCPY(addr, cached->addr, addrLen + 1);
+        *addrResponseLen = PK_LEN_SECP256K1 + addrLen;
+        return zxerr_ok;
+    }
+
     // extract pubkey
     CHECK_ZXERR(crypto_extractPublicKey(hdPath, buffer, buffer_len))
 
@@ -200,10 +274,66 @@ zxerr_t crypto_fillAddress(uint8_t *buffer, uint16_t buffer_len, uint16_t *addrR
     uint8_t hashed2_pk[CX_RIPEMD160_SIZE];
     ripemd160_32(hashed2_pk, hashed1_pk);
 
-    char *addr = (char *) (buffer + PK_LEN_SECP256K1);
     CHECK_ZXERR(bech32EncodeFromBytes(addr, buffer_len - PK_LEN_SECP256K1, bech32_hrp, hashed2_pk, CX_RIPEMD160_SIZE, 1))
 
     *addrResponseLen = PK_LEN_SECP256K1 + strlen(addr);
+    addr_cache_store(buffer, addr);
+
+    return zxerr_ok;
+}
+
+zxerr_t crypto_fillAddressBatch(uint8_t *buffer, uint16_t bufferLen,
+                                uint8_t pathIdx, uint8_t count, bool pubKeyOnly,
+                                uint16_t *responseLen) {
+    *responseLen = 0;
+    if (bufferLen < 1 || pathIdx >= HDPATH_LEN_DEFAULT) {
+        return zxerr_buffer_too_small;
+    }
+
+    // bech32 address of a 20 byte hash: hrp + '1' + 32 data chars + 6 checksum chars
+    const uint16_t expectedRecordLen = pubKeyOnly ?
+                                       PK_LEN_SECP256K1 :
+                                       PK_LEN_SECP256K1 + 1 + bech32_hrp_len + 39;
+
+    uint8_t record[PK_LEN_SECP256K1 + MAX_BECH32_HRP_LEN + 50];
+    const uint32_t basePath = hdPath[pathIdx];
+
+    zxerr_t err = zxerr_ok;
+    uint16_t pos = 1;
+    buffer[0] = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (pos + expectedRecordLen > bufferLen) {
+            break;
+        }
+
+        hdPath[pathIdx] = basePath + i;
+        uint16_t recordLen = 0;
+        MEMZERO(record, sizeof(record));
+        err = crypto_fillAddress(record, sizeof(record), &recordLen);
+        if (err != zxerr_ok) {
+            break;
+        }
+
+        const uint16_t addrLen = recordLen - PK_LEN_SECP256K1;
+        if (pos + (pubKeyOnly ? PK_LEN_SECP256K1 : recordLen + 1) > bufferLen) {
+            break;
+        }
+
+        MEMCPY(buffer + pos, record, PK_LEN_SECP256K1);
+        pos += PK_LEN_SECP256K1;
+        if (!pubKeyOnly) {
+            buffer[pos++] = (uint8_t) addrLen;
+            MEMCPY(buffer + pos, record + PK_LEN_SECP256K1, addrLen);
+            pos += addrLen;
+        }
+        buffer[0]++;
+    }
+    hdPath[pathIdx] = basePath;
+
+    if (err != zxerr_ok) {
+        return err;
+    }
 
+    *responseLen = pos;
     return zxerr_ok;
 }
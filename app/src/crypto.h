@@ -35,10 +35,27 @@ uint8_t extractHRP(uint32_t rx, uint32_t offset);
 
 void crypto_set_hrp(char *p);
 
+/// Fills buffer with the public key followed by the bech32 address for the current hdPath and HRP
+/// Results are cached for the session, see crypto_resetAddressCache
 zxerr_t crypto_fillAddress(uint8_t *buffer, uint16_t bufferLen, uint16_t *addrResponseLen);
 
+/// Forgets all cached public keys and addresses (app start, device lock)
+void crypto_resetAddressCache();
+
+/// Fills buffer with consecutive addresses, incrementing hdPath[pathIdx] from its current value
+/// Output is [N] followed by N records of [PK][ADDR_LEN][ADDR], or [PK] when pubKeyOnly is set
+/// Stops after count records or when the next record does not fit. hdPath is left unchanged
+zxerr_t crypto_fillAddressBatch(uint8_t *buffer, uint16_t bufferLen,
+                                uint8_t pathIdx, uint8_t count, bool pubKeyOnly,
+                                uint16_t *responseLen);
+
 zxerr_t crypto_sign(uint8_t *signature, uint16_t signatureMaxlen, uint16_t *signatureLen);
 
+/// Signs a SHA-256 digest with the key derived from path
+zxerr_t crypto_signDigest(const uint32_t path[HDPATH_LEN_DEFAULT],
+                         const uint8_t *messageDigest,
+                         uint8_t *signature, uint16_t signatureMaxlen, uint16_t *signatureLen);
+
 #ifdef __cplusplus
 }
 #endif
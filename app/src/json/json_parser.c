@@ -21,6 +21,7 @@
 
 #define EQUALS(_P, _Q, _LEN) (MEMCMP( (const void*) PIC(_P), (const void*) PIC(_Q), (_LEN))==0)
 
+#if JSON_TOKEN_ENGINE
 parser_error_t json_parse(parsed_json_t *parsed_json, const char *buffer, uint16_t bufferLen) {
     jsmn_parser parser;
     jsmn_init(&parser);
@@ -258,3 +259,14 @@ parser_error_t object_get_value(const parsed_json_t *json,
 
     return parser_no_data;
 }
+
+uint16_t json_next_sibling(const parsed_json_t *json,
+                           uint16_t token_index) {
+    const int32_t end = json->tokens[token_index].end;
+    token_index++;
+    while (token_index < json->numberOfTokens && json->tokens[token_index].start < end) {
+        token_index++;
+    }
+    return token_index;
+}
+#endif
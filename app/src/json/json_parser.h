@@ -39,6 +39,17 @@ extern "C" {
 #define MAX_NUMBER_OF_TOKENS    96
 #endif
 
+/// Transactions are read without tokens by default (see json_stream.h), so they are not limited by MAX_NUMBER_OF_TOKENS
+#if defined(TARGET_NANOS)
+#define JSON_STREAMING_DEFAULT  1
+#else
+#define JSON_STREAMING_DEFAULT  0
+#endif
+
+/// The token engine (parser_engine_tokens) is only built when it is the default: elsewhere its token array
+/// would be most of the parser state
+#define JSON_TOKEN_ENGINE       (!JSON_STREAMING_DEFAULT)
+
 #define ROOT_TOKEN_INDEX 0
 
 //---------------------------------------------
@@ -49,11 +60,14 @@ extern "C" {
 typedef struct {
     uint8_t isValid;
     uint32_t numberOfTokens;
+#if JSON_TOKEN_ENGINE
     jsmntok_t tokens[MAX_NUMBER_OF_TOKENS];
+#endif
     const char *buffer;
     uint16_t bufferLen;
 } parsed_json_t;
 
+#if JSON_TOKEN_ENGINE
 //---------------------------------------------
 // NEW JSON PARSER CODE
 
@@ -127,6 +141,14 @@ parser_error_t object_get_value(const parsed_json_t *json,
                                 const char *key_name,
                                 uint16_t *token_index);
 
+/// Get the token index that follows the given token and all of its children
+/// \param json
+/// \param token_index
+/// \return token index of the next sibling (numberOfTokens if there is none)
+uint16_t json_next_sibling(const parsed_json_t *json,
+                           uint16_t token_index);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,361 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include <zxmacros.h>
+#include "json_stream.h"
+
+// Same whitespace as jsmn
+__Z_INLINE bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+__Z_INLINE bool is_hex(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+}
+
+__Z_INLINE bool in_array(const json_cursor_t *cursor) {
+    return (cursor->arrayMask & (1u << (cursor->depth - 1))) != 0;
+}
+
+__Z_INLINE void value_read(json_cursor_t *cursor) {
+    cursor->expect = cursor->depth == 0 ? json_expect_nothing : json_expect_next;
+}
+
+// Same escapes as jsmn_parse_string
+static parser_error_t read_string(const json_stream_t *json, json_cursor_t *cursor, json_event_t *event) {
+    event->type = JSMN_STRING;
+    event->start = cursor->offset + 1;
+
+    for (uint16_t i = event->start; i < json->bufferLen; i++) {
+        const char c = json->buffer[i];
+        if (c == '"') {
+            event->end = i;
+            cursor->offset = i + 1;
+            return parser_ok;
+        }
+        if (c != '\\' || i + 1 >= json->bufferLen) {
+            continue;
+        }
+        i++;
+        switch (json->buffer[i]) {
+            case '"':
+            case '/':
+            case '\\':
+            case 'b':
+            case 'f':
+            case 'r':
+            case 'n':
+            case 't':
+                break;
+            case 'u':
+                for (uint8_t j = 0; j < 4 && i + 1 < json->bufferLen; j++) {
+                    i++;
+                    if (!is_hex(json->buffer[i])) {
+                        return parser_unexpected_characters;
+                    }
+                }
+                break;
+            default:
+                return parser_unexpected_characters;
+        }
+    }
+
+    return parser_json_incomplete_json;
+}
+
+// Same as jsmn_parse_primitive (non strict): anything printable up to a delimiter
+static parser_error_t read_primitive(const json_stream_t *json, json_cursor_t *cursor, json_event_t *event) {
+    event->type = JSMN_PRIMITIVE;
+    event->start = cursor->offset;
+
+    uint16_t i = cursor->offset;
+    for (; i < json->bufferLen; i++) {
+        const uint8_t c = (uint8_t) json->buffer[i];
+        if (c == ':' || c == ',' || c == ']' || c == '}' || is_space((char) c)) {
+            break;
+        }
+        if (c < 32 || c >= 127) {
+            return parser_unexpected_characters;
+        }
+    }
+
+    event->end = i;
+    cursor->offset = i;
+    return parser_ok;
+}
+
+static parser_error_t read_value(const json_stream_t *json, json_cursor_t *cursor, json_event_t *event) {
+    const char c = json->buffer[cursor->offset];
+    switch (c) {
+        case '{':
+        case '[':
+            if (cursor->depth >= JSON_STREAM_MAX_DEPTH) {
+                return parser_json_too_deep;
+            }
+            if (c == '[') {
+                cursor->arrayMask |= (1u << cursor->depth);
+            } else {
+                cursor->arrayMask &= ~(1u << cursor->depth);
+            }
+            cursor->depth++;
+            cursor->expect = c == '[' ? json_expect_value_or_end : json_expect_key_or_end;
+            event->kind = json_event_open;
+            event->type = c == '[' ? JSMN_ARRAY : JSMN_OBJECT;
+            event->start = cursor->offset;
+            cursor->offset++;
+            return parser_ok;
+        case '"':
+            event->kind = json_event_value;
+            CHECK_PARSER_ERR(read_string(json, cursor, event))
+            value_read(cursor);
+            return parser_ok;
+        case '}':
+        case ']':
+        case ',':
+        case ':':
+            return parser_unexpected_characters;
+        default:
+            event->kind = json_event_value;
+            CHECK_PARSER_ERR(read_primitive(json, cursor, event))
+            value_read(cursor);
+            return parser_ok;
+    }
+}
+
+static parser_error_t read_close(json_cursor_t *cursor, char c, json_event_t *event) {
+    if ((c != '}' && c != ']') || (c == ']') != in_array(cursor)) {
+        return parser_unexpected_characters;
+    }
+    event->kind = json_event_close;
+    event->type = c == ']' ? JSMN_ARRAY : JSMN_OBJECT;
+    event->start = cursor->offset;
+    event->end = cursor->offset + 1;
+    cursor->offset++;
+    cursor->depth--;
+    value_read(cursor);
+    return parser_ok;
+}
+
+void json_stream_cursor(json_cursor_t *cursor, uint16_t offset) {
+    MEMZERO(cursor, sizeof(*cursor));
+    cursor->offset = offset;
+    cursor->expect = json_expect_value;
+}
+
+parser_error_t json_stream_next(const json_stream_t *json, json_cursor_t *cursor, json_event_t *event) {
+    MEMZERO(event, sizeof(*event));
+
+    while (cursor->expect != json_expect_nothing) {
+        while (cursor->offset < json->bufferLen && is_space(json->buffer[cursor->offset])) {
+            cursor->offset++;
+        }
+        if (cursor->offset >= json->bufferLen) {
+            return parser_json_incomplete_json;
+        }
+
+        const char c = json->buffer[cursor->offset];
+        event->offset = cursor->offset;
+        switch (cursor->expect) {
+            case json_expect_colon:
+                if (c != ':') {
+                    return parser_unexpected_characters;
+                }
+                cursor->offset++;
+                cursor->expect = json_expect_value;
+                continue;
+            case json_expect_next:
+                if (c == ',') {
+                    cursor->offset++;
+                    cursor->expect = in_array(cursor) ? json_expect_value : json_expect_key;
+                    continue;
+                }
+                return read_close(cursor, c, event);
+            case json_expect_key_or_end:
+            case json_expect_key:
+                if (c == '"') {
+                    event->kind = json_event_key;
+                    CHECK_PARSER_ERR(read_string(json, cursor, event))
+                    cursor->expect = json_expect_colon;
+                    return parser_ok;
+                }
+                if (cursor->expect == json_expect_key_or_end) {
+                    return read_close(cursor, c, event);
+                }
+                return parser_unexpected_characters;
+            case json_expect_value_or_end:
+                if (c == ']') {
+                    return read_close(cursor, c, event);
+                }
+                return read_value(json, cursor, event);
+            default:
+                return read_value(json, cursor, event);
+        }
+    }
+
+    return parser_no_data;
+}
+
+parser_error_t json_stream_skip(const json_stream_t *json, json_cursor_t *cursor, json_event_t *event) {
+    if (event->kind != json_event_open) {
+        return parser_ok;
+    }
+
+    const uint8_t depth = cursor->depth - 1;
+    json_event_t inner;
+    do {
+        CHECK_PARSER_ERR(json_stream_next(json, cursor, &inner))
+    } while (inner.kind != json_event_close || cursor->depth != depth);
+
+    event->end = inner.end;
+    return parser_ok;
+}
+
+parser_error_t json_stream_parse(json_stream_t *json, const char *buffer, uint16_t bufferLen) {
+    MEMZERO(json, sizeof(*json));
+    json->buffer = buffer;
+
+    // jsmn stops at the first NUL
+    while (json->bufferLen < bufferLen && buffer[json->bufferLen] != 0) {
+        json->bufferLen++;
+    }
+
+    while (json->root < json->bufferLen && is_space(buffer[json->root])) {
+        json->root++;
+    }
+    if (json->root >= json->bufferLen) {
+        return parser_json_zero_tokens;
+    }
+
+    json_cursor_t cursor;
+    json_event_t event;
+    json_stream_cursor(&cursor, json->root);
+    CHECK_PARSER_ERR(json_stream_next(json, &cursor, &event))
+    CHECK_PARSER_ERR(json_stream_skip(json, &cursor, &event))
+
+    for (uint16_t i = cursor.offset; i < json->bufferLen; i++) {
+        if (!is_space(buffer[i])) {
+            return parser_unexpected_characters;
+        }
+    }
+
+    return parser_ok;
+}
+
+parser_error_t json_stream_value(const json_stream_t *json, uint16_t offset, json_event_t *value) {
+    json_cursor_t cursor;
+    json_stream_cursor(&cursor, offset);
+    CHECK_PARSER_ERR(json_stream_next(json, &cursor, value))
+    return json_stream_skip(json, &cursor, value);
+}
+
+parser_error_t json_stream_token(const json_stream_t *json, uint16_t offset, uint16_t n, json_event_t *token) {
+    json_cursor_t cursor;
+    json_stream_cursor(&cursor, offset);
+
+    uint16_t i = 0;
+    while (true) {
+        CHECK_PARSER_ERR(json_stream_next(json, &cursor, token))
+        if (token->kind == json_event_close) {
+            continue;
+        }
+        if (i == n) {
+            // Find the end without moving on
+            json_cursor_t tmp = cursor;
+            return json_stream_skip(json, &tmp, token);
+        }
+        i++;
+    }
+}
+
+// Opens the container found at offset. Returns parser_no_data for other values
+__Z_INLINE parser_error_t open_container(const json_stream_t *json, uint16_t offset,
+                                         json_cursor_t *cursor, json_event_t *event) {
+    json_stream_cursor(cursor, offset);
+    CHECK_PARSER_ERR(json_stream_next(json, cursor, event))
+    return event->kind == json_event_open ? parser_ok : parser_no_data;
+}
+
+parser_error_t json_stream_next_child(const json_stream_t *json, json_cursor_t *cursor, json_event_t *event) {
+    CHECK_PARSER_ERR(json_stream_next(json, cursor, event))
+    if (event->kind == json_event_close) {
+        return parser_no_data;
+    }
+    return json_stream_skip(json, cursor, event);
+}
+
+parser_error_t json_stream_element_count(const json_stream_t *json, uint16_t offset, uint16_t *count) {
+    *count = 0;
+
+    json_cursor_t cursor;
+    json_event_t event;
+    parser_error_t err = open_container(json, offset, &cursor, &event);
+    if (err == parser_no_data) {
+        return parser_ok;
+    }
+    CHECK_PARSER_ERR(err)
+
+    while ((err = json_stream_next_child(json, &cursor, &event)) == parser_ok) {
+        (*count)++;
+    }
+    return err == parser_no_data ? parser_ok : err;
+}
+
+parser_error_t json_stream_nth_element(const json_stream_t *json, uint16_t offset, uint16_t n, uint16_t *element_offset) {
+    json_cursor_t cursor;
+    json_event_t event;
+    CHECK_PARSER_ERR(open_container(json, offset, &cursor, &event))
+
+    for (uint16_t i = 0; i <= n; i++) {
+        CHECK_PARSER_ERR(json_stream_next_child(json, &cursor, &event))
+    }
+    *element_offset = event.offset;
+    return parser_ok;
+}
+
+parser_error_t json_stream_object_get_value(const json_stream_t *json, uint16_t object_offset,
+                                            const char *key_name, uint16_t *value_offset) {
+    json_cursor_t cursor;
+    json_event_t key;
+    json_event_t value;
+    CHECK_PARSER_ERR(open_container(json, object_offset, &cursor, &key))
+    if (key.type != JSMN_OBJECT) {
+        return parser_no_data;
+    }
+
+    while (true) {
+        CHECK_PARSER_ERR(json_stream_next_child(json, &cursor, &key))
+        CHECK_PARSER_ERR(json_stream_next_child(json, &cursor, &value))
+        if (json_stream_compare(json, &key, key_name) == 0) {
+            *value_offset = value.offset;
+            return parser_ok;
+        }
+    }
+}
+
+int8_t json_stream_compare(const json_stream_t *json, const json_event_t *event, const char *s) {
+    const size_t len = event->end - event->start;
+    const size_t s_len = strlen(s);
+    const size_t common_len = len < s_len ? len : s_len;
+
+    const int cmp = MEMCMP(json->buffer + event->start, s, common_len);
+    if (cmp != 0) {
+        return cmp < 0 ? -1 : 1;
+    }
+    if (len == s_len) {
+        return 0;
+    }
+    return len < s_len ? -1 : 1;
+}
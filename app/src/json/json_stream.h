@@ -0,0 +1,119 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#include <jsmn.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "common/parser_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Reads JSON without tokenizing it: values are referred to by their offset in the buffer, and are
+// found again by scanning it whenever they are needed. Memory use does not depend on the document.
+// Strings and primitives follow the jsmn rules, but the structure must be strict JSON
+// (jsmn also accepts missing colons, trailing commas, unquoted keys, etc.)
+
+/// Containers are tracked in a bit mask
+#define JSON_STREAM_MAX_DEPTH   32u
+
+typedef struct {
+    const char *buffer;
+    uint16_t bufferLen;         // up to the first NUL, as jsmn
+    uint16_t root;              // offset of the root value
+} json_stream_t;
+
+typedef enum {
+    json_expect_value = 0,
+    json_expect_value_or_end,   // after '['
+    json_expect_key_or_end,     // after '{'
+    json_expect_key,            // after ',' in an object
+    json_expect_colon,
+    json_expect_next,           // after a value: ',' or the end of its container
+    json_expect_nothing,        // the value the cursor started on has been read
+} json_expect_e;
+
+/// Position in a document. It is small enough to be kept, so that reading can resume from it
+typedef struct {
+    uint16_t offset;            // next byte to read
+    uint8_t depth;              // containers opened since the cursor started
+    uint8_t expect;             // json_expect_e
+    uint32_t arrayMask;         // bit n is set when the container at depth n + 1 is an array
+} json_cursor_t;
+
+typedef enum {
+    json_event_open = 0,        // '{' or '['
+    json_event_close,
+    json_event_key,
+    json_event_value,           // string or primitive
+} json_event_e;
+
+/// Bounds are the ones of the equivalent jsmn token: strings exclude their quotes,
+/// containers include their brackets (the end is only known once they are skipped)
+typedef struct {
+    uint8_t kind;               // json_event_e
+    jsmntype_t type;
+    uint16_t offset;            // first byte, the opening quote of strings
+    uint16_t start;
+    uint16_t end;
+} json_event_t;
+
+/// Checks that the buffer holds a single JSON value, and locates it
+/// \return the jsmn errors (parser_unexpected_characters, parser_json_incomplete_json, ...),
+///         parser_json_too_deep beyond JSON_STREAM_MAX_DEPTH
+parser_error_t json_stream_parse(json_stream_t *json, const char *buffer, uint16_t bufferLen);
+
+/// Starts reading the value found at offset
+void json_stream_cursor(json_cursor_t *cursor, uint16_t offset);
+
+/// Reads the next key, value, or container start/end. Whitespace is skipped
+/// \return parser_no_data once the value the cursor started on has been read
+parser_error_t json_stream_next(const json_stream_t *json, json_cursor_t *cursor, json_event_t *event);
+
+/// After an event opening a container, reads up to the end of the container and sets event->end
+parser_error_t json_stream_skip(const json_stream_t *json, json_cursor_t *cursor, json_event_t *event);
+
+/// Reads the next key or element of the container the cursor is in, skipping what is nested in it
+/// \return parser_no_data at the end of the container
+parser_error_t json_stream_next_child(const json_stream_t *json, json_cursor_t *cursor, json_event_t *event);
+
+/// Reads the value found at offset, with its bounds
+parser_error_t json_stream_value(const json_stream_t *json, uint16_t offset, json_event_t *value);
+
+/// Finds the n-th token from a value on, in jsmn order (0 is the value itself, then keys and values inside it)
+/// \return parser_no_data when the value has fewer tokens
+parser_error_t json_stream_token(const json_stream_t *json, uint16_t offset, uint16_t n, json_event_t *token);
+
+/// Same as array_get_element_count: number of elements of an array, or of keys and values of an object
+parser_error_t json_stream_element_count(const json_stream_t *json, uint16_t offset, uint16_t *count);
+
+/// Same as array_get_nth_element
+/// \return parser_no_data when there are not enough elements
+parser_error_t json_stream_nth_element(const json_stream_t *json, uint16_t offset, uint16_t n, uint16_t *element_offset);
+
+/// Same as object_get_value
+/// \return parser_no_data when the object does not have the key
+parser_error_t json_stream_object_get_value(const json_stream_t *json, uint16_t object_offset,
+                                            const char *key_name, uint16_t *value_offset);
+
+/// Compares the bytes of a key or value with a C string, following strcmp ordering
+int8_t json_stream_compare(const json_stream_t *json, const json_event_t *event, const char *s);
+
+#ifdef __cplusplus
+}
+#endif
@@ -21,46 +21,116 @@
 #include <zxtypes.h>
 #include "tx_parser.h"
 #include "tx_display.h"
+#include "tx_proto.h"
+#include "parser_cache.h"
 #include "parser_impl.h"
 #include "common/parser.h"
 #include "coin.h"
 
+// Page size used to check that all items can be displayed
+#define PARSER_VALIDATE_VALUE_LEN   40
+
 parser_error_t parser_parse(parser_context_t *ctx,
                             const uint8_t *data,
                             size_t dataLen) {
+    CHECK_CONTEXT_BOUND(ctx)
+    // Parser state is about to be overwritten
+    parser_cache_invalidate(ctx);
+    if (parser_getTx(ctx)->format == parser_format_protobuf) {
+        CHECK_PARSER_ERR(tx_proto_readTx(ctx, data, dataLen))
+        return parser_ok;
+    }
     CHECK_PARSER_ERR(tx_display_readTx(ctx, data, dataLen))
     return parser_ok;
 }
 
+void parser_initContext(parser_context_t *ctx) {
+    MEMZERO(ctx, sizeof(*ctx));
+    ctx->tx_obj = &parser_tx_obj;
+}
+
+void parser_bindState(parser_context_t *ctx, parser_state_t *state) {
+    MEMZERO(ctx, sizeof(*ctx));
+    MEMZERO(state, sizeof(*state));
+    state->tx_obj.display = &state->display;
+    state->tx_obj.scratch = &state->scratch;
+    ctx->tx_obj = &state->tx_obj;
+}
+
+void parser_setMode(parser_context_t *ctx, parser_mode_e mode) {
+    if (ctx->tx_obj != NULL) {
+        parser_tx_t *tx_obj = parser_getTx(ctx);
+        tx_obj->mode = mode;
+        // Items were indexed and validated for the previous mode
+        tx_obj->flags.cache_valid = 0;
+        tx_obj->parsed.valid = false;
+    }
+}
+
+void parser_setFormat(parser_context_t *ctx, parser_format_e format) {
+    if (ctx->tx_obj != NULL) {
+        parser_getTx(ctx)->format = format;
+    }
+}
+
+void parser_setEngine(parser_context_t *ctx, parser_engine_e engine) {
+    if (ctx->tx_obj != NULL) {
+        parser_getTx(ctx)->engine = engine;
+    }
+}
+
+void parser_setMsgRenderers(parser_context_t *ctx, bool enabled) {
+    if (ctx->tx_obj != NULL) {
+        parser_tx_t *tx_obj = parser_getTx(ctx);
+        tx_obj->flags.msg_renderers_off = !enabled;
+        tx_obj->flags.cache_valid = 0;
+    }
+}
+
 parser_error_t parser_validate(const parser_context_t *ctx) {
-    CHECK_PARSER_ERR(tx_validate(&parser_tx_obj.json))
+    CHECK_CONTEXT_BOUND(ctx)
+    parser_tx_t *tx_obj = parser_getTx(ctx);
+
+    // Protobuf payloads are fully checked while parsing
+    if (tx_obj->format == parser_format_amino_json) {
+        if (parser_isStreaming(tx_obj)) {
+            CHECK_PARSER_ERR(tx_validate_stream(&tx_obj->stream))
+        }
+#if JSON_TOKEN_ENGINE
+        else {
+            CHECK_PARSER_ERR(tx_validate(&tx_obj->json))
+        }
+#endif
+    }
 
     // Iterate through all items to check that all can be shown and are valid
+    // Items are only measured, nothing is rendered
     uint8_t numItems = 0;
     CHECK_PARSER_ERR(parser_getNumItems(ctx, &numItems))
 
-    char tmpKey[40];
-    char tmpVal[40];
-
     for (uint8_t idx = 0; idx < numItems; idx++) {
         uint8_t pageCount = 0;
-        CHECK_PARSER_ERR(parser_getItem(ctx, idx, tmpKey, sizeof(tmpKey), tmpVal, sizeof(tmpVal), 0, &pageCount))
+        CHECK_PARSER_ERR(parser_getItem(ctx, idx, NULL, 0, NULL, PARSER_VALIDATE_VALUE_LEN, 0, &pageCount))
     }
 
     return parser_ok;
 }
 
-parser_error_t parser_getNumItems(const parser_context_t *ctx __attribute__((unused)), uint8_t *num_items) {
+parser_error_t parser_getNumItems(const parser_context_t *ctx, uint8_t *num_items) {
     *num_items = 0;
-    return tx_display_numItems(num_items);
+    CHECK_CONTEXT_BOUND(ctx)
+    return tx_display_numItems(parser_getTx(ctx), num_items);
 }
 
-__Z_INLINE bool_t parser_areEqual(uint16_t tokenIdx, char *expected) {
-    if (parser_tx_obj.json.tokens[tokenIdx].type != JSMN_STRING) {
+__Z_INLINE bool_t parser_areEqual(parser_tx_t *tx_obj, uint16_t tokenIdx, char *expected) {
+    jsmntype_t type;
+    int32_t start;
+    int32_t end;
+    if (tx_getBounds(tx_obj, tokenIdx, &type, &start, &end) != parser_ok || type != JSMN_STRING) {
         return bool_false;
     }
 
-    int32_t len = parser_tx_obj.json.tokens[tokenIdx].end - parser_tx_obj.json.tokens[tokenIdx].start;
+    int32_t len = end - start;
     if (len < 0) {
         return bool_false;
     }
@@ -69,7 +139,7 @@ __Z_INLINE bool_t parser_areEqual(uint16_t tokenIdx, char *expected) {
         return bool_false;
     }
 
-    const char *p = parser_tx_obj.tx + parser_tx_obj.json.tokens[tokenIdx].start;
+    const char *p = tx_obj->tx + start;
     for (int32_t i = 0; i < len; i++) {
         if (expected[i] != *(p + i)) {
             return bool_false;
@@ -111,8 +181,8 @@ __Z_INLINE bool_t parser_isAmount(char *key) {
     return bool_false;
 }
 
-__Z_INLINE bool_t is_default_denom_base(const char *denom, uint8_t denom_len) {
-    if (tx_is_expert_mode()) {
+__Z_INLINE bool_t is_default_denom_base(parser_tx_t *tx_obj, const char *denom, uint8_t denom_len) {
+    if (tx_is_expert_mode(tx_obj)) {
         return false;
     }
 
@@ -126,17 +196,71 @@ __Z_INLINE bool_t is_default_denom_base(const char *denom, uint8_t denom_len) {
     return bool_false;
 }
 
-__Z_INLINE parser_error_t parser_formatAmountItem(uint16_t amountToken,
+parser_error_t parser_formatCoin(parser_tx_t *tx_obj,
+                                 const char *amountPtr, int32_t amountLen,
+                                 const char *denomPtr, int32_t denomLen,
+                                 char *outVal, uint16_t outValLen,
+                                 uint8_t pageIdx, uint8_t *pageCount) {
+    *pageCount = 0;
+
+    if (denomLen <= 0 || denomLen >= COIN_DENOM_MAXSIZE) {
+        return parser_unexpected_error;
+    }
+    if (amountLen <= 0 || amountLen >= COIN_AMOUNT_MAXSIZE) {
+        return parser_unexpected_error;
+    }
+
+    char *bufferUI = tx_obj->scratch->render.value;
+    const size_t bufferUILen = sizeof(tx_obj->scratch->render.value);
+    char tmpDenom[COIN_DENOM_MAXSIZE];
+    char tmpAmount[COIN_AMOUNT_MAXSIZE];
+    MEMZERO(tmpDenom, sizeof tmpDenom);
+    MEMZERO(tmpAmount, sizeof(tmpAmount));
+    MEMZERO(bufferUI, bufferUILen);
+
+    const size_t totalLen = amountLen + denomLen + 2;
+    if (bufferUILen < totalLen) {
+        return parser_unexpected_buffer_end;
+    }
+
+    // Extract amount and denomination
+    MEMCPY(tmpDenom, denomPtr, denomLen);
+    MEMCPY(tmpAmount, amountPtr, amountLen);
+
+    snprintf(bufferUI, bufferUILen, "%s ", tmpAmount);
+    // If denomination has been recognized format and replace
+    if (is_default_denom_base(tx_obj, denomPtr, denomLen)) {
+        if (fpstr_to_str(bufferUI, bufferUILen, tmpAmount, COIN_DEFAULT_DENOM_FACTOR) != 0) {
+            return parser_unexpected_error;
+        }
+        number_inplace_trimming(bufferUI, COIN_DEFAULT_DENOM_TRIMMING);
+        snprintf(tmpDenom, sizeof(tmpDenom), " %s", COIN_DEFAULT_DENOM_REPR);
+    }
+
+    z_str3join(bufferUI, bufferUILen, "", tmpDenom);
+
+    if (outVal == NULL) {
+        *pageCount = tx_countPages(strlen(bufferUI), outValLen);
+        return parser_ok;
+    }
+    pageString(outVal, outValLen, bufferUI, pageIdx, pageCount);
+
+    return parser_ok;
+}
+
+__Z_INLINE parser_error_t parser_formatAmountItem(parser_tx_t *tx_obj, uint16_t amountToken,
                                                   char *outVal, uint16_t outValLen,
                                                   uint8_t pageIdx, uint8_t *pageCount) {
     *pageCount = 0;
 
     uint16_t numElements;
-    CHECK_PARSER_ERR(array_get_element_count(&parser_tx_obj.json, amountToken, &numElements))
+    CHECK_PARSER_ERR(tx_getElementCount(tx_obj, amountToken, &numElements))
 
     if (numElements == 0) {
         *pageCount = 1;
-        snprintf(outVal, outValLen, "Empty");
+        if (outVal != NULL) {
+            snprintf(outVal, outValLen, "Empty");
+        }
         return parser_ok;
     }
 
@@ -144,77 +268,60 @@ __Z_INLINE parser_error_t parser_formatAmountItem(uint16_t amountToken,
         return parser_unexpected_field;
     }
 
-    if (parser_tx_obj.json.tokens[amountToken].type != JSMN_OBJECT) {
+    jsmntype_t type;
+    int32_t start;
+    int32_t end;
+    CHECK_PARSER_ERR(tx_getBounds(tx_obj, amountToken, &type, &start, &end))
+    if (type != JSMN_OBJECT) {
         return parser_unexpected_field;
     }
 
-    if (!parser_areEqual(amountToken + 1u, "amount")) {
-        return parser_unexpected_field;
+    // amount key, amount value, denom key, denom value
+    uint16_t coinTokens[5];
+    for (uint16_t i = 1; i < array_length(coinTokens); i++) {
+        CHECK_PARSER_ERR(tx_getNthToken(tx_obj, amountToken, i, &coinTokens[i]))
     }
 
-    if (!parser_areEqual(amountToken + 3u, "denom")) {
+    if (!parser_areEqual(tx_obj, coinTokens[1], "amount")) {
         return parser_unexpected_field;
     }
 
-    char bufferUI[160];
-    char tmpDenom[COIN_DENOM_MAXSIZE];
-    char tmpAmount[COIN_AMOUNT_MAXSIZE];
-    MEMZERO(tmpDenom, sizeof tmpDenom);
-    MEMZERO(tmpAmount, sizeof(tmpAmount));
-    MEMZERO(outVal, outValLen);
-    MEMZERO(bufferUI, sizeof(bufferUI));
-
-    const char *amountPtr = parser_tx_obj.tx + parser_tx_obj.json.tokens[amountToken + 2].start;
-    if (parser_tx_obj.json.tokens[amountToken + 2].start < 0) {
-        return parser_unexpected_buffer_end;
-    }
-
-    const int32_t amountLen = parser_tx_obj.json.tokens[amountToken + 2].end -
-                              parser_tx_obj.json.tokens[amountToken + 2].start;
-    const char *denomPtr = parser_tx_obj.tx + parser_tx_obj.json.tokens[amountToken + 4].start;
-    const int32_t denomLen = parser_tx_obj.json.tokens[amountToken + 4].end -
-                             parser_tx_obj.json.tokens[amountToken + 4].start;
-
-    if (denomLen <= 0 || denomLen >= COIN_DENOM_MAXSIZE) {
-        return parser_unexpected_error;
-    }
-    if (amountLen <= 0 || amountLen >= COIN_AMOUNT_MAXSIZE) {
-        return parser_unexpected_error;
+    if (!parser_areEqual(tx_obj, coinTokens[3], "denom")) {
+        return parser_unexpected_field;
     }
 
-    const size_t totalLen = amountLen + denomLen + 2;
-    if (sizeof(bufferUI) < totalLen) {
+    int32_t amountStart;
+    int32_t amountEnd;
+    CHECK_PARSER_ERR(tx_getBounds(tx_obj, coinTokens[2], &type, &amountStart, &amountEnd))
+    if (amountStart < 0) {
         return parser_unexpected_buffer_end;
     }
 
-    // Extract amount and denomination
-    MEMCPY(tmpDenom, denomPtr, denomLen);
-    MEMCPY(tmpAmount, amountPtr, amountLen);
-
-    snprintf(bufferUI, sizeof(bufferUI), "%s ", tmpAmount);
-    // If denomination has been recognized format and replace
-    if (is_default_denom_base(denomPtr, denomLen)) {
-        if (fpstr_to_str(bufferUI, sizeof(bufferUI), tmpAmount, COIN_DEFAULT_DENOM_FACTOR) != 0) {
-            return parser_unexpected_error;
-        }
-        number_inplace_trimming(bufferUI, COIN_DEFAULT_DENOM_TRIMMING);
-        snprintf(tmpDenom, sizeof(tmpDenom), " %s", COIN_DEFAULT_DENOM_REPR);
-    }
+    int32_t denomStart;
+    int32_t denomEnd;
+    CHECK_PARSER_ERR(tx_getBounds(tx_obj, coinTokens[4], &type, &denomStart, &denomEnd))
 
-    z_str3join(bufferUI, sizeof(bufferUI), "", tmpDenom);
-    pageString(outVal, outValLen, bufferUI, pageIdx, pageCount);
+    const char *amountPtr = tx_obj->tx + amountStart;
+    const int32_t amountLen = amountEnd - amountStart;
+    const char *denomPtr = tx_obj->tx + denomStart;
+    const int32_t denomLen = denomEnd - denomStart;
 
-    return parser_ok;
+    return parser_formatCoin(tx_obj, amountPtr, amountLen, denomPtr, denomLen,
+                             outVal, outValLen, pageIdx, pageCount);
 }
 
-__Z_INLINE parser_error_t parser_formatAmount(uint16_t amountToken,
+__Z_INLINE parser_error_t parser_formatAmount(parser_tx_t *tx_obj, uint16_t amountToken,
                                               char *outVal, uint16_t outValLen,
                                               uint8_t pageIdx, uint8_t *pageCount) {
     ZEMU_LOGF(200, "[formatAmount] ------- pageidx %d", pageIdx)
 
     *pageCount = 0;
-    if (parser_tx_obj.json.tokens[amountToken].type != JSMN_ARRAY) {
-        return parser_formatAmountItem(amountToken, outVal, outValLen, pageIdx, pageCount);
+    jsmntype_t type;
+    int32_t start;
+    int32_t end;
+    CHECK_PARSER_ERR(tx_getBounds(tx_obj, amountToken, &type, &start, &end))
+    if (type != JSMN_ARRAY) {
+        return parser_formatAmountItem(tx_obj, amountToken, outVal, outValLen, pageIdx, pageCount);
     }
 
     uint8_t totalPages = 0;
@@ -223,15 +330,15 @@ __Z_INLINE parser_error_t parser_formatAmount(uint16_t amountToken,
     uint16_t showItemTokenIdx = 0;
 
     uint16_t numberAmounts;
-    CHECK_PARSER_ERR(array_get_element_count(&parser_tx_obj.json, amountToken, &numberAmounts))
+    CHECK_PARSER_ERR(tx_getElementCount(tx_obj, amountToken, &numberAmounts))
 
     // Count total subpagesCount and calculate correct page and TokenIdx
     for (uint16_t i = 0; i < numberAmounts; i++) {
         uint16_t itemTokenIdx;
         uint8_t subpagesCount;
 
-        CHECK_PARSER_ERR(array_get_nth_element(&parser_tx_obj.json, amountToken, i, &itemTokenIdx));
-        CHECK_PARSER_ERR(parser_formatAmountItem(itemTokenIdx, outVal, outValLen, 0, &subpagesCount));
+        CHECK_PARSER_ERR(tx_getNthElement(tx_obj, amountToken, i, &itemTokenIdx));
+        CHECK_PARSER_ERR(parser_formatAmountItem(tx_obj, itemTokenIdx, NULL, outValLen, 0, &subpagesCount));
         totalPages += subpagesCount;
 
         ZEMU_LOGF(200, "[formatAmount] [%d] TokenIdx: %d - PageIdx: %d - Pages: %d - Total %d", i, itemTokenIdx,
@@ -255,12 +362,54 @@ __Z_INLINE parser_error_t parser_formatAmount(uint16_t amountToken,
 
     if (totalPages == 0) {
         *pageCount = 1;
-        snprintf(outVal, outValLen, "Empty");
+        if (outVal != NULL) {
+            snprintf(outVal, outValLen, "Empty");
+        }
+        return parser_ok;
+    }
+
+    if (outVal == NULL) {
         return parser_ok;
     }
 
     uint8_t dummy;
-    return parser_formatAmountItem(showItemTokenIdx, outVal, outValLen, showPageIdx, &dummy);
+    return parser_formatAmountItem(tx_obj, showItemTokenIdx, outVal, outValLen, showPageIdx, &dummy);
+}
+
+typedef enum {
+    value_kind_token = 0,
+    value_kind_amount,
+    value_kind_opaque,
+} value_kind_e;
+
+// How the value of an item is shown, given its key before make_friendly
+__Z_INLINE value_kind_e parser_valueKind(parser_tx_t *tx_obj, char *key) {
+    if (parser_isAmount(key)) {
+        return value_kind_amount;
+    }
+    if (!parser_isExpert(tx_obj) && tx_display_is_opaque(key)) {
+        // Only the display mode matters here, so sign data (empty chain_id) is fingerprinted too
+        return value_kind_opaque;
+    }
+    return value_kind_token;
+}
+
+__Z_INLINE parser_error_t parser_renderValue(parser_tx_t *tx_obj, value_kind_e kind, uint16_t valueTokenIdx,
+                                             char *outVal, uint16_t outValLen,
+                                             uint8_t pageIdx, uint8_t *pageCount) {
+    if (tx_obj->format == parser_format_protobuf) {
+        // Values are decoded from the payload, see tx_display_query
+        return tx_proto_getValue(tx_obj, valueTokenIdx, outVal, outValLen, pageIdx, pageCount);
+    }
+
+    switch (kind) {
+        case value_kind_amount:
+            return parser_formatAmount(tx_obj, valueTokenIdx, outVal, outValLen, pageIdx, pageCount);
+        case value_kind_opaque:
+            return tx_display_opaque_digest(tx_obj, valueTokenIdx, outVal, outValLen, pageIdx, pageCount);
+        default:
+            return tx_getToken(tx_obj, valueTokenIdx, outVal, outValLen, pageIdx, pageCount);
+    }
 }
 
 parser_error_t parser_getItem(const parser_context_t *ctx,
@@ -269,11 +418,18 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
                               char *outVal, uint16_t outValLen,
                               uint8_t pageIdx, uint8_t *pageCount) {
     *pageCount = 0;
+    CHECK_CONTEXT_BOUND(ctx)
 
-    char tmpKey[100];
+    // When no output is requested, the item is only checked and measured
+    const bool measureOnly = outVal == NULL;
+    parser_tx_t *tx_obj = parser_getTx(ctx);
+    char *tmpKey = tx_obj->scratch->render.key;
+    const uint16_t tmpKeyLen = sizeof(tx_obj->scratch->render.key);
 
-    MEMZERO(outKey, outKeyLen);
-    MEMZERO(outVal, outValLen);
+    if (!measureOnly) {
+        MEMZERO(outKey, outKeyLen);
+        MEMZERO(outVal, outValLen);
+    }
 
     uint8_t numItems;
     CHECK_PARSER_ERR(parser_getNumItems(ctx, &numItems))
@@ -287,23 +443,34 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
         return parser_display_idx_out_of_range;
     }
 
+    // Reuse page counts that have already been measured
+    if (tx_display_getPageCount(tx_obj, displayIdx, outValLen, pageCount) == parser_ok) {
+        if (measureOnly) {
+            return parser_ok;
+        }
+        if (pageIdx >= *pageCount) {
+            return parser_display_page_out_of_range;
+        }
+    }
+
     uint16_t ret_value_token_index = 0;
-    CHECK_PARSER_ERR(tx_display_query(displayIdx, tmpKey, sizeof(tmpKey), &ret_value_token_index))
+    CHECK_PARSER_ERR(tx_display_query(tx_obj, displayIdx, tmpKey, tmpKeyLen, &ret_value_token_index))
     CHECK_APP_CANARY()
-    snprintf(outKey, outKeyLen, "%s", tmpKey);
-
-    if (parser_isAmount(tmpKey)) {
-        CHECK_PARSER_ERR(parser_formatAmount(ret_value_token_index,
-                                             outVal, outValLen,
-                                             pageIdx, pageCount))
-    } else {
-        CHECK_PARSER_ERR(tx_getToken(ret_value_token_index,
-                                     outVal, outValLen,
-                                     pageIdx, pageCount))
+    if (!measureOnly) {
+        snprintf(outKey, outKeyLen, "%s", tmpKey);
     }
+
+    CHECK_PARSER_ERR(parser_renderValue(tx_obj, parser_valueKind(tx_obj, tmpKey), ret_value_token_index,
+                                        outVal, outValLen,
+                                        pageIdx, pageCount))
     CHECK_APP_CANARY()
 
-    CHECK_PARSER_ERR(tx_display_make_friendly())
+    tx_display_setPageCount(tx_obj, displayIdx, outValLen, *pageCount);
+    if (measureOnly) {
+        return parser_ok;
+    }
+
+    CHECK_PARSER_ERR(tx_display_make_friendly(tx_obj))
     CHECK_APP_CANARY()
 
     snprintf(outKey, outKeyLen, "%s", tmpKey);
@@ -311,3 +478,54 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
 
     return parser_ok;
 }
+
+parser_error_t parser_renderAll(const parser_context_t *ctx,
+                                char *outKey, uint16_t outKeyLen,
+                                char *outVal, uint16_t outValLen,
+                                parser_render_fn render, void *user) {
+    CHECK_CONTEXT_BOUND(ctx)
+    parser_tx_t *tx_obj = parser_getTx(ctx);
+
+    uint8_t numItems;
+    CHECK_PARSER_ERR(parser_getNumItems(ctx, &numItems))
+    if (numItems == 0) {
+        return parser_unexpected_number_items;
+    }
+
+    char *tmpKey = tx_obj->scratch->render.key;
+    const uint16_t tmpKeyLen = sizeof(tx_obj->scratch->render.key);
+    for (uint8_t displayIdx = 0; displayIdx < numItems; displayIdx++) {
+        MEMZERO(outKey, outKeyLen);
+        MEMZERO(outVal, outValLen);
+
+        // Items are looked up once, pages are only sliced
+        uint16_t valueTokenIdx = 0;
+        uint8_t pageCount = 0;
+        value_kind_e kind = value_kind_token;
+        parser_error_t err = tx_display_query(tx_obj, displayIdx, tmpKey, tmpKeyLen, &valueTokenIdx);
+        if (err == parser_ok) {
+            snprintf(outKey, outKeyLen, "%s", tmpKey);
+            kind = parser_valueKind(tx_obj, tmpKey);
+            err = parser_renderValue(tx_obj, kind, valueTokenIdx, outVal, outValLen, 0, &pageCount);
+        }
+        if (err != parser_ok) {
+            // Same as parser_getItem: the error is shown in place of the item
+            CHECK_PARSER_ERR(render(user, displayIdx, outKey, outVal, 0, pageCount, err))
+            continue;
+        }
+        CHECK_APP_CANARY()
+
+        tx_display_setPageCount(tx_obj, displayIdx, outValLen, pageCount);
+        CHECK_PARSER_ERR(tx_display_make_friendly(tx_obj))
+        snprintf(outKey, outKeyLen, "%s", tmpKey);
+
+        CHECK_PARSER_ERR(render(user, displayIdx, outKey, outVal, 0, pageCount, parser_ok))
+        for (uint8_t pageIdx = 1; pageIdx < pageCount; pageIdx++) {
+            uint8_t dummy;
+            err = parser_renderValue(tx_obj, kind, valueTokenIdx, outVal, outValLen, pageIdx, &dummy);
+            CHECK_PARSER_ERR(render(user, displayIdx, outKey, outVal, pageIdx, pageCount, err))
+        }
+    }
+
+    return parser_ok;
+}
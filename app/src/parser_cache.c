@@ -0,0 +1,94 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "parser_cache.h"
+#include <zxmacros.h>
+#include "common/parser.h"
+#include "parser_impl.h"
+#include "sha256.h"
+
+// Messages sent from the device address are grouped (msg_from_grouping_hide_all), so the review
+// depends on the signer as much as on the payload
+static void cache_key(const parser_tx_t *tx_obj, const uint8_t *digest, uint8_t *key) {
+    sha256_ctx_t sha;
+    sha256_init(&sha);
+    sha256_update(&sha, digest, SHA256_DIGEST_SIZE);
+    if (tx_obj->own_addr != NULL) {
+        // The terminator tells an empty address from none
+        sha256_update(&sha, (const uint8_t *) tx_obj->own_addr, strlen(tx_obj->own_addr) + 1);
+    }
+    sha256_final(&sha, key);
+}
+
+void parser_cache_invalidate(const parser_context_t *ctx) {
+    if (ctx->tx_obj != NULL) {
+        parser_getTx(ctx)->parsed.valid = false;
+    }
+}
+
+parser_error_t parser_cache_parse(parser_context_t *ctx,
+                                  const uint8_t *data, size_t dataLen,
+                                  const uint8_t *digest,
+                                  bool *cached) {
+    CHECK_CONTEXT_BOUND(ctx)
+    uint8_t tmpDigest[SHA256_DIGEST_SIZE];
+    if (digest == NULL) {
+        sha256_digest(data, dataLen, tmpDigest);
+        digest = tmpDigest;
+    }
+
+    if (cached != NULL) {
+        *cached = false;
+    }
+
+    parser_tx_t *tx_obj = parser_getTx(ctx);
+    uint8_t key[SHA256_DIGEST_SIZE];
+    cache_key(tx_obj, digest, key);
+
+    if (tx_obj->parsed.valid &&
+        tx_obj->parsed.expert == parser_isExpert(tx_obj) &&
+        tx_obj->parsed.format == tx_obj->format &&
+        tx_obj->parsed.engine == tx_obj->engine &&
+        tx_obj->parsed.dataLen == dataLen &&
+        MEMCMP(tx_obj->parsed.key, key, SHA256_DIGEST_SIZE) == 0) {
+        // Same bytes, possibly at another address. Tokens and slices only hold offsets
+        CHECK_PARSER_ERR(parser_init(ctx, data, dataLen))
+        tx_obj->tx = (const char *) data;
+        if (tx_obj->format == parser_format_amino_json) {
+            if (parser_isStreaming(tx_obj)) {
+                tx_obj->stream.buffer = (const char *) data;
+            } else {
+                tx_obj->json.buffer = (const char *) data;
+            }
+        }
+        if (cached != NULL) {
+            *cached = true;
+        }
+        return parser_ok;
+    }
+
+    CHECK_PARSER_ERR(parser_parse(ctx, data, dataLen))
+    CHECK_PARSER_ERR(parser_validate(ctx))
+
+    tx_obj->parsed.expert = parser_isExpert(tx_obj);
+    tx_obj->parsed.format = tx_obj->format;
+    tx_obj->parsed.engine = tx_obj->engine;
+    tx_obj->parsed.dataLen = dataLen;
+    MEMCPY(tx_obj->parsed.key, key, SHA256_DIGEST_SIZE);
+    tx_obj->parsed.valid = true;
+
+    return parser_ok;
+}
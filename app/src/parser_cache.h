@@ -0,0 +1,45 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "common/parser_common.h"
+
+/// Parses and validates a tx buffer, unless it is the same payload, for the same signer (own_addr),
+/// as the last one parsed and validated successfully in the same state. In that case the parsed tokens and display
+/// cache are kept and only pointed at data
+/// \param ctx
+/// \param data
+/// \param dataLen
+/// \param digest SHA-256 of data, or NULL to calculate it here
+/// \param cached (out, optional) true when parsing was skipped
+parser_error_t parser_cache_parse(parser_context_t *ctx,
+                                  const uint8_t *data, size_t dataLen,
+                                  const uint8_t *digest,
+                                  bool *cached);
+
+/// Forgets the last payload of the context. Called whenever its parser state is overwritten
+void parser_cache_invalidate(const parser_context_t *ctx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,8 +15,47 @@
 ********************************************************************************/
 
 #include "parser_impl.h"
+#include "ram_arena.h"
+#include "app_mode.h"
 
-parser_tx_t parser_tx_obj;
+// Static instance, its display cache and scratch buffers share the RAM arena with chunk reception.
+// They are only usable in the review phase, see ram_arena_enter
+parser_tx_t parser_tx_obj = {
+        .display = &ram_arena.review.display,
+        .scratch = &ram_arena.review.scratch,
+};
+
+parser_tx_t *parser_getTx(const parser_context_t *ctx) {
+    return ctx->tx_obj;
+}
+
+bool parser_isExpert(const parser_tx_t *tx_obj) {
+    switch (tx_obj->mode) {
+        case parser_mode_normal:
+            return false;
+        case parser_mode_expert:
+            return true;
+        default:
+            return app_mode_expert();
+    }
+}
+
+bool parser_isStreaming(const parser_tx_t *tx_obj) {
+#if JSON_TOKEN_ENGINE
+    switch (tx_obj->engine) {
+        case parser_engine_tokens:
+            return false;
+        case parser_engine_streaming:
+            return true;
+        default:
+            return JSON_STREAMING_DEFAULT;
+    }
+#else
+    // Only the streaming engine is built
+    UNUSED(tx_obj);
+    return true;
+#endif
+}
 
 parser_error_t parser_init_context(parser_context_t *ctx,
                                    const uint8_t *buffer,
@@ -58,6 +97,8 @@ const char *parser_getErrorDescription(parser_error_t err) {
             return "Unexpected version";
         case parser_unexpected_characters:
             return "Unexpected characters";
+        case parser_unexpected_type:
+            return "Unexpected type";
         case parser_unexpected_field:
             return "Unexpected field";
         case parser_duplicated_field:
@@ -100,24 +141,28 @@ const char *parser_getErrorDescription(parser_error_t err) {
             return "JSON Missing memo";
         case parser_json_unexpected_error:
             return "JSON Unexpected error";
+        case parser_json_too_deep:
+            return "JSON Nesting too deep";
 
         default:
             return "Unrecognized error code";
     }
 }
 
-parser_error_t _readTx(parser_context_t *c, parser_tx_t *v __attribute((unused))) {
-    parser_error_t err = json_parse(&parser_tx_obj.json,
-                                    (const char *) c->buffer,
-                                    c->bufferLen);
-    if (err != parser_ok) {
-        return err;
+parser_error_t _readTx(parser_context_t *c, parser_tx_t *v) {
+    if (parser_isStreaming(v)) {
+        CHECK_PARSER_ERR(json_stream_parse(&v->stream, (const char *) c->buffer, c->bufferLen))
+    }
+#if JSON_TOKEN_ENGINE
+    else {
+        CHECK_PARSER_ERR(json_parse(&v->json, (const char *) c->buffer, c->bufferLen))
     }
+#endif
 
-    parser_tx_obj.tx = (const char *) c->buffer;
-    parser_tx_obj.flags.cache_valid = 0;
-    parser_tx_obj.filter_msg_type_count = 0;
-    parser_tx_obj.filter_msg_from_count = 0;
+    v->tx = (const char *) c->buffer;
+    v->flags.cache_valid = 0;
+    v->filter_msg_type_count = 0;
+    v->filter_msg_from_count = 0;
 
     return parser_ok;
 }
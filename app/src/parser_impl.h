@@ -30,8 +30,29 @@ typedef struct {
     char str2[50];
 } key_subst_t;
 
+// Static instance bound by parser_initContext (device builds)
 extern parser_tx_t parser_tx_obj;
 
+// Entry points refuse contexts that were never bound to a parsing state
+#define CHECK_CONTEXT_BOUND(CTX) {if ((CTX) == NULL || (CTX)->tx_obj == NULL) return parser_init_context_empty;}
+
+/// Returns the state a bound context parses into
+parser_tx_t *parser_getTx(const parser_context_t *ctx);
+
+/// Indicates if items of this state are shown in expert mode
+bool parser_isExpert(const parser_tx_t *tx_obj);
+
+/// Indicates if Amino JSON payloads of this state are read by the streaming engine (see json_stream.h)
+bool parser_isStreaming(const parser_tx_t *tx_obj);
+
+/// Shows a coin, in the representation of the default denom unless in expert mode
+/// When outVal is NULL, only the page count is calculated
+parser_error_t parser_formatCoin(parser_tx_t *tx_obj,
+                                 const char *amountPtr, int32_t amountLen,
+                                 const char *denomPtr, int32_t denomLen,
+                                 char *outVal, uint16_t outValLen,
+                                 uint8_t pageIdx, uint8_t *pageCount);
+
 parser_error_t parser_init(parser_context_t *ctx,
                            const uint8_t *buffer,
                            size_t bufferSize);
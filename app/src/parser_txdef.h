@@ -23,6 +23,10 @@ extern "C" {
 #include <stddef.h>
 
 #include <json/json_parser.h>
+#include <json/json_stream.h>
+#include "proto/proto_reader.h"
+#include "coin.h"
+#include "sha256.h"
 
 typedef struct {
     // These are internal values used for tracking the state of the query/search
@@ -48,12 +52,132 @@ typedef struct {
 
 
 
+#define NUM_REQUIRED_ROOT_PAGES 7
+
+#define OPAQUE_DIGEST_CACHE_SIZE 4
+
+#if defined(TARGET_NANOS)
+#define PAGE_COUNT_CACHE_SIZE 16
+#define MSG_ITEM_CACHE_SIZE 32
+#else
+#define PAGE_COUNT_CACHE_SIZE 64
+#define MSG_ITEM_CACHE_SIZE 128
+#endif
+
+typedef struct {
+    uint16_t token_idx;
+    uint8_t digest[COIN_OPAQUE_DIGEST_LEN];
+} opaque_digest_t;
+
+// Where the streaming engine can resume looking for an item of a root item (see tx_stream.h)
+typedef struct {
+    uint16_t root_offset;           // root item value, 0 when unused
+    uint16_t leaf_index;            // query._item_index_current of the next leaf
+    uint16_t skipped;               // leaves hidden by grouping before it
+    uint16_t key_offset[2];         // keys appended to out_key, one per object being read
+    uint16_t offset;                // json_cursor_t
+    uint8_t depth;
+    uint8_t array_mask;
+    uint8_t expect;
+} stream_checkpoint_t;
+
+#define STREAM_CHECKPOINT_COUNT (MSG_ITEM_CACHE_SIZE * sizeof(uint16_t) / sizeof(stream_checkpoint_t))
+
+typedef struct {
+    bool root_item_start_token_valid[NUM_REQUIRED_ROOT_PAGES];
+    // token where the root_item starts (negative for non-existing)
+    uint16_t root_item_start_token_idx[NUM_REQUIRED_ROOT_PAGES];
+
+    // total items
+    uint16_t total_item_count;
+    // number of items the root_item contains
+    uint8_t root_item_number_subitems[NUM_REQUIRED_ROOT_PAGES];
+
+    uint8_t is_default_chain;
+
+    // fingerprints of opaque values, calculated while indexing
+    uint8_t opaque_digest_count;
+    opaque_digest_t opaque_digest[OPAQUE_DIGEST_CACHE_SIZE];
+
+    // page count of the first items (0 = unknown). Only valid for the value length and mode they were measured with
+    uint16_t page_count_value_len;
+    bool page_count_expert;
+    uint8_t page_count[PAGE_COUNT_CACHE_SIZE];
+
+    // key token of every msgs item (| MSG_ITEM_VALUE_FIELD), when all messages have a renderer
+    bool msg_items_valid;
+    uint8_t msg_item_count;
+    union {
+        uint16_t msg_item_key_token[MSG_ITEM_CACHE_SIZE];
+        // the streaming engine has no tokens to list, it keeps checkpoints instead
+        stream_checkpoint_t stream_checkpoint[STREAM_CHECKPOINT_COUNT];
+    };
+} display_cache_t;
+
+#define PARSER_SCRATCH_KEY_LEN      100
+#define PARSER_SCRATCH_VALUE_LEN    160
+
+// Temporaries of a single call. Indexing can run inside parser_getItem, so the two parts never overlap
+typedef struct {
+    // tx_indexRootFields
+    struct {
+        char key[INDEXING_TMP_KEYSIZE];
+        char value[INDEXING_TMP_VALUESIZE];
+        char reference_msg_type[INDEXING_GROUPING_REF_TYPE_SIZE];
+        char reference_msg_from[INDEXING_GROUPING_REF_FROM_SIZE];
+    } parse;
+
+    // parser_getItem, parser_renderAll and the values they format
+    struct {
+        char key[PARSER_SCRATCH_KEY_LEN];
+        char value[PARSER_SCRATCH_VALUE_LEN];       // formatted coin or opaque value
+        char query_value[2];                        // tx_display_query only needs the key
+    } render;
+} parser_scratch_t;
+
+typedef enum {
+    parser_mode_app = 0,        // follows the expert mode setting of the app
+    parser_mode_normal,
+    parser_mode_expert,
+} parser_mode_e;
+
+typedef enum {
+    parser_format_amino_json = 0,   // StdSignDoc, SIGN_MODE_LEGACY_AMINO_JSON
+    parser_format_protobuf,         // SignDoc, SIGN_MODE_DIRECT
+} parser_format_e;
+
+typedef enum {
+    parser_engine_default = 0,      // streaming when JSON_STREAMING_DEFAULT is set
+    parser_engine_tokens,           // jsmn token array, limited to MAX_NUMBER_OF_TOKENS (JSON_TOKEN_ENGINE)
+    parser_engine_streaming,        // buffer scanned again for every item (see json_stream.h)
+} parser_engine_e;
+
+// Sections of a protobuf SignDoc, located once it has been validated (see tx_proto.h)
 typedef struct {
+    proto_slice_t sign_doc;         // the whole payload
+    proto_slice_t body;             // TxBody
+    proto_slice_t signer;           // AuthInfo.signer_infos, there is only one
+    proto_slice_t fee;              // AuthInfo.fee
+    proto_slice_t tip;              // AuthInfo.tip, when has_tip
+    bool has_tip;
+} proto_tx_t;
+
+typedef struct parser_tx_t {
     // Buffer to the original tx blob
     const char *tx;
 
-    // parsed data (tokens, etc.)
-    parsed_json_t json;
+    // payload format, see parser_setFormat
+    parser_format_e format;
+
+    // how Amino JSON payloads are read, see parser_setEngine
+    parser_engine_e engine;
+
+    // parsed data, depending on the format and engine
+    union {
+        parsed_json_t json;         // tokens, etc.
+        json_stream_t stream;
+        proto_tx_t proto;
+    };
 
     // internal flags
     struct {
@@ -61,6 +185,7 @@ typedef struct {
         bool msg_type_grouping:1;       // indicates if msg type grouping is enabled
         bool msg_from_grouping:1;       // indicates if msg from grouping is enabled
         bool msg_from_grouping_hide_all:1; // indicates if msg from grouping should hide all
+        bool msg_renderers_off:1;       // every message goes through tx_traverse_find (see parser_setMsgRenderers)
     } flags;
 
     // indicates that N identical msg_type fields have been detected
@@ -74,6 +199,25 @@ typedef struct {
 
     // current tx query
     tx_query_t query;
+
+    // items are shown in this mode
+    parser_mode_e mode;
+
+    // items indexed for display
+    display_cache_t *display;
+
+    // temporaries of parsing and rendering
+    parser_scratch_t *scratch;
+
+    // payload last parsed and validated successfully (see parser_cache.h)
+    struct {
+        bool valid;
+        bool expert;
+        parser_format_e format;
+        parser_engine_e engine;
+        uint32_t dataLen;
+        uint8_t key[SHA256_DIGEST_SIZE];    // SHA-256 of the payload digest and own_addr
+    } parsed;
 } parser_tx_t;
 
 #ifdef __cplusplus
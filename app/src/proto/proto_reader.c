@@ -0,0 +1,102 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include <zxmacros.h>
+#include "proto_reader.h"
+
+// Field numbers are 29 bits
+#define PROTO_MAX_FIELD_NUMBER  0x1FFFFFFFu
+#define PROTO_MAX_VARINT_LEN    10u
+
+void proto_reader_init(proto_reader_t *reader, const uint8_t *buffer, proto_slice_t slice) {
+    reader->buffer = buffer;
+    reader->offset = slice.offset;
+    reader->end = slice.offset + slice.len;
+}
+
+__Z_INLINE parser_error_t proto_read_varint(proto_reader_t *reader, uint64_t *value) {
+    *value = 0;
+    for (uint8_t i = 0; i < PROTO_MAX_VARINT_LEN; i++) {
+        if (reader->offset >= reader->end) {
+            return parser_unexpected_buffer_end;
+        }
+        const uint8_t b = reader->buffer[reader->offset++];
+        if (i == PROTO_MAX_VARINT_LEN - 1 && b > 1) {
+            // Beyond 64 bits
+            return parser_value_out_of_range;
+        }
+        *value |= (uint64_t) (b & 0x7Fu) << (7u * i);
+        if ((b & 0x80u) == 0) {
+            return parser_ok;
+        }
+    }
+    return parser_value_out_of_range;
+}
+
+__Z_INLINE parser_error_t proto_read_bytes(proto_reader_t *reader, uint64_t len, proto_slice_t *slice) {
+    if (len > (uint64_t) (reader->end - reader->offset)) {
+        return parser_unexpected_buffer_end;
+    }
+    slice->offset = reader->offset;
+    slice->len = (uint16_t) len;
+    reader->offset += (uint16_t) len;
+    return parser_ok;
+}
+
+parser_error_t proto_next_field(proto_reader_t *reader, proto_field_t *field) {
+    MEMZERO(field, sizeof(*field));
+    if (reader->offset >= reader->end) {
+        return parser_no_data;
+    }
+
+    uint64_t tag = 0;
+    CHECK_PARSER_ERR(proto_read_varint(reader, &tag))
+    if ((tag >> 3u) == 0 || (tag >> 3u) > PROTO_MAX_FIELD_NUMBER) {
+        return parser_unexpected_field;
+    }
+    field->number = (uint32_t) (tag >> 3u);
+    field->wire_type = (uint8_t) (tag & 0x07u);
+
+    uint64_t len = 0;
+    switch (field->wire_type) {
+        case PROTO_WIRE_VARINT:
+            return proto_read_varint(reader, &field->varint);
+        case PROTO_WIRE_I64:
+            return proto_read_bytes(reader, 8, &field->bytes);
+        case PROTO_WIRE_LEN:
+            CHECK_PARSER_ERR(proto_read_varint(reader, &len))
+            return proto_read_bytes(reader, len, &field->bytes);
+        case PROTO_WIRE_I32:
+            return proto_read_bytes(reader, 4, &field->bytes);
+        default:
+            // Groups are deprecated, and not used by any message shown here
+            return parser_unexpected_type;
+    }
+}
+
+parser_error_t proto_find_field(const uint8_t *buffer, proto_slice_t message,
+                                uint32_t number, proto_field_t *field) {
+    proto_reader_t reader;
+    proto_reader_init(&reader, buffer, message);
+
+    parser_error_t err;
+    while ((err = proto_next_field(&reader, field)) == parser_ok) {
+        if (field->number == number) {
+            return parser_ok;
+        }
+    }
+    return err;
+}
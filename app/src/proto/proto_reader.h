@@ -0,0 +1,66 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "common/parser_common.h"
+
+// Protobuf wire types
+#define PROTO_WIRE_VARINT       0u
+#define PROTO_WIRE_I64          1u
+#define PROTO_WIRE_LEN          2u
+#define PROTO_WIRE_I32          5u
+
+/// Bytes of the payload, as an offset from its start. Nothing is copied out of the payload
+typedef struct {
+    uint16_t offset;
+    uint16_t len;
+} proto_slice_t;
+
+/// Reads the fields of one message. Embedded messages are read with a reader of their own
+typedef struct {
+    const uint8_t *buffer;      // start of the payload, slices are relative to it
+    uint16_t offset;
+    uint16_t end;
+} proto_reader_t;
+
+typedef struct {
+    uint32_t number;
+    uint8_t wire_type;
+    uint64_t varint;            // PROTO_WIRE_VARINT
+    proto_slice_t bytes;        // any other wire type
+} proto_field_t;
+
+/// Starts reading the message found at slice of buffer
+void proto_reader_init(proto_reader_t *reader, const uint8_t *buffer, proto_slice_t slice);
+
+/// Reads the next field of the message. Its value is bounds checked but not decoded
+/// \return parser_no_data after the last field, parser_unexpected_type for groups
+parser_error_t proto_next_field(proto_reader_t *reader, proto_field_t *field);
+
+/// Looks for a field of the message. Fields are expected once (see tx_proto_readTx)
+/// \return parser_no_data when the message does not have it
+parser_error_t proto_find_field(const uint8_t *buffer, proto_slice_t message,
+                                uint32_t number, proto_field_t *field);
+
+#ifdef __cplusplus
+}
+#endif
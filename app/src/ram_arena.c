@@ -0,0 +1,63 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "ram_arena.h"
+#include <zxmacros.h>
+#include "parser_impl.h"
+
+_Static_assert(sizeof(((ram_arena_t *) 0)->ingest) <= RAM_ARENA_BUDGET, "ingest phase is larger than the RAM arena budget of this target");
+_Static_assert(sizeof(((ram_arena_t *) 0)->review) <= RAM_ARENA_BUDGET, "review phase is larger than the RAM arena budget of this target");
+_Static_assert(sizeof(ram_arena_t) <= RAM_ARENA_BUDGET, "RAM arena is larger than the budget of this target");
+
+#if defined(RAM_ARENA_REPORT)
+// Only built by `make ram_report`, never linked: the size of each symbol is the RAM used on the target
+const uint8_t ram_report_phase_ingest[sizeof(((ram_arena_t *) 0)->ingest)] = {0};
+const uint8_t ram_report_phase_review[sizeof(((ram_arena_t *) 0)->review)] = {0};
+const uint8_t ram_report_display[sizeof(display_cache_t)] = {0};
+const uint8_t ram_report_scratch_parse[sizeof(((parser_scratch_t *) 0)->parse)] = {0};
+const uint8_t ram_report_scratch_render[sizeof(((parser_scratch_t *) 0)->render)] = {0};
+const uint8_t ram_report_arena[sizeof(ram_arena_t)] = {0};
+const uint8_t ram_report_arena_budget[RAM_ARENA_BUDGET] = {0};
+const uint8_t ram_report_parser_tx[sizeof(parser_tx_t)] = {0};
+#if JSON_TOKEN_ENGINE
+const uint8_t ram_report_json_tokens[sizeof(((parsed_json_t *) 0)->tokens)] = {0};
+#endif
+#endif
+
+ram_arena_t ram_arena;
+static ram_arena_phase_e ram_arena_current = ram_arena_none;
+
+void ram_arena_enter(ram_arena_phase_e phase) {
+    MEMZERO(&ram_arena, sizeof(ram_arena));
+    ram_arena_current = phase;
+    // Items have to be indexed again
+    parser_tx_obj.flags.cache_valid = 0;
+}
+
+ram_arena_phase_e ram_arena_phase() {
+    return ram_arena_current;
+}
+
+size_t ram_arena_phase_size(ram_arena_phase_e phase) {
+    switch (phase) {
+        case ram_arena_ingest:
+            return sizeof(ram_arena.ingest);
+        case ram_arena_review:
+            return sizeof(ram_arena.review);
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,71 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include "parser_txdef.h"
+#include "tx_stream_check.h"
+#include "tx_decompress.h"
+
+// State that is never live at the same time shares a single static block.
+// Each phase owns one member of the union; entering a phase clears the block.
+// Phases are entered explicitly: process_chunk for ingest, tx_parse and batch_init for review
+typedef enum {
+    ram_arena_none = 0,
+    ram_arena_ingest,           // chunks of a new transaction are being received
+    ram_arena_review,           // the transaction is parsed, indexed and rendered
+} ram_arena_phase_e;
+
+typedef union {
+    struct {
+        tx_stream_check_t check;
+        decompress_ctx_t decompress;
+    } ingest;
+
+    // Sub-allocations of the static parser state (parser_tx_obj)
+    struct {
+        display_cache_t display;        // built by indexing, read by every query
+        parser_scratch_t scratch;       // parse and render temporaries
+    } review;
+} ram_arena_t;
+
+// Largest phase on each target, checked at compile time. `make ram_report` lists the sizes on a target
+#if defined(TARGET_NANOS)
+#define RAM_ARENA_BUDGET    704
+#else
+#define RAM_ARENA_BUDGET    944
+#endif
+
+extern ram_arena_t ram_arena;
+
+/// Makes the arena available to a phase. Whatever the previous phase kept there is lost,
+/// the display cache of the static parser state included
+void ram_arena_enter(ram_arena_phase_e phase);
+
+/// Phase currently owning the arena
+ram_arena_phase_e ram_arena_phase();
+
+/// Bytes used by a phase
+size_t ram_arena_phase_size(ram_arena_phase_e phase);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,153 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "sha256.h"
+#include <zxmacros.h>
+
+#if defined(TARGET_NANOS) || defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+
+void sha256_init(sha256_ctx_t *ctx) {
+    cx_sha256_init(ctx);
+}
+
+void sha256_update(sha256_ctx_t *ctx, const uint8_t *data, size_t dataLen) {
+    cx_hash(&ctx->header, 0, data, dataLen, NULL, 0);
+}
+
+void sha256_final(sha256_ctx_t *ctx, uint8_t *digest) {
+    cx_hash(&ctx->header, CX_LAST, NULL, 0, digest, CX_SHA256_SIZE);
+}
+
+void sha256_digest(const uint8_t *data, size_t dataLen, uint8_t *digest) {
+    cx_hash_sha256(data, dataLen, digest, CX_SHA256_SIZE);
+}
+
+#else
+
+///////////////////////////////////////
+// THIS IS ONLY USED FOR TEST PURPOSES
+///////////////////////////////////////
+
+static const uint32_t sha256_k[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#define ROTR32(_X, _N) (((_X) >> (_N)) | ((_X) << (32u - (_N))))
+
+static void sha256_compress(sha256_ctx_t *ctx, const uint8_t *block) {
+    uint32_t w[64];
+    for (uint8_t i = 0; i < 16; i++) {
+        w[i] = ((uint32_t) block[4 * i] << 24u) | ((uint32_t) block[4 * i + 1] << 16u) |
+               ((uint32_t) block[4 * i + 2] << 8u) | ((uint32_t) block[4 * i + 3]);
+    }
+    for (uint8_t i = 16; i < 64; i++) {
+        const uint32_t s0 = ROTR32(w[i - 15], 7u) ^ ROTR32(w[i - 15], 18u) ^ (w[i - 15] >> 3u);
+        const uint32_t s1 = ROTR32(w[i - 2], 17u) ^ ROTR32(w[i - 2], 19u) ^ (w[i - 2] >> 10u);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = ctx->state[0], b = ctx->state[1], c = ctx->state[2], d = ctx->state[3];
+    uint32_t e = ctx->state[4], f = ctx->state[5], g = ctx->state[6], h = ctx->state[7];
+
+    for (uint8_t i = 0; i < 64; i++) {
+        const uint32_t t1 = h + (ROTR32(e, 6u) ^ ROTR32(e, 11u) ^ ROTR32(e, 25u)) + ((e & f) ^ (~e & g)) +
+                            sha256_k[i] + w[i];
+        const uint32_t t2 = (ROTR32(a, 2u) ^ ROTR32(a, 13u) ^ ROTR32(a, 22u)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    ctx->state[0] += a;
+    ctx->state[1] += b;
+    ctx->state[2] += c;
+    ctx->state[3] += d;
+    ctx->state[4] += e;
+    ctx->state[5] += f;
+    ctx->state[6] += g;
+    ctx->state[7] += h;
+}
+
+void sha256_init(sha256_ctx_t *ctx) {
+    static const uint32_t iv[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    MEMZERO(ctx, sizeof(sha256_ctx_t));
+    MEMCPY(ctx->state, iv, sizeof(iv));
+}
+
+void sha256_update(sha256_ctx_t *ctx, const uint8_t *data, size_t dataLen) {
+    ctx->length += dataLen;
+    while (dataLen > 0) {
+        size_t n = sizeof(ctx->block) - ctx->blockLen;
+        if (n > dataLen) {
+            n = dataLen;
+        }
+        MEMCPY(ctx->block + ctx->blockLen, data, n);
+        ctx->blockLen += n;
+        data += n;
+        dataLen -= n;
+
+        if (ctx->blockLen == sizeof(ctx->block)) {
+            sha256_compress(ctx, ctx->block);
+            ctx->blockLen = 0;
+        }
+    }
+}
+
+void sha256_final(sha256_ctx_t *ctx, uint8_t *digest) {
+    const uint64_t bitLength = ctx->length * 8u;
+
+    ctx->block[ctx->blockLen++] = 0x80;
+    if (ctx->blockLen > 56) {
+        MEMZERO(ctx->block + ctx->blockLen, sizeof(ctx->block) - ctx->blockLen);
+        sha256_compress(ctx, ctx->block);
+        ctx->blockLen = 0;
+    }
+    MEMZERO(ctx->block + ctx->blockLen, 56 - ctx->blockLen);
+    for (uint8_t i = 0; i < 8; i++) {
+        ctx->block[63 - i] = (uint8_t) (bitLength >> (8u * i));
+    }
+    sha256_compress(ctx, ctx->block);
+
+    for (uint8_t i = 0; i < 8; i++) {
+        digest[4 * i] = (uint8_t) (ctx->state[i] >> 24u);
+        digest[4 * i + 1] = (uint8_t) (ctx->state[i] >> 16u);
+        digest[4 * i + 2] = (uint8_t) (ctx->state[i] >> 8u);
+        digest[4 * i + 3] = (uint8_t) (ctx->state[i]);
+    }
+}
+
+void sha256_digest(const uint8_t *data, size_t dataLen, uint8_t *digest) {
+    sha256_ctx_t ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, data, dataLen);
+    sha256_final(&ctx, digest);
+}
+
+#endif
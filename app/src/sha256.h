@@ -0,0 +1,63 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SHA256_DIGEST_SIZE      32u
+
+#if defined(TARGET_NANOS) || defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+#include "cx.h"
+typedef cx_sha256_t sha256_ctx_t;
+#else
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;
+    uint8_t block[64];
+    uint8_t blockLen;
+} sha256_ctx_t;
+#endif
+
+/// Starts a streamed SHA-256
+/// \param ctx
+void sha256_init(sha256_ctx_t *ctx);
+
+/// Hashes the next chunk of data
+/// \param ctx
+/// \param data
+/// \param dataLen
+void sha256_update(sha256_ctx_t *ctx, const uint8_t *data, size_t dataLen);
+
+/// Finishes a streamed SHA-256. The context has to be initialized again before reuse
+/// \param ctx
+/// \param digest (out) SHA256_DIGEST_SIZE bytes
+void sha256_final(sha256_ctx_t *ctx, uint8_t *digest);
+
+/// One-shot SHA-256. On device this goes through the cx API,
+/// host builds (unit tests, fuzzing) use a portable implementation
+/// \param data
+/// \param dataLen
+/// \param digest (out) SHA256_DIGEST_SIZE bytes
+void sha256_digest(const uint8_t *data, size_t dataLen, uint8_t *digest);
+
+#ifdef __cplusplus
+}
+#endif
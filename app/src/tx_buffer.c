@@ -0,0 +1,114 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "tx_buffer.h"
+#include <string.h>
+#include <zxmacros.h>
+
+void tx_buffer_init(tx_buffer_t *b,
+                    uint8_t *ram, uint32_t ramSize,
+                    uint8_t *flash, uint32_t flashSize, uint32_t pageSize,
+                    tx_buffer_flash_write_fn flashWrite) {
+    b->ram = ram;
+    b->ramSize = ramSize;
+    b->flash = flash;
+    b->flashSize = flashSize;
+    b->pageSize = pageSize;
+    b->flashWrite = flashWrite;
+    tx_buffer_reset(b);
+}
+
+void tx_buffer_reset(tx_buffer_t *b) {
+    b->len = 0;
+    b->flashLen = 0;
+    b->spilled = false;
+}
+
+// Writes cached bytes up to end to flash, and keeps the rest at the start of RAM
+static void tx_buffer_flush(tx_buffer_t *b, uint32_t end) {
+    const uint32_t count = end - b->flashLen;
+    if (count == 0) {
+        return;
+    }
+    b->flashWrite(b->flash + b->flashLen, b->ram, count);
+    memmove(b->ram, b->ram + count, b->len - end);
+    b->flashLen = end;
+}
+
+uint32_t tx_buffer_append(tx_buffer_t *b, const uint8_t *data, uint32_t len) {
+    if (len > b->flashSize - b->len) {
+        return 0;
+    }
+
+    if (!b->spilled) {
+        if (len <= b->ramSize - b->len) {
+            MEMCPY(b->ram + b->len, data, len);
+            b->len += len;
+            return len;
+        }
+        // From now on, RAM caches the bytes that are not in flash yet
+        b->spilled = true;
+    }
+
+    uint32_t remaining = len;
+    while (remaining > 0) {
+        const uint32_t cached = b->len - b->flashLen;
+        if (cached == b->ramSize) {
+            // Write whole pages, unless RAM is smaller than a page
+            uint32_t end = b->len - (b->len % b->pageSize);
+            if (end <= b->flashLen) {
+                end = b->len;
+            }
+            tx_buffer_flush(b, end);
+            continue;
+        }
+
+        uint32_t n = b->ramSize - cached;
+        if (n > remaining) {
+            n = remaining;
+        }
+        MEMCPY(b->ram + cached, data, n);
+        b->len += n;
+        data += n;
+        remaining -= n;
+    }
+    return len;
+}
+
+const uint8_t *tx_buffer_data(tx_buffer_t *b) {
+    if (!b->spilled) {
+        return b->ram;
+    }
+    tx_buffer_flush(b, b->len);
+    return b->flash;
+}
+
+const uint8_t *tx_buffer_range(tx_buffer_t *b, uint32_t offset, uint32_t len) {
+    if (offset >= b->flashLen) {
+        return b->ram + (offset - b->flashLen);
+    }
+    if (offset + len > b->flashLen) {
+        tx_buffer_flush(b, offset + len);
+    }
+    return b->flash + offset;
+}
+
+uint8_t tx_buffer_byte(const tx_buffer_t *b, uint32_t offset) {
+    if (offset < b->flashLen) {
+        return b->flash[offset];
+    }
+    return b->ram[offset - b->flashLen];
+}
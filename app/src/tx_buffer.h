@@ -0,0 +1,66 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/// Writes to flash (nvm_write on device)
+typedef void (*tx_buffer_flash_write_fn)(uint8_t *dst, const uint8_t *src, uint32_t len);
+
+// Transactions are kept in RAM while they fit. Larger ones are stored in flash, with RAM
+// caching the bytes not written yet so flash is written in page aligned batches
+typedef struct {
+    uint8_t *ram;
+    uint32_t ramSize;
+    uint8_t *flash;
+    uint32_t flashSize;
+    uint32_t pageSize;
+    tx_buffer_flash_write_fn flashWrite;
+
+    uint32_t len;           // bytes received
+    uint32_t flashLen;      // bytes already written to flash, RAM holds [flashLen, len)
+    bool spilled;
+} tx_buffer_t;
+
+void tx_buffer_init(tx_buffer_t *b,
+                    uint8_t *ram, uint32_t ramSize,
+                    uint8_t *flash, uint32_t flashSize, uint32_t pageSize,
+                    tx_buffer_flash_write_fn flashWrite);
+
+void tx_buffer_reset(tx_buffer_t *b);
+
+/// Appends data, all or nothing
+/// \return number of bytes added (0 if data does not fit)
+uint32_t tx_buffer_append(tx_buffer_t *b, const uint8_t *data, uint32_t len);
+
+/// Contiguous view of the whole buffer. Pending bytes of a spilled buffer are written to flash first
+const uint8_t *tx_buffer_data(tx_buffer_t *b);
+
+/// Contiguous view of [offset, offset + len). Only a range split between flash and RAM
+/// causes a write, and only up to its end
+const uint8_t *tx_buffer_range(tx_buffer_t *b, uint32_t offset, uint32_t len);
+
+/// Reads a byte wherever it currently is, without writing to flash
+uint8_t tx_buffer_byte(const tx_buffer_t *b, uint32_t offset);
+
+#ifdef __cplusplus
+}
+#endif
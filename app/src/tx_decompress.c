@@ -0,0 +1,202 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "tx_decompress.h"
+#include <string.h>
+#include <zxmacros.h>
+
+// Decoded bytes are staged here before being appended
+#define DECOMPRESS_STAGE_SIZE   64
+
+// Frequent fragments of amino JSON sign docs. Indexes are part of the encoding: only append
+static const char dict[][40] = {
+    "{\"account_number\":\"",
+    "\",\"chain_id\":\"",
+    "\",\"fee\":{\"amount\":[",
+    "{\"amount\":\"",
+    "\",\"denom\":\"",
+    "uscrt\"}",
+    "],\"gas\":\"",
+    "\"},\"memo\":\"",
+    "\",\"msgs\":[",
+    "{\"type\":\"cosmos-sdk/Msg",
+    "\",\"value\":{",
+    "\"amount\":",
+    "\"delegator_address\":\"",
+    "\"validator_address\":\"",
+    "\"from_address\":\"",
+    "\"to_address\":\"",
+    "\"address\":\"",
+    "\"coins\":[",
+    "}],\"sequence\":\"",
+    "secretvaloper1",
+    "secret1",
+    "secret-4",
+    "WithdrawDelegationReward",
+    "Delegate",
+    "Undelegate",
+    "BeginRedelegate",
+    "Send",
+    "Vote",
+    "Deposit",
+    "\"validator_dst_address\":\"",
+    "\"validator_src_address\":\"",
+    "\"option\":\"",
+    "\"proposal_id\":\"",
+    "\"depositor\":\"",
+    "\"voter\":\"",
+    "{\"type\":\"wasm/MsgExecuteContract\"",
+    "\"callback_code_hash\":\"",
+    "\"contract\":\"",
+    "\"msg\":\"",
+    "\"sender\":\"",
+    "\"sent_funds\":[",
+    "\"inputs\":[",
+    "\"outputs\":[",
+    "\"granter\":\"",
+    "\"payer\":\"",
+    "\"},{\"amount\":\"",
+    "\"}},{\"type\":\"cosmos-sdk/Msg",
+    "\"}}],\"sequence\":\"",
+    "\"}",
+    "\"}]",
+    "000000",
+    "\"description\":\"",
+    "\"title\":\"",
+    "\"proposer\":\"",
+    "\"initial_deposit\":[",
+    "\"proposal_type\":\"",
+    "\"validator_address\":\"secretvaloper1",
+    "\"delegator_address\":\"secret1",
+};
+
+#define DICT_SIZE (sizeof(dict) / sizeof(dict[0]))
+
+typedef struct {
+    uint8_t data[DECOMPRESS_STAGE_SIZE];
+    uint8_t len;
+} stage_t;
+
+static decompress_error_e stage_flush(decompress_ctx_t *ctx, stage_t *stage, decompress_append_fn append) {
+    if (stage->len == 0) {
+        return decompress_ok;
+    }
+    const uint32_t added = append(stage->data, stage->len);
+    ctx->outLen += added;
+    if (added != stage->len) {
+        return decompress_output_full;
+    }
+    stage->len = 0;
+    return decompress_ok;
+}
+
+static decompress_error_e stage_put(decompress_ctx_t *ctx, stage_t *stage, decompress_append_fn append, uint8_t c) {
+    if (stage->len == sizeof(stage->data)) {
+        const decompress_error_e err = stage_flush(ctx, stage, append);
+        if (err != decompress_ok) {
+            return err;
+        }
+    }
+    stage->data[stage->len++] = c;
+    return decompress_ok;
+}
+
+// Length of a token, given its first byte
+static uint8_t token_len(uint8_t token) {
+    if (token == DECOMPRESS_TOKEN_ESCAPE) {
+        return 2;
+    }
+    if (token >= DECOMPRESS_TOKEN_COPY) {
+        return 3;
+    }
+    return 1;
+}
+
+static decompress_error_e decode_token(decompress_ctx_t *ctx, stage_t *stage,
+                                       const uint8_t *token, decompress_read_fn read,
+                                       decompress_append_fn append) {
+    decompress_error_e err = decompress_ok;
+
+    if (token[0] < DECOMPRESS_TOKEN_DICT) {
+        return stage_put(ctx, stage, append, token[0]);
+    }
+
+    if (token[0] == DECOMPRESS_TOKEN_ESCAPE) {
+        return stage_put(ctx, stage, append, token[1]);
+    }
+
+    if (token[0] < DECOMPRESS_TOKEN_COPY) {
+        const char *entry = decompress_dict_entry(token[0] - DECOMPRESS_TOKEN_DICT);
+        if (entry == NULL) {
+            return decompress_invalid_token;
+        }
+        for (; *entry != 0 && err == decompress_ok; entry++) {
+            err = stage_put(ctx, stage, append, (uint8_t) *entry);
+        }
+        return err;
+    }
+
+    const uint8_t len = token[0] - DECOMPRESS_TOKEN_COPY + DECOMPRESS_COPY_MIN_LEN;
+    const uint32_t dist = ((uint32_t) token[1] << 8u) | token[2];
+    if (dist == 0 || dist > ctx->outLen + stage->len) {
+        return decompress_invalid_distance;
+    }
+
+    // Byte by byte, copies may overlap what they produce
+    for (uint8_t i = 0; i < len && err == decompress_ok; i++) {
+        const uint32_t pos = ctx->outLen + stage->len - dist;
+        const uint8_t c = pos < ctx->outLen ? read(pos) : stage->data[pos - ctx->outLen];
+        err = stage_put(ctx, stage, append, c);
+    }
+    return err;
+}
+
+void decompress_init(decompress_ctx_t *ctx) {
+    MEMZERO(ctx, sizeof(*ctx));
+}
+
+decompress_error_e decompress_chunk(decompress_ctx_t *ctx,
+                                    const uint8_t *in, uint32_t inLen,
+                                    decompress_read_fn read, decompress_append_fn append) {
+    stage_t stage;
+    stage.len = 0;
+    decompress_error_e err = decompress_ok;
+
+    for (uint32_t i = 0; i < inLen && err == decompress_ok; i++) {
+        ctx->pending[ctx->pendingLen++] = in[i];
+        if (ctx->pendingLen < token_len(ctx->pending[0])) {
+            continue;
+        }
+        err = decode_token(ctx, &stage, ctx->pending, read, append);
+        ctx->pendingLen = 0;
+    }
+
+    if (err != decompress_ok) {
+        return err;
+    }
+    return stage_flush(ctx, &stage, append);
+}
+
+bool decompress_is_complete(const decompress_ctx_t *ctx) {
+    return ctx->pendingLen == 0;
+}
+
+const char *decompress_dict_entry(uint8_t index) {
+    if (index >= DICT_SIZE || index >= DECOMPRESS_TOKEN_COPY - DECOMPRESS_TOKEN_DICT) {
+        return NULL;
+    }
+    return (const char *) PIC(dict[index]);
+}
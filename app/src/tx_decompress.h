@@ -0,0 +1,77 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Compressed payloads are a sequence of tokens:
+//   0x00-0x7F              literal byte
+//   0x80-0xBF              dictionary entry (token - 0x80)
+//   0xC0-0xFE [DIST (2)]   copy (token - 0xC0 + 4) bytes from DIST bytes back (big endian, DIST >= 1)
+//   0xFF [BYTE]            literal byte (0x80-0xFF)
+// Dictionary entries are part of the encoding and can only be appended
+#define DECOMPRESS_TOKEN_DICT       0x80u
+#define DECOMPRESS_TOKEN_COPY       0xC0u
+#define DECOMPRESS_TOKEN_ESCAPE     0xFFu
+#define DECOMPRESS_COPY_MIN_LEN     4u
+#define DECOMPRESS_COPY_MAX_LEN     (DECOMPRESS_TOKEN_ESCAPE - 1u - DECOMPRESS_TOKEN_COPY + DECOMPRESS_COPY_MIN_LEN)
+#define DECOMPRESS_COPY_MAX_DIST    0xFFFFu
+
+typedef enum {
+    decompress_ok = 0,
+    decompress_invalid_token,
+    decompress_invalid_distance,
+    decompress_output_full,
+} decompress_error_e;
+
+/// Appends decoded bytes to the output, returns how many were stored
+typedef uint32_t (*decompress_append_fn)(unsigned char *data, uint32_t length);
+
+/// Reads a decoded byte previously appended
+typedef uint8_t (*decompress_read_fn)(uint32_t offset);
+
+typedef struct {
+    uint32_t outLen;        // bytes appended so far
+    uint8_t pending[3];     // token split across chunks
+    uint8_t pendingLen;
+} decompress_ctx_t;
+
+void decompress_init(decompress_ctx_t *ctx);
+
+/// Decodes a chunk of the compressed stream. Tokens can be split across chunks
+/// \param ctx
+/// \param in compressed chunk
+/// \param inLen
+/// \param read reads decoded bytes appended so far (copies are read from here)
+/// \param append
+decompress_error_e decompress_chunk(decompress_ctx_t *ctx,
+                                    const uint8_t *in, uint32_t inLen,
+                                    decompress_read_fn read, decompress_append_fn append);
+
+/// Indicates that no token is left half-received
+bool decompress_is_complete(const decompress_ctx_t *ctx);
+
+/// Returns a dictionary entry, or NULL past the end of the dictionary
+const char *decompress_dict_entry(uint8_t index);
+
+#ifdef __cplusplus
+}
+#endif
@@ -17,13 +17,19 @@
 ********************************************************************************/
 
 #include "coin.h"
-#include "app_mode.h"
 #include "tx_display.h"
 #include "tx_parser.h"
+#include "tx_proto.h"
+#include "tx_schema.h"
+#include "tx_stream.h"
 #include "parser_impl.h"
+#include "sha256.h"
 #include <zxmacros.h>
+#include <zxformat.h>
+#include <hexutils.h>
 
-#define NUM_REQUIRED_ROOT_PAGES 7
+// Marks msgs items that are a field of msgs/value (otherwise the item is msgs/type)
+#define MSG_ITEM_VALUE_FIELD 0x8000u
 
 const char *get_required_root_item(root_item_e i) {
     switch (i) {
@@ -72,46 +78,38 @@ __Z_INLINE uint8_t get_root_max_level(root_item_e i) {
 
 #pragma clang diagnostic pop
 
-typedef struct {
-    bool root_item_start_token_valid[NUM_REQUIRED_ROOT_PAGES];
-    // token where the root_item starts (negative for non-existing)
-    uint16_t root_item_start_token_idx[NUM_REQUIRED_ROOT_PAGES];
-
-    // total items
-    uint16_t total_item_count;
-    // number of items the root_item contains
-    uint8_t root_item_number_subitems[NUM_REQUIRED_ROOT_PAGES];
-
-    uint8_t is_default_chain;
-} display_cache_t;
-
-display_cache_t display_cache;
+// Values found under these keys cannot be reviewed by the user (e.g. encrypted wasm messages).
+// Unless in expert mode, they are summarized by their length and SHA-256 fingerprint
+static const char opaque_value_keys[][20] = {
+        "msgs/value/msg",       // wasm/MsgExecuteContract
+        "msgs/value/data",      // sign/MsgSignData
+};
 
 parser_error_t tx_display_readTx(parser_context_t *ctx, const uint8_t *data, size_t dataLen) {
     CHECK_PARSER_ERR(parser_init(ctx, data, dataLen))
-    CHECK_PARSER_ERR(_readTx(ctx, &parser_tx_obj))
+    CHECK_PARSER_ERR(_readTx(ctx, parser_getTx(ctx)))
     return parser_ok;
 }
 
-__Z_INLINE parser_error_t calculate_is_default_chainid() {
-    display_cache.is_default_chain = false;
+__Z_INLINE parser_error_t calculate_is_default_chainid(parser_tx_t *tx_obj) {
+    tx_obj->display->is_default_chain = false;
 
     // get chain_id
     char outKey[2];
     char outVal[COIN_MAX_CHAINID_LEN];
     uint8_t pageCount;
-    INIT_QUERY_CONTEXT(outKey, sizeof(outKey),
+    INIT_QUERY_CONTEXT(tx_obj, outKey, sizeof(outKey),
                        outVal, sizeof(outVal),
                        0, get_root_max_level(root_item_chain_id))
-    parser_tx_obj.query.item_index = 0;
-    parser_tx_obj.query._item_index_current = 0;
+    tx_obj->query.item_index = 0;
+    tx_obj->query._item_index_current = 0;
 
     uint16_t ret_value_token_index;
-    CHECK_PARSER_ERR(tx_traverse_find(
-            display_cache.root_item_start_token_idx[root_item_chain_id],
+    CHECK_PARSER_ERR(tx_traverse_find(tx_obj,
+            tx_obj->display->root_item_start_token_idx[root_item_chain_id],
             &ret_value_token_index))
 
-    CHECK_PARSER_ERR(tx_getToken(
+    CHECK_PARSER_ERR(tx_getToken(tx_obj,
             ret_value_token_index,
             outVal, sizeof(outVal),
             0, &pageCount))
@@ -121,7 +119,7 @@ __Z_INLINE parser_error_t calculate_is_default_chainid() {
 
     if (strcmp(outVal, COIN_DEFAULT_CHAINID) == 0) {
         // If we don't match the default chainid, switch to expert mode
-        display_cache.is_default_chain = true;
+        tx_obj->display->is_default_chain = true;
         zemu_log_stack("DEFAULT Chain ");
     } else {
         zemu_log_stack("Chain is NOT DEFAULT");
@@ -130,18 +128,218 @@ __Z_INLINE parser_error_t calculate_is_default_chainid() {
     return parser_ok;
 }
 
-__Z_INLINE bool address_matches_own(char *addr) {
-    if (parser_tx_obj.own_addr == NULL) {
+bool tx_display_is_opaque(const char *key) {
+    for (size_t i = 0; i < array_length(opaque_value_keys); i++) {
+        if (strcmp(key, opaque_value_keys[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+__Z_INLINE parser_error_t opaque_calculate_digest(parser_tx_t *tx_obj, uint16_t token_index, uint8_t *digest) {
+    jsmntype_t type;
+    int32_t start;
+    int32_t end;
+    CHECK_PARSER_ERR(tx_getBounds(tx_obj, token_index, &type, &start, &end))
+    if (start < 0 || start > end) {
+        return parser_unexpected_buffer_end;
+    }
+
+    uint8_t fullDigest[SHA256_DIGEST_SIZE];
+    sha256_digest((const uint8_t *) tx_obj->tx + start, end - start, fullDigest);
+    MEMCPY(digest, fullDigest, COIN_OPAQUE_DIGEST_LEN);
+
+    return parser_ok;
+}
+
+__Z_INLINE parser_error_t opaque_cache_digest(parser_tx_t *tx_obj, uint16_t token_index) {
+    if (tx_obj->display->opaque_digest_count >= OPAQUE_DIGEST_CACHE_SIZE) {
+        // Not enough room, the fingerprint will be calculated when shown
+        return parser_ok;
+    }
+
+    opaque_digest_t *entry = &tx_obj->display->opaque_digest[tx_obj->display->opaque_digest_count];
+    CHECK_PARSER_ERR(opaque_calculate_digest(tx_obj, token_index, entry->digest))
+    entry->token_idx = token_index;
+    tx_obj->display->opaque_digest_count++;
+
+    return parser_ok;
+}
+
+#if JSON_TOKEN_ENGINE
+__Z_INLINE bool token_equals(parser_tx_t *tx_obj, uint16_t token_index, const char *s) {
+    const jsmntok_t *token = &tx_obj->json.tokens[token_index];
+    const size_t len = strlen(s);
+    return token->end - token->start == (int32_t) len && MEMCMP(tx_obj->tx + token->start, s, len) == 0;
+}
+
+// Messages of a known type are {"type":...,"value":{...}} with a flat value (see tx_schema),
+// so their items can be resolved from the token array without traversing the tree
+__Z_INLINE bool msg_has_value_fields(parser_tx_t *tx_obj, uint16_t msg_token_index) {
+    if (tx_obj->flags.msg_renderers_off) {
         return false;
     }
-    if (strcmp(parser_tx_obj.own_addr, addr) != 0) {
+    const parsed_json_t *json = &tx_obj->json;
+    if (msg_token_index + 4 >= json->numberOfTokens ||
+        json->tokens[msg_token_index].type != JSMN_OBJECT ||
+        json->tokens[msg_token_index].size != 2 ||
+        !token_equals(tx_obj, msg_token_index + 1, "type") ||
+        json->tokens[msg_token_index + 2].type != JSMN_STRING ||
+        !token_equals(tx_obj, msg_token_index + 3, "value") ||
+        json->tokens[msg_token_index + 4].type != JSMN_OBJECT) {
+        return false;
+    }
+    return tx_schema_is_known_msg(json, msg_token_index + 2);
+}
+
+__Z_INLINE parser_error_t msg_add_item(parser_tx_t *tx_obj, uint16_t key_token) {
+    if (tx_obj->display->msg_item_count >= MSG_ITEM_CACHE_SIZE) {
+        return parser_no_data;
+    }
+    tx_obj->display->msg_item_key_token[tx_obj->display->msg_item_count++] = key_token;
+    return parser_ok;
+}
+
+// Lists msgs items in the same order tx_traverse_find finds them.
+// Returns parser_no_data if a message needs the generic traversal
+__Z_INLINE parser_error_t msg_collect_items(parser_tx_t *tx_obj, uint16_t msgs_token_index) {
+    const parsed_json_t *json = &tx_obj->json;
+    tx_obj->display->msg_item_count = 0;
+
+    if (json->tokens[msgs_token_index].type != JSMN_ARRAY) {
+        return parser_no_data;
+    }
+
+    uint16_t msg_token_index = msgs_token_index + 1;
+    for (int i = 0; i < json->tokens[msgs_token_index].size; i++) {
+        if (!msg_has_value_fields(tx_obj, msg_token_index)) {
+            return parser_no_data;
+        }
+        CHECK_PARSER_ERR(msg_add_item(tx_obj, msg_token_index + 1))
+
+        const uint16_t value_token_index = msg_token_index + 4;
+        uint16_t key_token_index = value_token_index + 1;
+        for (int j = 0; j < json->tokens[value_token_index].size; j++) {
+            if (key_token_index + 1 >= json->numberOfTokens) {
+                return parser_unexpected_buffer_end;
+            }
+            CHECK_PARSER_ERR(msg_add_item(tx_obj, key_token_index | MSG_ITEM_VALUE_FIELD))
+            key_token_index = json_next_sibling(json, key_token_index + 1);
+        }
+
+        msg_token_index = json_next_sibling(json, msg_token_index);
+    }
+
+    return parser_ok;
+}
+
+__Z_INLINE void msg_item_key(parser_tx_t *tx_obj, uint16_t item, char *outKey, uint16_t outKeyLen, uint16_t *value_token_index) {
+    const uint16_t key_token_index = item & ~MSG_ITEM_VALUE_FIELD;
+    *value_token_index = key_token_index + 1;
+
+    if ((item & MSG_ITEM_VALUE_FIELD) == 0) {
+        snprintf(outKey, outKeyLen, "msgs/type");
+        return;
+    }
+
+    const jsmntok_t *token = &tx_obj->json.tokens[key_token_index];
+    snprintf(outKey, outKeyLen, "msgs/value/%.*s",
+             (int) (token->end - token->start), tx_obj->tx + token->start);
+}
+
+// Drops the msgs items that tx_traverse_find hides when grouping (see get_subitem_count)
+__Z_INLINE void msg_filter_items(parser_tx_t *tx_obj) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < tx_obj->display->msg_item_count; i++) {
+        const uint16_t item = tx_obj->display->msg_item_key_token[i];
+
+        const bool skipTypeField =
+                tx_obj->flags.msg_type_grouping &&
+                (item & MSG_ITEM_VALUE_FIELD) == 0 &&
+                tx_obj->filter_msg_type_valid_idx != i;
+
+        const bool skipFromField =
+                tx_obj->flags.msg_from_grouping &&
+                (item & MSG_ITEM_VALUE_FIELD) != 0 &&
+                token_equals(tx_obj, item & ~MSG_ITEM_VALUE_FIELD, "delegator_address") &&
+                (tx_obj->flags.msg_from_grouping_hide_all || tx_obj->filter_msg_from_valid_idx != i);
+
+        if (!skipTypeField && !skipFromField) {
+            tx_obj->display->msg_item_key_token[count++] = item;
+        }
+    }
+    tx_obj->display->msg_item_count = count;
+    tx_obj->display->msg_items_valid = true;
+}
+#endif
+
+__Z_INLINE bool address_matches_own(parser_tx_t *tx_obj, char *addr) {
+    if (tx_obj->own_addr == NULL) {
+        return false;
+    }
+    if (strcmp(tx_obj->own_addr, addr) != 0) {
         return false;
     }
     return true;
 }
 
-parser_error_t tx_indexRootFields() {
-    if (parser_tx_obj.flags.cache_valid) {
+__Z_INLINE parser_error_t index_msgs_item(parser_tx_t *tx_obj, char *tmp_key, char *tmp_val,
+                                          int16_t current_item_idx, uint16_t value_token_index,
+                                          char *reference_msg_type, char *reference_msg_from) {
+    // Note: if we are dealing with the message field, Ledger has requested that we group.
+    // This means that if all messages share the same time, we should only count the type field once
+    // This is indicated by `tx_obj->flags.msg_type_grouping`
+
+    // GROUPING: Message Type
+    if (tx_obj->flags.msg_type_grouping && is_msg_type_field(tmp_key)) {
+        // First message, initialize expected type
+        if (tx_obj->filter_msg_type_count == 0) {
+
+            if (strlen(tmp_val) >= INDEXING_GROUPING_REF_TYPE_SIZE) {
+                return parser_unexpected_type;
+            }
+
+            snprintf(reference_msg_type, INDEXING_GROUPING_REF_TYPE_SIZE, "%s", tmp_val);
+            tx_obj->filter_msg_type_valid_idx = current_item_idx;
+        }
+
+        if (strcmp(reference_msg_type, tmp_val) != 0) {
+            // different values, so disable grouping
+            tx_obj->flags.msg_type_grouping = 0;
+            tx_obj->filter_msg_type_count = 0;
+        }
+
+        tx_obj->filter_msg_type_count++;
+    }
+
+    // GROUPING: Message From
+    if (tx_obj->flags.msg_from_grouping && is_msg_from_field(tmp_key)) {
+        // First message, initialize expected from
+        if (tx_obj->filter_msg_from_count == 0) {
+            snprintf(reference_msg_from, INDEXING_GROUPING_REF_FROM_SIZE, "%s", tmp_val);
+            tx_obj->filter_msg_from_valid_idx = current_item_idx;
+        }
+
+        if (strcmp(reference_msg_from, tmp_val) != 0) {
+            // different values, so disable grouping
+            tx_obj->flags.msg_from_grouping = 0;
+            tx_obj->filter_msg_from_count = 0;
+        }
+
+        tx_obj->filter_msg_from_count++;
+    }
+
+    if (tx_display_is_opaque(tmp_key)) {
+        CHECK_PARSER_ERR(opaque_cache_digest(tx_obj, value_token_index))
+    }
+
+    ZEMU_LOGF(200, "[ZEMU] %s [%d/%d]", tmp_key, tx_obj->filter_msg_type_count, tx_obj->filter_msg_from_count);
+    return parser_ok;
+}
+
+parser_error_t tx_indexRootFields(parser_tx_t *tx_obj) {
+    if (tx_obj->flags.cache_valid) {
         return parser_ok;
     }
 
@@ -150,23 +348,23 @@ parser_error_t tx_indexRootFields() {
 #endif
 
     // Clear cache
-    MEMZERO(&display_cache, sizeof(display_cache_t));
+    MEMZERO(tx_obj->display, sizeof(display_cache_t));
 
-    char tmp_key[INDEXING_TMP_KEYSIZE];
-    char tmp_val[INDEXING_TMP_VALUESIZE];
-    MEMZERO(&tmp_key, sizeof(tmp_key));
-    MEMZERO(&tmp_val, sizeof(tmp_val));
+    MEMZERO(&tx_obj->scratch->parse, sizeof(tx_obj->scratch->parse));
+    char *tmp_key = tx_obj->scratch->parse.key;
+    char *tmp_val = tx_obj->scratch->parse.value;
 
     // Grouping references
-    char reference_msg_type[INDEXING_GROUPING_REF_TYPE_SIZE];
-    char reference_msg_from[INDEXING_GROUPING_REF_FROM_SIZE];
-    MEMZERO(&reference_msg_type, sizeof(reference_msg_type));
-    MEMZERO(&reference_msg_from, sizeof(reference_msg_from));
-
-    parser_tx_obj.filter_msg_type_count = 0;
-    parser_tx_obj.filter_msg_from_count = 0;
-    parser_tx_obj.flags.msg_type_grouping = 1;
-    parser_tx_obj.flags.msg_from_grouping = 1;
+    char *reference_msg_type = tx_obj->scratch->parse.reference_msg_type;
+    char *reference_msg_from = tx_obj->scratch->parse.reference_msg_from;
+
+    tx_obj->filter_msg_type_count = 0;
+    tx_obj->filter_msg_from_count = 0;
+    tx_obj->flags.msg_type_grouping = 1;
+    tx_obj->flags.msg_from_grouping = 1;
+#if JSON_TOKEN_ENGINE
+    bool msg_items_collected = false;
+#endif
 
     // Look for all expected root items in the JSON tree
     // mark them as found/valid,
@@ -176,11 +374,7 @@ parser_error_t tx_indexRootFields() {
 
         const char *required_root_item_key = get_required_root_item(root_item_idx);
 
-        parser_error_t err = object_get_value(
-                &parser_tx_obj.json,
-                ROOT_TOKEN_INDEX,
-                required_root_item_key,
-                &req_root_item_key_token_idx);
+        parser_error_t err = tx_getRootItem(tx_obj, required_root_item_key, &req_root_item_key_token_idx);
 
         if (err == parser_no_data) {
             continue;
@@ -188,96 +382,76 @@ parser_error_t tx_indexRootFields() {
         CHECK_PARSER_ERR(err)
 
         // Remember root item start token
-        display_cache.root_item_start_token_valid[root_item_idx] = true;
-        display_cache.root_item_start_token_idx[root_item_idx] = req_root_item_key_token_idx;
+        tx_obj->display->root_item_start_token_valid[root_item_idx] = true;
+        tx_obj->display->root_item_start_token_idx[root_item_idx] = req_root_item_key_token_idx;
+
+#if JSON_TOKEN_ENGINE
+        // Messages with a renderer are indexed straight from their tokens
+        if (root_item_idx == root_item_msgs && !parser_isStreaming(tx_obj) &&
+            msg_collect_items(tx_obj, req_root_item_key_token_idx) == parser_ok) {
+            msg_items_collected = true;
+            for (uint8_t i = 0; i < tx_obj->display->msg_item_count; i++) {
+                uint16_t ret_value_token_index;
+                msg_item_key(tx_obj, tx_obj->display->msg_item_key_token[i], tmp_key, INDEXING_TMP_KEYSIZE, &ret_value_token_index);
+
+                uint8_t pageCount;
+                CHECK_PARSER_ERR(tx_getToken(tx_obj, ret_value_token_index, tmp_val, INDEXING_TMP_VALUESIZE, 0, &pageCount))
+                CHECK_PARSER_ERR(index_msgs_item(tx_obj, tmp_key, tmp_val,
+                                                 i, ret_value_token_index,
+                                                 reference_msg_type, reference_msg_from))
+            }
+            tx_obj->display->root_item_number_subitems[root_item_idx] = tx_obj->display->msg_item_count;
+            tx_obj->display->total_item_count += tx_obj->display->msg_item_count;
+            continue;
+        }
+#endif
 
         // Now count how many items can be found in this root item
         int16_t current_item_idx = 0;
         while (err == parser_ok) {
-            INIT_QUERY_CONTEXT(tmp_key, sizeof(tmp_key),
-                               tmp_val, sizeof(tmp_val),
+            INIT_QUERY_CONTEXT(tx_obj, tmp_key, INDEXING_TMP_KEYSIZE,
+                               tmp_val, INDEXING_TMP_VALUESIZE,
                                0, get_root_max_level(root_item_idx))
 
-            parser_tx_obj.query.item_index = current_item_idx;
-            strncpy_s(parser_tx_obj.query.out_key,
+            tx_obj->query.item_index = current_item_idx;
+            strncpy_s(tx_obj->query.out_key,
                       required_root_item_key,
-                      parser_tx_obj.query.out_key_len);
+                      tx_obj->query.out_key_len);
 
             uint16_t ret_value_token_index;
-            err = tx_traverse_find(display_cache.root_item_start_token_idx[root_item_idx], &ret_value_token_index);
+            err = tx_traverse_find(tx_obj, tx_obj->display->root_item_start_token_idx[root_item_idx], &ret_value_token_index);
             if (err != parser_ok) {
                 continue;
             }
 
             uint8_t pageCount;
-            CHECK_PARSER_ERR(tx_getToken(
+            CHECK_PARSER_ERR(tx_getToken(tx_obj,
                     ret_value_token_index,
-                    parser_tx_obj.query.out_val,
-                    parser_tx_obj.query.out_val_len,
+                    tx_obj->query.out_val,
+                    tx_obj->query.out_val_len,
                     0, &pageCount))
 
-            ZEMU_LOGF(200, "[ZEMU] %s : %s", tmp_key, parser_tx_obj.query.out_val)
+            ZEMU_LOGF(200, "[ZEMU] %s : %s", tmp_key, tx_obj->query.out_val)
 
             switch (root_item_idx) {
                 case root_item_memo: {
-                    if (strlen(parser_tx_obj.query.out_val) == 0) {
+                    if (strlen(tx_obj->query.out_val) == 0) {
                         err = parser_query_no_results;
                         continue;
                     }
                     break;
                 }
                 case root_item_msgs: {
-                    // Note: if we are dealing with the message field, Ledger has requested that we group.
-                    // This means that if all messages share the same time, we should only count the type field once
-                    // This is indicated by `parser_tx_obj.flags.msg_type_grouping`
-
-                    // GROUPING: Message Type
-                    if (parser_tx_obj.flags.msg_type_grouping && is_msg_type_field(tmp_key)) {
-                        // First message, initialize expected type
-                        if (parser_tx_obj.filter_msg_type_count == 0) {
-
-                            if (strlen(tmp_val) >= sizeof(reference_msg_type)) {
-                                return parser_unexpected_type;
-                            }
-
-                            snprintf(reference_msg_type, sizeof(reference_msg_type), "%s", tmp_val);
-                            parser_tx_obj.filter_msg_type_valid_idx = current_item_idx;
-                        }
-
-                        if (strcmp(reference_msg_type, tmp_val) != 0) {
-                            // different values, so disable grouping
-                            parser_tx_obj.flags.msg_type_grouping = 0;
-                            parser_tx_obj.filter_msg_type_count = 0;
-                        }
-
-                        parser_tx_obj.filter_msg_type_count++;
-                    }
-
-                    // GROUPING: Message From
-                    if (parser_tx_obj.flags.msg_from_grouping && is_msg_from_field(tmp_key)) {
-                        // First message, initialize expected from
-                        if (parser_tx_obj.filter_msg_from_count == 0) {
-                            snprintf(reference_msg_from, sizeof(reference_msg_from), "%s", tmp_val);
-                            parser_tx_obj.filter_msg_from_valid_idx = current_item_idx;
-                        }
-
-                        if (strcmp(reference_msg_from, tmp_val) != 0) {
-                            // different values, so disable grouping
-                            parser_tx_obj.flags.msg_from_grouping = 0;
-                            parser_tx_obj.filter_msg_from_count = 0;
-                        }
-
-                        parser_tx_obj.filter_msg_from_count++;
-                    }
-
-                    ZEMU_LOGF(200, "[ZEMU] %s [%d/%d]", tmp_key, parser_tx_obj.filter_msg_type_count, parser_tx_obj.filter_msg_from_count);
+                    CHECK_PARSER_ERR(index_msgs_item(tx_obj, tmp_key, tmp_val,
+                                                     current_item_idx, ret_value_token_index,
+                                                     reference_msg_type, reference_msg_from))
                     break;
                 }
                 default:
                     break;
             }
 
-            display_cache.root_item_number_subitems[root_item_idx]++;
+            tx_obj->display->root_item_number_subitems[root_item_idx]++;
             current_item_idx++;
         }
 
@@ -285,69 +459,87 @@ parser_error_t tx_indexRootFields() {
             return err;
         }
 
-        display_cache.total_item_count += display_cache.root_item_number_subitems[root_item_idx];
+        tx_obj->display->total_item_count += tx_obj->display->root_item_number_subitems[root_item_idx];
     }
 
-    parser_tx_obj.flags.cache_valid = 1;
+    tx_obj->flags.cache_valid = 1;
 
-    CHECK_PARSER_ERR(calculate_is_default_chainid())
+    CHECK_PARSER_ERR(calculate_is_default_chainid(tx_obj))
 
     // turn off grouping if we are not in expert mode
-    if (tx_is_expert_mode()) {
-        parser_tx_obj.flags.msg_from_grouping = 0;
+    if (tx_is_expert_mode(tx_obj)) {
+        tx_obj->flags.msg_from_grouping = 0;
     }
 
     // check if from reference value matches the device address that will be signing
-    parser_tx_obj.flags.msg_from_grouping_hide_all = 0;
-    if (address_matches_own(reference_msg_from)) {
-        parser_tx_obj.flags.msg_from_grouping_hide_all = 1;
+    tx_obj->flags.msg_from_grouping_hide_all = 0;
+    if (address_matches_own(tx_obj, reference_msg_from)) {
+        tx_obj->flags.msg_from_grouping_hide_all = 1;
+    }
+
+#if JSON_TOKEN_ENGINE
+    if (msg_items_collected) {
+        msg_filter_items(tx_obj);
+    }
+#endif
+
+    // Checkpoints taken while indexing did not apply the grouping rules
+    if (parser_isStreaming(tx_obj)) {
+        tx_stream_clearCheckpoints(tx_obj);
     }
 
     return parser_ok;
 }
 
-__Z_INLINE bool is_default_chainid() {
-    CHECK_PARSER_ERR(tx_indexRootFields())
-    return display_cache.is_default_chain;
+__Z_INLINE parser_error_t tx_display_index(parser_tx_t *tx_obj) {
+    if (tx_obj->format == parser_format_protobuf) {
+        return tx_proto_index(tx_obj);
+    }
+    return tx_indexRootFields(tx_obj);
+}
+
+__Z_INLINE bool is_default_chainid(parser_tx_t *tx_obj) {
+    CHECK_PARSER_ERR(tx_display_index(tx_obj))
+    return tx_obj->display->is_default_chain;
 }
 
-bool tx_is_expert_mode() {
-    return app_mode_expert() || !is_default_chainid();
+bool tx_is_expert_mode(parser_tx_t *tx_obj) {
+    return parser_isExpert(tx_obj) || !is_default_chainid(tx_obj);
 }
 
-__Z_INLINE uint8_t get_subitem_count(root_item_e root_item) {
-    CHECK_PARSER_ERR(tx_indexRootFields())
-    if (display_cache.total_item_count == 0)
+__Z_INLINE uint8_t get_subitem_count(parser_tx_t *tx_obj, root_item_e root_item) {
+    CHECK_PARSER_ERR(tx_indexRootFields(tx_obj))
+    if (tx_obj->display->total_item_count == 0)
         return 0;
 
-    int32_t tmp_num_items = display_cache.root_item_number_subitems[root_item];
+    int32_t tmp_num_items = tx_obj->display->root_item_number_subitems[root_item];
 
     switch (root_item) {
         case root_item_chain_id:
         case root_item_sequence:
         case root_item_account_number:
-            if (!tx_is_expert_mode()) {
+            if (!tx_is_expert_mode(tx_obj)) {
                 tmp_num_items = 0;
             }
             break;
         case root_item_msgs: {
             // Remove grouped items from list
-            if (parser_tx_obj.flags.msg_type_grouping && parser_tx_obj.filter_msg_type_count > 0) {
+            if (tx_obj->flags.msg_type_grouping && tx_obj->filter_msg_type_count > 0) {
                 tmp_num_items += 1; // we leave main type
-                tmp_num_items -= parser_tx_obj.filter_msg_type_count;
+                tmp_num_items -= tx_obj->filter_msg_type_count;
             }
-            if (parser_tx_obj.flags.msg_from_grouping && parser_tx_obj.filter_msg_from_count > 0) {
-                if (!parser_tx_obj.flags.msg_from_grouping_hide_all) {
+            if (tx_obj->flags.msg_from_grouping && tx_obj->filter_msg_from_count > 0) {
+                if (!tx_obj->flags.msg_from_grouping_hide_all) {
                     tmp_num_items += 1; // we leave main from
                 }
-                tmp_num_items -= parser_tx_obj.filter_msg_from_count;
+                tmp_num_items -= tx_obj->filter_msg_from_count;
             }
             break;
         }
         case root_item_memo:
             break;
         case root_item_fee:
-            if (!tx_is_expert_mode()) {
+            if (!tx_is_expert_mode(tx_obj)) {
                 tmp_num_items = 1;     // Only Amount
             }
         case root_item_tip:
@@ -360,23 +552,23 @@ __Z_INLINE uint8_t get_subitem_count(root_item_e root_item) {
     return tmp_num_items;
 }
 
-__Z_INLINE parser_error_t retrieve_tree_indexes(uint8_t display_index, root_item_e *root_item, uint8_t *subitem_index) {
+__Z_INLINE parser_error_t retrieve_tree_indexes(parser_tx_t *tx_obj, uint8_t display_index, root_item_e *root_item, uint8_t *subitem_index) {
     // Find root index | display_index idx -> item_index
     // consume indexed subpages until we get the item index in the subpage
     *root_item = 0;
     *subitem_index = 0;
-    while (get_subitem_count(*root_item) == 0) {
+    while (get_subitem_count(tx_obj, *root_item) == 0) {
         (*root_item)++;
     }
 
     for (uint16_t i = 0; i < display_index; i++) {
         (*subitem_index)++;
-        const uint8_t subitem_count = get_subitem_count(*root_item);
+        const uint8_t subitem_count = get_subitem_count(tx_obj, *root_item);
         if (*subitem_index >= subitem_count) {
             // Advance root index and skip empty items
             *subitem_index = 0;
             (*root_item)++;
-            while (get_subitem_count(*root_item) == 0) {
+            while (get_subitem_count(tx_obj, *root_item) == 0) {
                 (*root_item)++;
             }
         }
@@ -389,26 +581,35 @@ __Z_INLINE parser_error_t retrieve_tree_indexes(uint8_t display_index, root_item
     return parser_ok;
 }
 
-parser_error_t tx_display_numItems(uint8_t *num_items) {
+parser_error_t tx_display_numItems(parser_tx_t *tx_obj, uint8_t *num_items) {
     *num_items = 0;
-    CHECK_PARSER_ERR(tx_indexRootFields())
+    if (tx_obj->format == parser_format_protobuf) {
+        return tx_proto_numItems(tx_obj, num_items);
+    }
+    CHECK_PARSER_ERR(tx_indexRootFields(tx_obj))
 
     *num_items = 0;
     for (root_item_e root_item = 0; root_item < NUM_REQUIRED_ROOT_PAGES; root_item++) {
-        *num_items += get_subitem_count(root_item);
+        *num_items += get_subitem_count(tx_obj, root_item);
     }
 
     return parser_ok;
 }
 
 // This function assumes that the tx_ctx has been set properly
-parser_error_t tx_display_query(uint16_t displayIdx,
+parser_error_t tx_display_query(parser_tx_t *tx_obj, uint16_t displayIdx,
                                 char *outKey, uint16_t outKeyLen,
                                 uint16_t *ret_value_token_index) {
-    CHECK_PARSER_ERR(tx_indexRootFields())
+    if (tx_obj->format == parser_format_protobuf) {
+        // There are no tokens, items are found again when their value is shown
+        *ret_value_token_index = displayIdx;
+        return tx_proto_query(tx_obj, displayIdx, outKey, outKeyLen);
+    }
+
+    CHECK_PARSER_ERR(tx_indexRootFields(tx_obj))
 
     uint8_t num_items;
-    CHECK_PARSER_ERR(tx_display_numItems(&num_items))
+    CHECK_PARSER_ERR(tx_display_numItems(tx_obj, &num_items))
 
     if (displayIdx < 0 || displayIdx >= num_items) {
         return parser_display_idx_out_of_range;
@@ -416,28 +617,112 @@ parser_error_t tx_display_query(uint16_t displayIdx,
 
     root_item_e root_index = 0;
     uint8_t subitem_index = 0;
-    CHECK_PARSER_ERR(retrieve_tree_indexes(displayIdx, &root_index, &subitem_index))
+    CHECK_PARSER_ERR(retrieve_tree_indexes(tx_obj, displayIdx, &root_index, &subitem_index))
 
     // Prepare query
-    static char tmp_val[2];
-    INIT_QUERY_CONTEXT(outKey, outKeyLen, tmp_val, sizeof(tmp_val),
+    INIT_QUERY_CONTEXT(tx_obj, outKey, outKeyLen,
+                       tx_obj->scratch->render.query_value, sizeof(tx_obj->scratch->render.query_value),
                        0, get_root_max_level(root_index))
-    parser_tx_obj.query.item_index = subitem_index;
-    parser_tx_obj.query._item_index_current = 0;
+    tx_obj->query.item_index = subitem_index;
+    tx_obj->query._item_index_current = 0;
 
     strncpy_s(outKey, get_required_root_item(root_index), outKeyLen);
 
-    if (!display_cache.root_item_start_token_valid[root_index]) {
+    if (!tx_obj->display->root_item_start_token_valid[root_index]) {
         return parser_no_data;
     }
 
-    CHECK_PARSER_ERR(tx_traverse_find(
-            display_cache.root_item_start_token_idx[root_index],
+#if JSON_TOKEN_ENGINE
+    if (root_index == root_item_msgs && tx_obj->display->msg_items_valid) {
+        if (subitem_index >= tx_obj->display->msg_item_count) {
+            return parser_no_data;
+        }
+        msg_item_key(tx_obj, tx_obj->display->msg_item_key_token[subitem_index], outKey, outKeyLen, ret_value_token_index);
+        return parser_ok;
+    }
+#endif
+
+    CHECK_PARSER_ERR(tx_traverse_find(tx_obj,
+            tx_obj->display->root_item_start_token_idx[root_index],
             ret_value_token_index))
 
     return parser_ok;
 }
 
+parser_error_t tx_display_getPageCount(parser_tx_t *tx_obj, uint8_t displayIdx, uint16_t outValLen, uint8_t *pageCount) {
+    if (!tx_obj->flags.cache_valid ||
+        displayIdx >= PAGE_COUNT_CACHE_SIZE ||
+        tx_obj->display->page_count_value_len != outValLen ||
+        tx_obj->display->page_count_expert != parser_isExpert(tx_obj) ||
+        tx_obj->display->page_count[displayIdx] == 0) {
+        return parser_no_data;
+    }
+
+    *pageCount = tx_obj->display->page_count[displayIdx];
+    return parser_ok;
+}
+
+void tx_display_setPageCount(parser_tx_t *tx_obj, uint8_t displayIdx, uint16_t outValLen, uint8_t pageCount) {
+    if (!tx_obj->flags.cache_valid || displayIdx >= PAGE_COUNT_CACHE_SIZE) {
+        return;
+    }
+
+    if (tx_obj->display->page_count_value_len != outValLen || tx_obj->display->page_count_expert != parser_isExpert(tx_obj)) {
+        MEMZERO(tx_obj->display->page_count, sizeof(tx_obj->display->page_count));
+        tx_obj->display->page_count_value_len = outValLen;
+        tx_obj->display->page_count_expert = parser_isExpert(tx_obj);
+    }
+
+    tx_obj->display->page_count[displayIdx] = pageCount;
+}
+
+parser_error_t tx_display_opaque_digest(parser_tx_t *tx_obj, uint16_t token_index,
+                                        char *outVal, uint16_t outValLen,
+                                        uint8_t pageIdx, uint8_t *pageCount) {
+    *pageCount = 0;
+    if (outVal != NULL) {
+        MEMZERO(outVal, outValLen);
+    }
+    CHECK_PARSER_ERR(tx_indexRootFields(tx_obj))
+
+    jsmntype_t type;
+    int32_t start;
+    int32_t end;
+    CHECK_PARSER_ERR(tx_getBounds(tx_obj, token_index, &type, &start, &end))
+    if (start < 0 || start > end) {
+        return parser_unexpected_buffer_end;
+    }
+
+    uint8_t digest[COIN_OPAQUE_DIGEST_LEN];
+    bool digestFound = false;
+    for (uint8_t i = 0; i < tx_obj->display->opaque_digest_count && !digestFound; i++) {
+        if (tx_obj->display->opaque_digest[i].token_idx == token_index) {
+            MEMCPY(digest, tx_obj->display->opaque_digest[i].digest, sizeof(digest));
+            digestFound = true;
+        }
+    }
+    if (!digestFound) {
+        CHECK_PARSER_ERR(opaque_calculate_digest(tx_obj, token_index, digest))
+    }
+
+    char digestHex[2 * COIN_OPAQUE_DIGEST_LEN + 1];
+    array_to_hexstr(digestHex, sizeof(digestHex), digest, sizeof(digest));
+
+    char *bufferUI = tx_obj->scratch->render.value;
+    snprintf(bufferUI, PARSER_SCRATCH_VALUE_LEN, "%d bytes, SHA-256 %s", (int) (end - start), digestHex);
+    if (outVal == NULL) {
+        *pageCount = tx_countPages(strlen(bufferUI), outValLen);
+    } else {
+        pageString(outVal, outValLen, bufferUI, pageIdx, pageCount);
+    }
+
+    if (pageIdx >= *pageCount) {
+        return parser_display_page_out_of_range;
+    }
+
+    return parser_ok;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -527,13 +812,13 @@ static const key_subst_t key_substitutions[] = {
         {"msgs/value/option",                 "Option"},
 };
 
-parser_error_t tx_display_make_friendly() {
-    CHECK_PARSER_ERR(tx_indexRootFields())
+parser_error_t tx_display_make_friendly(parser_tx_t *tx_obj) {
+    CHECK_PARSER_ERR(tx_display_index(tx_obj))
 
     // post process keys
     for (size_t i = 0; i < array_length(key_substitutions); i++) {
-        if (!strcmp(parser_tx_obj.query.out_key, key_substitutions[i].str1)) {
-            strncpy_s(parser_tx_obj.query.out_key, key_substitutions[i].str2, parser_tx_obj.query.out_key_len);
+        if (!strcmp(tx_obj->query.out_key, key_substitutions[i].str1)) {
+            strncpy_s(tx_obj->query.out_key, key_substitutions[i].str2, tx_obj->query.out_key_len);
             break;
         }
     }
@@ -34,20 +34,35 @@ typedef enum {
     root_item_tip,
 } root_item_e;
 
-bool tx_is_expert_mode();
+bool tx_is_expert_mode(parser_tx_t *tx_obj);
 
 const char *get_required_root_item(root_item_e i);
 
-parser_error_t tx_display_query(uint16_t displayIdx,
+parser_error_t tx_display_query(parser_tx_t *tx_obj, uint16_t displayIdx,
                                 char *outKey, uint16_t outKeyLen,
                                 uint16_t *ret_value_token_index);
 
 parser_error_t tx_display_readTx(parser_context_t *c,
                                  const uint8_t *data, size_t dataLen);
 
-parser_error_t tx_display_numItems(uint8_t *num_items);
+parser_error_t tx_display_numItems(parser_tx_t *tx_obj, uint8_t *num_items);
 
-parser_error_t tx_display_make_friendly();
+parser_error_t tx_display_make_friendly(parser_tx_t *tx_obj);
+
+/// Returns the page count of an item if it has already been calculated for this value length
+/// \return parser_no_data when unknown
+parser_error_t tx_display_getPageCount(parser_tx_t *tx_obj, uint8_t displayIdx, uint16_t outValLen, uint8_t *pageCount);
+
+/// Remembers the page count of an item for a given value length
+void tx_display_setPageCount(parser_tx_t *tx_obj, uint8_t displayIdx, uint16_t outValLen, uint8_t pageCount);
+
+/// Indicates if values under this key are opaque to the user (encrypted blobs, etc.)
+bool tx_display_is_opaque(const char *key);
+
+/// Shows an opaque value as its length and a short SHA-256 fingerprint
+parser_error_t tx_display_opaque_digest(parser_tx_t *tx_obj, uint16_t token_index,
+                                        char *outVal, uint16_t outValLen,
+                                        uint8_t pageIdx, uint8_t *pageCount);
 
 //---------------------------------------------
 
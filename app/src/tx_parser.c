@@ -21,6 +21,7 @@
 #include "zxmacros.h"
 #include "zxformat.h"
 #include "parser_impl.h"
+#include "tx_stream.h"
 
 // strcat but source does not need to be terminated (a chunk from a bigger string is concatenated)
 // dst_max is measured in bytes including the space for NULL termination
@@ -67,21 +68,96 @@ static const key_subst_t value_substitutions[] = {
         {"sign/MsgSignData",                       "Sign Data"},
 };
 
-parser_error_t tx_getToken(uint16_t token_index,
+parser_error_t tx_getBounds(const parser_tx_t *tx_obj, uint16_t idx,
+                           jsmntype_t *type, int32_t *start, int32_t *end) {
+#if JSON_TOKEN_ENGINE
+    if (!parser_isStreaming(tx_obj)) {
+        if (idx >= tx_obj->json.numberOfTokens) {
+            return parser_no_data;
+        }
+        *type = tx_obj->json.tokens[idx].type;
+        *start = tx_obj->json.tokens[idx].start;
+        *end = tx_obj->json.tokens[idx].end;
+        return parser_ok;
+    }
+#endif
+
+    json_event_t value;
+    CHECK_PARSER_ERR(json_stream_value(&tx_obj->stream, idx, &value))
+    *type = value.type;
+    *start = value.start;
+    *end = value.end;
+    return parser_ok;
+}
+
+parser_error_t tx_getNthToken(const parser_tx_t *tx_obj, uint16_t idx, uint16_t n, uint16_t *ret_idx) {
+#if JSON_TOKEN_ENGINE
+    if (!parser_isStreaming(tx_obj)) {
+        if (idx + n >= tx_obj->json.numberOfTokens) {
+            return parser_no_data;
+        }
+        *ret_idx = idx + n;
+        return parser_ok;
+    }
+#endif
+
+    json_event_t token;
+    CHECK_PARSER_ERR(json_stream_token(&tx_obj->stream, idx, n, &token))
+    *ret_idx = token.offset;
+    return parser_ok;
+}
+
+parser_error_t tx_getElementCount(const parser_tx_t *tx_obj, uint16_t idx, uint16_t *count) {
+#if JSON_TOKEN_ENGINE
+    if (!parser_isStreaming(tx_obj)) {
+        return array_get_element_count(&tx_obj->json, idx, count);
+    }
+#endif
+    return json_stream_element_count(&tx_obj->stream, idx, count);
+}
+
+parser_error_t tx_getNthElement(const parser_tx_t *tx_obj, uint16_t idx, uint16_t n, uint16_t *ret_idx) {
+#if JSON_TOKEN_ENGINE
+    if (!parser_isStreaming(tx_obj)) {
+        return array_get_nth_element(&tx_obj->json, idx, n, ret_idx);
+    }
+#endif
+    return json_stream_nth_element(&tx_obj->stream, idx, n, ret_idx);
+}
+
+parser_error_t tx_getRootItem(const parser_tx_t *tx_obj, const char *key, uint16_t *ret_idx) {
+#if JSON_TOKEN_ENGINE
+    if (!parser_isStreaming(tx_obj)) {
+        return object_get_value(&tx_obj->json, ROOT_TOKEN_INDEX, key, ret_idx);
+    }
+#endif
+    return json_stream_object_get_value(&tx_obj->stream, tx_obj->stream.root, key, ret_idx);
+}
+
+parser_error_t tx_getToken(parser_tx_t *tx_obj, uint16_t token_index,
                            char *out_val, uint16_t out_val_len,
                            uint8_t pageIdx, uint8_t *pageCount) {
     *pageCount = 0;
-    MEMZERO(out_val, out_val_len);
-
-    const int16_t token_start = parser_tx_obj.json.tokens[token_index].start;
-    const int16_t token_end = parser_tx_obj.json.tokens[token_index].end;
+    jsmntype_t token_type;
+    int32_t token_start;
+    int32_t token_end;
+    CHECK_PARSER_ERR(tx_getBounds(tx_obj, token_index, &token_type, &token_start, &token_end))
 
     if (token_start > token_end) {
         return parser_unexpected_buffer_end;
     }
 
-    const char *inValue = parser_tx_obj.tx + token_start;
-    uint16_t inLen = token_end - token_start;
+    return tx_getString(tx_obj->tx + token_start, token_end - token_start,
+                        out_val, out_val_len, pageIdx, pageCount);
+}
+
+parser_error_t tx_getString(const char *inValue, uint16_t inLen,
+                            char *out_val, uint16_t out_val_len,
+                            uint8_t pageIdx, uint8_t *pageCount) {
+    *pageCount = 0;
+    if (out_val != NULL) {
+        MEMZERO(out_val, out_val_len);
+    }
 
     // empty strings are considered the first page
     *pageCount = 1;
@@ -96,8 +172,11 @@ parser_error_t tx_getToken(uint16_t token_index,
             }
         }
 
-        pageStringExt(out_val, out_val_len, inValue, inLen, pageIdx, pageCount);
-
+        if (out_val != NULL) {
+            pageStringExt(out_val, out_val_len, inValue, inLen, pageIdx, pageCount);
+        } else {
+            *pageCount = tx_countPages(inLen, out_val_len);
+        }
     }
 
     if (pageIdx >= *pageCount) {
@@ -107,25 +186,64 @@ parser_error_t tx_getToken(uint16_t token_index,
     return parser_ok;
 }
 
-__Z_INLINE void append_key_item(uint16_t token_index) {
-    if (*parser_tx_obj.query.out_key > 0) {
+void tx_appendKey(parser_tx_t *tx_obj, const char *key, int32_t key_len) {
+    if (*tx_obj->query.out_key > 0) {
         // There is already something there, add separator
-        strcat_chunk_s(parser_tx_obj.query.out_key,
-                       parser_tx_obj.query.out_key_len,
+        strcat_chunk_s(tx_obj->query.out_key,
+                       tx_obj->query.out_key_len,
                        "/",
                        1);
     }
 
-    const int16_t token_start = parser_tx_obj.json.tokens[token_index].start;
-    const int16_t token_end = parser_tx_obj.json.tokens[token_index].end;
-    const char *address_ptr = parser_tx_obj.tx + token_start;
-    const int32_t new_item_size = token_end - token_start;
+    strcat_chunk_s(tx_obj->query.out_key,
+                   tx_obj->query.out_key_len,
+                   key,
+                   key_len);
+}
+
+#if JSON_TOKEN_ENGINE
+__Z_INLINE void append_key_item(parser_tx_t *tx_obj, uint16_t token_index) {
+    const int16_t token_start = tx_obj->json.tokens[token_index].start;
+    const int16_t token_end = tx_obj->json.tokens[token_index].end;
+    tx_appendKey(tx_obj, tx_obj->tx + token_start, token_end - token_start);
+}
+#endif
+
+parser_error_t tx_traverse_leaf(parser_tx_t *tx_obj) {
+    const bool skipTypeField =
+            tx_obj->flags.cache_valid &&
+            tx_obj->flags.msg_type_grouping &&
+            is_msg_type_field(tx_obj->query.out_key) &&
+            tx_obj->filter_msg_type_valid_idx != tx_obj->query._item_index_current;
+
+    const bool skipFromFieldHidingRule =
+            tx_obj->flags.msg_from_grouping_hide_all ||
+            tx_obj->filter_msg_from_valid_idx != tx_obj->query._item_index_current;
+
+    const bool skipFromField =
+            tx_obj->flags.cache_valid &&
+            tx_obj->flags.msg_from_grouping &&
+            is_msg_from_field(tx_obj->query.out_key) &&
+            skipFromFieldHidingRule;
+
+    const bool skipField = skipFromField || skipTypeField;
 
-    strcat_chunk_s(parser_tx_obj.query.out_key,
-                   parser_tx_obj.query.out_key_len,
-                   address_ptr,
-                   new_item_size);
+    CHECK_APP_CANARY()
+
+    // Early bail out
+    if (!skipField && tx_obj->query._item_index_current == tx_obj->query.item_index) {
+        return parser_ok;
+    }
+
+    if (skipField) {
+        tx_obj->query.item_index++;
+    }
+
+    tx_obj->query._item_index_current++;
+    CHECK_APP_CANARY()
+    return parser_query_no_results;
 }
+
 ///////////////////////////
 ///////////////////////////
 ///////////////////////////
@@ -133,105 +251,78 @@ __Z_INLINE void append_key_item(uint16_t token_index) {
 ///////////////////////////
 ///////////////////////////
 
-parser_error_t tx_traverse_find(uint16_t root_token_index, uint16_t *ret_value_token_index) {
-    const jsmntype_t token_type = parser_tx_obj.json.tokens[root_token_index].type;
+#if JSON_TOKEN_ENGINE
+static parser_error_t tx_token_traverse_find(parser_tx_t *tx_obj, uint16_t root_token_index,
+                                             uint16_t *ret_value_token_index) {
+    const jsmntype_t token_type = tx_obj->json.tokens[root_token_index].type;
 
     CHECK_APP_CANARY()
 
-    if (parser_tx_obj.tx == NULL || root_token_index < 0) {
+    if (tx_obj->tx == NULL || root_token_index < 0) {
         return parser_no_data;
     }
 
-    if (parser_tx_obj.query.max_level <= 0 || parser_tx_obj.query.max_depth <= 0 ||
+    if (tx_obj->query.max_level <= 0 || tx_obj->query.max_depth <= 0 ||
         token_type == JSMN_STRING ||
         token_type == JSMN_PRIMITIVE) {
-        const bool skipTypeField =
-                parser_tx_obj.flags.cache_valid &&
-                parser_tx_obj.flags.msg_type_grouping &&
-                is_msg_type_field(parser_tx_obj.query.out_key) &&
-                parser_tx_obj.filter_msg_type_valid_idx != parser_tx_obj.query._item_index_current;
-
-        const bool skipFromFieldHidingRule =
-                parser_tx_obj.flags.msg_from_grouping_hide_all ||
-                parser_tx_obj.filter_msg_from_valid_idx != parser_tx_obj.query._item_index_current;
-
-        const bool skipFromField =
-                parser_tx_obj.flags.cache_valid &&
-                parser_tx_obj.flags.msg_from_grouping &&
-                is_msg_from_field(parser_tx_obj.query.out_key) &&
-                skipFromFieldHidingRule;
-
-        const bool skipField = skipFromField || skipTypeField;
-
-        CHECK_APP_CANARY()
-
-        // Early bail out
-        if (!skipField && parser_tx_obj.query._item_index_current == parser_tx_obj.query.item_index) {
+        const parser_error_t err = tx_traverse_leaf(tx_obj);
+        if (err == parser_ok) {
             *ret_value_token_index = root_token_index;
-            CHECK_APP_CANARY()
-            return parser_ok;
         }
-
-        if (skipField) {
-            parser_tx_obj.query.item_index++;
-        }
-
-        parser_tx_obj.query._item_index_current++;
-        CHECK_APP_CANARY()
-        return parser_query_no_results;
+        return err;
     }
 
     uint16_t el_count;
     parser_error_t err;
 
-    CHECK_PARSER_ERR(object_get_element_count(&parser_tx_obj.json, root_token_index, &el_count))
-
     switch (token_type) {
         case JSMN_OBJECT: {
-            const size_t key_len = strlen(parser_tx_obj.query.out_key);
+            CHECK_PARSER_ERR(object_get_element_count(&tx_obj->json, root_token_index, &el_count))
+            const size_t key_len = strlen(tx_obj->query.out_key);
             for (uint16_t i = 0; i < el_count; ++i) {
                 uint16_t key_index;
                 uint16_t value_index;
 
-                CHECK_PARSER_ERR(object_get_nth_key(&parser_tx_obj.json, root_token_index, i, &key_index))
-                CHECK_PARSER_ERR(object_get_nth_value(&parser_tx_obj.json, root_token_index, i, &value_index))
+                CHECK_PARSER_ERR(object_get_nth_key(&tx_obj->json, root_token_index, i, &key_index))
+                CHECK_PARSER_ERR(object_get_nth_value(&tx_obj->json, root_token_index, i, &value_index))
 
                 // Skip writing keys if we are actually exploring to count
-                append_key_item(key_index);
+                append_key_item(tx_obj, key_index);
                 CHECK_APP_CANARY()
 
                 // When traversing objects both level and depth should be considered
-                parser_tx_obj.query.max_level--;
-                parser_tx_obj.query.max_depth--;
+                tx_obj->query.max_level--;
+                tx_obj->query.max_depth--;
 
                 // Traverse the value, extracting subkeys
-                err = tx_traverse_find(value_index, ret_value_token_index);
+                err = tx_token_traverse_find(tx_obj, value_index, ret_value_token_index);
                 CHECK_APP_CANARY()
-                parser_tx_obj.query.max_level++;
-                parser_tx_obj.query.max_depth++;
+                tx_obj->query.max_level++;
+                tx_obj->query.max_depth++;
 
                 if (err == parser_ok) {
                     return parser_ok;
                 }
 
-                *(parser_tx_obj.query.out_key + key_len) = 0;
+                *(tx_obj->query.out_key + key_len) = 0;
                 CHECK_APP_CANARY()
             }
             break;
         }
         case JSMN_ARRAY: {
+            CHECK_PARSER_ERR(array_get_element_count(&tx_obj->json, root_token_index, &el_count))
             for (uint16_t i = 0; i < el_count; ++i) {
                 uint16_t element_index;
-                CHECK_PARSER_ERR(array_get_nth_element(&parser_tx_obj.json,
+                CHECK_PARSER_ERR(array_get_nth_element(&tx_obj->json,
                                                        root_token_index, i,
                                                        &element_index))
                 CHECK_APP_CANARY()
 
                 // When iterating along an array,
                 // the level does not change but we need to count the recursion
-                parser_tx_obj.query.max_depth--;
-                err = tx_traverse_find(element_index, ret_value_token_index);
-                parser_tx_obj.query.max_depth++;
+                tx_obj->query.max_depth--;
+                err = tx_token_traverse_find(tx_obj, element_index, ret_value_token_index);
+                tx_obj->query.max_depth++;
 
                 CHECK_APP_CANARY()
 
@@ -247,5 +338,15 @@ parser_error_t tx_traverse_find(uint16_t root_token_index, uint16_t *ret_value_t
 
     return parser_query_no_results;
 }
+#endif
+
+parser_error_t tx_traverse_find(parser_tx_t *tx_obj, uint16_t root_token_index, uint16_t *ret_value_token_index) {
+#if JSON_TOKEN_ENGINE
+    if (!parser_isStreaming(tx_obj)) {
+        return tx_token_traverse_find(tx_obj, root_token_index, ret_value_token_index);
+    }
+#endif
+    return tx_stream_traverse_find(tx_obj, root_token_index, ret_value_token_index);
+}
 
 #pragma clang diagnostic pop
@@ -21,6 +21,7 @@
 #include "json/json_parser.h"
 #include <stdint.h>
 #include <common/parser_common.h>
+#include "parser_txdef.h"
 #include "zxmacros.h"
 
 #ifdef __cplusplus
@@ -29,31 +30,72 @@ extern "C" {
 
 #define MAX_RECURSION_DEPTH  6
 
-#define INIT_QUERY_CONTEXT(_KEY, _KEY_LEN, _VAL, _VAL_LEN, _PAGE_IDX, _MAX_LEVEL) \
-    parser_tx_obj.query._item_index_current = 0; \
-    parser_tx_obj.query.max_depth = MAX_RECURSION_DEPTH; \
-    parser_tx_obj.query.max_level = _MAX_LEVEL; \
+#define INIT_QUERY_CONTEXT(_TX, _KEY, _KEY_LEN, _VAL, _VAL_LEN, _PAGE_IDX, _MAX_LEVEL) \
+    (_TX)->query._item_index_current = 0; \
+    (_TX)->query.max_depth = MAX_RECURSION_DEPTH; \
+    (_TX)->query.max_level = _MAX_LEVEL; \
     \
-    parser_tx_obj.query.item_index= 0; \
-    parser_tx_obj.query.page_index = (_PAGE_IDX); \
+    (_TX)->query.item_index= 0; \
+    (_TX)->query.page_index = (_PAGE_IDX); \
     \
     MEMZERO(_KEY, (_KEY_LEN)); \
     MEMZERO(_VAL, (_VAL_LEN)); \
-    parser_tx_obj.query.out_key= _KEY; \
-    parser_tx_obj.query.out_val= _VAL; \
-    parser_tx_obj.query.out_key_len = (_KEY_LEN); \
-    parser_tx_obj.query.out_val_len = (_VAL_LEN);
+    (_TX)->query.out_key= _KEY; \
+    (_TX)->query.out_val= _VAL; \
+    (_TX)->query.out_key_len = (_KEY_LEN); \
+    (_TX)->query.out_val_len = (_VAL_LEN);
 
-parser_error_t tx_traverse_find(uint16_t root_token_index, uint16_t *ret_value_token_index);
+// Values of Amino JSON payloads are referred to by their token index, or by their offset in the buffer
+// when they are read by the streaming engine (see parser_isStreaming). These work with both
+
+/// Type and bounds of a value, same as its jsmn token
+parser_error_t tx_getBounds(const parser_tx_t *tx_obj, uint16_t idx,
+                            jsmntype_t *type, int32_t *start, int32_t *end);
+
+/// n-th token from a value on (0 is the value itself), in jsmn order
+parser_error_t tx_getNthToken(const parser_tx_t *tx_obj, uint16_t idx, uint16_t n, uint16_t *ret_idx);
+
+/// Same as array_get_element_count
+parser_error_t tx_getElementCount(const parser_tx_t *tx_obj, uint16_t idx, uint16_t *count);
+
+/// Same as array_get_nth_element
+parser_error_t tx_getNthElement(const parser_tx_t *tx_obj, uint16_t idx, uint16_t n, uint16_t *ret_idx);
+
+/// Value of a key of the root object
+parser_error_t tx_getRootItem(const parser_tx_t *tx_obj, const char *key, uint16_t *ret_idx);
+
+parser_error_t tx_traverse_find(parser_tx_t *tx_obj, uint16_t root_token_index, uint16_t *ret_value_token_index);
+
+// Appends a key to query.out_key, with a separator
+void tx_appendKey(parser_tx_t *tx_obj, const char *key, int32_t key_len);
+
+// Counts a leaf found by tx_traverse_find, applying the grouping rules.
+// Returns parser_ok if it is the leaf the query is looking for
+parser_error_t tx_traverse_leaf(parser_tx_t *tx_obj);
 
 // Traverses transaction data and fills tx_context
-parser_error_t tx_traverse(int16_t root_token_index, uint8_t *numChunks);
+parser_error_t tx_traverse(parser_tx_t *tx_obj, int16_t root_token_index, uint8_t *numChunks);
+
+// Number of pages needed to show a value of value_len characters in out_val_len sized chunks (same as pageStringExt)
+__Z_INLINE uint8_t tx_countPages(uint16_t value_len, uint16_t out_val_len) {
+    if (value_len == 0 || out_val_len <= 1) {
+        return 0;
+    }
+    const uint16_t page_len = out_val_len - 1;
+    return (uint8_t) ((value_len / page_len) + ((value_len % page_len) > 0 ? 1 : 0));
+}
 
 // Retrieves the value for the corresponding token index. If the value goes beyond val_len, the chunk_idx will be used
-parser_error_t tx_getToken(uint16_t token_index,
+// When out_val is NULL, only the page count is calculated (out_val_len is still used as page size)
+parser_error_t tx_getToken(parser_tx_t *tx_obj, uint16_t token_index,
                            char *out_val, uint16_t out_val_len,
                            uint8_t pageIdx, uint8_t *pageCount);
 
+// Same as tx_getToken, for a value that is not a token
+parser_error_t tx_getString(const char *value, uint16_t value_len,
+                            char *out_val, uint16_t out_val_len,
+                            uint8_t pageIdx, uint8_t *pageCount);
+
 __Z_INLINE bool is_msg_type_field(char *field_name) {
     return strcmp(field_name, "msgs/type") == 0;
 }
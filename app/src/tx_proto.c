@@ -0,0 +1,764 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "tx_proto.h"
+#include "tx_display.h"
+#include "tx_parser.h"
+#include "parser_impl.h"
+#include "proto/proto_reader.h"
+#include "coin.h"
+#include <zxmacros.h>
+#include <zxformat.h>
+
+// cosmos.tx.v1beta1.SignDoc
+#define SIGN_DOC_BODY_BYTES             1u
+#define SIGN_DOC_AUTH_INFO_BYTES        2u
+#define SIGN_DOC_CHAIN_ID               3u
+#define SIGN_DOC_ACCOUNT_NUMBER         4u
+
+// cosmos.tx.v1beta1.TxBody
+#define TX_BODY_MESSAGES                1u
+#define TX_BODY_MEMO                    2u
+
+// cosmos.tx.v1beta1.AuthInfo
+#define AUTH_INFO_SIGNER_INFOS          1u
+#define AUTH_INFO_FEE                   2u
+#define AUTH_INFO_TIP                   3u
+
+// cosmos.tx.v1beta1.SignerInfo
+#define SIGNER_INFO_SEQUENCE            3u
+
+// google.protobuf.Any
+#define ANY_TYPE_URL                    1u
+#define ANY_VALUE                       2u
+
+// cosmos.base.v1beta1.Coin
+#define PROTO_COIN_DENOM                1u
+#define PROTO_COIN_AMOUNT               2u
+
+// Passed as display index to count items
+#define WALK_COUNT_ONLY                 0xFFFFu
+
+typedef enum {
+    proto_kind_string = 0,      // printable ASCII
+    proto_kind_uint,            // varint, shown in decimal
+    proto_kind_coin,            // Coin
+    proto_kind_coins,           // repeated Coin
+    proto_kind_any,             // repeated Any, one of msg_defs
+    proto_kind_bytes,           // not shown, or checked by the caller
+} proto_kind_e;
+
+typedef struct {
+    char name[24];              // key in the Amino JSON sign doc
+    uint8_t number;
+    uint8_t kind;
+    bool repeated;
+    bool omit_empty;            // only shown when set, as Amino JSON omits it
+} proto_field_def_t;
+
+#define PROTO_MSG_MAX_FIELDS    4
+
+typedef struct {
+    char type_url[64];
+    char amino_type[44];
+    uint8_t num_fields;
+    // in the order the Amino JSON sign doc has them, keys sorted
+    proto_field_def_t fields[PROTO_MSG_MAX_FIELDS];
+} proto_msg_def_t;
+
+static const proto_field_def_t sign_doc_fields[] = {
+        {"body_bytes",      SIGN_DOC_BODY_BYTES,      proto_kind_bytes,  false, false},
+        {"auth_info_bytes", SIGN_DOC_AUTH_INFO_BYTES, proto_kind_bytes,  false, false},
+        {"chain_id",        SIGN_DOC_CHAIN_ID,        proto_kind_string, false, false},
+        {"account_number",  SIGN_DOC_ACCOUNT_NUMBER,  proto_kind_uint,   false, false},
+};
+
+// timeout_height is accepted, but not shown as Amino JSON does not have it.
+// Extension options are rejected as unknown fields
+static const proto_field_def_t tx_body_fields[] = {
+        {"messages",        TX_BODY_MESSAGES,         proto_kind_any,    true,  false},
+        {"memo",            TX_BODY_MEMO,             proto_kind_string, false, false},
+        {"timeout_height",  3,                        proto_kind_uint,   false, false},
+};
+
+static const proto_field_def_t auth_info_fields[] = {
+        {"signer_infos",    AUTH_INFO_SIGNER_INFOS,   proto_kind_bytes,  true,  false},
+        {"fee",             AUTH_INFO_FEE,            proto_kind_bytes,  false, false},
+        {"tip",             AUTH_INFO_TIP,            proto_kind_bytes,  false, false},
+};
+
+static const proto_field_def_t signer_info_fields[] = {
+        {"public_key",      1,                        proto_kind_bytes,  false, false},
+        {"mode_info",       2,                        proto_kind_bytes,  false, false},
+        {"sequence",        SIGNER_INFO_SEQUENCE,     proto_kind_uint,   false, false},
+};
+
+static const proto_field_def_t fee_fields[] = {
+        {"amount",          1,                        proto_kind_coins,  true,  false},
+        {"gas",             2,                        proto_kind_uint,   false, false},
+        {"granter",         4,                        proto_kind_string, false, true},
+        {"payer",           3,                        proto_kind_string, false, true},
+};
+
+static const proto_field_def_t tip_fields[] = {
+        {"amount",          1,                        proto_kind_coins,  true,  false},
+        {"tipper",          2,                        proto_kind_string, false, false},
+};
+
+static const proto_field_def_t any_fields[] = {
+        {"type_url",        ANY_TYPE_URL,             proto_kind_string, false, false},
+        {"value",           ANY_VALUE,                proto_kind_bytes,  false, false},
+};
+
+static const proto_field_def_t coin_fields[] = {
+        {"denom",           PROTO_COIN_DENOM,         proto_kind_string, false, false},
+        {"amount",          PROTO_COIN_AMOUNT,        proto_kind_string, false, false},
+};
+
+// Messages accepted in a SignDoc, shown as their Amino JSON counterpart (see tx_schema)
+static const proto_msg_def_t msg_defs[] = {
+        {"/cosmos.bank.v1beta1.MsgSend", "cosmos-sdk/MsgSend", 3, {
+                {"amount",                3, proto_kind_coins,  true,  false},
+                {"from_address",          1, proto_kind_string, false, false},
+                {"to_address",            2, proto_kind_string, false, false},
+        }},
+        {"/cosmos.staking.v1beta1.MsgDelegate", "cosmos-sdk/MsgDelegate", 3, {
+                {"amount",                3, proto_kind_coin,   false, false},
+                {"delegator_address",     1, proto_kind_string, false, false},
+                {"validator_address",     2, proto_kind_string, false, false},
+        }},
+        {"/cosmos.staking.v1beta1.MsgUndelegate", "cosmos-sdk/MsgUndelegate", 3, {
+                {"amount",                3, proto_kind_coin,   false, false},
+                {"delegator_address",     1, proto_kind_string, false, false},
+                {"validator_address",     2, proto_kind_string, false, false},
+        }},
+        {"/cosmos.staking.v1beta1.MsgBeginRedelegate", "cosmos-sdk/MsgBeginRedelegate", 4, {
+                {"amount",                4, proto_kind_coin,   false, false},
+                {"delegator_address",     1, proto_kind_string, false, false},
+                {"validator_dst_address", 3, proto_kind_string, false, false},
+                {"validator_src_address", 2, proto_kind_string, false, false},
+        }},
+        {"/cosmos.distribution.v1beta1.MsgWithdrawDelegatorReward", "cosmos-sdk/MsgWithdrawDelegationReward", 2, {
+                {"delegator_address",     1, proto_kind_string, false, false},
+                {"validator_address",     2, proto_kind_string, false, false},
+        }},
+        {"/cosmos.distribution.v1beta1.MsgWithdrawValidatorCommission", "cosmos-sdk/MsgWithdrawValidatorCommission", 1, {
+                {"validator_address",     1, proto_kind_string, false, false},
+        }},
+        {"/cosmos.gov.v1beta1.MsgVote", "cosmos-sdk/MsgVote", 3, {
+                {"option",                3, proto_kind_uint,   false, false},
+                {"proposal_id",           1, proto_kind_uint,   false, false},
+                {"voter",                 2, proto_kind_string, false, false},
+        }},
+        {"/cosmos.gov.v1beta1.MsgDeposit", "cosmos-sdk/MsgDeposit", 3, {
+                {"amount",                3, proto_kind_coins,  true,  false},
+                {"depositor",             2, proto_kind_string, false, false},
+                {"proposal_id",           1, proto_kind_uint,   false, false},
+        }},
+};
+
+__Z_INLINE const uint8_t *proto_buffer(const parser_tx_t *tx_obj) {
+    return (const uint8_t *) tx_obj->tx;
+}
+
+__Z_INLINE const proto_field_def_t *find_field_def(const proto_field_def_t *defs, uint8_t numDefs, uint32_t number) {
+    for (uint8_t i = 0; i < numDefs; i++) {
+        if (defs[i].number == number) {
+            return &defs[i];
+        }
+    }
+    return NULL;
+}
+
+__Z_INLINE bool slice_equals(const uint8_t *buffer, proto_slice_t slice, const char *s) {
+    const size_t len = strlen(s);
+    return slice.len == len && MEMCMP(buffer + slice.offset, s, len) == 0;
+}
+
+__Z_INLINE bool slices_equal(const uint8_t *buffer, proto_slice_t a, proto_slice_t b) {
+    return a.len == b.len && MEMCMP(buffer + a.offset, buffer + b.offset, a.len) == 0;
+}
+
+__Z_INLINE const proto_msg_def_t *find_msg_def(const uint8_t *buffer, proto_slice_t type_url) {
+    for (size_t i = 0; i < array_length(msg_defs); i++) {
+        if (slice_equals(buffer, type_url, msg_defs[i].type_url)) {
+            return &msg_defs[i];
+        }
+    }
+    return NULL;
+}
+
+// Bytes of a string field, empty when the message does not have it (proto3 default)
+__Z_INLINE parser_error_t get_string_field(const uint8_t *buffer, proto_slice_t message,
+                                           uint32_t number, proto_slice_t *value) {
+    proto_field_t field;
+    const parser_error_t err = proto_find_field(buffer, message, number, &field);
+    if (err == parser_no_data) {
+        value->offset = message.offset;
+        value->len = 0;
+        return parser_ok;
+    }
+    CHECK_PARSER_ERR(err)
+    *value = field.bytes;
+    return parser_ok;
+}
+
+__Z_INLINE parser_error_t require_field(const uint8_t *buffer, proto_slice_t message,
+                                        uint32_t number, proto_slice_t *value) {
+    proto_field_t field;
+    const parser_error_t err = proto_find_field(buffer, message, number, &field);
+    if (err == parser_no_data) {
+        return parser_missing_field;
+    }
+    CHECK_PARSER_ERR(err)
+    *value = field.bytes;
+    return parser_ok;
+}
+
+// Type and value of a message
+__Z_INLINE parser_error_t read_any(const uint8_t *buffer, proto_slice_t any,
+                                   const proto_msg_def_t **def, proto_slice_t *value) {
+    proto_slice_t type_url;
+    CHECK_PARSER_ERR(require_field(buffer, any, ANY_TYPE_URL, &type_url))
+    *def = find_msg_def(buffer, type_url);
+    if (*def == NULL) {
+        // Nothing could be shown for it
+        return parser_unexpected_type;
+    }
+    return get_string_field(buffer, any, ANY_VALUE, value);
+}
+
+__Z_INLINE parser_error_t validate_printable(const uint8_t *buffer, proto_slice_t slice) {
+    for (uint16_t i = 0; i < slice.len; i++) {
+        const uint8_t c = buffer[slice.offset + i];
+        if (c < 0x20u || c > 0x7Eu) {
+            return parser_unexpected_characters;
+        }
+    }
+    return parser_ok;
+}
+
+static parser_error_t validate_message(const uint8_t *buffer, proto_slice_t message,
+                                       const proto_field_def_t *defs, uint8_t numDefs);
+
+// Same limits parser_formatAmountItem has for Amino JSON
+__Z_INLINE parser_error_t validate_coin(const uint8_t *buffer, proto_slice_t coin) {
+    CHECK_PARSER_ERR(validate_message(buffer, coin, coin_fields, array_length(coin_fields)))
+
+    proto_slice_t denom;
+    proto_slice_t amount;
+    CHECK_PARSER_ERR(get_string_field(buffer, coin, PROTO_COIN_DENOM, &denom))
+    CHECK_PARSER_ERR(get_string_field(buffer, coin, PROTO_COIN_AMOUNT, &amount))
+    if (denom.len == 0 || denom.len >= COIN_DENOM_MAXSIZE ||
+        amount.len == 0 || amount.len >= COIN_AMOUNT_MAXSIZE) {
+        return parser_unexpected_value;
+    }
+    for (uint16_t i = 0; i < amount.len; i++) {
+        const uint8_t c = buffer[amount.offset + i];
+        if (c < '0' || c > '9') {
+            return parser_unexpected_value;
+        }
+    }
+    return parser_ok;
+}
+
+__Z_INLINE parser_error_t validate_any(const uint8_t *buffer, proto_slice_t any) {
+    CHECK_PARSER_ERR(validate_message(buffer, any, any_fields, array_length(any_fields)))
+
+    const proto_msg_def_t *def = NULL;
+    proto_slice_t value;
+    CHECK_PARSER_ERR(read_any(buffer, any, &def, &value))
+    return validate_message(buffer, value, def->fields, def->num_fields);
+}
+
+// Every field has to be known, with the expected wire type, and only repeated fields can
+// appear more than once: protobuf keeps the last value, what is shown is the first one
+static parser_error_t validate_message(const uint8_t *buffer, proto_slice_t message,
+                                       const proto_field_def_t *defs, uint8_t numDefs) {
+    uint8_t seen = 0;
+    proto_reader_t reader;
+    proto_reader_init(&reader, buffer, message);
+
+    proto_field_t field;
+    parser_error_t err;
+    while ((err = proto_next_field(&reader, &field)) == parser_ok) {
+        const proto_field_def_t *def = find_field_def(defs, numDefs, field.number);
+        if (def == NULL) {
+            return parser_unexpected_field;
+        }
+
+        const uint8_t expectedWireType = def->kind == proto_kind_uint ? PROTO_WIRE_VARINT : PROTO_WIRE_LEN;
+        if (field.wire_type != expectedWireType) {
+            return parser_unexpected_type;
+        }
+
+        const uint8_t bit = (uint8_t) (1u << (uint8_t) (def - defs));
+        if (!def->repeated && (seen & bit) != 0) {
+            return parser_duplicated_field;
+        }
+        seen |= bit;
+
+        switch (def->kind) {
+            case proto_kind_string:
+                CHECK_PARSER_ERR(validate_printable(buffer, field.bytes))
+                break;
+            case proto_kind_coin:
+            case proto_kind_coins:
+                CHECK_PARSER_ERR(validate_coin(buffer, field.bytes))
+                break;
+            case proto_kind_any:
+                CHECK_PARSER_ERR(validate_any(buffer, field.bytes))
+                break;
+            default:
+                break;
+        }
+    }
+
+    return err == parser_no_data ? parser_ok : err;
+}
+
+parser_error_t tx_proto_readTx(parser_context_t *ctx, const uint8_t *data, size_t dataLen) {
+    // Slices are 16 bits
+    if (dataLen > UINT16_MAX) {
+        return parser_value_out_of_range;
+    }
+    CHECK_PARSER_ERR(parser_init(ctx, data, dataLen))
+
+    parser_tx_t *tx_obj = parser_getTx(ctx);
+    MEMZERO(&tx_obj->proto, sizeof(tx_obj->proto));
+    tx_obj->tx = (const char *) data;
+    tx_obj->flags.cache_valid = 0;
+    tx_obj->filter_msg_type_count = 0;
+    tx_obj->filter_msg_from_count = 0;
+
+    proto_tx_t *proto = &tx_obj->proto;
+    proto->sign_doc.len = (uint16_t) dataLen;
+
+    CHECK_PARSER_ERR(validate_message(data, proto->sign_doc, sign_doc_fields, array_length(sign_doc_fields)))
+    proto_slice_t chain_id;
+    proto_slice_t auth_info;
+    CHECK_PARSER_ERR(require_field(data, proto->sign_doc, SIGN_DOC_CHAIN_ID, &chain_id))
+    CHECK_PARSER_ERR(require_field(data, proto->sign_doc, SIGN_DOC_BODY_BYTES, &proto->body))
+    CHECK_PARSER_ERR(require_field(data, proto->sign_doc, SIGN_DOC_AUTH_INFO_BYTES, &auth_info))
+
+    CHECK_PARSER_ERR(validate_message(data, proto->body, tx_body_fields, array_length(tx_body_fields)))
+    proto_slice_t first_msg;
+    CHECK_PARSER_ERR(require_field(data, proto->body, TX_BODY_MESSAGES, &first_msg))
+
+    CHECK_PARSER_ERR(validate_message(data, auth_info, auth_info_fields, array_length(auth_info_fields)))
+    CHECK_PARSER_ERR(require_field(data, auth_info, AUTH_INFO_FEE, &proto->fee))
+    CHECK_PARSER_ERR(validate_message(data, proto->fee, fee_fields, array_length(fee_fields)))
+
+    proto_field_t field;
+    const parser_error_t err = proto_find_field(data, auth_info, AUTH_INFO_TIP, &field);
+    if (err == parser_ok) {
+        proto->tip = field.bytes;
+        proto->has_tip = true;
+        CHECK_PARSER_ERR(validate_message(data, proto->tip, tip_fields, array_length(tip_fields)))
+    } else if (err != parser_no_data) {
+        return err;
+    }
+
+    // The sequence shown is the one of the only signer
+    uint8_t signers = 0;
+    proto_reader_t reader;
+    proto_reader_init(&reader, data, auth_info);
+    while (proto_next_field(&reader, &field) == parser_ok) {
+        if (field.number == AUTH_INFO_SIGNER_INFOS) {
+            proto->signer = field.bytes;
+            signers++;
+        }
+    }
+    if (signers != 1) {
+        return parser_unexpected_number_items;
+    }
+    CHECK_PARSER_ERR(validate_message(data, proto->signer, signer_info_fields, array_length(signer_info_fields)))
+
+    return parser_ok;
+}
+
+__Z_INLINE bool is_from_field(const proto_field_def_t *def) {
+    return def != NULL && strcmp(def->name, "delegator_address") == 0;
+}
+
+__Z_INLINE const proto_field_def_t *find_from_field(const proto_msg_def_t *msg) {
+    for (uint8_t i = 0; i < msg->num_fields; i++) {
+        if (is_from_field(&msg->fields[i])) {
+            return &msg->fields[i];
+        }
+    }
+    return NULL;
+}
+
+parser_error_t tx_proto_index(parser_tx_t *tx_obj) {
+    if (tx_obj->flags.cache_valid) {
+        return parser_ok;
+    }
+
+    MEMZERO(tx_obj->display, sizeof(display_cache_t));
+    const uint8_t *buffer = proto_buffer(tx_obj);
+
+    proto_slice_t chain_id;
+    CHECK_PARSER_ERR(get_string_field(buffer, tx_obj->proto.sign_doc, SIGN_DOC_CHAIN_ID, &chain_id))
+    tx_obj->display->is_default_chain = slice_equals(buffer, chain_id, COIN_DEFAULT_CHAINID);
+
+    // Same grouping as Amino JSON: a type shared by all messages is shown once, and so is a
+    // delegator shared by all the messages that have one
+    tx_obj->filter_msg_type_count = 0;
+    tx_obj->filter_msg_from_count = 0;
+    tx_obj->filter_msg_type_valid_idx = 0;
+    tx_obj->filter_msg_from_valid_idx = 0;
+    tx_obj->flags.msg_type_grouping = 1;
+    tx_obj->flags.msg_from_grouping = 1;
+
+    proto_slice_t reference_msg_type = {0};
+    proto_slice_t reference_msg_from = {0};
+
+    proto_reader_t reader;
+    proto_reader_init(&reader, buffer, tx_obj->proto.body);
+    proto_field_t field;
+    parser_error_t err;
+    while ((err = proto_next_field(&reader, &field)) == parser_ok) {
+        if (field.number != TX_BODY_MESSAGES) {
+            continue;
+        }
+
+        proto_slice_t type_url;
+        CHECK_PARSER_ERR(require_field(buffer, field.bytes, ANY_TYPE_URL, &type_url))
+        if (tx_obj->filter_msg_type_count == 0) {
+            reference_msg_type = type_url;
+        } else if (!slices_equal(buffer, reference_msg_type, type_url)) {
+            tx_obj->flags.msg_type_grouping = 0;
+        }
+
+        const proto_msg_def_t *def = NULL;
+        proto_slice_t value;
+        CHECK_PARSER_ERR(read_any(buffer, field.bytes, &def, &value))
+        const proto_field_def_t *from = find_from_field(def);
+        if (from != NULL) {
+            proto_slice_t from_value;
+            CHECK_PARSER_ERR(get_string_field(buffer, value, from->number, &from_value))
+            if (tx_obj->filter_msg_from_count == 0) {
+                reference_msg_from = from_value;
+                tx_obj->filter_msg_from_valid_idx = tx_obj->filter_msg_type_count;
+            } else if (!slices_equal(buffer, reference_msg_from, from_value)) {
+                tx_obj->flags.msg_from_grouping = 0;
+            }
+            tx_obj->filter_msg_from_count++;
+        }
+
+        tx_obj->filter_msg_type_count++;
+    }
+    if (err != parser_no_data) {
+        return err;
+    }
+
+    tx_obj->flags.cache_valid = 1;
+
+    if (tx_is_expert_mode(tx_obj)) {
+        tx_obj->flags.msg_from_grouping = 0;
+    }
+
+    tx_obj->flags.msg_from_grouping_hide_all = 0;
+    if (tx_obj->filter_msg_from_count > 0 && tx_obj->own_addr != NULL &&
+        slice_equals(buffer, reference_msg_from, tx_obj->own_addr)) {
+        tx_obj->flags.msg_from_grouping_hide_all = 1;
+    }
+
+    return parser_ok;
+}
+
+typedef struct {
+    root_item_e root;
+    const proto_msg_def_t *msg;         // msgs items
+    const proto_field_def_t *field;     // NULL for msgs/type
+    proto_slice_t message;              // where the field is
+} proto_item_t;
+
+typedef struct {
+    uint16_t wanted;                    // display index, or WALK_COUNT_ONLY
+    uint16_t count;
+    proto_item_t *item;
+} proto_walk_t;
+
+// Counts a shown item, true when it is the one wanted
+__Z_INLINE bool walk_visit(proto_walk_t *walk, root_item_e root, const proto_msg_def_t *msg,
+                           const proto_field_def_t *field, proto_slice_t message) {
+    if (walk->count++ != walk->wanted) {
+        return false;
+    }
+    walk->item->root = root;
+    walk->item->msg = msg;
+    walk->item->field = field;
+    walk->item->message = message;
+    return true;
+}
+
+#define WALK_VISIT(_WALK, _ROOT, _MSG, _FIELD, _MESSAGE) \
+    if (walk_visit((_WALK), (_ROOT), (_MSG), (_FIELD), (_MESSAGE))) { return parser_ok; }
+
+// Goes through the items in display order, applying the rules get_subitem_count has for
+// Amino JSON. Stops at the wanted item, parser_no_data when there are no more
+static parser_error_t proto_walk(parser_tx_t *tx_obj, proto_walk_t *walk) {
+    CHECK_PARSER_ERR(tx_proto_index(tx_obj))
+    const uint8_t *buffer = proto_buffer(tx_obj);
+    const proto_tx_t *proto = &tx_obj->proto;
+    const bool expert = tx_is_expert_mode(tx_obj);
+    walk->count = 0;
+
+    if (expert) {
+        WALK_VISIT(walk, root_item_chain_id, NULL,
+                   find_field_def(sign_doc_fields, array_length(sign_doc_fields), SIGN_DOC_CHAIN_ID), proto->sign_doc)
+        WALK_VISIT(walk, root_item_account_number, NULL,
+                   find_field_def(sign_doc_fields, array_length(sign_doc_fields), SIGN_DOC_ACCOUNT_NUMBER), proto->sign_doc)
+        WALK_VISIT(walk, root_item_sequence, NULL,
+                   find_field_def(signer_info_fields, array_length(signer_info_fields), SIGNER_INFO_SEQUENCE), proto->signer)
+    }
+
+    proto_reader_t reader;
+    proto_reader_init(&reader, buffer, proto->body);
+    proto_field_t field;
+    parser_error_t err;
+    int32_t msgIdx = 0;
+    while ((err = proto_next_field(&reader, &field)) == parser_ok) {
+        if (field.number != TX_BODY_MESSAGES) {
+            continue;
+        }
+        const proto_msg_def_t *msg = NULL;
+        proto_slice_t value;
+        CHECK_PARSER_ERR(read_any(buffer, field.bytes, &msg, &value))
+
+        if (!tx_obj->flags.msg_type_grouping || msgIdx == 0) {
+            WALK_VISIT(walk, root_item_msgs, msg, NULL, value)
+        }
+        for (uint8_t i = 0; i < msg->num_fields; i++) {
+            const bool skipFromField =
+                    tx_obj->flags.msg_from_grouping &&
+                    is_from_field(&msg->fields[i]) &&
+                    (tx_obj->flags.msg_from_grouping_hide_all || tx_obj->filter_msg_from_valid_idx != msgIdx);
+            if (!skipFromField) {
+                WALK_VISIT(walk, root_item_msgs, msg, &msg->fields[i], value)
+            }
+        }
+        msgIdx++;
+    }
+    if (err != parser_no_data) {
+        return err;
+    }
+
+    proto_slice_t memo;
+    CHECK_PARSER_ERR(get_string_field(buffer, proto->body, TX_BODY_MEMO, &memo))
+    if (memo.len > 0) {
+        WALK_VISIT(walk, root_item_memo, NULL,
+                   find_field_def(tx_body_fields, array_length(tx_body_fields), TX_BODY_MEMO), proto->body)
+    }
+
+    // Only the amount unless in expert mode
+    const uint8_t feeItems = expert ? array_length(fee_fields) : 1;
+    for (uint8_t i = 0; i < feeItems; i++) {
+        if (fee_fields[i].omit_empty) {
+            proto_slice_t value;
+            CHECK_PARSER_ERR(get_string_field(buffer, proto->fee, fee_fields[i].number, &value))
+            if (value.len == 0) {
+                continue;
+            }
+        }
+        WALK_VISIT(walk, root_item_fee, NULL, &fee_fields[i], proto->fee)
+    }
+
+    if (proto->has_tip) {
+        for (uint8_t i = 0; i < array_length(tip_fields); i++) {
+            WALK_VISIT(walk, root_item_tip, NULL, &tip_fields[i], proto->tip)
+        }
+    }
+
+    return parser_no_data;
+}
+
+__Z_INLINE parser_error_t find_item(parser_tx_t *tx_obj, uint16_t displayIdx, proto_item_t *item) {
+    proto_walk_t walk = {.wanted = displayIdx, .count = 0, .item = item};
+    const parser_error_t err = proto_walk(tx_obj, &walk);
+    return err == parser_no_data ? parser_display_idx_out_of_range : err;
+}
+
+parser_error_t tx_proto_numItems(parser_tx_t *tx_obj, uint8_t *num_items) {
+    *num_items = 0;
+
+    proto_item_t item;
+    proto_walk_t walk = {.wanted = WALK_COUNT_ONLY, .count = 0, .item = &item};
+    const parser_error_t err = proto_walk(tx_obj, &walk);
+    if (err != parser_no_data) {
+        return err == parser_ok ? parser_unexpected_number_items : err;
+    }
+    if (walk.count > UINT8_MAX) {
+        return parser_unexpected_number_items;
+    }
+
+    *num_items = (uint8_t) walk.count;
+    return parser_ok;
+}
+
+parser_error_t tx_proto_query(parser_tx_t *tx_obj, uint16_t displayIdx,
+                              char *outKey, uint16_t outKeyLen) {
+    MEMZERO(outKey, outKeyLen);
+    tx_obj->query.out_key = outKey;
+    tx_obj->query.out_key_len = outKeyLen;
+
+    proto_item_t item;
+    CHECK_PARSER_ERR(find_item(tx_obj, displayIdx, &item))
+
+    const char *root = get_required_root_item(item.root);
+    switch (item.root) {
+        case root_item_msgs:
+            if (item.field == NULL) {
+                snprintf(outKey, outKeyLen, "%s/type", root);
+            } else {
+                snprintf(outKey, outKeyLen, "%s/value/%s", root, item.field->name);
+            }
+            break;
+        case root_item_fee:
+        case root_item_tip:
+            snprintf(outKey, outKeyLen, "%s/%s", root, item.field->name);
+            break;
+        default:
+            snprintf(outKey, outKeyLen, "%s", root);
+            break;
+    }
+
+    return parser_ok;
+}
+
+__Z_INLINE parser_error_t render_text(const char *text,
+                                      char *outVal, uint16_t outValLen,
+                                      uint8_t pageIdx, uint8_t *pageCount) {
+    return tx_getString(text, strlen(text), outVal, outValLen, pageIdx, pageCount);
+}
+
+__Z_INLINE parser_error_t render_coin(parser_tx_t *tx_obj, proto_slice_t coin,
+                                      char *outVal, uint16_t outValLen,
+                                      uint8_t pageIdx, uint8_t *pageCount) {
+    const uint8_t *buffer = proto_buffer(tx_obj);
+    proto_slice_t denom;
+    proto_slice_t amount;
+    CHECK_PARSER_ERR(get_string_field(buffer, coin, PROTO_COIN_DENOM, &denom))
+    CHECK_PARSER_ERR(get_string_field(buffer, coin, PROTO_COIN_AMOUNT, &amount))
+    return parser_formatCoin(tx_obj,
+                             (const char *) buffer + amount.offset, amount.len,
+                             (const char *) buffer + denom.offset, denom.len,
+                             outVal, outValLen, pageIdx, pageCount);
+}
+
+// All the coins of a repeated field, one after the other (see parser_formatAmount)
+__Z_INLINE parser_error_t render_coins(parser_tx_t *tx_obj, proto_slice_t message, uint32_t number,
+                                       char *outVal, uint16_t outValLen,
+                                       uint8_t pageIdx, uint8_t *pageCount) {
+    uint16_t totalPages = 0;
+    bool showCoinSet = false;
+    uint8_t showPageIdx = pageIdx;
+    proto_slice_t showCoin = {0};
+
+    proto_reader_t reader;
+    proto_reader_init(&reader, proto_buffer(tx_obj), message);
+    proto_field_t field;
+    parser_error_t err;
+    while ((err = proto_next_field(&reader, &field)) == parser_ok) {
+        if (field.number != number) {
+            continue;
+        }
+        uint8_t coinPages = 0;
+        CHECK_PARSER_ERR(render_coin(tx_obj, field.bytes, NULL, outValLen, 0, &coinPages))
+        totalPages += coinPages;
+        if (!showCoinSet) {
+            if (showPageIdx < coinPages) {
+                showCoinSet = true;
+                showCoin = field.bytes;
+            } else {
+                showPageIdx -= coinPages;
+            }
+        }
+    }
+    if (err != parser_no_data) {
+        return err;
+    }
+    if (totalPages > UINT8_MAX) {
+        return parser_value_out_of_range;
+    }
+
+    if (totalPages == 0) {
+        return render_text("Empty", outVal, outValLen, pageIdx, pageCount);
+    }
+
+    *pageCount = (uint8_t) totalPages;
+    if (pageIdx >= *pageCount) {
+        return parser_display_page_out_of_range;
+    }
+    if (outVal == NULL) {
+        return parser_ok;
+    }
+
+    uint8_t dummy;
+    return render_coin(tx_obj, showCoin, outVal, outValLen, showPageIdx, &dummy);
+}
+
+parser_error_t tx_proto_getValue(parser_tx_t *tx_obj, uint16_t displayIdx,
+                                 char *outVal, uint16_t outValLen,
+                                 uint8_t pageIdx, uint8_t *pageCount) {
+    *pageCount = 0;
+    if (outVal != NULL) {
+        MEMZERO(outVal, outValLen);
+    }
+
+    proto_item_t item;
+    CHECK_PARSER_ERR(find_item(tx_obj, displayIdx, &item))
+
+    if (item.field == NULL) {
+        // msgs/type, as the Amino JSON type
+        return render_text(item.msg->amino_type, outVal, outValLen, pageIdx, pageCount);
+    }
+
+    const uint8_t *buffer = proto_buffer(tx_obj);
+    proto_field_t field;
+    parser_error_t err = proto_find_field(buffer, item.message, item.field->number, &field);
+    if (err != parser_ok && err != parser_no_data) {
+        return err;
+    }
+    const bool found = err == parser_ok;
+
+    switch (item.field->kind) {
+        case proto_kind_string:
+            if (!found) {
+                return render_text("", outVal, outValLen, pageIdx, pageCount);
+            }
+            return tx_getString((const char *) buffer + field.bytes.offset, field.bytes.len,
+                                outVal, outValLen, pageIdx, pageCount);
+        case proto_kind_uint: {
+            char number[21];
+            if (uint64_to_str(number, sizeof(number), found ? field.varint : 0) != NULL) {
+                return parser_unexpected_value;
+            }
+            return render_text(number, outVal, outValLen, pageIdx, pageCount);
+        }
+        case proto_kind_coin:
+            if (!found) {
+                return render_text("Empty", outVal, outValLen, pageIdx, pageCount);
+            }
+            return render_coin(tx_obj, field.bytes, outVal, outValLen, pageIdx, pageCount);
+        case proto_kind_coins:
+            return render_coins(tx_obj, item.message, item.field->number, outVal, outValLen, pageIdx, pageCount);
+        default:
+            return parser_unexpected_type;
+    }
+}
@@ -0,0 +1,57 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <common/parser_common.h>
+#include "parser_txdef.h"
+
+// Protobuf SignDoc (SIGN_MODE_DIRECT) support.
+// Nothing is tokenized: the payload is validated once, then items are decoded from it again
+// whenever they are shown. They have the same keys, values and hiding rules as the items of the
+// equivalent Amino JSON sign doc, so the review looks the same in both formats
+
+/// Validates a SignDoc and locates its sections. Only the messages that have an Amino
+/// equivalent shown by the app are accepted, with a single signer
+/// \param ctx
+/// \param data
+/// \param dataLen
+/// \return parser_unexpected_type for other messages, parser_unexpected_field for fields that
+///         would not be shown (extension options, etc.)
+parser_error_t tx_proto_readTx(parser_context_t *ctx, const uint8_t *data, size_t dataLen);
+
+/// Finds the chain and message grouping (see tx_indexRootFields)
+parser_error_t tx_proto_index(parser_tx_t *tx_obj);
+
+parser_error_t tx_proto_numItems(parser_tx_t *tx_obj, uint8_t *num_items);
+
+/// Key of an item, before tx_display_make_friendly
+parser_error_t tx_proto_query(parser_tx_t *tx_obj, uint16_t displayIdx,
+                              char *outKey, uint16_t outKeyLen);
+
+/// Value of an item. When outVal is NULL, only the page count is calculated
+parser_error_t tx_proto_getValue(parser_tx_t *tx_obj, uint16_t displayIdx,
+                                 char *outVal, uint16_t outValLen,
+                                 uint8_t pageIdx, uint8_t *pageCount);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,485 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "tx_schema.h"
+#include <jsmn.h>
+#include <zxmacros.h>
+
+#define SCHEMA_REQUIRED     1u
+#define SCHEMA_OPTIONAL     0u
+
+typedef struct {
+    char key[24];
+    uint8_t type;
+    uint8_t required;
+} schema_field_t;
+
+typedef struct {
+    char msg_type[44];
+    uint8_t first_field;
+    uint8_t num_fields;
+} schema_msg_t;
+
+// Fields of each message are listed in key order, so they can be merged
+// against the (already sorted) keys of the message value.
+// Only fields present in every known variant of a message are required;
+// unknown fields are left to the generic display.
+static const schema_field_t schema_fields[] = {
+        // 0: cosmos-sdk/MsgSend
+        {"amount", schema_coins, SCHEMA_REQUIRED},
+        {"from_address", schema_string, SCHEMA_REQUIRED},
+        {"to_address", schema_string, SCHEMA_REQUIRED},
+        // 3: cosmos-sdk/MsgDelegate, cosmos-sdk/MsgUndelegate
+        {"amount", schema_coin, SCHEMA_OPTIONAL},
+        {"delegator_address", schema_string, SCHEMA_REQUIRED},
+        {"validator_address", schema_string, SCHEMA_REQUIRED},
+        // 6: cosmos-sdk/MsgBeginRedelegate
+        {"amount", schema_coin, SCHEMA_OPTIONAL},
+        {"delegator_address", schema_string, SCHEMA_REQUIRED},
+        {"validator_dst_address", schema_string, SCHEMA_REQUIRED},
+        {"validator_src_address", schema_string, SCHEMA_REQUIRED},
+        // 10: cosmos-sdk/MsgSubmitProposal
+        {"content", schema_object, SCHEMA_OPTIONAL},
+        {"initial_deposit", schema_coins, SCHEMA_OPTIONAL},
+        {"proposer", schema_string, SCHEMA_REQUIRED},
+        // 13: cosmos-sdk/MsgDeposit
+        {"amount", schema_coins, SCHEMA_OPTIONAL},
+        {"depositor", schema_string, SCHEMA_REQUIRED},
+        {"proposal_id", schema_scalar, SCHEMA_REQUIRED},
+        // 16: cosmos-sdk/MsgVote
+        {"option", schema_scalar, SCHEMA_REQUIRED},
+        {"proposal_id", schema_scalar, SCHEMA_REQUIRED},
+        {"voter", schema_string, SCHEMA_REQUIRED},
+        // 19: cosmos-sdk/MsgWithdrawDelegationReward
+        {"delegator_address", schema_string, SCHEMA_REQUIRED},
+        {"validator_address", schema_string, SCHEMA_REQUIRED},
+        // 21: cosmos-sdk/MsgWithdrawValidatorCommission
+        {"validator_address", schema_string, SCHEMA_REQUIRED},
+        // 22: cosmos-sdk/MsgTransfer
+        {"receiver", schema_string, SCHEMA_REQUIRED},
+        {"sender", schema_string, SCHEMA_REQUIRED},
+        {"source_channel", schema_string, SCHEMA_REQUIRED},
+        {"source_port", schema_string, SCHEMA_REQUIRED},
+        {"timeout_height", schema_object, SCHEMA_OPTIONAL},
+        {"timeout_timestamp", schema_scalar, SCHEMA_OPTIONAL},
+        {"token", schema_coin, SCHEMA_REQUIRED},
+        // 29: cosmos-sdk/MsgGrant
+        {"grant", schema_object, SCHEMA_REQUIRED},
+        {"grantee", schema_string, SCHEMA_REQUIRED},
+        {"granter", schema_string, SCHEMA_REQUIRED},
+        // 32: wasm/MsgExecuteContract
+        {"callback_code_hash", schema_string, SCHEMA_OPTIONAL},
+        {"contract", schema_string, SCHEMA_REQUIRED},
+        {"msg", schema_string, SCHEMA_REQUIRED},
+        {"sender", schema_string, SCHEMA_REQUIRED},
+        {"sent_funds", schema_coins, SCHEMA_OPTIONAL},
+        // 37: query_permit
+        {"allowed_tokens", schema_strings, SCHEMA_REQUIRED},
+        {"permissions", schema_strings, SCHEMA_REQUIRED},
+        {"permit_name", schema_string, SCHEMA_REQUIRED},
+        // 40: sign/MsgSignData
+        {"data", schema_string, SCHEMA_REQUIRED},
+        {"signer", schema_string, SCHEMA_REQUIRED},
+};
+
+static const schema_msg_t schema_msgs[] = {
+        {"cosmos-sdk/MsgSend", 0, 3},
+        {"cosmos-sdk/MsgDelegate", 3, 3},
+        {"cosmos-sdk/MsgUndelegate", 3, 3},
+        {"cosmos-sdk/MsgBeginRedelegate", 6, 4},
+        {"cosmos-sdk/MsgSubmitProposal", 10, 3},
+        {"cosmos-sdk/MsgDeposit", 13, 3},
+        {"cosmos-sdk/MsgVote", 16, 3},
+        {"cosmos-sdk/MsgWithdrawDelegationReward", 19, 2},
+        {"cosmos-sdk/MsgWithdrawValidatorCommission", 21, 1},
+        {"cosmos-sdk/MsgTransfer", 22, 7},
+        {"cosmos-sdk/MsgGrant", 29, 3},
+        {"wasm/MsgExecuteContract", 32, 5},
+        {"query_permit", 37, 3},
+        {"sign/MsgSignData", 40, 2},
+};
+
+#if JSON_TOKEN_ENGINE
+// Compares a token against a C string, following strcmp ordering
+__Z_INLINE int8_t compare_token(const parsed_json_t *json, uint16_t idx, const char *s) {
+    const jsmntok_t *token = &json->tokens[idx];
+    const size_t token_len = token->end - token->start;
+    const size_t s_len = strlen(s);
+    const size_t common_len = token_len < s_len ? token_len : s_len;
+
+    const int cmp = MEMCMP(json->buffer + token->start, s, common_len);
+    if (cmp != 0) {
+        return cmp < 0 ? -1 : 1;
+    }
+    if (token_len == s_len) {
+        return 0;
+    }
+    return token_len < s_len ? -1 : 1;
+}
+
+__Z_INLINE bool is_null(const parsed_json_t *json, uint16_t idx) {
+    return json->tokens[idx].type == JSMN_PRIMITIVE && compare_token(json, idx, "null") == 0;
+}
+
+static parser_error_t validate_coin(const parsed_json_t *json, uint16_t idx) {
+    const jsmntok_t *token = &json->tokens[idx];
+    if (token->type != JSMN_OBJECT) {
+        return parser_unexpected_type;
+    }
+    // Same shape parser_formatAmountItem expects
+    if (token->size != 2 || idx + 4 >= json->numberOfTokens ||
+        compare_token(json, idx + 1, "amount") != 0 ||
+        compare_token(json, idx + 3, "denom") != 0) {
+        return parser_unexpected_field;
+    }
+    if (json->tokens[idx + 2].type != JSMN_STRING || json->tokens[idx + 4].type != JSMN_STRING) {
+        return parser_unexpected_type;
+    }
+    return parser_ok;
+}
+
+static parser_error_t validate_value(const parsed_json_t *json, uint16_t idx, uint8_t type) {
+    const jsmntok_t *token = &json->tokens[idx];
+    switch (type) {
+        case schema_string:
+            return token->type == JSMN_STRING ? parser_ok : parser_unexpected_type;
+        case schema_scalar:
+            return token->type == JSMN_STRING || token->type == JSMN_PRIMITIVE ? parser_ok : parser_unexpected_type;
+        case schema_object:
+            return token->type == JSMN_OBJECT ? parser_ok : parser_unexpected_type;
+        case schema_coin:
+            return validate_coin(json, idx);
+        case schema_strings:
+        case schema_coins: {
+            if (token->type != JSMN_ARRAY) {
+                return parser_unexpected_type;
+            }
+            uint16_t element = idx + 1;
+            for (int i = 0; i < token->size; i++) {
+                if (element >= json->numberOfTokens) {
+                    return parser_unexpected_buffer_end;
+                }
+                if (type == schema_coins) {
+                    CHECK_PARSER_ERR(validate_coin(json, element))
+                } else if (json->tokens[element].type != JSMN_STRING) {
+                    return parser_unexpected_type;
+                }
+                element = json_next_sibling(json, element);
+            }
+            return parser_ok;
+        }
+        default:
+            return parser_unexpected_error;
+    }
+}
+
+static parser_error_t validate_fields(const parsed_json_t *json, uint16_t value_idx, const schema_msg_t *schema) {
+    const schema_field_t *fields = &schema_fields[schema->first_field];
+    uint8_t field_idx = 0;
+
+    const jsmntok_t *value_token = &json->tokens[value_idx];
+    uint16_t key_idx = value_idx + 1;
+    for (int i = 0; i < value_token->size; i++) {
+        if (key_idx + 1 >= json->numberOfTokens) {
+            return parser_unexpected_buffer_end;
+        }
+
+        int8_t cmp = 1;
+        while (field_idx < schema->num_fields) {
+            cmp = compare_token(json, key_idx, fields[field_idx].key);
+            if (cmp <= 0) {
+                break;
+            }
+            if (fields[field_idx].required == SCHEMA_REQUIRED) {
+                return parser_missing_field;
+            }
+            field_idx++;
+        }
+
+        const uint16_t element_idx = key_idx + 1;
+        if (field_idx < schema->num_fields && cmp == 0) {
+            const bool skip = fields[field_idx].required == SCHEMA_OPTIONAL && is_null(json, element_idx);
+            if (!skip) {
+                CHECK_PARSER_ERR(validate_value(json, element_idx, fields[field_idx].type))
+            }
+            field_idx++;
+        }
+        key_idx = json_next_sibling(json, element_idx);
+    }
+
+    for (; field_idx < schema->num_fields; field_idx++) {
+        if (fields[field_idx].required == SCHEMA_REQUIRED) {
+            return parser_missing_field;
+        }
+    }
+    return parser_ok;
+}
+
+static const schema_msg_t *find_schema(const parsed_json_t *json, uint16_t type_idx) {
+    for (size_t i = 0; i < array_length(schema_msgs); i++) {
+        if (compare_token(json, type_idx, schema_msgs[i].msg_type) == 0) {
+            return &schema_msgs[i];
+        }
+    }
+    return NULL;
+}
+
+bool tx_schema_is_known_msg(const parsed_json_t *json, uint16_t type_token_index) {
+    return find_schema(json, type_token_index) != NULL;
+}
+
+static parser_error_t validate_msg(const parsed_json_t *json, uint16_t msg_idx) {
+    const jsmntok_t *msg_token = &json->tokens[msg_idx];
+    if (msg_token->type != JSMN_OBJECT) {
+        return parser_ok;
+    }
+
+    uint16_t type_idx = 0;
+    uint16_t value_idx = 0;
+    uint16_t key_idx = msg_idx + 1;
+    for (int i = 0; i < msg_token->size; i++) {
+        if (key_idx + 1 >= json->numberOfTokens) {
+            return parser_unexpected_buffer_end;
+        }
+        if (compare_token(json, key_idx, "type") == 0) {
+            type_idx = key_idx + 1;
+        } else if (compare_token(json, key_idx, "value") == 0) {
+            value_idx = key_idx + 1;
+        }
+        key_idx = json_next_sibling(json, key_idx + 1);
+    }
+
+    if (type_idx == 0 || json->tokens[type_idx].type != JSMN_STRING) {
+        // Untyped messages are shown as generic json
+        return parser_ok;
+    }
+
+    const schema_msg_t *schema = find_schema(json, type_idx);
+    if (schema == NULL) {
+        return parser_ok;
+    }
+    if (value_idx == 0) {
+        return parser_missing_field;
+    }
+    if (json->tokens[value_idx].type != JSMN_OBJECT) {
+        return parser_unexpected_type;
+    }
+    return validate_fields(json, value_idx, schema);
+}
+
+parser_error_t tx_schema_validate_msgs(const parsed_json_t *json, uint16_t msgs_token_index) {
+    if (msgs_token_index >= json->numberOfTokens) {
+        return parser_unexpected_buffer_end;
+    }
+    const jsmntok_t *msgs_token = &json->tokens[msgs_token_index];
+    if (msgs_token->type != JSMN_ARRAY) {
+        return parser_ok;
+    }
+
+    uint16_t msg_idx = msgs_token_index + 1;
+    for (int i = 0; i < msgs_token->size; i++) {
+        if (msg_idx >= json->numberOfTokens) {
+            return parser_unexpected_buffer_end;
+        }
+        CHECK_PARSER_ERR(validate_msg(json, msg_idx))
+        msg_idx = json_next_sibling(json, msg_idx);
+    }
+    return parser_ok;
+}
+#endif
+
+// Same checks for the streaming engine, values are offsets in the buffer
+
+__Z_INLINE bool stream_is_null(const json_stream_t *json, const json_event_t *value) {
+    return value->type == JSMN_PRIMITIVE && json_stream_compare(json, value, "null") == 0;
+}
+
+static parser_error_t validate_coin_stream(const json_stream_t *json, uint16_t offset) {
+    json_event_t token;
+    CHECK_PARSER_ERR(json_stream_value(json, offset, &token))
+    if (token.type != JSMN_OBJECT) {
+        return parser_unexpected_type;
+    }
+
+    // Same shape parser_formatAmountItem expects
+    uint16_t count;
+    CHECK_PARSER_ERR(json_stream_element_count(json, offset, &count))
+    if (count != 4) {
+        return parser_unexpected_field;
+    }
+
+    json_event_t tokens[4];
+    for (uint8_t i = 0; i < 4; i++) {
+        CHECK_PARSER_ERR(json_stream_token(json, offset, i + 1, &tokens[i]))
+    }
+    if (json_stream_compare(json, &tokens[0], "amount") != 0 ||
+        json_stream_compare(json, &tokens[2], "denom") != 0) {
+        return parser_unexpected_field;
+    }
+    if (tokens[1].type != JSMN_STRING || tokens[3].type != JSMN_STRING) {
+        return parser_unexpected_type;
+    }
+    return parser_ok;
+}
+
+static parser_error_t validate_value_stream(const json_stream_t *json, const json_event_t *value, uint8_t type) {
+    switch (type) {
+        case schema_string:
+            return value->type == JSMN_STRING ? parser_ok : parser_unexpected_type;
+        case schema_scalar:
+            return value->type == JSMN_STRING || value->type == JSMN_PRIMITIVE ? parser_ok : parser_unexpected_type;
+        case schema_object:
+            return value->type == JSMN_OBJECT ? parser_ok : parser_unexpected_type;
+        case schema_coin:
+            return validate_coin_stream(json, value->offset);
+        case schema_strings:
+        case schema_coins: {
+            if (value->type != JSMN_ARRAY) {
+                return parser_unexpected_type;
+            }
+            json_cursor_t cursor;
+            json_event_t element;
+            json_stream_cursor(&cursor, value->offset);
+            CHECK_PARSER_ERR(json_stream_next(json, &cursor, &element))
+
+            parser_error_t err;
+            while ((err = json_stream_next_child(json, &cursor, &element)) == parser_ok) {
+                if (type == schema_coins) {
+                    CHECK_PARSER_ERR(validate_coin_stream(json, element.offset))
+                } else if (element.type != JSMN_STRING) {
+                    return parser_unexpected_type;
+                }
+            }
+            return err == parser_no_data ? parser_ok : err;
+        }
+        default:
+            return parser_unexpected_error;
+    }
+}
+
+static parser_error_t validate_fields_stream(const json_stream_t *json, uint16_t value_offset, const schema_msg_t *schema) {
+    const schema_field_t *fields = &schema_fields[schema->first_field];
+    uint8_t field_idx = 0;
+
+    json_cursor_t cursor;
+    json_event_t key;
+    json_event_t value;
+    json_stream_cursor(&cursor, value_offset);
+    CHECK_PARSER_ERR(json_stream_next(json, &cursor, &key))
+
+    parser_error_t err;
+    while ((err = json_stream_next_child(json, &cursor, &key)) == parser_ok) {
+        CHECK_PARSER_ERR(json_stream_next_child(json, &cursor, &value))
+
+        int8_t cmp = 1;
+        while (field_idx < schema->num_fields) {
+            cmp = json_stream_compare(json, &key, fields[field_idx].key);
+            if (cmp <= 0) {
+                break;
+            }
+            if (fields[field_idx].required == SCHEMA_REQUIRED) {
+                return parser_missing_field;
+            }
+            field_idx++;
+        }
+
+        if (field_idx < schema->num_fields && cmp == 0) {
+            const bool skip = fields[field_idx].required == SCHEMA_OPTIONAL && stream_is_null(json, &value);
+            if (!skip) {
+                CHECK_PARSER_ERR(validate_value_stream(json, &value, fields[field_idx].type))
+            }
+            field_idx++;
+        }
+    }
+    if (err != parser_no_data) {
+        return err;
+    }
+
+    for (; field_idx < schema->num_fields; field_idx++) {
+        if (fields[field_idx].required == SCHEMA_REQUIRED) {
+            return parser_missing_field;
+        }
+    }
+    return parser_ok;
+}
+
+static parser_error_t validate_msg_stream(const json_stream_t *json, uint16_t msg_offset) {
+    json_cursor_t cursor;
+    json_event_t key;
+    json_event_t value;
+    json_stream_cursor(&cursor, msg_offset);
+    CHECK_PARSER_ERR(json_stream_next(json, &cursor, &key))
+    if (key.kind != json_event_open || key.type != JSMN_OBJECT) {
+        return parser_ok;
+    }
+
+    json_event_t type;
+    json_event_t msg_value;
+    bool has_type = false;
+    bool has_value = false;
+    parser_error_t err;
+    while ((err = json_stream_next_child(json, &cursor, &key)) == parser_ok) {
+        CHECK_PARSER_ERR(json_stream_next_child(json, &cursor, &value))
+        if (json_stream_compare(json, &key, "type") == 0) {
+            type = value;
+            has_type = true;
+        } else if (json_stream_compare(json, &key, "value") == 0) {
+            msg_value = value;
+            has_value = true;
+        }
+    }
+    if (err != parser_no_data) {
+        return err;
+    }
+
+    if (!has_type || type.type != JSMN_STRING) {
+        // Untyped messages are shown as generic json
+        return parser_ok;
+    }
+
+    const schema_msg_t *schema = NULL;
+    for (size_t i = 0; i < array_length(schema_msgs) && schema == NULL; i++) {
+        if (json_stream_compare(json, &type, schema_msgs[i].msg_type) == 0) {
+            schema = &schema_msgs[i];
+        }
+    }
+    if (schema == NULL) {
+        return parser_ok;
+    }
+    if (!has_value) {
+        return parser_missing_field;
+    }
+    if (msg_value.type != JSMN_OBJECT) {
+        return parser_unexpected_type;
+    }
+    return validate_fields_stream(json, msg_value.offset, schema);
+}
+
+parser_error_t tx_schema_validate_msgs_stream(const json_stream_t *json, uint16_t msgs_offset) {
+    json_cursor_t cursor;
+    json_event_t msg;
+    json_stream_cursor(&cursor, msgs_offset);
+    CHECK_PARSER_ERR(json_stream_next(json, &cursor, &msg))
+    if (msg.kind != json_event_open || msg.type != JSMN_ARRAY) {
+        return parser_ok;
+    }
+
+    parser_error_t err;
+    while ((err = json_stream_next_child(json, &cursor, &msg)) == parser_ok) {
+        CHECK_PARSER_ERR(validate_msg_stream(json, msg.offset))
+    }
+    return err == parser_no_data ? parser_ok : err;
+}
@@ -0,0 +1,57 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#pragma once
+
+#include "json/json_parser.h"
+#include "json/json_stream.h"
+#include <stdint.h>
+#include <common/parser_common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    schema_string = 0,      // "..."
+    schema_scalar,          // "..." or number/bool
+    schema_object,          // {...}
+    schema_strings,         // ["...", ...]
+    schema_coin,            // {"amount":"...","denom":"..."}
+    schema_coins,           // [coin, ...]
+} schema_type_e;
+
+#if JSON_TOKEN_ENGINE
+/// Checks the value of every message with a known type against its schema
+/// Keys are expected to be sorted (see tx_validate), so each message is checked in a single pass
+/// \param json
+/// \param msgs_token_index: token index of the msgs array
+/// \return parser_missing_field, parser_unexpected_type or parser_unexpected_field on mismatch
+parser_error_t tx_schema_validate_msgs(const parsed_json_t *json, uint16_t msgs_token_index);
+
+/// Indicates that a message type has a schema, so its value only holds the known fields
+/// \param json
+/// \param type_token_index: token index of the msg type string
+bool tx_schema_is_known_msg(const parsed_json_t *json, uint16_t type_token_index);
+#endif
+
+/// Same as tx_schema_validate_msgs, for the streaming engine
+/// \param msgs_offset: offset of the msgs array
+parser_error_t tx_schema_validate_msgs_stream(const json_stream_t *json, uint16_t msgs_offset);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,192 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "tx_stream.h"
+#include "tx_parser.h"
+#include <zxmacros.h>
+
+#define STREAM_CHECKPOINT_KEYS  (sizeof(((stream_checkpoint_t *) 0)->key_offset) / sizeof(uint16_t))
+
+// Walk state. The recursion of tx_traverse_find is replaced by the containers the cursor is in
+typedef struct {
+    json_cursor_t cursor;
+    // out_key length when each container was opened
+    uint16_t key_len[MAX_RECURSION_DEPTH + 1];
+    // key being read in each object, outermost first
+    uint16_t key_offset[STREAM_CHECKPOINT_KEYS];
+} stream_walk_t;
+
+// Number of objects among the first `depth` containers
+__Z_INLINE uint8_t count_objects(const json_cursor_t *cursor, uint8_t depth) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < depth; i++) {
+        if ((cursor->arrayMask & (1u << i)) == 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+__Z_INLINE parser_error_t append_key(parser_tx_t *tx_obj, uint16_t key_offset) {
+    json_event_t key;
+    CHECK_PARSER_ERR(json_stream_value(&tx_obj->stream, key_offset, &key))
+    tx_appendKey(tx_obj, tx_obj->tx + key.start, key.end - key.start);
+    return parser_ok;
+}
+
+void tx_stream_clearCheckpoints(parser_tx_t *tx_obj) {
+    if (tx_obj->display != NULL) {
+        MEMZERO(tx_obj->display->stream_checkpoint, sizeof(tx_obj->display->stream_checkpoint));
+    }
+}
+
+// Saves the position of the leaf about to be read from `before`
+__Z_INLINE void save_checkpoint(parser_tx_t *tx_obj, uint8_t slot, uint16_t root_offset,
+                                const stream_walk_t *walk, const json_cursor_t *before, uint16_t target) {
+    if (tx_obj->display == NULL || count_objects(before, before->depth) > STREAM_CHECKPOINT_KEYS) {
+        return;
+    }
+
+    stream_checkpoint_t *checkpoint = &tx_obj->display->stream_checkpoint[slot];
+    checkpoint->root_offset = root_offset;
+    checkpoint->leaf_index = tx_obj->query._item_index_current;
+    checkpoint->skipped = tx_obj->query.item_index - target;
+    MEMCPY(checkpoint->key_offset, walk->key_offset, sizeof(checkpoint->key_offset));
+    checkpoint->offset = before->offset;
+    checkpoint->depth = before->depth;
+    checkpoint->array_mask = (uint8_t) before->arrayMask;
+    checkpoint->expect = before->expect;
+}
+
+// Continues from the closest checkpoint before the item, if any
+static parser_error_t resume(parser_tx_t *tx_obj, uint16_t root_offset, stream_walk_t *walk,
+                             uint16_t base_len, uint16_t target) {
+    if (tx_obj->display == NULL) {
+        return parser_ok;
+    }
+
+    const stream_checkpoint_t *best = NULL;
+    for (uint8_t i = 0; i < STREAM_CHECKPOINT_COUNT; i++) {
+        const stream_checkpoint_t *checkpoint = &tx_obj->display->stream_checkpoint[i];
+        // Items before the leaf of the checkpoint must not include the one being looked for
+        if (checkpoint->root_offset != root_offset || checkpoint->leaf_index - checkpoint->skipped > target) {
+            continue;
+        }
+        if (best == NULL || checkpoint->leaf_index > best->leaf_index) {
+            best = checkpoint;
+        }
+    }
+    if (best == NULL) {
+        return parser_ok;
+    }
+
+    walk->cursor.offset = best->offset;
+    walk->cursor.depth = best->depth;
+    walk->cursor.arrayMask = best->array_mask;
+    walk->cursor.expect = best->expect;
+    MEMCPY(walk->key_offset, best->key_offset, sizeof(walk->key_offset));
+    tx_obj->query._item_index_current = best->leaf_index;
+    tx_obj->query.item_index = (int16_t) (target + best->skipped);
+
+    // Rebuild out_key, one key per object
+    tx_obj->query.out_key[base_len] = 0;
+    uint8_t objects = 0;
+    for (uint8_t depth = 1; depth <= best->depth; depth++) {
+        walk->key_len[depth] = strlen(tx_obj->query.out_key);
+        if ((best->array_mask & (1u << (depth - 1))) == 0) {
+            CHECK_PARSER_ERR(append_key(tx_obj, walk->key_offset[objects]))
+            objects++;
+        }
+    }
+
+    return parser_ok;
+}
+
+parser_error_t tx_stream_traverse_find(parser_tx_t *tx_obj, uint16_t root_offset, uint16_t *ret_value_offset) {
+    CHECK_APP_CANARY()
+
+    if (tx_obj->tx == NULL) {
+        return parser_no_data;
+    }
+
+    const json_stream_t *json = &tx_obj->stream;
+    const uint16_t target = tx_obj->query.item_index;
+
+    stream_walk_t walk;
+    MEMZERO(&walk, sizeof(walk));
+    json_stream_cursor(&walk.cursor, root_offset);
+    CHECK_PARSER_ERR(resume(tx_obj, root_offset, &walk, strlen(tx_obj->query.out_key), target))
+
+    while (true) {
+        const json_cursor_t before = walk.cursor;
+        json_event_t event;
+        parser_error_t err = json_stream_next(json, &walk.cursor, &event);
+        if (err == parser_no_data) {
+            return parser_query_no_results;
+        }
+        CHECK_PARSER_ERR(err)
+
+        // Containers the event is in
+        const uint8_t depth = before.depth;
+        const uint8_t objects = count_objects(&before, depth);
+
+        switch (event.kind) {
+            case json_event_key:
+                tx_obj->query.out_key[walk.key_len[depth]] = 0;
+                if (objects <= STREAM_CHECKPOINT_KEYS) {
+                    walk.key_offset[objects - 1] = event.offset;
+                }
+                tx_appendKey(tx_obj, tx_obj->tx + event.start, event.end - event.start);
+                continue;
+            case json_event_close:
+                if (event.type == JSMN_OBJECT) {
+                    tx_obj->query.out_key[walk.key_len[depth]] = 0;
+                }
+                continue;
+            default:
+                break;
+        }
+
+        // Same rules as tx_traverse_find: objects use a level and all containers use depth
+        const int16_t level = (int16_t) tx_obj->query.max_level - objects;
+        const int16_t budget = (int16_t) tx_obj->query.max_depth - depth;
+        if (event.kind == json_event_open && level > 0 && budget > 0 && depth < MAX_RECURSION_DEPTH) {
+            walk.key_len[depth + 1] = strlen(tx_obj->query.out_key);
+            continue;
+        }
+
+        // This is a leaf, containers are shown whole
+        CHECK_PARSER_ERR(json_stream_skip(json, &walk.cursor, &event))
+
+        if (tx_obj->query._item_index_current % STREAM_CHECKPOINT_INTERVAL == 0 &&
+            tx_obj->query._item_index_current > 0) {
+            const uint8_t slot = (tx_obj->query._item_index_current / STREAM_CHECKPOINT_INTERVAL) %
+                                 (STREAM_CHECKPOINT_COUNT - 1) + 1;
+            save_checkpoint(tx_obj, slot, root_offset, &walk, &before, target);
+        }
+
+        err = tx_traverse_leaf(tx_obj);
+        if (err == parser_ok) {
+            // Next items are usually looked for right after this one
+            save_checkpoint(tx_obj, 0, root_offset, &walk, &before, target);
+            *ret_value_offset = event.offset;
+            return parser_ok;
+        }
+        if (err != parser_query_no_results) {
+            return err;
+        }
+    }
+}
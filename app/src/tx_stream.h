@@ -0,0 +1,40 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#include <stdint.h>
+#include <common/parser_common.h>
+#include "parser_txdef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Streaming engine: items of Amino JSON payloads are found by reading the buffer again (see json_stream.h).
+// To keep seeks short, the display cache keeps the position of the last item found
+// and of every STREAM_CHECKPOINT_INTERVAL-th leaf, as long as they fit
+
+#define STREAM_CHECKPOINT_INTERVAL  8
+
+/// Same as tx_traverse_find, values are offsets in the buffer
+parser_error_t tx_stream_traverse_find(parser_tx_t *tx_obj, uint16_t root_offset, uint16_t *ret_value_offset);
+
+/// Drops all checkpoints. Needed whenever the grouping rules change
+void tx_stream_clearCheckpoints(parser_tx_t *tx_obj);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,211 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "tx_stream_check.h"
+#include <zxmacros.h>
+#include "json/json_parser.h"
+
+void tx_stream_check_init(tx_stream_check_t *ctx, uint32_t offset) {
+    MEMZERO(ctx, sizeof(*ctx));
+    ctx->offset = offset;
+    ctx->error = parser_ok;
+}
+
+// Same ordering as compare_keys in tx_validate.c, limited to the stored prefixes
+static parser_error_t check_root_key_order(const tx_stream_check_t *ctx) {
+    const uint8_t prevStored = ctx->prevKeyLen < STREAM_CHECK_KEY_LEN ? ctx->prevKeyLen : STREAM_CHECK_KEY_LEN;
+    const uint8_t keyStored = ctx->keyLen < STREAM_CHECK_KEY_LEN ? ctx->keyLen : STREAM_CHECK_KEY_LEN;
+    const uint8_t common = prevStored < keyStored ? prevStored : keyStored;
+
+    const int cmp = MEMCMP(ctx->prevKey, ctx->key, common);
+    if (cmp < 0) {
+        return parser_ok;
+    }
+    if (cmp > 0) {
+        return parser_json_is_not_sorted;
+    }
+
+    if (ctx->prevKeyLen > STREAM_CHECK_KEY_LEN || ctx->keyLen > STREAM_CHECK_KEY_LEN) {
+        // Undecided, tx_validate will tell
+        return parser_ok;
+    }
+    if (ctx->prevKeyLen == ctx->keyLen) {
+        return parser_duplicated_field;
+    }
+    return ctx->prevKeyLen < ctx->keyLen ? parser_ok : parser_json_is_not_sorted;
+}
+
+static parser_error_t check_string_byte(tx_stream_check_t *ctx, uint8_t c) {
+    if (ctx->escape) {
+        ctx->escape = 0;
+    } else if (c == '\\') {
+        ctx->escape = 1;
+    } else if (c == '"') {
+        ctx->inString = 0;
+        if (ctx->inRootKey) {
+            ctx->inRootKey = 0;
+            if (ctx->hasPrevKey) {
+                CHECK_PARSER_ERR(check_root_key_order(ctx))
+            }
+            MEMCPY(ctx->prevKey, ctx->key, sizeof(ctx->key));
+            ctx->prevKeyLen = ctx->keyLen;
+            ctx->hasPrevKey = 1;
+        }
+        return parser_ok;
+    }
+
+    if (ctx->inRootKey) {
+        if (ctx->keyLen < STREAM_CHECK_KEY_LEN) {
+            ctx->key[ctx->keyLen] = (char) c;
+        }
+        if (ctx->keyLen < 0xFF) {
+            ctx->keyLen++;
+        }
+    }
+    return parser_ok;
+}
+
+static parser_error_t count_token(tx_stream_check_t *ctx) {
+#if JSON_TOKEN_ENGINE
+    if (ctx->numTokens >= MAX_NUMBER_OF_TOKENS) {
+        return parser_json_too_many_tokens;
+    }
+#endif
+    ctx->numTokens++;
+    return parser_ok;
+}
+
+static parser_error_t check_byte(tx_stream_check_t *ctx, uint8_t c) {
+    if (ctx->rootClosed) {
+        // Anything after the root object is left to the parser
+        return parser_ok;
+    }
+
+    if (ctx->inString) {
+        return check_string_byte(ctx, c);
+    }
+
+    if (ctx->inPrimitive) {
+        switch (c) {
+            case ':':
+            case ',':
+            case ']':
+            case '}':
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                ctx->inPrimitive = 0;
+                break;
+            default:
+                if (c < 32 || c >= 127) {
+                    return parser_unexpected_characters;
+                }
+                return parser_ok;
+        }
+    }
+
+    if (ctx->depth == 0 && c != '{') {
+        // Sign docs are objects, leading whitespace included
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v'
+               ? parser_json_contains_whitespace
+               : parser_unexpected_characters;
+    }
+
+    switch (c) {
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+        case '\f':
+        case '\v':
+            return parser_json_contains_whitespace;
+
+        case '{':
+        case '[':
+            CHECK_PARSER_ERR(count_token(ctx))
+            if (ctx->depth >= STREAM_CHECK_MAX_DEPTH) {
+                return parser_json_too_deep;
+            }
+            if (c == '[') {
+                ctx->arrayMask |= (1u << ctx->depth);
+            } else {
+                ctx->arrayMask &= ~(1u << ctx->depth);
+            }
+            ctx->depth++;
+            if (ctx->depth == 1) {
+                ctx->rootExpectKey = 1;
+            }
+            return parser_ok;
+
+        case '}':
+        case ']': {
+            const bool isArray = (ctx->arrayMask & (1u << (ctx->depth - 1))) != 0;
+            if (isArray != (c == ']')) {
+                return parser_unexpected_characters;
+            }
+            ctx->depth--;
+            if (ctx->depth == 0) {
+                ctx->rootClosed = 1;
+            }
+            return parser_ok;
+        }
+
+        case '"':
+            CHECK_PARSER_ERR(count_token(ctx))
+            ctx->inString = 1;
+            if (ctx->depth == 1 && ctx->rootExpectKey) {
+                ctx->inRootKey = 1;
+                ctx->keyLen = 0;
+            }
+            return parser_ok;
+
+        case ':':
+            if (ctx->depth == 1) {
+                ctx->rootExpectKey = 0;
+            }
+            return parser_ok;
+
+        case ',':
+            if (ctx->depth == 1) {
+                ctx->rootExpectKey = 1;
+            }
+            return parser_ok;
+
+        default:
+            if (c < 32 || c >= 127) {
+                return parser_unexpected_characters;
+            }
+            CHECK_PARSER_ERR(count_token(ctx))
+            ctx->inPrimitive = 1;
+            return parser_ok;
+    }
+}
+
+parser_error_t tx_stream_check(tx_stream_check_t *ctx, tx_stream_check_read_fn read, uint32_t bufferLen) {
+    if (ctx->error != parser_ok) {
+        return ctx->error;
+    }
+
+    for (; ctx->offset < bufferLen; ctx->offset++) {
+        const parser_error_t err = check_byte(ctx, read(ctx->offset));
+        if (err != parser_ok) {
+            ctx->error = err;
+            return err;
+        }
+    }
+    return parser_ok;
+}
@@ -0,0 +1,68 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "common/parser_common.h"
+
+#define STREAM_CHECK_MAX_DEPTH      32u
+// Root keys longer than this are only compared by prefix
+#define STREAM_CHECK_KEY_LEN        24u
+
+typedef struct {
+    uint32_t offset;                // next byte to check, or offending byte after an error
+    parser_error_t error;
+
+    uint16_t numTokens;
+    uint8_t depth;
+    uint32_t arrayMask;             // bit n is set when the container at depth n + 1 is an array
+
+    uint8_t inString: 1;
+    uint8_t escape: 1;
+    uint8_t inPrimitive: 1;
+    uint8_t rootClosed: 1;
+    uint8_t rootExpectKey: 1;
+    uint8_t inRootKey: 1;
+    uint8_t hasPrevKey: 1;
+
+    uint8_t keyLen;
+    uint8_t prevKeyLen;
+    char key[STREAM_CHECK_KEY_LEN];
+    char prevKey[STREAM_CHECK_KEY_LEN];
+} tx_stream_check_t;
+
+/// Reads a byte of the transaction buffer
+typedef uint8_t (*tx_stream_check_read_fn)(uint32_t offset);
+
+/// Starts checking a transaction stored from offset on
+void tx_stream_check_init(tx_stream_check_t *ctx, uint32_t offset);
+
+/// Checks the bytes received since the last call, that is [ctx->offset..bufferLen)
+/// Rejects whitespace between tokens, too many tokens, too deep nesting and unsorted root keys,
+/// which would otherwise only be detected once the whole transaction has been received
+/// \param ctx
+/// \param read
+/// \param bufferLen
+/// \return parser_ok, or the error with ctx->offset pointing at the offending byte
+parser_error_t tx_stream_check(tx_stream_check_t *ctx, tx_stream_check_read_fn read, uint32_t bufferLen);
+
+#ifdef __cplusplus
+}
+#endif
@@ -18,6 +18,7 @@
 #include <common/parser_common.h>
 #include <zxmacros.h>
 #include "json/json_parser.h"
+#include "tx_schema.h"
 
 const char whitespaces[] = {
         0x20,// space ' '
@@ -37,6 +38,7 @@ int8_t is_space(char c) {
     return 0;
 }
 
+#if JSON_TOKEN_ENGINE
 int8_t contains_whitespace(parsed_json_t *json) {
     int start = 0;
     const int last_element_index = json->tokens[0].end;
@@ -63,68 +65,56 @@ int8_t contains_whitespace(parsed_json_t *json) {
     }
     return 0;
 }
+#endif
 
-int8_t is_sorted(uint16_t first_index,
-                 uint16_t second_index,
-                 parsed_json_t *json) {
-    char first[256];
-    char second[256];
-    MEMZERO(first, sizeof first);
-    MEMZERO(second, sizeof second);
+// Compares two keys in place, following strcmp ordering
+__Z_INLINE int8_t compare_bytes(const char *buffer, int32_t first_start, int32_t first_end,
+                                int32_t second_start, int32_t second_end) {
+    const int32_t first_len = first_end - first_start;
+    const int32_t second_len = second_end - second_start;
+    const int32_t common_len = first_len < second_len ? first_len : second_len;
 
-    size_t size = json->tokens[first_index].end - json->tokens[first_index].start;
-    if (size >= sizeof(first)) {
-        return 0;
+    const int cmp = MEMCMP(buffer + first_start, buffer + second_start, common_len);
+    if (cmp != 0) {
+        return cmp < 0 ? -1 : 1;
     }
-
-    strncpy(first, json->buffer + json->tokens[first_index].start, size);
-    first[size] = '\0';
-
-    size = json->tokens[second_index].end - json->tokens[second_index].start;
-    if (size >= sizeof(second)) return 0;
-
-    strncpy(second, json->buffer + json->tokens[second_index].start, size);
-    second[size] = '\0';
-
-    if (strcmp(first, second) <= 0) {
-        return 1;
+    if (first_len == second_len) {
+        return 0;
     }
-
-    return 0;
+    return first_len < second_len ? -1 : 1;
 }
 
-int8_t dictionaries_sorted(parsed_json_t *json) {
-    for (uint32_t i = 0; i < json->numberOfTokens; i++) {
-        if (json->tokens[i].type == JSMN_OBJECT) {
-
-            uint16_t count;
+#if JSON_TOKEN_ENGINE
+__Z_INLINE int8_t compare_keys(const parsed_json_t *json, const jsmntok_t *first, const jsmntok_t *second) {
+    return compare_bytes(json->buffer, first->start, first->end, second->start, second->end);
+}
 
-            if (object_get_element_count(json, i, &count) != parser_ok) {
-                return 0;
-            }
+parser_error_t dictionaries_sorted(const parsed_json_t *json) {
+    for (uint16_t i = 0; i < json->numberOfTokens; i++) {
+        const jsmntok_t object_token = json->tokens[i];
+        if (object_token.type != JSMN_OBJECT) {
+            continue;
+        }
 
-            if (count > 1) {
-                uint16_t prev_token_index;
-                if (object_get_nth_key(json, i, 0, &prev_token_index) != parser_ok) {
-                    return 0;
+        // Hop from each value to the next key, so only the keys of this object are visited
+        const jsmntok_t *prev_key = NULL;
+        uint16_t key_index = i + 1;
+        while (key_index + 1 < json->numberOfTokens && json->tokens[key_index].start < object_token.end) {
+            const jsmntok_t *key_token = &json->tokens[key_index];
+            if (prev_key != NULL) {
+                const int8_t cmp = compare_keys(json, prev_key, key_token);
+                if (cmp == 0) {
+                    return parser_duplicated_field;
                 }
-
-                for (int j = 1; j < count; j++) {
-                    uint16_t next_token_index;
-
-                    if (object_get_nth_key(json, i, j, &next_token_index) != parser_ok) {
-                        return 0;
-                    }
-
-                    if (!is_sorted(prev_token_index, next_token_index, json)) {
-                        return 0;
-                    }
-                    prev_token_index = next_token_index;
+                if (cmp > 0) {
+                    return parser_json_is_not_sorted;
                 }
             }
+            prev_key = key_token;
+            key_index = json_next_sibling(json, key_index + 1);
         }
     }
-    return 1;
+    return parser_ok;
 }
 
 parser_error_t tx_validate(parsed_json_t *json) {
@@ -132,12 +122,12 @@ parser_error_t tx_validate(parsed_json_t *json) {
         return parser_json_contains_whitespace;
     }
 
-    if (dictionaries_sorted(json) != 1) {
-        return parser_json_is_not_sorted;
+    parser_error_t err = dictionaries_sorted(json);
+    if (err != parser_ok) {
+        return err;
     }
 
     uint16_t token_index;
-    parser_error_t err;
 
     err = object_get_value(json, 0, "chain_id", &token_index);
     if (err != parser_ok)
@@ -155,6 +145,10 @@ parser_error_t tx_validate(parsed_json_t *json) {
     if (err != parser_ok)
         return parser_json_missing_msgs;
 
+    err = tx_schema_validate_msgs(json, token_index);
+    if (err != parser_ok)
+        return err;
+
     err = object_get_value(json, 0, "account_number", &token_index);
     if (err != parser_ok)
         return parser_json_missing_account_number;
@@ -165,3 +159,112 @@ parser_error_t tx_validate(parsed_json_t *json) {
 
     return parser_ok;
 }
+#endif
+
+// Whitespace outside strings, from the start of the buffer to the end of the root value
+__Z_INLINE bool stream_contains_whitespace(const json_stream_t *json, uint16_t end) {
+    bool inString = false;
+    bool escape = false;
+    for (uint16_t i = 0; i < end; i++) {
+        const char c = json->buffer[i];
+        if (inString) {
+            if (escape) {
+                escape = false;
+            } else if (c == '\\') {
+                escape = true;
+            } else if (c == '"') {
+                inString = false;
+            }
+        } else if (c == '"') {
+            inString = true;
+        } else if (is_space(c)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Same result as dictionaries_sorted: the error of the first object (in document order) that has one
+__Z_INLINE parser_error_t stream_dictionaries_sorted(const json_stream_t *json) {
+    // previous key and start of the object at each depth
+    uint16_t prevStart[JSON_STREAM_MAX_DEPTH];
+    uint16_t prevEnd[JSON_STREAM_MAX_DEPTH];
+    uint16_t objectStart[JSON_STREAM_MAX_DEPTH];
+    uint32_t hasPrev = 0;
+    uint32_t failed = 0;
+
+    parser_error_t result = parser_ok;
+    uint16_t resultObject = 0;
+
+    json_cursor_t cursor;
+    json_event_t event;
+    json_stream_cursor(&cursor, json->root);
+    parser_error_t err;
+    while ((err = json_stream_next(json, &cursor, &event)) == parser_ok) {
+        if (event.kind != json_event_open && event.kind != json_event_key) {
+            continue;
+        }
+
+        // Container the event opens, or the key is in
+        const uint8_t d = cursor.depth - 1;
+        const uint32_t bit = 1u << d;
+        if (event.kind == json_event_open) {
+            objectStart[d] = event.offset;
+            hasPrev &= ~bit;
+            failed &= ~bit;
+            continue;
+        }
+
+        if ((hasPrev & bit) != 0 && (failed & bit) == 0) {
+            const int8_t cmp = compare_bytes(json->buffer, prevStart[d], prevEnd[d], event.start, event.end);
+            if (cmp >= 0) {
+                failed |= bit;
+                if (result == parser_ok || objectStart[d] < resultObject) {
+                    result = cmp == 0 ? parser_duplicated_field : parser_json_is_not_sorted;
+                    resultObject = objectStart[d];
+                }
+            }
+        }
+        prevStart[d] = event.start;
+        prevEnd[d] = event.end;
+        hasPrev |= bit;
+    }
+    if (err != parser_no_data) {
+        return err;
+    }
+    return result;
+}
+
+parser_error_t tx_validate_stream(const json_stream_t *json) {
+    json_event_t root;
+    CHECK_PARSER_ERR(json_stream_value(json, json->root, &root))
+
+    if (stream_contains_whitespace(json, root.end)) {
+        return parser_json_contains_whitespace;
+    }
+
+    CHECK_PARSER_ERR(stream_dictionaries_sorted(json))
+
+    uint16_t offset;
+    if (json_stream_object_get_value(json, json->root, "chain_id", &offset) != parser_ok)
+        return parser_json_missing_chain_id;
+
+    if (json_stream_object_get_value(json, json->root, "sequence", &offset) != parser_ok)
+        return parser_json_missing_sequence;
+
+    if (json_stream_object_get_value(json, json->root, "fee", &offset) != parser_ok)
+        return parser_json_missing_fee;
+
+    if (json_stream_object_get_value(json, json->root, "msgs", &offset) != parser_ok)
+        return parser_json_missing_msgs;
+
+    CHECK_PARSER_ERR(tx_schema_validate_msgs_stream(json, offset))
+
+    if (json_stream_object_get_value(json, json->root, "account_number", &offset) != parser_ok)
+        return parser_json_missing_account_number;
+
+    if (json_stream_object_get_value(json, json->root, "memo", &offset) != parser_ok)
+        return parser_json_missing_memo;
+
+    return parser_ok;
+}
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "json/json_parser.h"
+#include "json/json_stream.h"
 #include <stdint.h>
 #include <common/parser_common.h>
 
@@ -24,11 +25,16 @@
 extern "C" {
 #endif
 
+#if JSON_TOKEN_ENGINE
 /// Validate json transaction
 /// \param parsed_transacton
 /// \param transaction
 /// \return
 parser_error_t tx_validate(parsed_json_t *json);
+#endif
+
+/// Same checks as tx_validate, for the streaming engine. Any whitespace outside strings is rejected
+parser_error_t tx_validate_stream(const json_stream_t *json);
 
 #ifdef __cplusplus
 }
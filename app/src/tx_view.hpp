@@ -0,0 +1,209 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// Host-side (C++17) view over the parser. Not part of device builds
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "common/parser.h"
+
+namespace secret {
+
+/// parser_error_t as a scoped enum
+enum class TxError : uint8_t {
+    ok = parser_ok,
+    no_data = parser_no_data,
+    init_context_empty = parser_init_context_empty,
+    display_idx_out_of_range = parser_display_idx_out_of_range,
+    display_page_out_of_range = parser_display_page_out_of_range,
+    unexpected_error = parser_unexpected_error,
+    unexpected_type = parser_unexpected_type,
+    unexpected_method = parser_unexpected_method,
+    unexpected_buffer_end = parser_unexpected_buffer_end,
+    unexpected_value = parser_unexpected_value,
+    unexpected_number_items = parser_unexpected_number_items,
+    unexpected_version = parser_unexpected_version,
+    unexpected_characters = parser_unexpected_characters,
+    unexpected_field = parser_unexpected_field,
+    duplicated_field = parser_duplicated_field,
+    value_out_of_range = parser_value_out_of_range,
+    invalid_address = parser_invalid_address,
+    unexpected_chain = parser_unexpected_chain,
+    missing_field = parser_missing_field,
+    query_no_results = parser_query_no_results,
+    json_zero_tokens = parser_json_zero_tokens,
+    json_too_many_tokens = parser_json_too_many_tokens,
+    json_incomplete_json = parser_json_incomplete_json,
+    json_contains_whitespace = parser_json_contains_whitespace,
+    json_is_not_sorted = parser_json_is_not_sorted,
+    json_missing_chain_id = parser_json_missing_chain_id,
+    json_missing_sequence = parser_json_missing_sequence,
+    json_missing_fee = parser_json_missing_fee,
+    json_missing_msgs = parser_json_missing_msgs,
+    json_missing_account_number = parser_json_missing_account_number,
+    json_missing_memo = parser_json_missing_memo,
+    json_unexpected_error = parser_json_unexpected_error,
+    json_too_deep = parser_json_too_deep,
+};
+
+static_assert(static_cast<int>(TxError::json_too_deep) == parser_json_too_deep, "TxError is out of sync");
+
+inline std::string_view describe(TxError err) {
+    return parser_getErrorDescription(static_cast<parser_error_t>(err));
+}
+
+/// A parsed and validated sign doc. Items are rendered page by page into buffers owned
+/// by the view, so keys and values are only valid until the iterator moves on.
+/// The sign doc is not copied and has to outlive the view
+class TxView {
+public:
+    /// One page of a display item
+    struct Item {
+        uint8_t index;
+        uint8_t page;
+        uint8_t pageCount;
+        std::string_view key;
+        std::string_view value;
+        TxError error;      // the page could not be rendered, key and value are empty
+    };
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Item;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Item *;
+        using reference = const Item &;
+
+        reference operator*() const { return item_; }
+
+        pointer operator->() const { return &item_; }
+
+        iterator &operator++() {
+            if (item_.page + 1u < item_.pageCount) {
+                item_.page++;
+            } else {
+                item_.index++;
+                item_.page = 0;
+            }
+            load();
+            return *this;
+        }
+
+        bool operator==(const iterator &other) const {
+            return item_.index == other.item_.index && item_.page == other.item_.page;
+        }
+
+        bool operator!=(const iterator &other) const { return !(*this == other); }
+
+    private:
+        friend class TxView;
+
+        iterator(TxView *view, uint8_t index) : view_(view), item_{index, 0, 0, {}, {}, TxError::ok} {
+            load();
+        }
+
+        void load() {
+            if (item_.index >= view_->numItems_) {
+                item_.index = view_->numItems_;
+                return;
+            }
+            const parser_error_t err = parser_getItem(&view_->ctx_, item_.index,
+                                                      view_->key_.data(), static_cast<uint16_t>(view_->key_.size()),
+                                                      view_->value_.data(), static_cast<uint16_t>(view_->value_.size()),
+                                                      item_.page, &item_.pageCount);
+            item_.error = static_cast<TxError>(err);
+            if (err != parser_ok) {
+                item_.key = {};
+                item_.value = {};
+                return;
+            }
+            item_.key = {view_->key_.data(), strnlen(view_->key_.data(), view_->key_.size())};
+            item_.value = {view_->value_.data(), strnlen(view_->value_.data(), view_->value_.size())};
+        }
+
+        TxView *view_;
+        Item item_;
+    };
+
+    /// \param keyLen key buffer size (terminator included)
+    /// \param pageLen value buffer size (terminator included), this is the page size
+    explicit TxView(uint16_t keyLen = 40, uint16_t pageLen = 40)
+            : state_(std::make_unique<parser_state_t>()), key_(keyLen), value_(pageLen) {
+        parser_bindState(&ctx_, state_.get());
+    }
+
+    TxView(const TxView &) = delete;
+    TxView &operator=(const TxView &) = delete;
+    TxView(TxView &&) = default;
+    TxView &operator=(TxView &&) = default;
+
+    /// Parses and validates a sign doc. Nothing can be iterated unless this succeeds
+    TxError parse(const uint8_t *data, size_t dataLen) {
+        numItems_ = 0;
+        parser_error_t err = parser_parse(&ctx_, data, dataLen);
+        if (err == parser_ok) {
+            err = parser_validate(&ctx_);
+        }
+        if (err == parser_ok) {
+            err = parser_getNumItems(&ctx_, &numItems_);
+        }
+        if (err != parser_ok) {
+            numItems_ = 0;
+        }
+        return static_cast<TxError>(err);
+    }
+
+    TxError parse(std::string_view doc) {
+        return parse(reinterpret_cast<const uint8_t *>(doc.data()), doc.size());
+    }
+
+    /// Shows items in expert or normal mode regardless of the app setting. Applies to the next parse
+    void setExpert(bool expert) {
+        parser_setMode(&ctx_, expert ? parser_mode_expert : parser_mode_normal);
+    }
+
+    /// Reads Amino JSON with the given engine (see parser_setEngine). Applies to the next parse
+    void setEngine(parser_engine_e engine) {
+        parser_setEngine(&ctx_, engine);
+    }
+
+    /// Resolves messages of known types from the token array or by traversal (see parser_setMsgRenderers)
+    void setMsgRenderers(bool enabled) {
+        parser_setMsgRenderers(&ctx_, enabled);
+    }
+
+    uint8_t numItems() const { return numItems_; }
+
+    iterator begin() { return iterator(this, 0); }
+
+    iterator end() { return iterator(this, numItems_); }
+
+private:
+    std::unique_ptr<parser_state_t> state_;
+    parser_context_t ctx_{};
+    std::vector<char> key_;
+    std::vector<char> value_;
+    uint8_t numItems_ = 0;
+};
+
+}
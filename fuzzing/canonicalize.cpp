@@ -0,0 +1,63 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "canonical.h"
+#include "parser.h"
+#include "tx_validate.h"
+
+
+#ifdef NDEBUG
+#error "This fuzz target won't work correctly with NDEBUG defined, which will cause asserts to be eliminated"
+#endif
+
+
+using std::size_t;
+
+static uint8_t ARENA[CANONICAL_ARENA_SIZE(MAX_NUMBER_OF_TOKENS)];
+static char OUTPUT[CANONICAL_MAX_INPUT_LEN + MAX_NUMBER_OF_TOKENS];
+static char SECOND_OUTPUT[sizeof(OUTPUT)];
+static parsed_json_t PARSED;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size > CANONICAL_MAX_INPUT_LEN) {
+        return 0;
+    }
+    const char *input = reinterpret_cast<const char *>(data);
+
+    canonical_arena_t arena;
+    canonical_arena_init(&arena, ARENA, sizeof(ARENA));
+
+    uint16_t outLen = 0;
+    parser_error_t rc = canonicalize_doc(&arena, input, size, OUTPUT, sizeof(OUTPUT), &outLen);
+    if (rc != parser_ok) {
+        return 0;
+    }
+    assert(outLen <= size + MAX_NUMBER_OF_TOKENS);
+
+    // The output tokenizes like the input did, and tx_validate finds nothing to fix
+    rc = json_parse(&PARSED, OUTPUT, outLen);
+    if (rc != parser_ok) {
+        fprintf(stderr, "json_parse rejected the output: %s\n", parser_getErrorDescription(rc));
+        assert(false);
+    }
+    rc = tx_validate(&PARSED);
+    if (rc == parser_json_contains_whitespace ||
+        rc == parser_json_is_not_sorted ||
+        rc == parser_duplicated_field) {
+        fprintf(stderr, "tx_validate rejected the output: %s\n", parser_getErrorDescription(rc));
+        fwrite(OUTPUT, 1, outLen, stderr);
+        fprintf(stderr, "\n");
+        assert(false);
+    }
+
+    // Canonical docs are left untouched
+    uint16_t secondLen = 0;
+    rc = canonicalize_doc(&arena, OUTPUT, outLen, SECOND_OUTPUT, sizeof(SECOND_OUTPUT), &secondLen);
+    assert(rc == parser_ok);
+    assert(secondLen == outLen && memcmp(OUTPUT, SECOND_OUTPUT, outLen) == 0);
+
+    return 0;
+}
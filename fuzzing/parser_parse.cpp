@@ -18,6 +18,7 @@ static char PARSER_VALUE[16384];
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
 {
     parser_context_t ctx;
+    parser_initContext(&ctx);
     parser_error_t rc;
 
     char buffer[1000];
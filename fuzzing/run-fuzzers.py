@@ -11,6 +11,7 @@ MUTATE_DEPTH = random.randint(1, 20)
 # (fuzzer name, max length, max time scale factor)
 CONFIGS = [
     ('parser_parse', 17000, 4),
+    ('canonicalize', 17000, 1),
 ]
 
 for config in CONFIGS:
@@ -0,0 +1,312 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include <gmock/gmock.h>
+#include "testcases.h"
+#include "apdu_trace.h"
+#include "proto_encode.h"
+#include "sim_fleet.h"
+#include "sim_replay.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    const std::string HRP = "secret";
+    // Zemu seed, 44'/529'/0'/0/0
+    const char *deviceAddress = "secret1eku0yvmkyjqwr3gxdrswmrem0kwev5j9tda8p2";
+
+    std::vector<tools::Exchange> signRequest(const std::string &doc, uint8_t encoding = tools::APDU_ENCODING_JSON) {
+        auto trace = tools::signTrace(doc, 0, 0, encoding);
+        trace.insert(trace.begin(), tools::addressExchange(HRP));
+        return trace;
+    }
+
+    std::string addressOf(const std::vector<uint8_t> &reply) {
+        // Compressed public key, then the address
+        if (reply.size() < 33 + 2) {
+            return "";
+        }
+        return std::string(reply.begin() + 33, reply.end() - 2);
+    }
+
+    // dumpUI adds the page number to the key, the device shows it elsewhere. Test cases are trimmed
+    std::string comparable(std::string line) {
+        const size_t sep = line.find(" : ");
+        const size_t page = line.rfind(" [", sep);
+        if (sep != std::string::npos && page != std::string::npos) {
+            line = line.substr(0, page) + line.substr(sep);
+        }
+        line.erase(line.find_last_not_of(' ') + 1);
+        return line;
+    }
+
+    class ApduSimCorpus : public ::testing::TestWithParam<testcase_t> {
+    public:
+        struct PrintToStringParamName {
+            template<class ParamType>
+            std::string operator()(const testing::TestParamInfo<ParamType> &info) const {
+                return static_cast<testcase_t>(info.param).description;
+            }
+        };
+    };
+
+    INSTANTIATE_TEST_SUITE_P(
+        JsonTestCases,
+        ApduSimCorpus,
+        ::testing::ValuesIn(GetJsonTestCases("testcases/manual.json")),
+        ApduSimCorpus::PrintToStringParamName()
+    );
+
+    // The whole command path shows the same pages as the parser tests
+    TEST_P(ApduSimCorpus, SignFlow) {
+        const testcase_t &tc = GetParam();
+        sim_device_config_t config{};
+        config.expert = tc.expert;
+        config.keyLen = 40;
+        config.valueLen = 40;
+
+        sim::Replay replay;
+        sim::replay(signRequest(tc.tx), config, &replay);
+        ASSERT_EQ(replay.exception, 0);
+        ASSERT_FALSE(replay.replies.empty());
+        EXPECT_EQ(tools::statusWord(replay.replies.front()), 0x9000);
+
+        const uint16_t sw = tools::statusWord(replay.replies.back());
+        if (tc.parsingErr != "No error" || tc.validationErr != "No error") {
+            EXPECT_EQ(sw, 0x6984);
+            EXPECT_TRUE(replay.pages.empty());
+            return;
+        }
+
+        EXPECT_EQ(sw, 0x9000);
+        std::vector<std::string> pages;
+        std::vector<std::string> expected;
+        for (const auto &line : replay.pages) {
+            pages.push_back(comparable(line));
+        }
+        for (const auto &line : tc.expected) {
+            expected.push_back(comparable(line));
+        }
+        EXPECT_EQ(pages, expected);
+        EXPECT_EQ(replay.stageNs[sim_stage_review].size(), 1u);
+    }
+
+    TEST(ApduSim, Address) {
+        sim::Replay replay;
+        sim::replay({tools::addressExchange(HRP, 5, 3)}, sim_device_config_t{}, &replay);
+        ASSERT_EQ(replay.replies.size(), 1u);
+        EXPECT_EQ(tools::statusWord(replay.replies[0]), 0x9000);
+        EXPECT_EQ(addressOf(replay.replies[0]), "secret17l38833pgwpztuyy74nens3jkyqt43nqp7t7rf");
+        EXPECT_EQ(replay.stageNs[sim_stage_address].size(), 1u);
+    }
+
+    // A HRP may contain '1': "secret" must not reuse the address cached for "secret1x"
+    TEST(ApduSim, AddressCacheHrp) {
+        sim::Replay replay;
+        sim::replay({tools::addressExchange("secret1x"), tools::addressExchange(HRP)}, sim_device_config_t{}, &replay);
+        ASSERT_EQ(replay.replies.size(), 2u);
+        EXPECT_EQ(addressOf(replay.replies[0]).rfind("secret1x1", 0), 0u);
+        EXPECT_EQ(addressOf(replay.replies[1]), deviceAddress);
+    }
+
+    // Recorded replies, the signature is deterministic (RFC6979)
+    TEST(ApduSim, RecordedTrace) {
+        std::vector<tools::Exchange> trace;
+        std::string error;
+        ASSERT_TRUE(tools::loadTrace(std::string(TESTVECTORS_DIR) + "traces/delegation.trace", &trace, &error)) << error;
+
+        sim::Replay replay;
+        sim::replay(trace, sim_device_config_t{}, &replay);
+        ASSERT_EQ(replay.exception, 0);
+        ASSERT_EQ(replay.replies.size(), trace.size());
+        for (size_t i = 0; i < trace.size(); i++) {
+            ASSERT_TRUE(trace[i].hasReply);
+            EXPECT_EQ(tools::toHex(replay.replies[i].data(), replay.replies[i].size()),
+                      tools::toHex(trace[i].reply.data(), trace[i].reply.size())) << "Command " << i;
+        }
+    }
+
+    // The address exchange overwrites the APDU buffer, the format comes from the init chunk
+    TEST(ApduSim, ProtobufSignDoc) {
+        const char *recipient = "secret1xz54wxqsgkvmhf2hj0g4d3w8xqjyx6ev2v2dte";
+        proto_encode::SignDoc doc;
+        doc.msgs = {proto_encode::msgSend(deviceAddress, recipient, "15")};
+        const std::string amino = std::string(R"({"account_number":"108","chain_id":"secret-4","fee":{"amount":[{"amount":"600","denom":"uscrt"}],"gas":"200000"},"memo":"","msgs":[{"type":"cosmos-sdk/MsgSend","value":{"amount":[{"amount":"15","denom":"uscrt"}],"from_address":")") +
+                                  deviceAddress + R"(","to_address":")" + recipient + R"("}}],"sequence":"2"})";
+
+        for (const bool expert : {false, true}) {
+            sim_device_config_t config{};
+            config.expert = expert;
+
+            sim::Replay expected;
+            sim::replay(signRequest(amino), config, &expected);
+            ASSERT_EQ(expected.exception, 0);
+            ASSERT_EQ(tools::statusWord(expected.replies.back()), 0x9000);
+
+            sim::Replay replay;
+            sim::replay(signRequest(doc.encode(), tools::APDU_ENCODING_PROTOBUF), config, &replay);
+            ASSERT_EQ(replay.exception, 0);
+            ASSERT_FALSE(replay.replies.empty());
+            EXPECT_EQ(addressOf(replay.replies.front()), deviceAddress);
+            EXPECT_EQ(tools::statusWord(replay.replies.back()), 0x9000) << "expert " << expert;
+            EXPECT_EQ(replay.pages, expected.pages) << "expert " << expert;
+            EXPECT_FALSE(replay.pages.empty());
+        }
+    }
+
+    TEST(ApduSim, Reject) {
+        const auto tests = GetJsonTestCases("testcases/manual.json");
+        ASSERT_FALSE(tests.empty());
+        const auto &tc = tests.back();
+
+        sim::Replay replay;
+        replay.approve = [] { return false; };
+        sim::replay(signRequest(tc.tx), sim_device_config_t{}, &replay);
+        ASSERT_EQ(replay.exception, 0);
+        EXPECT_EQ(tools::statusWord(replay.replies.back()), 0x6986);
+        EXPECT_FALSE(replay.pages.empty());
+    }
+
+    TEST(ApduSim, Errors) {
+        const uint8_t path[20] = {};
+        std::vector<tools::Exchange> trace = {
+                // Chunk before init
+                {tools::apdu(tools::APDU_INS_SIGN, 1, 0, path, 4)},
+                // Unknown instruction
+                {tools::apdu(0x7F, 0, 0, nullptr, 0)},
+                // Wrong class
+                {{0xE0, 0x00, 0x00, 0x00, 0x00}},
+                // Version
+                {tools::apdu(0x00, 0, 0, nullptr, 0)},
+        };
+
+        sim::Replay replay;
+        sim::replay(trace, sim_device_config_t{}, &replay);
+        ASSERT_EQ(replay.exception, 0);
+        ASSERT_EQ(replay.replies.size(), trace.size());
+        EXPECT_NE(tools::statusWord(replay.replies[0]), 0x9000);
+        EXPECT_EQ(tools::statusWord(replay.replies[1]), 0x6D00);
+        EXPECT_EQ(tools::statusWord(replay.replies[2]), 0x6E00);
+        EXPECT_EQ(tools::statusWord(replay.replies[3]), 0x9000);
+        EXPECT_EQ(replay.replies[3].size(), 9u + 2);
+    }
+
+    std::vector<tools::Exchange> batchDocument(const std::string &doc) {
+        const auto path = tools::hdPath(0, 0);
+        std::vector<tools::Exchange> trace = {{tools::apdu(tools::APDU_INS_SIGN_BATCH, 1, 0, path.data(), path.size())}};
+        for (size_t offset = 0; offset < doc.size(); offset += tools::APDU_CHUNK_SIZE) {
+            const size_t len = std::min(tools::APDU_CHUNK_SIZE, doc.size() - offset);
+            const uint8_t p1 = offset + len >= doc.size() ? 3 : 2;
+            trace.push_back({tools::apdu(tools::APDU_INS_SIGN_BATCH, p1, 0, (const uint8_t *) doc.data() + offset, len)});
+        }
+        return trace;
+    }
+
+    // Document chunks are only accepted after a document start of the current batch
+    TEST(ApduSim, BatchDocuments) {
+        const auto tests = GetJsonTestCases("testcases/manual.json");
+        ASSERT_FALSE(tests.empty());
+        const std::string &doc = tests.back().tx;
+        const uint8_t count = 1;
+        const tools::Exchange init = {tools::apdu(tools::APDU_INS_SIGN_BATCH, 0, 0, &count, 1)};
+
+        auto document = batchDocument(doc);
+        std::vector<tools::Exchange> trace = {init};
+        trace.insert(trace.end(), document.begin() + 1, document.end());
+        sim::Replay withoutStart;
+        sim::replay(trace, sim_device_config_t{}, &withoutStart);
+        ASSERT_EQ(withoutStart.exception, 0);
+        EXPECT_EQ(tools::statusWord(withoutStart.replies.back()), 0x6984);
+        EXPECT_TRUE(withoutStart.pages.empty());
+
+        // A document left open is dropped by the next init
+        trace = {init, document[0], document[1], init};
+        trace.insert(trace.end(), document.begin() + 1, document.end());
+        sim::Replay reopened;
+        sim::replay(trace, sim_device_config_t{}, &reopened);
+        ASSERT_EQ(reopened.exception, 0);
+        EXPECT_EQ(tools::statusWord(reopened.replies.back()), 0x6984);
+        EXPECT_TRUE(reopened.pages.empty());
+
+        trace = {init};
+        trace.insert(trace.end(), document.begin(), document.end());
+        sim::Replay approved;
+        sim::replay(trace, sim_device_config_t{}, &approved);
+        ASSERT_EQ(approved.exception, 0);
+        EXPECT_EQ(tools::statusWord(approved.replies.back()), 0x9000);
+        EXPECT_FALSE(approved.pages.empty());
+    }
+
+    // Nothing is left from a previous session
+    TEST(ApduSim, Sessions) {
+        const auto tests = GetJsonTestCases("testcases/manual.json");
+        ASSERT_FALSE(tests.empty());
+
+        sim::Replay first;
+        sim::replay(signRequest(tests.back().tx), sim_device_config_t{}, &first);
+
+        // A chunk without init must not sign the previous document
+        std::vector<tools::Exchange> trace = {
+                {tools::apdu(tools::APDU_INS_SIGN, 2, 0, (const uint8_t *) "{}", 2)},
+        };
+        sim::Replay second;
+        sim::replay(trace, sim_device_config_t{}, &second);
+        ASSERT_EQ(second.replies.size(), 1u);
+        EXPECT_NE(tools::statusWord(second.replies[0]), 0x9000);
+        EXPECT_TRUE(second.pages.empty());
+    }
+
+    // Loaded copies are independent devices: concurrent sessions in different modes do not interfere
+    TEST(ApduSim, Fleet) {
+        std::vector<tools::Exchange> trace;
+        std::string error;
+        ASSERT_TRUE(tools::loadTrace(std::string(TESTVECTORS_DIR) + "traces/delegation.trace", &trace, &error)) << error;
+
+        const size_t numDevices = 4;
+        sim::Fleet fleet;
+        ASSERT_TRUE(fleet.load(APDU_SIM_DEVICE_MODULE, numDevices, &error)) << error;
+        ASSERT_EQ(fleet.size(), numDevices);
+
+        std::vector<std::vector<sim::Replay>> replays(numDevices, std::vector<sim::Replay>(10));
+        std::vector<std::thread> threads;
+        for (size_t d = 0; d < numDevices; d++) {
+            threads.emplace_back([&, d] {
+                sim_device_config_t config{};
+                config.expert = d % 2 == 1;
+                for (auto &replay : replays[d]) {
+                    sim::replayOn(fleet.device(d), trace, config, &replay);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        for (size_t d = 0; d < numDevices; d++) {
+            for (const auto &replay : replays[d]) {
+                ASSERT_EQ(replay.exception, 0);
+                ASSERT_EQ(replay.replies.size(), trace.size());
+                for (size_t i = 0; i < trace.size(); i++) {
+                    EXPECT_EQ(replay.replies[i], trace[i].reply) << "Device " << d << ", command " << i;
+                }
+                // Expert mode shows more items
+                EXPECT_EQ(replay.pages.size(), replays[d % 2].front().pages.size());
+            }
+        }
+        EXPECT_LT(replays[0].front().pages.size(), replays[1].front().pages.size());
+    }
+}
@@ -0,0 +1,143 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include <batch.h>
+#include <common/parser.h>
+#include <app_mode.h>
+#include <string>
+#include <vector>
+
+namespace {
+    std::string sendDoc(const std::string &amount, const std::string &to) {
+        return R"({"account_number":"108","chain_id":"secret-4","fee":{"amount":[{"amount":"600","denom":"uscrt"}],"gas":"200000"},"memo":"","msgs":[{"type":"cosmos-sdk/MsgSend","value":{"amount":[{"amount":")"
+               + amount +
+               R"(","denom":"uscrt"}],"from_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","to_address":")"
+               + to +
+               R"("}}],"sequence":"2"})";
+    }
+
+    const char *addrA = "secret1xz54wxqsgkvmhf2hj0g4d3w8xqjyx6ev2v2dte";
+    const char *addrB = "secret1kn3wugetjuy4zetlq6wadchfhvu3x7407zqqsp";
+
+    parser_error_t addDocs(std::string &buffer, const std::vector<std::string> &docs) {
+        for (const auto &doc: docs) {
+            buffer += doc;
+        }
+
+        CHECK_PARSER_ERR(batch_init(docs.size()))
+
+        const uint32_t path[HDPATH_LEN_DEFAULT] = {0x8000002c, 0x80000211, 0x80000000, 0, 0};
+        const uint8_t digest[SHA256_DIGEST_SIZE] = {0};
+        uint32_t offset = 0;
+        for (const auto &doc: docs) {
+            CHECK_PARSER_ERR(batch_addDoc((const uint8_t *) buffer.data() + offset, offset, doc.size(), path, digest))
+            offset += doc.size();
+        }
+        return parser_ok;
+    }
+
+    std::vector<std::string> dumpItems(const std::string &buffer) {
+        std::vector<std::string> answer;
+
+        uint8_t numItems = 0;
+        EXPECT_EQ(batch_getNumItems(&numItems), parser_ok);
+
+        char key[40];
+        char value[40];
+        for (uint8_t idx = 0; idx < numItems; idx++) {
+            uint8_t pageCount = 1;
+            for (uint8_t page = 0; page < pageCount; page++) {
+                EXPECT_EQ(batch_getItem((const uint8_t *) buffer.data(), idx,
+                                        key, sizeof(key), value, sizeof(value),
+                                        page, &pageCount), parser_ok);
+                std::string line = std::to_string(idx) + " | " + key;
+                if (pageCount > 1) {
+                    line += " [" + std::to_string(page + 1) + "/" + std::to_string(pageCount) + "]";
+                }
+                answer.push_back(line + " : " + value);
+            }
+        }
+        return answer;
+    }
+
+    TEST(Batch, OnlyDifferingItemsAreRepeated) {
+        app_mode_set_expert(false);
+        std::string buffer;
+        ASSERT_EQ(addDocs(buffer, {sendDoc("15", addrA), sendDoc("25", addrA), sendDoc("15", addrB)}), parser_ok);
+        EXPECT_TRUE(batch_isComplete());
+
+        const std::vector<std::string> expected = {
+            "0 | Batch : 3 transactions",
+            "1 | Type : Send",
+            "2 | #1 Amount : 0.000015 SCRT",
+            "3 | From [1/2] : secret1w34k53py5v5xyluazqpq65agyajavep2",
+            "3 | From [2/2] : rflq6h",
+            "4 | #1 To [1/2] : secret1xz54wxqsgkvmhf2hj0g4d3w8xqjyx6ev",
+            "4 | #1 To [2/2] : 2v2dte",
+            "5 | Fee : 0.000600 SCRT",
+            "6 | #2 Amount : 0.000025 SCRT",
+            "7 | #2 To [1/2] : secret1xz54wxqsgkvmhf2hj0g4d3w8xqjyx6ev",
+            "7 | #2 To [2/2] : 2v2dte",
+            "8 | #3 Amount : 0.000015 SCRT",
+            "9 | #3 To [1/2] : secret1kn3wugetjuy4zetlq6wadchfhvu3x740",
+            "9 | #3 To [2/2] : 7zqqsp",
+        };
+        EXPECT_EQ(dumpItems(buffer), expected);
+    }
+
+    TEST(Batch, IdenticalDocs) {
+        app_mode_set_expert(false);
+        std::string buffer;
+        ASSERT_EQ(addDocs(buffer, {sendDoc("15", addrA), sendDoc("15", addrA)}), parser_ok);
+
+        uint8_t numItems = 0;
+        ASSERT_EQ(batch_getNumItems(&numItems), parser_ok);
+        EXPECT_EQ(numItems, 1 + 5);
+    }
+
+    TEST(Batch, SignaturesRequireApproval) {
+        app_mode_set_expert(false);
+        std::string buffer;
+        ASSERT_EQ(addDocs(buffer, {sendDoc("15", addrA), sendDoc("25", addrB)}), parser_ok);
+
+        const uint32_t *path = nullptr;
+        const uint8_t *digest = nullptr;
+        EXPECT_EQ(batch_getSigningData(0, &path, &digest), parser_no_data);
+
+        batch_approve();
+        EXPECT_EQ(batch_getSigningData(1, &path, &digest), parser_ok);
+        EXPECT_EQ(batch_getSigningData(2, &path, &digest), parser_value_out_of_range);
+
+        batch_reset();
+        EXPECT_EQ(batch_getSigningData(0, &path, &digest), parser_no_data);
+    }
+
+    TEST(Batch, DifferentStructureIsRejected) {
+        app_mode_set_expert(false);
+        std::string buffer;
+        const std::string withMemo = R"({"account_number":"108","chain_id":"secret-4","fee":{"amount":[{"amount":"600","denom":"uscrt"}],"gas":"200000"},"memo":"payroll","msgs":[{"type":"cosmos-sdk/MsgSend","value":{"amount":[{"amount":"15","denom":"uscrt"}],"from_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","to_address":"secret1xz54wxqsgkvmhf2hj0g4d3w8xqjyx6ev2v2dte"}}],"sequence":"2"})";
+        EXPECT_EQ(addDocs(buffer, {sendDoc("15", addrA), withMemo}), parser_unexpected_number_items);
+        EXPECT_FALSE(batch_isComplete());
+    }
+
+    TEST(Batch, InvalidCount) {
+        EXPECT_EQ(batch_init(0), parser_unexpected_number_items);
+        EXPECT_EQ(batch_init(BATCH_MAX_DOCS + 1), parser_unexpected_number_items);
+        EXPECT_EQ(batch_init(BATCH_MAX_DOCS), parser_ok);
+        batch_reset();
+    }
+}
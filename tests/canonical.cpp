@@ -0,0 +1,233 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include <canonical.h>
+#include <common/parser.h>
+#include <json/json_parser.h>
+#include <tx_stream_check.h>
+#include <tx_validate.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "testcases.h"
+
+namespace {
+    struct result_t {
+        parser_error_t err;
+        std::string out;
+    };
+
+    result_t canonical(const std::string &in, size_t maxTokens = MAX_NUMBER_OF_TOKENS) {
+        std::vector<uint8_t> buffer(CANONICAL_ARENA_SIZE(maxTokens));
+        canonical_arena_t arena;
+        canonical_arena_init(&arena, buffer.data(), buffer.size());
+
+        std::string out(in.size() + maxTokens, '\0');
+        uint16_t outLen = 0;
+        const parser_error_t err = canonicalize_doc(&arena, in.data(), in.size(), &out[0], out.size(), &outLen);
+        out.resize(outLen);
+        return {err, out};
+    }
+
+    // Rewrites a doc with whitespace between tokens and keys in random order
+    class Scrambler {
+    public:
+        explicit Scrambler(uint32_t seed) : rng_(seed) {}
+
+        std::string operator()(const std::string &doc) {
+            doc_ = doc;
+            tokens_.resize(MAX_NUMBER_OF_TOKENS);
+            jsmn_parser parser;
+            jsmn_init(&parser);
+            const int num = jsmn_parse(&parser, doc.data(), doc.size(), tokens_.data(), tokens_.size());
+            EXPECT_GT(num, 0);
+            std::string out;
+            write(0, &out);
+            space(&out);
+            return out;
+        }
+
+    private:
+        void space(std::string *out) {
+            // What jsmn skips, tx_validate rejects \f and \v as well
+            static const char spaces[] = " \t\r\n";
+            while (rng_() % 3 == 0) {
+                out->push_back(spaces[rng_() % 4]);
+            }
+        }
+
+        int write(int idx, std::string *out) {
+            space(out);
+            const jsmntok_t &tok = tokens_[idx];
+            int child = idx + 1;
+            if (tok.type == JSMN_STRING || tok.type == JSMN_PRIMITIVE) {
+                const bool quoted = tok.type == JSMN_STRING;
+                out->append(doc_, tok.start - quoted, tok.end - tok.start + 2 * quoted);
+                return child;
+            }
+
+            // Members are written out of place, then assembled
+            std::vector<std::string> members;
+            for (int i = 0; i < tok.size; i++) {
+                std::string member;
+                if (tok.type == JSMN_OBJECT) {
+                    child = write(child, &member);
+                    space(&member);
+                    member += ":";
+                }
+                child = write(child, &member);
+                space(&member);
+                members.push_back(member);
+            }
+            if (tok.type == JSMN_OBJECT) {
+                std::shuffle(members.begin(), members.end(), rng_);
+            }
+            out->push_back(tok.type == JSMN_OBJECT ? '{' : '[');
+            for (size_t i = 0; i < members.size(); i++) {
+                out->append(i > 0 ? "," : "").append(members[i]);
+            }
+            space(out);
+            out->push_back(tok.type == JSMN_OBJECT ? '}' : ']');
+            return child;
+        }
+
+        std::mt19937 rng_;
+        std::string doc_;
+        std::vector<jsmntok_t> tokens_;
+    };
+
+    TEST(Canonical, StripsWhitespaceAndSortsKeys) {
+        const result_t r = canonical("{ \"memo\" : \"a b\",\n\t\"fee\": { \"gas\" : 1 , \"amount\" : [ ] } }\n");
+        ASSERT_EQ(r.err, parser_ok);
+        EXPECT_EQ(r.out, R"({"fee":{"amount":[],"gas":1},"memo":"a b"})");
+    }
+
+    // Raw bytes are compared, shorter keys first, as dictionaries_sorted does
+    TEST(Canonical, KeyOrder) {
+        const result_t r = canonical(R"({"b":0,"ab":1,"a":2,"B":3,"a\"":4})");
+        ASSERT_EQ(r.err, parser_ok);
+        EXPECT_EQ(r.out, R"({"B":3,"a":2,"a\"":4,"ab":1,"b":0})");
+    }
+
+    TEST(Canonical, PreservesStrings) {
+        const std::string doc = R"({"k":["é\\ \n","  ","\"\/"],"l":-1.5e3,"m":null})";
+        const result_t r = canonical(doc);
+        ASSERT_EQ(r.err, parser_ok);
+        EXPECT_EQ(r.out, doc);
+    }
+
+    TEST(Canonical, DuplicatedKeys) {
+        EXPECT_EQ(canonical(R"({"a":1,"b":2,"a":3})").err, parser_duplicated_field);
+        EXPECT_EQ(canonical(R"({"x":[{"a":1,"a":1}]})").err, parser_duplicated_field);
+        // Same text once unescaped is not a duplicate to tx_validate either
+        EXPECT_EQ(canonical(R"({"ab":1,"a\u0062":3})").err, parser_ok);
+    }
+
+    TEST(Canonical, Rejected) {
+        EXPECT_EQ(canonical("").err, parser_json_zero_tokens);
+        EXPECT_EQ(canonical(R"({"a":[1,2)").err, parser_json_incomplete_json);
+        EXPECT_EQ(canonical(R"({"a":"\x"})").err, parser_unexpected_characters);
+        EXPECT_EQ(canonical(R"({"a":["b""c"]})").out, R"({"a":["b","c"]})");
+        EXPECT_EQ(canonical(R"({"a"})").err, parser_unexpected_characters);
+        EXPECT_EQ(canonical(R"({"a":1} {"b":2})").err, parser_unexpected_characters);
+        EXPECT_EQ(canonical(R"({"a":[1,2,3]})", 5).err, parser_json_too_many_tokens);
+        EXPECT_EQ(canonical(R"({"a":[1,2,3]})", 6).err, parser_ok);
+
+        // Sign docs are objects
+        EXPECT_EQ(canonical(R"("a b")").err, parser_unexpected_type);
+        EXPECT_EQ(canonical("[1]").err, parser_unexpected_type);
+
+        std::string deep = "{}";
+        for (uint32_t i = 1; i < STREAM_CHECK_MAX_DEPTH; i++) {
+            deep = R"({"a":)" + deep + "}";
+        }
+        EXPECT_EQ(canonical(deep).err, parser_ok);
+        EXPECT_EQ(canonical(R"({"a":)" + deep + "}").err, parser_json_too_deep);
+    }
+
+    TEST(Canonical, OutputTooSmall) {
+        std::vector<uint8_t> buffer(CANONICAL_ARENA_SIZE(16));
+        canonical_arena_t arena;
+        canonical_arena_init(&arena, buffer.data(), buffer.size());
+        char out[8];
+        uint16_t outLen = 0;
+        const std::string doc = R"({"abc":"defgh"})";
+        EXPECT_EQ(canonicalize_doc(&arena, doc.data(), doc.size(), out, sizeof(out), &outLen),
+                  parser_unexpected_buffer_end);
+        EXPECT_EQ(outLen, 0);
+    }
+
+    // Every doc the device accepts comes back unchanged once scrambled
+    TEST(Canonical, ScrambledCorpus) {
+        Scrambler scramble(1);
+        uint32_t checked = 0;
+        for (const auto &tc : GetJsonTestCases("testcases/manual.json")) {
+            parser_context_t ctx;
+            parser_initContext(&ctx);
+            if (parser_parse(&ctx, (const uint8_t *) tc.tx.data(), tc.tx.size()) != parser_ok ||
+                parser_validate(&ctx) != parser_ok) {
+                continue;
+            }
+            EXPECT_EQ(canonical(tc.tx).out, tc.tx) << tc.description;
+            for (int i = 0; i < 4; i++) {
+                const std::string scrambled = scramble(tc.tx);
+                const result_t r = canonical(scrambled);
+                ASSERT_EQ(r.err, parser_ok) << scrambled;
+                EXPECT_EQ(r.out, tc.tx) << scrambled;
+            }
+            checked++;
+        }
+        EXPECT_GT(checked, 0u);
+    }
+
+    // Same properties as fuzzing/canonicalize.cpp, over random edits of the corpus
+    TEST(Canonical, MutatedCorpus) {
+        static const char alphabet[] = "{}[]:,\" \n\\a1-";
+        std::mt19937 rng(2);
+        const auto testcases = GetJsonTestCases("testcases/manual.json");
+        parsed_json_t json;
+        uint32_t accepted = 0;
+
+        for (int iteration = 0; iteration < 20000; iteration++) {
+            std::string doc = testcases[rng() % testcases.size()].tx;
+            for (uint32_t edits = 1 + rng() % 4; edits > 0 && !doc.empty(); edits--) {
+                const size_t pos = rng() % doc.size();
+                const char c = alphabet[rng() % (sizeof(alphabet) - 1)];
+                switch (rng() % 3) {
+                    case 0: doc[pos] = c; break;
+                    case 1: doc.insert(doc.begin() + pos, c); break;
+                    default: doc.erase(pos, 1); break;
+                }
+            }
+
+            const result_t r = canonical(doc);
+            if (r.err != parser_ok) {
+                continue;
+            }
+            accepted++;
+            ASSERT_LE(r.out.size(), doc.size() + MAX_NUMBER_OF_TOKENS);
+            ASSERT_EQ(json_parse(&json, r.out.data(), r.out.size()), parser_ok) << doc;
+            const parser_error_t err = tx_validate(&json);
+            ASSERT_NE(err, parser_json_contains_whitespace) << doc;
+            ASSERT_NE(err, parser_json_is_not_sorted) << doc;
+            ASSERT_NE(err, parser_duplicated_field) << doc;
+            ASSERT_EQ(canonical(r.out).out, r.out) << doc;
+        }
+        EXPECT_GT(accepted, 0u);
+    }
+}
@@ -0,0 +1,244 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include <chunk_seq.h>
+#include <sha256.h>
+#include <iostream>
+#include <random>
+#include "chunk_transport.h"
+
+using namespace chunk_transport;
+
+namespace {
+    // Bytes read by chunk_seq_check, as tx_get_byte does on device
+    const std::vector<uint8_t> *received = nullptr;
+
+    uint8_t readReceived(uint32_t offset) {
+        return received->at(offset);
+    }
+
+    // Mirrors process_chunk, with the transaction buffer and running digest of tx.c
+    class SimDevice {
+    public:
+        Reply process(const std::vector<uint8_t> &apdu) {
+            Reply reply;
+            reply.delivered = true;
+            reply.sw = SW_OK;
+
+            const uint8_t p1 = apdu[2];
+            const std::vector<uint8_t> payload(apdu.begin() + 5, apdu.end());
+            switch (p1) {
+                case P1_INIT:
+                    buffer.clear();
+                    sha256_init(&digestCtx);
+                    lastSeq = 0;
+                    return reply;
+                case P1_ADD:
+                case P1_LAST:
+                    append(payload.data(), payload.size());
+                    if (p1 == P1_LAST) {
+                        complete = true;
+                    }
+                    return reply;
+                case P1_SEQ_ADD:
+                case P1_SEQ_LAST:
+                    break;
+                default:
+                    reply.sw = 0x6B00;
+                    return reply;
+            }
+
+            chunk_seq_header_t header;
+            if (!chunk_seq_read_header(payload.data(), payload.size(), &header)) {
+                reply.sw = 0x6700;
+                return reply;
+            }
+            const uint8_t *data = payload.data() + CHUNK_SEQ_HEADER_LEN;
+            const uint32_t dataLen = payload.size() - CHUNK_SEQ_HEADER_LEN;
+
+            uint32_t skip = 0;
+            received = &buffer;
+            switch (chunk_seq_check(readReceived, buffer.size(), header.offset, data, dataLen, &skip)) {
+                case chunk_seq_append:
+                    append(data + skip, dataLen - skip);
+                    break;
+                case chunk_seq_gap:
+                    reply.sw = SW_RESUME;
+                    reply.data.resize(CHUNK_SEQ_ACK_LEN);
+                    chunk_seq_write_ack(reply.data.data(), lastSeq, buffer.size());
+                    return reply;
+                default:
+                    reply.sw = 0x6984;
+                    return reply;
+            }
+            lastSeq = header.seq;
+
+            if (p1 == P1_SEQ_LAST) {
+                complete = header.offset + dataLen == buffer.size();
+                reply.sw = complete ? SW_OK : 0x6984;
+                return reply;
+            }
+            reply.data.resize(CHUNK_SEQ_ACK_LEN);
+            chunk_seq_write_ack(reply.data.data(), header.seq, buffer.size());
+            return reply;
+        }
+
+        std::vector<uint8_t> digest() {
+            std::vector<uint8_t> answer(SHA256_DIGEST_SIZE);
+            sha256_ctx_t ctx = digestCtx;
+            sha256_final(&ctx, answer.data());
+            return answer;
+        }
+
+        std::vector<uint8_t> buffer;
+        bool complete = false;
+
+    private:
+        void append(const uint8_t *data, size_t len) {
+            buffer.insert(buffer.end(), data, data + len);
+            sha256_update(&digestCtx, data, len);
+        }
+
+        sha256_ctx_t digestCtx{};
+        uint16_t lastSeq = 0;
+    };
+
+    // Drops requests and responses, and delivers some requests twice
+    class LossyLink {
+    public:
+        LossyLink(SimDevice &device, double lossRate, uint32_t seed) : device(device), lossRate(lossRate), rng(seed) {}
+
+        Reply exchange(const std::vector<uint8_t> &apdu) {
+            if (chance(lossRate)) {
+                return Reply();
+            }
+            Reply reply = device.process(apdu);
+            if (chance(lossRate / 2)) {
+                // Retransmission at the link layer, the device sees the request again
+                reply = device.process(apdu);
+            }
+            if (chance(lossRate)) {
+                return Reply();
+            }
+            return reply;
+        }
+
+    private:
+        bool chance(double p) { return std::uniform_real_distribution<double>(0, 1)(rng) < p; }
+
+        SimDevice &device;
+        double lossRate;
+        std::mt19937 rng;
+    };
+
+    std::vector<uint8_t> randomTx(std::mt19937 &rng, size_t len) {
+        std::vector<uint8_t> tx(len);
+        for (auto &b : tx) {
+            b = (uint8_t) ('a' + rng() % 26);
+        }
+        return tx;
+    }
+
+    std::vector<uint8_t> sha256(const std::vector<uint8_t> &data) {
+        std::vector<uint8_t> answer(SHA256_DIGEST_SIZE);
+        sha256_digest(data.data(), data.size(), answer.data());
+        return answer;
+    }
+
+    const std::vector<uint8_t> path(20, 0);
+
+    TEST(ChunkSeq, Check) {
+        const std::vector<uint8_t> bytes = {1, 2, 3, 4};
+        received = &bytes;
+        const uint8_t replay[] = {3, 4, 5, 6};
+        const uint8_t different[] = {3, 9, 5, 6};
+        uint32_t skip = 0;
+
+        EXPECT_EQ(chunk_seq_check(readReceived, bytes.size(), 4, replay, 4, &skip), chunk_seq_append);
+        EXPECT_EQ(skip, 0);
+        EXPECT_EQ(chunk_seq_check(readReceived, bytes.size(), 2, replay, 4, &skip), chunk_seq_append);
+        EXPECT_EQ(skip, 2);
+        EXPECT_EQ(chunk_seq_check(readReceived, bytes.size(), 2, replay, 2, &skip), chunk_seq_append);
+        EXPECT_EQ(skip, 2);
+        EXPECT_EQ(chunk_seq_check(readReceived, bytes.size(), 2, different, 4, &skip), chunk_seq_mismatch);
+        EXPECT_EQ(chunk_seq_check(readReceived, bytes.size(), 5, replay, 4, &skip), chunk_seq_gap);
+    }
+
+    TEST(ChunkSeq, Header) {
+        uint8_t encoded[CHUNK_SEQ_ACK_LEN];
+        EXPECT_EQ(chunk_seq_write_ack(encoded, 0x1234, 0x00ABCDEF), CHUNK_SEQ_ACK_LEN);
+
+        chunk_seq_header_t header;
+        EXPECT_EQ(chunk_seq_read_header(encoded, 5, &header), 0);
+        ASSERT_EQ(chunk_seq_read_header(encoded, sizeof(encoded), &header), 1);
+        EXPECT_EQ(header.seq, 0x1234);
+        EXPECT_EQ(header.offset, 0x00ABCDEFu);
+    }
+
+    TEST(ChunkTransfer, LosslessLinkSendsEverythingOnce) {
+        std::mt19937 rng(1);
+        const auto tx = randomTx(rng, 3000);
+
+        SimDevice device;
+        LossyLink link(device, 0, 1);
+        Transport transport([&](const std::vector<uint8_t> &apdu) { return link.exchange(apdu); }, 0x55, 0x02);
+
+        Stats stats;
+        const Reply reply = transport.sendSequenced(path, tx, stats);
+        EXPECT_TRUE(reply.delivered);
+        EXPECT_EQ(reply.sw, SW_OK);
+        EXPECT_TRUE(device.complete);
+        EXPECT_EQ(device.buffer, tx);
+        EXPECT_EQ(stats.bytesSent, tx.size());
+        EXPECT_EQ(stats.bytesResent, 0u);
+    }
+
+    // Simulated flaky link: the transaction must arrive intact, and sequenced
+    // chunks resend far less than restarting the whole transfer
+    TEST(ChunkTransfer, LossyLink) {
+        std::mt19937 rng(42);
+
+        for (const double lossRate : {0.01, 0.05, 0.10}) {
+            Stats sequenced;
+            Stats legacy;
+
+            for (uint32_t round = 0; round < 30; round++) {
+                const auto tx = randomTx(rng, 500 + rng() % 12000);
+
+                SimDevice device;
+                LossyLink link(device, lossRate, round);
+                Transport transport([&](const std::vector<uint8_t> &apdu) { return link.exchange(apdu); }, 0x55, 0x02);
+                const Reply reply = transport.sendSequenced(path, tx, sequenced);
+                ASSERT_TRUE(reply.delivered || device.complete) << "loss " << lossRate << " round " << round;
+                ASSERT_TRUE(device.complete);
+                ASSERT_EQ(device.buffer, tx);
+                ASSERT_EQ(device.digest(), sha256(tx));
+
+                SimDevice legacyDevice;
+                LossyLink legacyLink(legacyDevice, lossRate, round);
+                Transport legacyTransport([&](const std::vector<uint8_t> &apdu) { return legacyLink.exchange(apdu); }, 0x55, 0x02);
+                legacyTransport.sendLegacy(path, tx, legacy);
+            }
+
+            std::cout << "loss " << lossRate
+                      << " | sequenced: " << sequenced.apdus << " apdus, " << sequenced.bytesResent << " bytes resent"
+                      << " | legacy: " << legacy.apdus << " apdus, " << legacy.bytesResent << " bytes resent"
+                      << std::endl;
+            EXPECT_LT(sequenced.bytesResent, legacy.bytesResent);
+        }
+    }
+}
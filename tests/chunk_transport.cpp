@@ -0,0 +1,132 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "chunk_transport.h"
+#include <algorithm>
+#include <chunk_seq.h>
+
+namespace chunk_transport {
+    Reply Transport::send(uint8_t p1, const std::vector<uint8_t> &payload, Stats &stats) {
+        std::vector<uint8_t> apdu = {cla, ins, p1, 0, (uint8_t) payload.size()};
+        apdu.insert(apdu.end(), payload.begin(), payload.end());
+        stats.apdus++;
+
+        Reply reply = exchange(apdu);
+        if (!reply.delivered) {
+            stats.lost++;
+        }
+        return reply;
+    }
+
+    bool Transport::sendInit(const std::vector<uint8_t> &path, Stats &stats) {
+        for (uint32_t retry = 0; retry < maxRetries; retry++) {
+            const Reply reply = send(P1_INIT, path, stats);
+            if (reply.delivered) {
+                return reply.sw == SW_OK;
+            }
+        }
+        return false;
+    }
+
+    Reply Transport::sendSequenced(const std::vector<uint8_t> &path, const std::vector<uint8_t> &tx, Stats &stats) {
+        if (!sendInit(path, stats)) {
+            return Reply();
+        }
+
+        const uint32_t chunkLen = MAX_PAYLOAD - CHUNK_SEQ_HEADER_LEN;
+        uint32_t offset = 0;
+        uint32_t sentUpTo = 0;      // everything below was sent at least once
+        uint16_t seq = 1;
+
+        for (uint32_t retry = 0; retry < maxRetries;) {
+            const uint32_t len = (uint32_t) std::min<size_t>(chunkLen, tx.size() - offset);
+            const bool isLast = offset + len == tx.size();
+
+            std::vector<uint8_t> payload(CHUNK_SEQ_HEADER_LEN);
+            // Headers and acks share the same layout
+            chunk_seq_write_ack(payload.data(), seq, offset);
+            payload.insert(payload.end(), tx.begin() + offset, tx.begin() + offset + len);
+
+            stats.bytesSent += len;
+            if (offset < sentUpTo) {
+                stats.bytesResent += std::min(sentUpTo, offset + len) - offset;
+            }
+            sentUpTo = std::max(sentUpTo, offset + len);
+
+            const Reply reply = send(isLast ? P1_SEQ_LAST : P1_SEQ_ADD, payload, stats);
+            if (!reply.delivered) {
+                // Replays are harmless, try the same chunk again
+                retry++;
+                continue;
+            }
+
+            if (isLast && reply.sw != SW_RESUME) {
+                return reply;
+            }
+
+            chunk_seq_header_t ack;
+            if ((reply.sw != SW_OK && reply.sw != SW_RESUME) ||
+                !chunk_seq_read_header(reply.data.data(), reply.data.size(), &ack) ||
+                ack.offset > tx.size()) {
+                return reply;
+            }
+
+            // Continue from whatever the device holds
+            offset = ack.offset;
+            seq++;
+        }
+
+        return Reply();
+    }
+
+    Reply Transport::sendLegacy(const std::vector<uint8_t> &path, const std::vector<uint8_t> &tx, Stats &stats) {
+        uint32_t sentUpTo = 0;
+
+        for (uint32_t retry = 0; retry < maxRetries; retry++) {
+            if (!sendInit(path, stats)) {
+                return Reply();
+            }
+
+            uint32_t offset = 0;
+            Reply reply;
+            do {
+                const uint32_t len = (uint32_t) std::min<size_t>(MAX_PAYLOAD, tx.size() - offset);
+                const bool isLast = offset + len == tx.size();
+
+                stats.bytesSent += len;
+                if (offset < sentUpTo) {
+                    stats.bytesResent += std::min(sentUpTo, offset + len) - offset;
+                }
+                sentUpTo = std::max(sentUpTo, offset + len);
+
+                reply = send(isLast ? P1_LAST : P1_ADD,
+                             std::vector<uint8_t>(tx.begin() + offset, tx.begin() + offset + len),
+                             stats);
+                offset += len;
+                if (reply.delivered && isLast) {
+                    return reply;
+                }
+            } while (reply.delivered && reply.sw == SW_OK);
+
+            if (reply.delivered) {
+                return reply;
+            }
+            // The device state is unknown, start over
+        }
+
+        return Reply();
+    }
+}
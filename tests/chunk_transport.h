@@ -0,0 +1,73 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#pragma once
+
+// Host side of the chunked transfer used by INS_SIGN_SECP256K1 (see docs/APDUSPEC.md)
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace chunk_transport {
+    const uint16_t SW_OK = 0x9000;
+    const uint16_t SW_RESUME = 0x6985;      // sequenced chunk arrived after a gap, payload is an ack
+
+    const uint8_t P1_INIT = 0;
+    const uint8_t P1_ADD = 1;
+    const uint8_t P1_LAST = 2;
+    const uint8_t P1_SEQ_ADD = 3;
+    const uint8_t P1_SEQ_LAST = 4;
+
+    const uint32_t MAX_PAYLOAD = 250;
+
+    struct Reply {
+        bool delivered = false;             // false when the request or its response was lost
+        uint16_t sw = 0;
+        std::vector<uint8_t> data;
+    };
+
+    using Exchange = std::function<Reply(const std::vector<uint8_t> &apdu)>;
+
+    struct Stats {
+        uint32_t apdus = 0;
+        uint64_t bytesSent = 0;             // transaction bytes put on the link
+        uint64_t bytesResent = 0;           // transaction bytes sent more than once
+        uint32_t lost = 0;
+    };
+
+    class Transport {
+    public:
+        Transport(Exchange exchange, uint8_t cla, uint8_t ins, uint32_t maxRetries = 1000)
+            : exchange(std::move(exchange)), cla(cla), ins(ins), maxRetries(maxRetries) {}
+
+        /// Sends path and transaction with sequenced chunks, resending only what the device is missing
+        /// Returns the reply to the last chunk (the signature)
+        Reply sendSequenced(const std::vector<uint8_t> &path, const std::vector<uint8_t> &tx, Stats &stats);
+
+        /// Original protocol: any loss restarts the transfer from the init chunk
+        Reply sendLegacy(const std::vector<uint8_t> &path, const std::vector<uint8_t> &tx, Stats &stats);
+
+    private:
+        Reply send(uint8_t p1, const std::vector<uint8_t> &payload, Stats &stats);
+        bool sendInit(const std::vector<uint8_t> &path, Stats &stats);
+
+        Exchange exchange;
+        uint8_t cla;
+        uint8_t ins;
+        uint32_t maxRetries;
+    };
+}
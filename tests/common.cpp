@@ -20,11 +20,58 @@
 #include <tx_display.h>
 #include <fmt/core.h>
 
+namespace {
+    std::string formatPage(uint8_t displayIdx, const char *key, const char *value,
+                           uint8_t pageIdx, uint8_t pageCount, parser_error_t err) {
+        std::stringstream ss;
+        ss << fmt::format("{} | {}", displayIdx, key);
+        if (pageCount > 1) {
+            ss << fmt::format(" [{}/{}]", pageIdx + 1, pageCount);
+        }
+        ss << " : ";
+
+        if (err == parser_ok) {
+            // Model multiple lines
+            ss << fmt::format("{}", value);
+        } else {
+            ss << parser_getErrorDescription(err);
+        }
+
+        auto output = ss.str();
+        if (output.back() == ' ') {
+            output = output.substr(0, output.size() - 1);
+        }
+        return output;
+    }
+
+    parser_error_t appendPage(void *user, uint8_t displayIdx, const char *key, const char *value,
+                              uint8_t pageIdx, uint8_t pageCount, parser_error_t err) {
+        auto *answer = static_cast<std::vector<std::string> *>(user);
+        answer->push_back(formatPage(displayIdx, key, value, pageIdx, pageCount, err));
+        return parser_ok;
+    }
+}
+
 std::vector<std::string> dumpUI(parser_context_t *ctx,
                                 uint16_t maxKeyLen,
                                 uint16_t maxValueLen) {
     auto answer = std::vector<std::string>();
 
+    std::vector<char> keyBuffer(maxKeyLen);
+    std::vector<char> valueBuffer(maxValueLen);
+    parser_renderAll(ctx,
+                     keyBuffer.data(), maxKeyLen,
+                     valueBuffer.data(), maxValueLen,
+                     appendPage, &answer);
+
+    return answer;
+}
+
+std::vector<std::string> dumpUIByItem(parser_context_t *ctx,
+                                      uint16_t maxKeyLen,
+                                      uint16_t maxValueLen) {
+    auto answer = std::vector<std::string>();
+
     uint8_t numItems;
     parser_error_t err = parser_getNumItems(ctx, &numItems);
     if (err != parser_ok) {
@@ -38,33 +85,12 @@ std::vector<std::string> dumpUI(parser_context_t *ctx,
         uint8_t pageCount = 1;
 
         while (pageIdx < pageCount) {
-            std::stringstream ss;
-
             err = parser_getItem(ctx,
                                  idx,
                                  keyBuffer, maxKeyLen,
                                  valueBuffer, maxValueLen,
                                  pageIdx, &pageCount);
-
-            ss << fmt::format("{} | {}", idx, keyBuffer);
-            if (pageCount > 1) {
-                ss << fmt::format(" [{}/{}]", pageIdx + 1, pageCount);
-            }
-            ss << " : ";
-
-            if (err == parser_ok) {
-                // Model multiple lines
-                ss << fmt::format("{}", valueBuffer);
-            } else {
-                ss << parser_getErrorDescription(err);
-            }
-
-            auto output = ss.str();
-            if (output.back() == ' ') {
-                output = output.substr(0, output.size() - 1);
-            }
-
-            answer.push_back(output);
+            answer.push_back(formatPage(idx, keyBuffer, valueBuffer, pageIdx, pageCount, err));
 
             pageIdx++;
         }
@@ -26,6 +26,10 @@ else FAIL() << "One of the strings is null"; }
 
 parser_error_t parse_tx(parsed_json_t *parsed_json, const char *tx);
 
+// Every page of every item, rendered with parser_renderAll
 std::vector<std::string> dumpUI(parser_context_t *ctx, uint16_t maxKeyLen, uint16_t maxValueLen);
 
+// Same as dumpUI, page by page with parser_getItem
+std::vector<std::string> dumpUIByItem(parser_context_t *ctx, uint16_t maxKeyLen, uint16_t maxValueLen);
+
 #define JSON_PARSE(parsed_json, buffer) json_parse(parsed_json, buffer, strlen(buffer))
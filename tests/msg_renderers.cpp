@@ -0,0 +1,106 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include "testcases.h"
+#include <tx_view.hpp>
+#include <app_mode.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <fmt/core.h>
+
+// Messages of known types are resolved from the token array (tx_display.c) instead of being traversed
+namespace {
+    std::vector<std::string> formatItems(secret::TxView &view) {
+        std::vector<std::string> answer;
+        for (const auto &item : view) {
+            answer.push_back(fmt::format("{} | {} [{}/{}] : {}", item.index, item.key,
+                                         item.page + 1, item.pageCount, item.value));
+        }
+        return answer;
+    }
+
+    std::vector<testcase_t> validTestcases() {
+        std::vector<testcase_t> answer;
+        for (const auto &tc : GetJsonTestCases("testcases/manual.json")) {
+            if (!tc.expert && tc.parsingErr == "No error" && tc.validationErr == "No error") {
+                answer.push_back(tc);
+            }
+        }
+        return answer;
+    }
+
+    TEST(MsgRenderers, SameItemsAsTraversal) {
+        const auto testcases = validTestcases();
+        ASSERT_FALSE(testcases.empty());
+        app_mode_set_expert(false);
+
+        secret::TxView traversed;
+        secret::TxView rendered;
+        traversed.setMsgRenderers(false);
+        for (const auto &tc : testcases) {
+            ASSERT_EQ(traversed.parse(tc.tx), secret::TxError::ok);
+            ASSERT_EQ(rendered.parse(tc.tx), secret::TxError::ok);
+            EXPECT_EQ(formatItems(rendered), formatItems(traversed)) << tc.description;
+        }
+    }
+
+    // Index time (parse, validation and indexing) and per item latency (every page of every item at
+    // 40 chars) over manual.json, with and without renderers.
+    // Timing only, not run by default: unittests --gtest_also_run_disabled_tests --gtest_filter='*Benchmark*'
+    TEST(MsgRenderers, DISABLED_Benchmark) {
+        constexpr size_t ROUNDS = 300;
+        const auto testcases = validTestcases();
+        app_mode_set_expert(false);
+
+        struct Timing {
+            double indexUs;
+            double itemUs;
+        };
+        const auto measure = [&](bool renderers) {
+            secret::TxView view;
+            view.setMsgRenderers(renderers);
+            std::chrono::steady_clock::duration indexTime{};
+            std::chrono::steady_clock::duration itemTime{};
+            size_t items = 0;
+            for (size_t round = 0; round < ROUNDS; round++) {
+                for (const auto &tc : testcases) {
+                    const auto start = std::chrono::steady_clock::now();
+                    EXPECT_EQ(view.parse(tc.tx), secret::TxError::ok);
+                    const auto indexed = std::chrono::steady_clock::now();
+                    for (const auto &item : view) {
+                        EXPECT_EQ(item.error, secret::TxError::ok);
+                    }
+                    itemTime += std::chrono::steady_clock::now() - indexed;
+                    indexTime += indexed - start;
+                    items += view.numItems();
+                }
+            }
+
+            const auto us = [](std::chrono::steady_clock::duration d) {
+                return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() / 1000.0;
+            };
+            return Timing{us(indexTime) / (double) (ROUNDS * testcases.size()), us(itemTime) / (double) items};
+        };
+
+        const Timing traversal = measure(false);
+        const Timing renderers = measure(true);
+        printf("%-10s %12s %12s\n", "", "index us/tx", "us per item");
+        printf("%-10s %12.2f %12.2f\n", "traversal", traversal.indexUs, traversal.itemUs);
+        printf("%-10s %12.2f %12.2f\n", "renderers", renderers.indexUs, renderers.itemUs);
+    }
+}
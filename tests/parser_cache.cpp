@@ -0,0 +1,133 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include <parser_cache.h>
+#include <common/parser.h>
+#include <app_mode.h>
+#include <parser_impl.h>
+#include <string>
+#include <vector>
+
+namespace {
+    const std::string sendTx = R"({"account_number":"108","chain_id":"secret-4","fee":{"amount":[{"amount":"600","denom":"uscrt"}],"gas":"200000"},"memo":"","msgs":[{"type":"cosmos-sdk/MsgSend","value":{"amount":[{"amount":"15","denom":"uscrt"}],"from_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","to_address":"secret1xz54wxqsgkvmhf2hj0g4d3w8xqjyx6ev2v2dte"}}],"sequence":"2"})";
+    const std::string otherTx = R"({"account_number":"108","chain_id":"secret-4","fee":{"amount":[{"amount":"600","denom":"uscrt"}],"gas":"200000"},"memo":"","msgs":[{"type":"cosmos-sdk/MsgSend","value":{"amount":[{"amount":"25","denom":"uscrt"}],"from_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","to_address":"secret1xz54wxqsgkvmhf2hj0g4d3w8xqjyx6ev2v2dte"}}],"sequence":"2"})";
+    const std::string delegateTx = R"({"account_number":"108","chain_id":"secret-4","fee":{"amount":[{"amount":"600","denom":"uscrt"}],"gas":"200000"},"memo":"","msgs":[{"type":"cosmos-sdk/MsgDelegate","value":{"amount":{"amount":"1000","denom":"uscrt"},"delegator_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","validator_address":"secretvaloper0"}},{"type":"cosmos-sdk/MsgDelegate","value":{"amount":{"amount":"1001","denom":"uscrt"},"delegator_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","validator_address":"secretvaloper1"}}],"sequence":"2"})";
+
+    std::vector<std::string> dumpItems(const parser_context_t *ctx) {
+        std::vector<std::string> answer;
+        uint8_t numItems = 0;
+        EXPECT_EQ(parser_getNumItems(ctx, &numItems), parser_ok);
+
+        char key[40];
+        char value[40];
+        for (uint8_t idx = 0; idx < numItems; idx++) {
+            uint8_t pageCount = 1;
+            for (uint8_t page = 0; page < pageCount; page++) {
+                EXPECT_EQ(parser_getItem(ctx, idx, key, sizeof(key), value, sizeof(value), page, &pageCount), parser_ok);
+                answer.push_back(std::string(key) + " : " + value);
+            }
+        }
+        return answer;
+    }
+
+    parser_error_t parseCached(parser_context_t *ctx, const std::string &tx, bool *cached) {
+        return parser_cache_parse(ctx, (const uint8_t *) tx.data(), tx.size(), nullptr, cached);
+    }
+
+    TEST(ParserCache, ResentPayloadIsNotParsedAgain) {
+        app_mode_set_expert(false);
+        parser_context_t ctx;
+        parser_initContext(&ctx);
+        bool cached = true;
+
+        ASSERT_EQ(parseCached(&ctx, sendTx, &cached), parser_ok);
+        EXPECT_FALSE(cached);
+        const std::vector<std::string> expected = dumpItems(&ctx);
+
+        // Same bytes at another address, as a retry would deliver them
+        const std::string resent = sendTx;
+        ASSERT_EQ(parseCached(&ctx, resent, &cached), parser_ok);
+        EXPECT_TRUE(cached);
+        EXPECT_EQ(ctx.buffer, (const uint8_t *) resent.data());
+        EXPECT_EQ(dumpItems(&ctx), expected);
+    }
+
+    TEST(ParserCache, DifferentPayloadOrModeIsParsed) {
+        app_mode_set_expert(false);
+        parser_context_t ctx;
+        parser_initContext(&ctx);
+        bool cached = true;
+
+        ASSERT_EQ(parseCached(&ctx, sendTx, &cached), parser_ok);
+        ASSERT_EQ(parseCached(&ctx, otherTx, &cached), parser_ok);
+        EXPECT_FALSE(cached);
+        ASSERT_EQ(parseCached(&ctx, otherTx, &cached), parser_ok);
+        EXPECT_TRUE(cached);
+
+        app_mode_set_expert(true);
+        ASSERT_EQ(parseCached(&ctx, otherTx, &cached), parser_ok);
+        EXPECT_FALSE(cached);
+        app_mode_set_expert(false);
+    }
+
+    TEST(ParserCache, DifferentSignerIsParsed) {
+        app_mode_set_expert(false);
+        parser_context_t ctx;
+        parser_initContext(&ctx);
+        bool cached = true;
+
+        // Delegations from the signer are grouped, so the delegator is not shown
+        parser_tx_obj.own_addr = "secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h";
+        ASSERT_EQ(parseCached(&ctx, delegateTx, &cached), parser_ok);
+        const std::vector<std::string> own = dumpItems(&ctx);
+
+        parser_tx_obj.own_addr = "secret1xz54wxqsgkvmhf2hj0g4d3w8xqjyx6ev2v2dte";
+        ASSERT_EQ(parseCached(&ctx, delegateTx, &cached), parser_ok);
+        EXPECT_FALSE(cached);
+        const std::vector<std::string> other = dumpItems(&ctx);
+        EXPECT_NE(other, own);
+
+        parser_tx_obj.own_addr = nullptr;
+        ASSERT_EQ(parseCached(&ctx, delegateTx, &cached), parser_ok);
+        EXPECT_FALSE(cached);
+        EXPECT_EQ(dumpItems(&ctx), other);
+    }
+
+    TEST(ParserCache, InvalidatedByOtherParses) {
+        app_mode_set_expert(false);
+        parser_context_t ctx;
+        parser_initContext(&ctx);
+        bool cached = true;
+
+        ASSERT_EQ(parseCached(&ctx, sendTx, &cached), parser_ok);
+        ASSERT_EQ(parser_parse(&ctx, (const uint8_t *) otherTx.data(), otherTx.size()), parser_ok);
+        ASSERT_EQ(parseCached(&ctx, sendTx, &cached), parser_ok);
+        EXPECT_FALSE(cached);
+    }
+
+    TEST(ParserCache, FailuresAreNotCached) {
+        app_mode_set_expert(false);
+        parser_context_t ctx;
+        parser_initContext(&ctx);
+        bool cached = true;
+
+        const std::string unsorted = R"({"chain_id":"secret-4","account_number":"108","fee":{"amount":[],"gas":"1"},"memo":"","msgs":[],"sequence":"2"})";
+        EXPECT_NE(parseCached(&ctx, unsorted, &cached), parser_ok);
+        EXPECT_NE(parseCached(&ctx, unsorted, &cached), parser_ok);
+        EXPECT_FALSE(cached);
+    }
+}
@@ -0,0 +1,163 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include "testcases.h"
+#include "common.h"
+#include <common/parser.h>
+#include <parser_cache.h>
+#include <app_mode.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Meant to be run under ThreadSanitizer as well: -DENABLE_TSAN=ON, then ctest -R parser_concurrency
+namespace {
+    constexpr size_t NUM_THREADS = 8;
+    constexpr size_t NUM_ROUNDS = 4;
+
+    // Parses, validates and renders a testcase in its own state. Returns false on any mismatch
+    bool check_in_state(parser_state_t *state, const testcase_t &tc) {
+        parser_context_t ctx;
+        parser_bindState(&ctx, state);
+
+        const auto *buffer = (const uint8_t *) tc.tx.c_str();
+        parser_error_t err = parser_parse(&ctx, buffer, tc.tx.size());
+        if (parser_getErrorDescription(err) != tc.parsingErr) {
+            return false;
+        }
+        if (err != parser_ok) {
+            return true;
+        }
+
+        err = parser_validate(&ctx);
+        if (parser_getErrorDescription(err) != tc.validationErr) {
+            return false;
+        }
+
+        // Second pass goes through the per-state parser cache
+        bool cached = false;
+        err = parser_cache_parse(&ctx, buffer, tc.tx.size(), nullptr, &cached);
+        if (err == parser_ok) {
+            parser_cache_parse(&ctx, buffer, tc.tx.size(), nullptr, &cached);
+            if (!cached) {
+                return false;
+            }
+        }
+
+        return dumpUI(&ctx, 40, 40) == tc.expected;
+    }
+
+    void check_concurrently(bool expert) {
+        std::vector<testcase_t> testcases;
+        for (const auto &tc : GetJsonTestCases("testcases/manual.json")) {
+            if (tc.expert == expert) {
+                testcases.push_back(tc);
+            }
+        }
+        ASSERT_FALSE(testcases.empty());
+
+        // The mode is read by all threads, only set it while none is running
+        app_mode_set_expert(expert);
+
+        std::atomic<uint32_t> mismatches{0};
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < NUM_THREADS; t++) {
+            threads.emplace_back([&, t]() {
+                auto state = std::make_unique<parser_state_t>();
+                for (size_t round = 0; round < NUM_ROUNDS; round++) {
+                    for (size_t i = 0; i < testcases.size(); i++) {
+                        // Threads walk the corpus from different offsets
+                        const auto &tc = testcases[(i + t * testcases.size() / NUM_THREADS) % testcases.size()];
+                        if (!check_in_state(state.get(), tc)) {
+                            mismatches++;
+                        }
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        EXPECT_EQ(mismatches.load(), 0u);
+    }
+
+    TEST(ParserConcurrency, CorpusInParallel) {
+        check_concurrently(false);
+    }
+
+    TEST(ParserConcurrency, CorpusInParallelExpert) {
+        check_concurrently(true);
+    }
+
+    TEST(ParserConcurrency, StatesAreIndependent) {
+        const auto testcases = GetJsonTestCases("testcases/manual.json");
+        const testcase_t *first = nullptr;
+        const testcase_t *second = nullptr;
+        for (const auto &tc : testcases) {
+            if (tc.expert || tc.parsingErr != "No error" || tc.validationErr != "No error") {
+                continue;
+            }
+            if (first == nullptr) {
+                first = &tc;
+            } else if (tc.expected != first->expected) {
+                second = &tc;
+                break;
+            }
+        }
+        ASSERT_NE(first, nullptr);
+        ASSERT_NE(second, nullptr);
+        app_mode_set_expert(false);
+
+        auto stateA = std::make_unique<parser_state_t>();
+        auto stateB = std::make_unique<parser_state_t>();
+        parser_context_t ctxA;
+        parser_context_t ctxB;
+        parser_bindState(&ctxA, stateA.get());
+        parser_bindState(&ctxB, stateB.get());
+
+        ASSERT_EQ(parser_parse(&ctxA, (const uint8_t *) first->tx.c_str(), first->tx.size()), parser_ok);
+        ASSERT_EQ(parser_parse(&ctxB, (const uint8_t *) second->tx.c_str(), second->tx.size()), parser_ok);
+
+        // Interleaved use does not leak tokens or display cache between contexts
+        EXPECT_EQ(dumpUI(&ctxA, 40, 40), first->expected);
+        EXPECT_EQ(dumpUI(&ctxB, 40, 40), second->expected);
+        EXPECT_EQ(dumpUI(&ctxA, 40, 40), first->expected);
+    }
+
+    // A context used before being bound to a parsing state is refused
+    TEST(ParserConcurrency, UnboundContext) {
+        const std::string tx = R"({"account_number":"108","chain_id":"secret-4","fee":{"amount":[],"gas":"1"},"memo":"","msgs":[],"sequence":"2"})";
+        parser_context_t ctx = {};
+        uint8_t numItems = 1;
+        uint8_t pageCount = 0;
+        char key[40];
+        char value[40];
+
+        EXPECT_EQ(parser_parse(&ctx, (const uint8_t *) tx.c_str(), tx.size()), parser_init_context_empty);
+        EXPECT_EQ(parser_cache_parse(&ctx, (const uint8_t *) tx.c_str(), tx.size(), nullptr, nullptr),
+                  parser_init_context_empty);
+        EXPECT_EQ(parser_validate(&ctx), parser_init_context_empty);
+        EXPECT_EQ(parser_getNumItems(&ctx, &numItems), parser_init_context_empty);
+        EXPECT_EQ(numItems, 0);
+        EXPECT_EQ(parser_getItem(&ctx, 0, key, sizeof(key), value, sizeof(value), 0, &pageCount),
+                  parser_init_context_empty);
+        parser_setMode(&ctx, parser_mode_expert);
+        EXPECT_EQ(ctx.tx_obj, nullptr);
+    }
+}
@@ -0,0 +1,101 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#include <proto/proto_reader.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace proto_encode {
+// Minimal protobuf encoder, enough to write sign docs by hand
+inline std::string varint(uint64_t value) {
+    std::string out;
+    do {
+        uint8_t b = value & 0x7Fu;
+        value >>= 7u;
+        if (value != 0) {
+            b |= 0x80u;
+        }
+        out.push_back((char) b);
+    } while (value != 0);
+    return out;
+}
+
+inline std::string tag(uint32_t number, uint8_t wireType) {
+    return varint(((uint64_t) number << 3u) | wireType);
+}
+
+inline std::string bytes(uint32_t number, const std::string &value) {
+    return tag(number, PROTO_WIRE_LEN) + varint(value.size()) + value;
+}
+
+inline std::string uint(uint32_t number, uint64_t value) {
+    return tag(number, PROTO_WIRE_VARINT) + varint(value);
+}
+
+inline std::string coin(const std::string &amount, const std::string &denom) {
+    return bytes(1, denom) + bytes(2, amount);
+}
+
+inline std::string any(const std::string &typeUrl, const std::string &value) {
+    return bytes(1, typeUrl) + bytes(2, value);
+}
+
+inline std::string msgSend(const std::string &from, const std::string &to, const std::string &amount) {
+    return any("/cosmos.bank.v1beta1.MsgSend",
+               bytes(1, from) + bytes(2, to) + bytes(3, coin(amount, "uscrt")));
+}
+
+inline std::string msgDelegate(const std::string &from, const std::string &to, const std::string &amount) {
+    return any("/cosmos.staking.v1beta1.MsgDelegate",
+               bytes(1, from) + bytes(2, to) + bytes(3, coin(amount, "uscrt")));
+}
+
+struct SignDoc {
+    std::vector<std::string> msgs;
+    std::string memo;
+    std::string chainId = "secret-4";
+    uint64_t accountNumber = 108;
+    uint64_t sequence = 2;
+    std::string fee = bytes(1, coin("600", "uscrt")) + uint(2, 200000);
+    std::string tip;
+    std::string extraBody;
+    std::string extraAuthInfo;
+
+    std::string encode() const {
+        std::string body;
+        for (const auto &msg : msgs) {
+            body += bytes(1, msg);
+        }
+        if (!memo.empty()) {
+            body += bytes(2, memo);
+        }
+        body += extraBody;
+
+        const std::string publicKey = any("/cosmos.crypto.secp256k1.PubKey", bytes(1, std::string(33, '\x02')));
+        const std::string modeInfo = bytes(1, uint(1, 1));
+        const std::string signer = bytes(1, publicKey) + bytes(2, modeInfo) + uint(3, sequence);
+        std::string authInfo = bytes(1, signer) + bytes(2, fee);
+        if (!tip.empty()) {
+            authInfo += bytes(3, tip);
+        }
+        authInfo += extraAuthInfo;
+
+        return bytes(1, body) + bytes(2, authInfo) + bytes(3, chainId) + uint(4, accountNumber);
+    }
+};
+}
@@ -0,0 +1,98 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include <ram_arena.h>
+#include <parser_cache.h>
+#include <common/parser.h>
+#include <parser_impl.h>
+#include <app_mode.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+    const std::string sendTx = R"({"account_number":"108","chain_id":"secret-4","fee":{"amount":[{"amount":"600","denom":"uscrt"}],"gas":"200000"},"memo":"","msgs":[{"type":"cosmos-sdk/MsgSend","value":{"amount":[{"amount":"15","denom":"uscrt"}],"from_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","to_address":"secret1xz54wxqsgkvmhf2hj0g4d3w8xqjyx6ev2v2dte"}}],"sequence":"2"})";
+
+    std::vector<std::string> dumpItems(const parser_context_t *ctx) {
+        std::vector<std::string> answer;
+        uint8_t numItems = 0;
+        EXPECT_EQ(parser_getNumItems(ctx, &numItems), parser_ok);
+
+        char key[40];
+        char value[40];
+        for (uint8_t idx = 0; idx < numItems; idx++) {
+            uint8_t pageCount = 1;
+            for (uint8_t page = 0; page < pageCount; page++) {
+                EXPECT_EQ(parser_getItem(ctx, idx, key, sizeof(key), value, sizeof(value), page, &pageCount), parser_ok);
+                answer.push_back(std::string(key) + " : " + value);
+            }
+        }
+        return answer;
+    }
+
+    TEST(RamArena, Report) {
+        printf("%-8s %6s\n", "phase", "bytes");
+        printf("%-8s %6zu\n", "ingest", ram_arena_phase_size(ram_arena_ingest));
+        printf("%-8s %6zu\n", "review", ram_arena_phase_size(ram_arena_review));
+        printf("%-8s %6zu (budget %d)\n", "arena", sizeof(ram_arena_t), RAM_ARENA_BUDGET);
+
+        // The largest phase, up to alignment
+        const size_t largest = std::max(ram_arena_phase_size(ram_arena_ingest), ram_arena_phase_size(ram_arena_review));
+        EXPECT_GE(sizeof(ram_arena_t), largest);
+        EXPECT_LT(sizeof(ram_arena_t), largest + alignof(ram_arena_t));
+    }
+
+    TEST(RamArena, DisplayCacheIsRebuiltAfterIngest) {
+        app_mode_set_expert(false);
+        parser_context_t ctx;
+        parser_initContext(&ctx);
+        bool cached = false;
+
+        // As tx_parse does
+        ram_arena_enter(ram_arena_review);
+        ASSERT_EQ(parser_cache_parse(&ctx, (const uint8_t *) sendTx.data(), sendTx.size(), nullptr, &cached), parser_ok);
+        const std::vector<std::string> expected = dumpItems(&ctx);
+
+        // The same transaction is received again, reusing the display cache memory
+        ram_arena_enter(ram_arena_ingest);
+        memset(&ram_arena, 0xA5, sizeof(ram_arena));
+
+        ram_arena_enter(ram_arena_review);
+        ASSERT_EQ(parser_cache_parse(&ctx, (const uint8_t *) sendTx.data(), sendTx.size(), nullptr, &cached), parser_ok);
+        EXPECT_TRUE(cached);
+        EXPECT_EQ(dumpItems(&ctx), expected);
+    }
+
+    TEST(RamArena, ReadingStateKeepsIngest) {
+        parser_context_t ctx;
+        parser_initContext(&ctx);
+
+        ram_arena_enter(ram_arena_ingest);
+        memset(&ram_arena.ingest, 0x5A, sizeof(ram_arena.ingest));
+        const std::vector<uint8_t> ingest((const uint8_t *) &ram_arena.ingest,
+                                          (const uint8_t *) &ram_arena.ingest + sizeof(ram_arena.ingest));
+
+        // Only tx_parse moves on to the review phase
+        parser_setFormat(&ctx, parser_format_amino_json);
+        EXPECT_NE(parser_getTx(&ctx), nullptr);
+        EXPECT_EQ(ram_arena_phase(), ram_arena_ingest);
+        EXPECT_EQ(std::vector<uint8_t>((const uint8_t *) &ram_arena.ingest,
+                                       (const uint8_t *) &ram_arena.ingest + sizeof(ram_arena.ingest)), ingest);
+        ram_arena_enter(ram_arena_review);
+    }
+}
@@ -0,0 +1,80 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include <sha256.h>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    std::string toHex(const uint8_t *digest) {
+        static const char hexChars[] = "0123456789abcdef";
+        std::string answer;
+        for (uint8_t i = 0; i < SHA256_DIGEST_SIZE; i++) {
+            answer += hexChars[digest[i] >> 4u];
+            answer += hexChars[digest[i] & 0x0Fu];
+        }
+        return answer;
+    }
+
+    std::string oneShot(const std::string &data) {
+        uint8_t digest[SHA256_DIGEST_SIZE];
+        sha256_digest((const uint8_t *) data.data(), data.size(), digest);
+        return toHex(digest);
+    }
+
+    TEST(SHA256, KnownVectors) {
+        EXPECT_EQ(oneShot(""), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        EXPECT_EQ(oneShot("abc"), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        EXPECT_EQ(oneShot("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+                  "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    }
+
+    // Transactions are hashed chunk by chunk as they are received (see tx_append)
+    TEST(SHA256, StreamedMatchesOneShot) {
+        std::mt19937 rng(1234);
+
+        for (uint32_t round = 0; round < 200; round++) {
+            const size_t dataLen = rng() % 4096;
+            std::vector<uint8_t> data(dataLen);
+            for (auto &b : data) {
+                b = (uint8_t) rng();
+            }
+
+            uint8_t expected[SHA256_DIGEST_SIZE];
+            sha256_digest(data.data(), data.size(), expected);
+
+            sha256_ctx_t ctx;
+            sha256_init(&ctx);
+            size_t offset = 0;
+            while (offset < dataLen) {
+                // APDU payloads are at most 250 bytes, empty chunks are allowed
+                size_t chunkLen = rng() % 251;
+                if (chunkLen > dataLen - offset) {
+                    chunkLen = dataLen - offset;
+                }
+                sha256_update(&ctx, data.data() + offset, chunkLen);
+                offset += chunkLen;
+            }
+
+            uint8_t streamed[SHA256_DIGEST_SIZE];
+            sha256_final(&ctx, streamed);
+
+            EXPECT_EQ(toHex(streamed), toHex(expected)) << "round " << round << " length " << dataLen;
+        }
+    }
+}
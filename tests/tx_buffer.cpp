@@ -0,0 +1,204 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include <tx_buffer.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+    struct target_t {
+        const char *name;
+        uint32_t ramSize;
+        uint32_t flashSize;
+        uint32_t pageSize;
+    };
+
+    // Same sizes as tx.c
+    const target_t targets[] = {
+        {"nanos", 256, 8192, 64},
+        {"nanox/nanos2", 8192, 16384, 512},
+    };
+
+    const uint32_t CHUNK_LEN = 250;
+
+    // Simulated flash, every page touched by a write is one page write
+    std::vector<uint8_t> flash;
+    uint32_t pageSize = 0;
+    uint32_t pageWrites = 0;
+
+    void flashWrite(uint8_t *dst, const uint8_t *src, uint32_t len) {
+        if (len == 0) {
+            return;
+        }
+        const uint32_t offset = dst - flash.data();
+        ASSERT_LE(offset + len, flash.size());
+        pageWrites += (offset + len - 1) / pageSize - offset / pageSize + 1;
+        memcpy(dst, src, len);
+    }
+
+    void resetFlash(const target_t &target) {
+        flash.assign(target.flashSize, 0);
+        pageSize = target.pageSize;
+        pageWrites = 0;
+    }
+
+    std::vector<uint8_t> makeTx(uint32_t len) {
+        std::vector<uint8_t> tx(len);
+        for (uint32_t i = 0; i < len; i++) {
+            tx[i] = (uint8_t) (i * 31 + i / 7);
+        }
+        return tx;
+    }
+
+    // Appends the transaction in chunks and reads it back, as the app does
+    uint32_t pageWritesFor(const target_t &target, uint32_t txLen) {
+        resetFlash(target);
+        std::vector<uint8_t> ram(target.ramSize);
+        tx_buffer_t b;
+        tx_buffer_init(&b, ram.data(), ram.size(), flash.data(), flash.size(), target.pageSize, flashWrite);
+
+        const std::vector<uint8_t> tx = makeTx(txLen);
+        for (uint32_t offset = 0; offset < txLen; offset += CHUNK_LEN) {
+            const uint32_t len = std::min(CHUNK_LEN, txLen - offset);
+            EXPECT_EQ(tx_buffer_append(&b, tx.data() + offset, len), len);
+        }
+        EXPECT_EQ(memcmp(tx_buffer_data(&b), tx.data(), txLen), 0);
+        return pageWrites;
+    }
+
+    // Previous strategy: RAM until a chunk does not fit, then the RAM contents
+    // and every following chunk are written to flash as they arrive
+    uint32_t previousPageWritesFor(const target_t &target, uint32_t txLen) {
+        resetFlash(target);
+        uint32_t ramLen = 0;
+        uint32_t flashLen = 0;
+        bool inRam = true;
+
+        const std::vector<uint8_t> tx = makeTx(txLen);
+        for (uint32_t offset = 0; offset < txLen; offset += CHUNK_LEN) {
+            const uint32_t len = std::min(CHUNK_LEN, txLen - offset);
+            if (inRam && ramLen + len <= target.ramSize) {
+                ramLen += len;
+                continue;
+            }
+            if (inRam) {
+                inRam = false;
+                flashWrite(flash.data(), tx.data(), ramLen);
+                flashLen = ramLen;
+            }
+            flashWrite(flash.data() + flashLen, tx.data() + offset, len);
+            flashLen += len;
+        }
+        return pageWrites;
+    }
+
+    TEST(TxBuffer, PageWritesReport) {
+        for (const auto &target: targets) {
+            printf("%-14s %8s %10s %10s\n", target.name, "tx size", "previous", "now");
+            for (const uint32_t txLen : {200u, 1000u, 4000u, 8000u, 8192u, 12000u, 16000u}) {
+                if (txLen > target.flashSize) {
+                    continue;
+                }
+                const uint32_t previous = previousPageWritesFor(target, txLen);
+                const uint32_t now = pageWritesFor(target, txLen);
+                printf("%-14s %8u %10u %10u\n", "", txLen, previous, now);
+
+                EXPECT_LE(now, previous) << target.name << " " << txLen;
+                if (txLen <= target.ramSize) {
+                    EXPECT_EQ(now, 0u) << target.name << " " << txLen;
+                }
+            }
+        }
+    }
+
+    TEST(TxBuffer, BytesReadableWhileReceiving) {
+        for (const auto &target: targets) {
+            resetFlash(target);
+            std::vector<uint8_t> ram(target.ramSize);
+            tx_buffer_t b;
+            tx_buffer_init(&b, ram.data(), ram.size(), flash.data(), flash.size(), target.pageSize, flashWrite);
+
+            // Odd chunk sizes, so flushes are not aligned with chunks
+            const std::vector<uint8_t> tx = makeTx(target.flashSize);
+            uint32_t offset = 0;
+            for (uint32_t chunk = 1; offset < tx.size(); chunk = chunk % 251 + 37) {
+                const uint32_t len = std::min<uint32_t>(chunk, tx.size() - offset);
+                ASSERT_EQ(tx_buffer_append(&b, tx.data() + offset, len), len);
+                offset += len;
+                ASSERT_EQ(b.len, offset);
+                for (const uint32_t i : {0u, offset / 2, offset - len, offset - 1}) {
+                    ASSERT_EQ(tx_buffer_byte(&b, i), tx[i]) << target.name << " " << i;
+                }
+            }
+
+            // Full, nothing else fits
+            const uint8_t extra = 0;
+            EXPECT_EQ(tx_buffer_append(&b, &extra, 1), 0u);
+            EXPECT_EQ(memcmp(tx_buffer_data(&b), tx.data(), tx.size()), 0);
+        }
+    }
+
+    TEST(TxBuffer, RangeOnlyWritesWhatItSpans) {
+        const target_t &target = targets[1];
+        resetFlash(target);
+        std::vector<uint8_t> ram(target.ramSize);
+        tx_buffer_t b;
+        tx_buffer_init(&b, ram.data(), ram.size(), flash.data(), flash.size(), target.pageSize, flashWrite);
+
+        const std::vector<uint8_t> tx = makeTx(target.ramSize + 1000);
+        ASSERT_EQ(tx_buffer_append(&b, tx.data(), target.ramSize), target.ramSize);
+        ASSERT_EQ(tx_buffer_append(&b, tx.data() + target.ramSize, 1000), 1000u);
+        const uint32_t flashLen = b.flashLen;
+        ASSERT_GT(flashLen, 0u);
+        ASSERT_LT(flashLen, b.len);
+        pageWrites = 0;
+
+        // Already in flash, or still in RAM: nothing is written
+        EXPECT_EQ(memcmp(tx_buffer_range(&b, 0, 100), tx.data(), 100), 0);
+        EXPECT_EQ(memcmp(tx_buffer_range(&b, flashLen + 10, 200), tx.data() + flashLen + 10, 200), 0);
+        EXPECT_EQ(pageWrites, 0u);
+        EXPECT_EQ(b.flashLen, flashLen);
+
+        // Split range: written up to its end, the rest stays in RAM
+        EXPECT_EQ(memcmp(tx_buffer_range(&b, flashLen - 10, 20), tx.data() + flashLen - 10, 20), 0);
+        EXPECT_EQ(b.flashLen, flashLen + 10);
+        EXPECT_EQ(pageWrites, 1u);
+        EXPECT_EQ(memcmp(tx_buffer_data(&b), tx.data(), tx.size()), 0);
+    }
+
+    TEST(TxBuffer, AppendAfterReading) {
+        const target_t &target = targets[0];
+        resetFlash(target);
+        std::vector<uint8_t> ram(target.ramSize);
+        tx_buffer_t b;
+        tx_buffer_init(&b, ram.data(), ram.size(), flash.data(), flash.size(), target.pageSize, flashWrite);
+
+        const std::vector<uint8_t> tx = makeTx(1000);
+        ASSERT_EQ(tx_buffer_append(&b, tx.data(), 600), 600u);
+        EXPECT_EQ(memcmp(tx_buffer_data(&b), tx.data(), 600), 0);
+        ASSERT_EQ(tx_buffer_append(&b, tx.data() + 600, 400), 400u);
+        EXPECT_EQ(memcmp(tx_buffer_data(&b), tx.data(), 1000), 0);
+
+        // Back to RAM after a reset
+        tx_buffer_reset(&b);
+        pageWrites = 0;
+        ASSERT_EQ(tx_buffer_append(&b, tx.data(), 100), 100u);
+        EXPECT_EQ(tx_buffer_data(&b), ram.data());
+        EXPECT_EQ(pageWrites, 0u);
+    }
+}
@@ -0,0 +1,78 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "tx_compress.h"
+#include <cstring>
+#include <tx_decompress.h>
+
+namespace tx_compress {
+    std::vector<uint8_t> compress(const std::string &tx) {
+        std::vector<std::string> dict;
+        for (uint8_t i = 0; decompress_dict_entry(i) != nullptr; i++) {
+            dict.emplace_back(decompress_dict_entry(i));
+        }
+
+        std::vector<uint8_t> answer;
+        size_t pos = 0;
+        while (pos < tx.size()) {
+            // Bytes saved by the best dictionary entry and by the longest copy
+            size_t dictLen = 0;
+            uint8_t dictIdx = 0;
+            for (size_t i = 0; i < dict.size(); i++) {
+                if (dict[i].size() > dictLen && tx.compare(pos, dict[i].size(), dict[i]) == 0) {
+                    dictLen = dict[i].size();
+                    dictIdx = (uint8_t) i;
+                }
+            }
+
+            size_t copyLen = 0;
+            size_t copyDist = 0;
+            const size_t maxLen = std::min<size_t>(DECOMPRESS_COPY_MAX_LEN, tx.size() - pos);
+            const size_t start = pos > DECOMPRESS_COPY_MAX_DIST ? pos - DECOMPRESS_COPY_MAX_DIST : 0;
+            for (size_t from = start; from < pos; from++) {
+                size_t len = 0;
+                while (len < maxLen && tx[from + len] == tx[pos + len]) {
+                    len++;
+                }
+                if (len >= copyLen) {
+                    // Prefer the closest match
+                    copyLen = len;
+                    copyDist = pos - from;
+                }
+            }
+
+            const size_t dictGain = dictLen > 1 ? dictLen - 1 : 0;
+            const size_t copyGain = copyLen >= DECOMPRESS_COPY_MIN_LEN ? copyLen - 3 : 0;
+
+            if (copyGain > 0 && copyGain >= dictGain) {
+                answer.push_back((uint8_t) (DECOMPRESS_TOKEN_COPY + copyLen - DECOMPRESS_COPY_MIN_LEN));
+                answer.push_back((uint8_t) (copyDist >> 8u));
+                answer.push_back((uint8_t) copyDist);
+                pos += copyLen;
+            } else if (dictGain > 0) {
+                answer.push_back((uint8_t) (DECOMPRESS_TOKEN_DICT + dictIdx));
+                pos += dictLen;
+            } else {
+                const auto c = (uint8_t) tx[pos++];
+                if (c >= DECOMPRESS_TOKEN_DICT) {
+                    answer.push_back(DECOMPRESS_TOKEN_ESCAPE);
+                }
+                answer.push_back(c);
+            }
+        }
+        return answer;
+    }
+}
@@ -0,0 +1,28 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#pragma once
+
+// Host side encoder for compressed INS_SIGN_SECP256K1 payloads (see app/src/tx_decompress.h)
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tx_compress {
+    /// Greedy encoder: at every position emits the token that saves the most bytes
+    std::vector<uint8_t> compress(const std::string &tx);
+}
@@ -0,0 +1,121 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include <tx_decompress.h>
+#include <iostream>
+#include <random>
+#include "testcases.h"
+#include "tx_compress.h"
+
+namespace {
+    // Stands in for the transaction buffer
+    std::vector<uint8_t> txBuffer;
+    uint32_t txCapacity = 0;
+
+    uint32_t appendTx(unsigned char *data, uint32_t length) {
+        const uint32_t added = std::min<uint32_t>(length, txCapacity - txBuffer.size());
+        txBuffer.insert(txBuffer.end(), data, data + added);
+        return added;
+    }
+
+    uint8_t readTx(uint32_t offset) {
+        return txBuffer[offset];
+    }
+
+    decompress_error_e decompress(const std::vector<uint8_t> &compressed, size_t chunkLen, uint32_t capacity = 16384) {
+        txBuffer.clear();
+        txBuffer.reserve(capacity);
+        txCapacity = capacity;
+
+        decompress_ctx_t ctx;
+        decompress_init(&ctx);
+        for (size_t offset = 0; offset < compressed.size(); offset += chunkLen) {
+            const size_t len = std::min(chunkLen, compressed.size() - offset);
+            const decompress_error_e err = decompress_chunk(&ctx, compressed.data() + offset, len, readTx, appendTx);
+            if (err != decompress_ok) {
+                return err;
+            }
+        }
+        return decompress_is_complete(&ctx) ? decompress_ok : decompress_invalid_token;
+    }
+
+    std::string decoded() {
+        return std::string(txBuffer.begin(), txBuffer.end());
+    }
+
+    TEST(Decompress, Tokens) {
+        // literal, dictionary entry, overlapping copy, escaped literal
+        const std::vector<uint8_t> compressed = {'a', 'b', DECOMPRESS_TOKEN_DICT + 20, DECOMPRESS_TOKEN_COPY + 2, 0, 2, 0xFF, 0xC3};
+        ASSERT_EQ(decompress(compressed, 1), decompress_ok);
+        EXPECT_EQ(decoded(), "absecret1t1t1t1\xC3");
+    }
+
+    TEST(Decompress, InvalidStreams) {
+        EXPECT_EQ(decompress({'a', DECOMPRESS_TOKEN_COPY, 0, 2}, 250), decompress_invalid_distance);
+        EXPECT_EQ(decompress({'a', DECOMPRESS_TOKEN_COPY, 0, 0}, 250), decompress_invalid_distance);
+        EXPECT_EQ(decompress({DECOMPRESS_TOKEN_COPY - 1}, 250), decompress_invalid_token);
+        EXPECT_EQ(decompress({'a', DECOMPRESS_TOKEN_COPY, 0}, 250), decompress_invalid_token);
+        EXPECT_EQ(decompress({'a', 'b', 'c', DECOMPRESS_TOKEN_DICT}, 250, 3), decompress_output_full);
+    }
+
+    // Compression ratio and APDU count over the UI test corpus
+    TEST(Decompress, Corpus) {
+        const auto testcases = GetJsonTestCases("testcases/manual.json");
+        const size_t chunkLen = 250;
+
+        size_t plainBytes = 0;
+        size_t compressedBytes = 0;
+        size_t plainApdus = 0;
+        size_t compressedApdus = 0;
+
+        for (const auto &tc : testcases) {
+            const auto compressed = tx_compress::compress(tc.tx);
+
+            // Chunk boundaries must not matter
+            for (const size_t len : {chunkLen, (size_t) 1, (size_t) 7}) {
+                ASSERT_EQ(decompress(compressed, len), decompress_ok) << tc.description;
+                ASSERT_EQ(decoded(), tc.tx) << tc.description;
+            }
+
+            plainBytes += tc.tx.size();
+            compressedBytes += compressed.size();
+            plainApdus += 1 + (tc.tx.size() + chunkLen - 1) / chunkLen;
+            compressedApdus += 1 + (compressed.size() + chunkLen - 1) / chunkLen;
+        }
+
+        std::cout << testcases.size() << " txs | "
+                  << plainBytes << " -> " << compressedBytes << " bytes ("
+                  << 100 * compressedBytes / plainBytes << "%) | "
+                  << plainApdus << " -> " << compressedApdus << " apdus" << std::endl;
+        EXPECT_LT(compressedBytes, plainBytes / 2);
+    }
+
+    TEST(Decompress, RandomRoundTrip) {
+        std::mt19937 rng(7);
+        for (uint32_t round = 0; round < 30; round++) {
+            std::string tx;
+            const size_t len = rng() % 3000;
+            for (size_t i = 0; i < len; i++) {
+                // Small alphabet, so copies are frequent, and some non ASCII bytes
+                tx += (char) (rng() % 8 == 0 ? 0x80 + rng() % 0x80 : 'a' + rng() % 4);
+            }
+            const auto compressed = tx_compress::compress(tx);
+            ASSERT_EQ(decompress(compressed, 1 + rng() % 250), decompress_ok);
+            ASSERT_EQ(decoded(), tx) << "round " << round;
+        }
+    }
+}
@@ -26,13 +26,13 @@ namespace {
 #pragma ide diagnostic ignored "ConstantParameter"
     parser_error_t tx_traverse(int16_t root_token_index, uint8_t *numChunks) {
         uint16_t ret_value_token_index = 0;
-        parser_error_t err = tx_traverse_find(root_token_index, &ret_value_token_index);
+        parser_error_t err = tx_traverse_find(&parser_tx_obj, root_token_index, &ret_value_token_index);
 
         if (err != parser_ok){
             return err;
         }
 
-        return tx_getToken(ret_value_token_index,
+        return tx_getToken(&parser_tx_obj, ret_value_token_index,
                            parser_tx_obj.query.out_val, parser_tx_obj.query.out_val_len,
                            parser_tx_obj.query.page_index, numChunks);
     }
@@ -59,7 +59,7 @@ namespace {
         uint8_t numChunks;
 
         // Try second key - first chunk
-        INIT_QUERY_CONTEXT(key, sizeof(key), val, sizeof(val), 0, 4)
+        INIT_QUERY_CONTEXT(&parser_tx_obj, key, sizeof(key), val, sizeof(val), 0, 4)
         parser_tx_obj.query.item_index = 1;
 
         err = tx_traverse(0, &numChunks);
@@ -69,14 +69,14 @@ namespace {
         EXPECT_EQ_STR(val, "abcdefg", "Incorrect value")
 
         // Try second key - Second chunk
-        INIT_QUERY_CONTEXT(key, sizeof(key), val, sizeof(val), 1, 4)
+        INIT_QUERY_CONTEXT(&parser_tx_obj, key, sizeof(key), val, sizeof(val), 1, 4)
         parser_tx_obj.query.item_index = 1;
         err = tx_traverse(0, &numChunks);
         EXPECT_EQ(err, parser_display_page_out_of_range) << parser_getErrorDescription(err);
         EXPECT_EQ(numChunks, 1) << "Incorrect number of chunks";
 
         // Find first key
-        INIT_QUERY_CONTEXT(key, sizeof(key), val, sizeof(val), 0, 4)
+        INIT_QUERY_CONTEXT(&parser_tx_obj, key, sizeof(key), val, sizeof(val), 0, 4)
         parser_tx_obj.query.item_index = 0;
         err = tx_traverse(0, &numChunks);
         EXPECT_EQ(err, parser_ok) << parser_getErrorDescription(err);
@@ -85,7 +85,7 @@ namespace {
         EXPECT_EQ_STR(val, "123456", "Incorrect value")
 
         // Try the same again
-        INIT_QUERY_CONTEXT(key, sizeof(key), val, sizeof(val), 0, 4)
+        INIT_QUERY_CONTEXT(&parser_tx_obj, key, sizeof(key), val, sizeof(val), 0, 4)
         parser_tx_obj.query.item_index = 0;
         err = tx_traverse(0, &numChunks);
         EXPECT_EQ(err, parser_ok) << parser_getErrorDescription(err);
@@ -94,7 +94,7 @@ namespace {
         EXPECT_EQ_STR(val, "123456", "Incorrect value")
 
         // Try last key
-        INIT_QUERY_CONTEXT(key, sizeof(key), val, sizeof(val), 0, 4)
+        INIT_QUERY_CONTEXT(&parser_tx_obj, key, sizeof(key), val, sizeof(val), 0, 4)
         parser_tx_obj.query.item_index = 2;
         err = tx_traverse(0, &numChunks);
         EXPECT_EQ(err, parser_ok) << parser_getErrorDescription(err);
@@ -115,12 +115,12 @@ namespace {
         char val[1000];
         uint8_t numChunks;
 
-        INIT_QUERY_CONTEXT(key, sizeof(key), val, sizeof(val), 5, 4)
+        INIT_QUERY_CONTEXT(&parser_tx_obj, key, sizeof(key), val, sizeof(val), 5, 4)
         err = tx_traverse(0, &numChunks);
         EXPECT_EQ(err, parser_display_page_out_of_range) << "This call should have resulted in a display out of range";
 
         // We should find it. but later tx_display should fail
-        INIT_QUERY_CONTEXT(key, sizeof(key), val, sizeof(val), 0, 4)
+        INIT_QUERY_CONTEXT(&parser_tx_obj, key, sizeof(key), val, sizeof(val), 0, 4)
         err = tx_traverse(0, &numChunks);
         EXPECT_EQ(err, parser_ok);
         EXPECT_EQ(numChunks, 1) << "Item not found";
@@ -135,7 +135,7 @@ namespace {
         EXPECT_EQ(err, parser_ok);
 
         uint8_t numItems;
-        tx_display_numItems(&numItems);
+        tx_display_numItems(&parser_tx_obj, &numItems);
 
         EXPECT_EQ(1, numItems) << "Wrong number of items";
     }
@@ -149,7 +149,7 @@ namespace {
         EXPECT_EQ(err, parser_ok);
 
         uint8_t numItems;
-        tx_display_numItems(&numItems);
+        tx_display_numItems(&parser_tx_obj, &numItems);
         EXPECT_EQ(10, numItems) << "Wrong number of items";
     }
 
@@ -163,7 +163,7 @@ namespace {
         EXPECT_EQ(err, parser_ok);
 
         uint8_t numItems;
-        tx_display_numItems(&numItems);
+        tx_display_numItems(&parser_tx_obj, &numItems);
         EXPECT_EQ(22, numItems) << "Wrong number of items";
     }
 }
@@ -0,0 +1,287 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include "common.h"
+#include <common/parser.h>
+#include <parser_cache.h>
+#include <proto/proto_reader.h>
+#include "proto_encode.h"
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    const char *delegator = "secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h";
+    const char *recipient = "secret1xz54wxqsgkvmhf2hj0g4d3w8xqjyx6ev2v2dte";
+    const char *validator1 = "secretvaloper1kn3wugetjuy4zetlq6wadchfhvu3x7407zqqsp";
+    const char *validator2 = "secretvaloper1sjllsnramtg3ewxqwwrwjxfgc4n4ef9u0tvx7u";
+
+    using proto_encode::any;
+    using proto_encode::bytes;
+    using proto_encode::coin;
+    using proto_encode::msgDelegate;
+    using proto_encode::msgSend;
+    using proto_encode::SignDoc;
+    using proto_encode::uint;
+
+    struct Parsed {
+        std::unique_ptr<parser_state_t> state = std::make_unique<parser_state_t>();
+        parser_context_t ctx{};
+        parser_error_t err = parser_ok;
+    };
+
+    std::unique_ptr<Parsed> parse(const std::string &doc, parser_format_e format, parser_mode_e mode,
+                                  const char *ownAddr = nullptr) {
+        auto parsed = std::make_unique<Parsed>();
+        parser_bindState(&parsed->ctx, parsed->state.get());
+        parser_setMode(&parsed->ctx, mode);
+        parser_setFormat(&parsed->ctx, format);
+        parsed->state->tx_obj.own_addr = ownAddr;
+        parsed->err = parser_parse(&parsed->ctx, (const uint8_t *) doc.data(), doc.size());
+        if (parsed->err == parser_ok) {
+            parsed->err = parser_validate(&parsed->ctx);
+        }
+        return parsed;
+    }
+
+    parser_error_t parseProto(const std::string &doc) {
+        return parse(doc, parser_format_protobuf, parser_mode_normal)->err;
+    }
+
+    // A SignDoc is reviewed exactly like the Amino JSON sign doc it is equivalent to
+    void expectSameReview(const std::string &amino, const SignDoc &doc, const char *ownAddr = nullptr) {
+        const std::string proto = doc.encode();
+        for (const parser_mode_e mode : {parser_mode_normal, parser_mode_expert}) {
+            auto expected = parse(amino, parser_format_amino_json, mode, ownAddr);
+            auto actual = parse(proto, parser_format_protobuf, mode, ownAddr);
+            ASSERT_EQ(expected->err, parser_ok) << amino;
+            ASSERT_EQ(actual->err, parser_ok) << parser_getErrorDescription(actual->err);
+
+            const auto lines = dumpUI(&expected->ctx, 40, 40);
+            EXPECT_EQ(dumpUI(&actual->ctx, 40, 40), lines) << "expert " << (mode == parser_mode_expert);
+            EXPECT_EQ(dumpUIByItem(&actual->ctx, 40, 40), lines);
+            EXPECT_LT(proto.size(), amino.size());
+        }
+    }
+
+    TEST(TxProto, Send) {
+        SignDoc doc;
+        doc.msgs = {msgSend(delegator, recipient, "15")};
+        expectSameReview(R"({"account_number":"108","chain_id":"secret-4","fee":{"amount":[{"amount":"600","denom":"uscrt"}],"gas":"200000"},"memo":"","msgs":[{"type":"cosmos-sdk/MsgSend","value":{"amount":[{"amount":"15","denom":"uscrt"}],"from_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","to_address":"secret1xz54wxqsgkvmhf2hj0g4d3w8xqjyx6ev2v2dte"}}],"sequence":"2"})", doc);
+    }
+
+    TEST(TxProto, GroupingDelegateAndSend) {
+        SignDoc doc;
+        doc.sequence = 106;
+        doc.msgs = {msgDelegate(delegator, validator1, "1000000"),
+                    msgDelegate(delegator, validator2, "2000000"),
+                    msgSend(delegator, recipient, "15")};
+        const std::string amino = R"({"account_number":"108","chain_id":"secret-4","fee":{"amount":[{"amount":"600","denom":"uscrt"}],"gas":"200000"},"memo":"","msgs":[{"type":"cosmos-sdk/MsgDelegate","value":{"amount":{"amount":"1000000","denom":"uscrt"},"delegator_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","validator_address":"secretvaloper1kn3wugetjuy4zetlq6wadchfhvu3x7407zqqsp"}},{"type":"cosmos-sdk/MsgDelegate","value":{"amount":{"amount":"2000000","denom":"uscrt"},"delegator_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","validator_address":"secretvaloper1sjllsnramtg3ewxqwwrwjxfgc4n4ef9u0tvx7u"}},{"type":"cosmos-sdk/MsgSend","value":{"amount":[{"amount":"15","denom":"uscrt"}],"from_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","to_address":"secret1xz54wxqsgkvmhf2hj0g4d3w8xqjyx6ev2v2dte"}}],"sequence":"106"})";
+        expectSameReview(amino, doc);
+        // The delegator is not shown at all when it is the signer
+        expectSameReview(amino, doc, delegator);
+    }
+
+    TEST(TxProto, GroupingSameType) {
+        SignDoc doc;
+        doc.memo = "restake";
+        doc.msgs = {msgDelegate(delegator, validator1, "1"), msgDelegate(delegator, validator2, "2")};
+        expectSameReview(R"({"account_number":"108","chain_id":"secret-4","fee":{"amount":[{"amount":"600","denom":"uscrt"}],"gas":"200000"},"memo":"restake","msgs":[{"type":"cosmos-sdk/MsgDelegate","value":{"amount":{"amount":"1","denom":"uscrt"},"delegator_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","validator_address":"secretvaloper1kn3wugetjuy4zetlq6wadchfhvu3x7407zqqsp"}},{"type":"cosmos-sdk/MsgDelegate","value":{"amount":{"amount":"2","denom":"uscrt"},"delegator_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","validator_address":"secretvaloper1sjllsnramtg3ewxqwwrwjxfgc4n4ef9u0tvx7u"}}],"sequence":"2"})", doc);
+    }
+
+    TEST(TxProto, StakingAndGovernance) {
+        SignDoc doc;
+        doc.msgs = {
+                any("/cosmos.staking.v1beta1.MsgUndelegate",
+                    bytes(1, delegator) + bytes(2, validator1) + bytes(3, coin("7", "uscrt"))),
+                any("/cosmos.staking.v1beta1.MsgBeginRedelegate",
+                    bytes(1, delegator) + bytes(2, validator1) + bytes(3, validator2) + bytes(4, coin("8", "uscrt"))),
+                any("/cosmos.distribution.v1beta1.MsgWithdrawDelegatorReward",
+                    bytes(1, delegator) + bytes(2, validator2)),
+                any("/cosmos.distribution.v1beta1.MsgWithdrawValidatorCommission", bytes(1, validator2)),
+                any("/cosmos.gov.v1beta1.MsgVote", uint(1, 12) + bytes(2, delegator) + uint(3, 1)),
+                any("/cosmos.gov.v1beta1.MsgDeposit",
+                    uint(1, 12) + bytes(2, delegator) + bytes(3, coin("9", "uscrt")) + bytes(3, coin("10", "ibc/27394FB0"))),
+        };
+        expectSameReview(R"({"account_number":"108","chain_id":"secret-4","fee":{"amount":[{"amount":"600","denom":"uscrt"}],"gas":"200000"},"memo":"","msgs":[)"
+                         R"({"type":"cosmos-sdk/MsgUndelegate","value":{"amount":{"amount":"7","denom":"uscrt"},"delegator_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","validator_address":"secretvaloper1kn3wugetjuy4zetlq6wadchfhvu3x7407zqqsp"}},)"
+                         R"({"type":"cosmos-sdk/MsgBeginRedelegate","value":{"amount":{"amount":"8","denom":"uscrt"},"delegator_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","validator_dst_address":"secretvaloper1sjllsnramtg3ewxqwwrwjxfgc4n4ef9u0tvx7u","validator_src_address":"secretvaloper1kn3wugetjuy4zetlq6wadchfhvu3x7407zqqsp"}},)"
+                         R"({"type":"cosmos-sdk/MsgWithdrawDelegationReward","value":{"delegator_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","validator_address":"secretvaloper1sjllsnramtg3ewxqwwrwjxfgc4n4ef9u0tvx7u"}},)"
+                         R"({"type":"cosmos-sdk/MsgWithdrawValidatorCommission","value":{"validator_address":"secretvaloper1sjllsnramtg3ewxqwwrwjxfgc4n4ef9u0tvx7u"}},)"
+                         R"({"type":"cosmos-sdk/MsgVote","value":{"option":1,"proposal_id":"12","voter":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h"}},)"
+                         R"({"type":"cosmos-sdk/MsgDeposit","value":{"amount":[{"amount":"9","denom":"uscrt"},{"amount":"10","denom":"ibc/27394FB0"}],"depositor":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","proposal_id":"12"}})"
+                         R"(],"sequence":"2"})", doc);
+    }
+
+    TEST(TxProto, FeeGranterPayerAndTip) {
+        SignDoc doc;
+        doc.accountNumber = 0;
+        doc.sequence = 1;
+        doc.memo = "testmemo";
+        doc.msgs = {msgSend(delegator, recipient, "10")};
+        doc.fee = bytes(1, coin("5", "feecoin1")) + bytes(1, coin("6", "feecoin2")) + uint(2, 10000) +
+                  bytes(3, "secretaccaddr1d9h8qatxxPAYER") + bytes(4, "secretaccaddr1d9h8xxxGRANTER");
+        doc.tip = bytes(1, coin("65", "tipcoin")) + bytes(1, coin("66", "tipcoin2")) + bytes(2, "secretaccaddr1d9h8qatxTIPPER");
+        expectSameReview(R"({"account_number":"0","chain_id":"secret-4","fee":{"amount":[{"amount":"5","denom":"feecoin1"},{"amount":"6","denom":"feecoin2"}],"gas":"10000","granter":"secretaccaddr1d9h8xxxGRANTER","payer":"secretaccaddr1d9h8qatxxPAYER"},"memo":"testmemo","msgs":[{"type":"cosmos-sdk/MsgSend","value":{"amount":[{"amount":"10","denom":"uscrt"}],"from_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","to_address":"secret1xz54wxqsgkvmhf2hj0g4d3w8xqjyx6ev2v2dte"}}],"sequence":"1","tip":{"amount":[{"amount":"65","denom":"tipcoin"},{"amount":"66","denom":"tipcoin2"}],"tipper":"secretaccaddr1d9h8qatxTIPPER"}})", doc);
+    }
+
+    TEST(TxProto, OtherChainIsShownInFull) {
+        SignDoc doc;
+        doc.chainId = "pulsar-2";
+        doc.fee = uint(2, 200000);
+        doc.msgs = {msgDelegate(delegator, validator1, "1"), msgDelegate(delegator, validator2, "2")};
+        expectSameReview(R"({"account_number":"108","chain_id":"pulsar-2","fee":{"amount":[],"gas":"200000"},"memo":"","msgs":[{"type":"cosmos-sdk/MsgDelegate","value":{"amount":{"amount":"1","denom":"uscrt"},"delegator_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","validator_address":"secretvaloper1kn3wugetjuy4zetlq6wadchfhvu3x7407zqqsp"}},{"type":"cosmos-sdk/MsgDelegate","value":{"amount":{"amount":"2","denom":"uscrt"},"delegator_address":"secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h","validator_address":"secretvaloper1sjllsnramtg3ewxqwwrwjxfgc4n4ef9u0tvx7u"}}],"sequence":"2"})", doc);
+    }
+
+    TEST(TxProto, Rejected) {
+        SignDoc valid;
+        valid.msgs = {msgSend(delegator, recipient, "15")};
+        ASSERT_EQ(parseProto(valid.encode()), parser_ok);
+
+        EXPECT_EQ(parseProto(""), parser_init_context_empty);
+
+        // Truncated anywhere, the payload is rejected. Without account_number it is still valid,
+        // as proto3 leaves out fields that are zero
+        const std::string encoded = valid.encode();
+        for (size_t len = 1; len < encoded.size() - uint(4, 108).size(); len++) {
+            EXPECT_NE(parseProto(encoded.substr(0, len)), parser_ok) << len;
+        }
+
+        EXPECT_EQ(parseProto("\x0a\x85"), parser_unexpected_buffer_end);
+        EXPECT_EQ(parseProto(encoded + "\x20\xff\xff\xff\xff\xff\xff\xff\xff\xff\x7f"), parser_value_out_of_range);
+        EXPECT_EQ(parseProto(encoded + "\x23"), parser_unexpected_type);
+        EXPECT_EQ(parseProto(encoded + bytes(5, "x")), parser_unexpected_field);
+        EXPECT_EQ(parseProto(encoded + bytes(3, "secret-4")), parser_duplicated_field);
+        EXPECT_EQ(parseProto(encoded + bytes(4, "1")), parser_unexpected_type);
+
+        SignDoc doc = valid;
+        doc.msgs = {any("/secret.compute.v1beta1.MsgExecuteContract", bytes(1, std::string(20, '\x01')))};
+        EXPECT_EQ(parseProto(doc.encode()), parser_unexpected_type);
+
+        doc = valid;
+        doc.msgs = {};
+        EXPECT_EQ(parseProto(doc.encode()), parser_missing_field);
+
+        doc = valid;
+        doc.extraBody = bytes(1023, any("/cosmos.tx.v1beta1.ExtensionOptionsMemo", ""));
+        EXPECT_EQ(parseProto(doc.encode()), parser_unexpected_field);
+
+        doc = valid;
+        doc.extraBody = uint(3, 1000);
+        EXPECT_EQ(parseProto(doc.encode()), parser_ok);
+
+        doc = valid;
+        doc.memo = "tab\there";
+        EXPECT_EQ(parseProto(doc.encode()), parser_unexpected_characters);
+
+        doc = valid;
+        doc.msgs = {any("/cosmos.bank.v1beta1.MsgSend", bytes(1, delegator) + bytes(1, recipient))};
+        EXPECT_EQ(parseProto(doc.encode()), parser_duplicated_field);
+
+        doc = valid;
+        doc.msgs = {any("/cosmos.bank.v1beta1.MsgSend", bytes(3, coin("1.5", "uscrt")))};
+        EXPECT_EQ(parseProto(doc.encode()), parser_unexpected_value);
+
+        doc = valid;
+        doc.extraAuthInfo = bytes(1, uint(3, 1));
+        EXPECT_EQ(parseProto(doc.encode()), parser_unexpected_number_items);
+
+        doc = valid;
+        doc.fee = uint(2, 1) + uint(5, 1);
+        EXPECT_EQ(parseProto(doc.encode()), parser_unexpected_field);
+    }
+
+    // Random edits of a valid doc are either rejected or can be shown in full
+    TEST(TxProto, MutatedDocs) {
+        SignDoc doc;
+        doc.memo = "memo";
+        doc.msgs = {msgDelegate(delegator, validator1, "1000000"), msgSend(delegator, recipient, "15")};
+        doc.tip = bytes(1, coin("1", "uscrt")) + bytes(2, delegator);
+        const std::string encoded = doc.encode();
+
+        std::mt19937 rng(3);
+        uint32_t accepted = 0;
+        for (int iteration = 0; iteration < 20000; iteration++) {
+            std::string mutated = encoded;
+            for (uint32_t edits = 1 + rng() % 3; edits > 0; edits--) {
+                const size_t pos = rng() % mutated.size();
+                switch (rng() % 3) {
+                    case 0: mutated[pos] = (char) rng(); break;
+                    case 1: mutated[pos] ^= (char) (1u << (rng() % 8)); break;
+                    default: mutated.erase(pos, 1); break;
+                }
+            }
+
+            auto parsed = parse(mutated, parser_format_protobuf, rng() % 2 ? parser_mode_expert : parser_mode_normal);
+            if (parsed->err != parser_ok) {
+                continue;
+            }
+            accepted++;
+            for (const auto &line : dumpUI(&parsed->ctx, 40, 40)) {
+                ASSERT_EQ(line.find("ERROR"), std::string::npos) << line;
+            }
+        }
+        EXPECT_GT(accepted, 0u);
+    }
+
+    TEST(TxProto, ModeChangeIndexesAgain) {
+        SignDoc doc;
+        doc.msgs = {msgDelegate(delegator, validator1, "1"), msgDelegate(delegator, validator2, "2")};
+        const std::string encoded = doc.encode();
+        const auto expert = dumpUI(&parse(encoded, parser_format_protobuf, parser_mode_expert)->ctx, 40, 40);
+
+        // The delegator is grouped in normal mode only
+        auto parsed = parse(encoded, parser_format_protobuf, parser_mode_normal);
+        ASSERT_EQ(parsed->err, parser_ok);
+        EXPECT_NE(dumpUI(&parsed->ctx, 40, 40), expert);
+
+        parser_setMode(&parsed->ctx, parser_mode_expert);
+        EXPECT_EQ(dumpUI(&parsed->ctx, 40, 40), expert);
+        bool cached = true;
+        ASSERT_EQ(parser_cache_parse(&parsed->ctx, (const uint8_t *) encoded.data(), encoded.size(), nullptr, &cached), parser_ok);
+        EXPECT_FALSE(cached);
+        EXPECT_EQ(dumpUI(&parsed->ctx, 40, 40), expert);
+    }
+
+    TEST(TxProto, CacheKeepsFormatsApart) {
+        SignDoc doc;
+        doc.msgs = {msgSend(delegator, recipient, "15")};
+        const std::string encoded = doc.encode();
+
+        auto state = std::make_unique<parser_state_t>();
+        parser_context_t ctx;
+        parser_bindState(&ctx, state.get());
+        parser_setMode(&ctx, parser_mode_normal);
+        parser_setFormat(&ctx, parser_format_protobuf);
+
+        bool cached = true;
+        ASSERT_EQ(parser_cache_parse(&ctx, (const uint8_t *) encoded.data(), encoded.size(), nullptr, &cached), parser_ok);
+        EXPECT_FALSE(cached);
+        const auto lines = dumpUI(&ctx, 40, 40);
+
+        const std::string resent = encoded;
+        ASSERT_EQ(parser_cache_parse(&ctx, (const uint8_t *) resent.data(), resent.size(), nullptr, &cached), parser_ok);
+        EXPECT_TRUE(cached);
+        EXPECT_EQ(dumpUI(&ctx, 40, 40), lines);
+
+        // The same bytes as JSON are parsed again, and rejected
+        parser_setFormat(&ctx, parser_format_amino_json);
+        EXPECT_NE(parser_cache_parse(&ctx, (const uint8_t *) resent.data(), resent.size(), nullptr, &cached), parser_ok);
+        EXPECT_FALSE(cached);
+    }
+}
@@ -0,0 +1,254 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include <gmock/gmock.h>
+#include "testcases.h"
+#include "common.h"
+#include <common/parser.h>
+#include <json/json_stream.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    const char *delegator = "secret1w34k53py5v5xyluazqpq65agyajavep2rflq6h";
+
+    struct Parsed {
+        std::unique_ptr<parser_state_t> state = std::make_unique<parser_state_t>();
+        parser_context_t ctx{};
+        parser_error_t parseErr = parser_ok;
+        parser_error_t validateErr = parser_ok;
+    };
+
+    std::unique_ptr<Parsed> parse(const std::string &doc, parser_engine_e engine, bool expert,
+                                  const char *ownAddr = nullptr) {
+        auto parsed = std::make_unique<Parsed>();
+        parser_bindState(&parsed->ctx, parsed->state.get());
+        parser_setMode(&parsed->ctx, expert ? parser_mode_expert : parser_mode_normal);
+        parser_setEngine(&parsed->ctx, engine);
+        parsed->state->tx_obj.own_addr = ownAddr;
+        parsed->parseErr = parser_parse(&parsed->ctx, (const uint8_t *) doc.data(), doc.size());
+        if (parsed->parseErr == parser_ok) {
+            parsed->validateErr = parser_validate(&parsed->ctx);
+        }
+        return parsed;
+    }
+
+    // Same pages as dumpUIByItem, but items are queried backwards so seeks cannot just go on from the last one
+    std::vector<std::string> dumpUIBackwards(parser_context_t *ctx, uint16_t pageWidth) {
+        std::vector<std::string> answer;
+        uint8_t numItems = 0;
+        if (parser_getNumItems(ctx, &numItems) != parser_ok) {
+            return answer;
+        }
+        for (int idx = numItems - 1; idx >= 0; idx--) {
+            char key[40];
+            char value[100];
+            uint8_t pageCount = 0;
+            const parser_error_t err = parser_getItem(ctx, idx, key, sizeof(key), value, pageWidth, 0, &pageCount);
+            answer.insert(answer.begin(), std::to_string(idx) + " " + key + " : " +
+                                          (err == parser_ok ? value : parser_getErrorDescription(err)));
+        }
+        return answer;
+    }
+
+    std::string delegateMsg(int i) {
+        return R"({"type":"cosmos-sdk/MsgDelegate","value":{"amount":{"amount":")" + std::to_string(1000 + i) +
+               R"(","denom":"uscrt"},"delegator_address":")" + delegator +
+               R"(","validator_address":"secretvaloper)" + std::to_string(i) + R"("}})";
+    }
+
+    std::string delegateDoc(int count) {
+        std::string msgs;
+        for (int i = 0; i < count; i++) {
+            msgs += (i > 0 ? "," : "") + delegateMsg(i);
+        }
+        return R"({"account_number":"108","chain_id":"secret-4","fee":{"amount":[{"amount":"600","denom":"uscrt"}],"gas":"200000"},"memo":"","msgs":[)" +
+               msgs + R"(],"sequence":"2"})";
+    }
+
+    class TxStreamCorpus : public ::testing::TestWithParam<testcase_t> {
+    public:
+        struct PrintToStringParamName {
+            template<class ParamType>
+            std::string operator()(const testing::TestParamInfo<ParamType> &info) const {
+                return static_cast<testcase_t>(info.param).description;
+            }
+        };
+    };
+
+    INSTANTIATE_TEST_SUITE_P(
+        JsonTestCases,
+        TxStreamCorpus,
+        ::testing::ValuesIn(GetJsonTestCases("testcases/manual.json")),
+        TxStreamCorpus::PrintToStringParamName()
+    );
+
+    TEST_P(TxStreamCorpus, SameErrors) {
+        const testcase_t &tc = GetParam();
+        auto tokens = parse(tc.tx, parser_engine_tokens, tc.expert);
+        auto streaming = parse(tc.tx, parser_engine_streaming, tc.expert);
+
+        EXPECT_EQ(parser_getErrorDescription(streaming->parseErr), tc.parsingErr);
+        EXPECT_EQ(streaming->parseErr, tokens->parseErr);
+        if (tokens->parseErr == parser_ok) {
+            EXPECT_EQ(parser_getErrorDescription(streaming->validateErr), tc.validationErr);
+            EXPECT_EQ(streaming->validateErr, tokens->validateErr);
+        }
+    }
+
+    TEST_P(TxStreamCorpus, SameUI) {
+        const testcase_t &tc = GetParam();
+        auto tokens = parse(tc.tx, parser_engine_tokens, tc.expert);
+        auto streaming = parse(tc.tx, parser_engine_streaming, tc.expert);
+        if (tokens->parseErr != parser_ok) {
+            return;
+        }
+
+        for (const uint16_t pageWidth : {17, 40, 100}) {
+            const auto expected = dumpUI(&tokens->ctx, 40, pageWidth);
+            EXPECT_EQ(dumpUI(&streaming->ctx, 40, pageWidth), expected) << "Page width " << pageWidth;
+            EXPECT_EQ(dumpUIByItem(&streaming->ctx, 40, pageWidth), expected) << "Page width " << pageWidth;
+            EXPECT_EQ(dumpUIBackwards(&streaming->ctx, pageWidth), dumpUIBackwards(&tokens->ctx, pageWidth));
+        }
+    }
+
+    // The streaming grammar is stricter than jsmn: whatever it accepts, the token engine shows the same way
+    TEST_P(TxStreamCorpus, MutationsAcceptedByBoth) {
+        const testcase_t &tc = GetParam();
+        if (tc.parsingErr != "No error" || tc.validationErr != "No error") {
+            return;
+        }
+
+        // Large documents are sampled
+        const size_t step = tc.tx.size() / 256 + 1;
+        for (size_t i = 0; i < tc.tx.size(); i += step) {
+            for (const char c : {'\0', ' ', '"', ',', '}', ']', '1', 'x', '\\'}) {
+                std::string doc = tc.tx;
+                if (c == '\0') {
+                    doc.erase(i, 1);
+                } else {
+                    doc[i] = c;
+                }
+
+                auto streaming = parse(doc, parser_engine_streaming, tc.expert);
+                if (streaming->parseErr != parser_ok || streaming->validateErr != parser_ok) {
+                    continue;
+                }
+                auto tokens = parse(doc, parser_engine_tokens, tc.expert);
+                ASSERT_EQ(tokens->parseErr, parser_ok) << doc;
+                ASSERT_EQ(tokens->validateErr, parser_ok) << doc;
+                ASSERT_EQ(dumpUI(&streaming->ctx, 40, 40), dumpUI(&tokens->ctx, 40, 40)) << doc;
+            }
+        }
+    }
+
+    TEST(TxStream, Reader) {
+        const std::string doc = R"( {"a":[1,"x\"y",{}],"b":{"c":null}} )";
+        json_stream_t json;
+        ASSERT_EQ(json_stream_parse(&json, doc.c_str(), doc.size()), parser_ok);
+        EXPECT_EQ(json.root, 1);
+
+        uint16_t a;
+        uint16_t count;
+        ASSERT_EQ(json_stream_object_get_value(&json, json.root, "a", &a), parser_ok);
+        ASSERT_EQ(json_stream_element_count(&json, a, &count), parser_ok);
+        EXPECT_EQ(count, 3);
+
+        uint16_t element;
+        json_event_t value;
+        ASSERT_EQ(json_stream_nth_element(&json, a, 1, &element), parser_ok);
+        ASSERT_EQ(json_stream_value(&json, element, &value), parser_ok);
+        EXPECT_EQ(value.type, JSMN_STRING);
+        EXPECT_EQ(doc.substr(value.start, value.end - value.start), R"(x\"y)");
+        EXPECT_EQ(json_stream_nth_element(&json, a, 3, &element), parser_no_data);
+
+        // Tokens in jsmn order: root, "a", [...], 1, "x\"y", {}, "b", {...}, "c", null
+        json_event_t token;
+        ASSERT_EQ(json_stream_token(&json, json.root, 9, &token), parser_ok);
+        EXPECT_EQ(doc.substr(token.start, token.end - token.start), "null");
+        EXPECT_EQ(json_stream_token(&json, json.root, 10, &token), parser_no_data);
+
+        ASSERT_EQ(json_stream_value(&json, json.root, &value), parser_ok);
+        EXPECT_EQ(value.type, JSMN_OBJECT);
+        EXPECT_EQ(value.end, doc.size() - 1);
+        EXPECT_EQ(json_stream_object_get_value(&json, json.root, "c", &element), parser_no_data);
+    }
+
+    TEST(TxStream, ReaderErrors) {
+        const std::vector<std::pair<std::string, parser_error_t>> cases = {
+                {"",                   parser_json_zero_tokens},
+                {"  ",                 parser_json_zero_tokens},
+                {R"({"a":1)",          parser_json_incomplete_json},
+                {R"({"a":"1)",         parser_json_incomplete_json},
+                {R"({"a":1]})",        parser_unexpected_characters},
+                {R"({"a":1,})",        parser_unexpected_characters},
+                {R"({"a" 1})",         parser_unexpected_characters},
+                {R"({a:1})",           parser_unexpected_characters},
+                {R"({"a":"\q"})",      parser_unexpected_characters},
+                {R"({"a":1} {})",      parser_unexpected_characters},
+                {std::string(33, '[') + std::string(33, ']'), parser_json_too_deep},
+        };
+        for (const auto &c : cases) {
+            json_stream_t json;
+            EXPECT_EQ(json_stream_parse(&json, c.first.c_str(), c.first.size()), c.second) << c.first;
+        }
+
+        // Same as jsmn, reading stops at the first NUL
+        const char withNul[] = "{\"a\":1}\0garbage";
+        json_stream_t json;
+        EXPECT_EQ(json_stream_parse(&json, withNul, sizeof(withNul)), parser_ok);
+    }
+
+    // Enough leaves for checkpoints to wrap around, with grouping hiding some of them
+    TEST(TxStream, ManyMessages) {
+        const std::string doc = delegateDoc(30);
+        for (const bool expert : {false, true}) {
+            for (const char *ownAddr : {(const char *) nullptr, delegator}) {
+                auto tokens = parse(doc, parser_engine_tokens, expert, ownAddr);
+                auto streaming = parse(doc, parser_engine_streaming, expert, ownAddr);
+                ASSERT_EQ(tokens->validateErr, parser_ok);
+                ASSERT_EQ(streaming->validateErr, parser_ok);
+
+                const auto expected = dumpUI(&tokens->ctx, 40, 40);
+                EXPECT_EQ(dumpUI(&streaming->ctx, 40, 40), expected);
+                EXPECT_EQ(dumpUIByItem(&streaming->ctx, 40, 40), expected);
+                EXPECT_EQ(dumpUIBackwards(&streaming->ctx, 40), dumpUIBackwards(&tokens->ctx, 40));
+            }
+        }
+    }
+
+    TEST(TxStream, BeyondTokenLimit) {
+        const std::string doc = delegateDoc(60);
+
+        auto tokens = parse(doc, parser_engine_tokens, false);
+        EXPECT_EQ(tokens->parseErr, parser_json_too_many_tokens);
+
+        auto streaming = parse(doc, parser_engine_streaming, false);
+        ASSERT_EQ(streaming->parseErr, parser_ok);
+        ASSERT_EQ(streaming->validateErr, parser_ok);
+
+        uint8_t numItems = 0;
+        ASSERT_EQ(parser_getNumItems(&streaming->ctx, &numItems), parser_ok);
+        // Type and delegator are grouped, then amount and validator of each message, and the fee
+        EXPECT_EQ(numItems, 2 + 60 * 2 + 1);
+
+        const auto lines = dumpUI(&streaming->ctx, 40, 40);
+        EXPECT_EQ(dumpUIByItem(&streaming->ctx, 40, 40), lines);
+        EXPECT_THAT(lines, ::testing::Contains("121 | Validator : secretvaloper59"));
+        EXPECT_THAT(lines, ::testing::Contains("120 | Amount : 0.001059 SCRT"));
+    }
+}
@@ -0,0 +1,126 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include <tx_stream_check.h>
+#include <common/parser.h>
+#include <json/json_parser.h>
+#include <string>
+#include "testcases.h"
+
+namespace {
+    struct result_t {
+        parser_error_t err;
+        uint32_t offset;
+    };
+
+    std::string streamTx;
+
+    uint8_t readTx(uint32_t offset) {
+        return (uint8_t) streamTx[offset];
+    }
+
+    // Feeds the transaction in chunks, as process_chunk does
+    result_t streamCheck(const std::string &tx, size_t chunkLen) {
+        streamTx = tx;
+        tx_stream_check_t ctx;
+        tx_stream_check_init(&ctx, 0);
+
+        for (size_t received = 0; received < tx.size();) {
+            received = std::min(received + chunkLen, tx.size());
+            const parser_error_t err = tx_stream_check(&ctx, readTx, received);
+            if (err != parser_ok) {
+                return {err, ctx.offset};
+            }
+        }
+        return {parser_ok, ctx.offset};
+    }
+
+    void expectRejected(const std::string &tx, parser_error_t err, uint32_t offset) {
+        for (const size_t chunkLen : {(size_t) 1, (size_t) 5, (size_t) 250}) {
+            const result_t result = streamCheck(tx, chunkLen);
+            EXPECT_EQ(result.err, err) << tx << " chunk " << chunkLen;
+            EXPECT_EQ(result.offset, offset) << tx << " chunk " << chunkLen;
+        }
+    }
+
+    const std::string validTx = R"({"account_number":"0","chain_id":"secret-4","fee":{"amount":[{"amount":"5","denom":"uscrt"}],"gas":"10000"},"memo":"a b\"c","msgs":[{"type":"cosmos-sdk/MsgSend","value":{"amount":[],"from_address":"x","to_address":"y"}}],"sequence":"1"})";
+
+    TEST(StreamCheck, AcceptsValid) {
+        for (const size_t chunkLen : {(size_t) 1, (size_t) 5, (size_t) 250}) {
+            const result_t result = streamCheck(validTx, chunkLen);
+            EXPECT_EQ(result.err, parser_ok);
+            EXPECT_EQ(result.offset, validTx.size());
+        }
+    }
+
+    TEST(StreamCheck, Whitespace) {
+        expectRejected(R"({"account_number":"0", "chain_id":"secret-4"})", parser_json_contains_whitespace, 22);
+        expectRejected(R"({"fee":{"amount":[ ]}})", parser_json_contains_whitespace, 18);
+        expectRejected(R"({"a":1 ,"b":2})", parser_json_contains_whitespace, 6);
+        expectRejected(R"( {"a":1})", parser_json_contains_whitespace, 0);
+        expectRejected("{\"a\":\n1}", parser_json_contains_whitespace, 5);
+    }
+
+    TEST(StreamCheck, RootKeyOrder) {
+        expectRejected(R"({"chain_id":"secret-4","account_number":"0"})", parser_json_is_not_sorted, 38);
+        expectRejected(R"({"memo":"","memo":""})", parser_duplicated_field, 16);
+        expectRejected(R"({"msgs":[],"msg":""})", parser_json_is_not_sorted, 15);
+        // Only root keys are checked here, nested objects are left to tx_validate
+        EXPECT_EQ(streamCheck(R"({"a":{"z":1,"b":2},"b":1})", 3).err, parser_ok);
+        // Keys longer than the stored prefix are left to tx_validate
+        EXPECT_EQ(streamCheck(R"({"aaaaaaaaaaaaaaaaaaaaaaaaaaaaz":1,"aaaaaaaaaaaaaaaaaaaaaaaaaaaab":2})", 3).err, parser_ok);
+    }
+
+    TEST(StreamCheck, Structure) {
+        expectRejected(R"(["a"])", parser_unexpected_characters, 0);
+        expectRejected(R"({"a":[1}})", parser_unexpected_characters, 7);
+        expectRejected("{\"a\":t\x01}", parser_unexpected_characters, 6);
+
+        std::string deep = R"({"a":)";
+        for (uint32_t i = 1; i < STREAM_CHECK_MAX_DEPTH; i++) {
+            deep += "[";
+        }
+        EXPECT_EQ(streamCheck(deep, 7).err, parser_ok);
+        expectRejected(deep + "[", parser_json_too_deep, deep.size());
+    }
+
+    TEST(StreamCheck, TokenBudget) {
+        std::string tx = R"({"a":[)";
+        uint32_t tokens = 3;
+        while (tokens < MAX_NUMBER_OF_TOKENS) {
+            tx += "1,";
+            tokens++;
+        }
+        EXPECT_EQ(streamCheck(tx, 250).err, parser_ok);
+        expectRejected(tx + "1", parser_json_too_many_tokens, tx.size());
+    }
+
+    // Whatever the full parser accepts must pass the chunk time checks
+    TEST(StreamCheck, Corpus) {
+        for (const auto &tc : GetJsonTestCases("testcases/manual.json")) {
+            parser_context_t ctx;
+            parser_initContext(&ctx);
+            if (parser_parse(&ctx, (const uint8_t *) tc.tx.data(), tc.tx.size()) != parser_ok ||
+                parser_validate(&ctx) != parser_ok) {
+                continue;
+            }
+            for (const size_t chunkLen : {(size_t) 1, (size_t) 250}) {
+                EXPECT_EQ(streamCheck(tc.tx, chunkLen).err, parser_ok) << tc.description;
+            }
+        }
+    }
+}
@@ -232,6 +232,203 @@ namespace {
         EXPECT_EQ(err, parser_json_is_not_sorted) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
 
+    TEST(TxValidationTest, DuplicatedKey_Root) {
+        auto transaction =
+            R"({"account_number":"0","chain_id":"test-chain-1","fee":{"amount":[{"amount":"5","denom":"photon"}],"gas":"10000"},"memo":"testmemo","memo":"testmemo","msgs":[{"inputs":[{"address":"cosmosaccaddr1d9h8qat5e4ehc5","coins":[{"amount":"10","denom":"atom"}]}],"outputs":[{"address":"cosmosaccaddr1da6hgur4wse3jx32","coins":[{"amount":"10","denom":"atom"}]}]}],"sequence":"1"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json);
+        EXPECT_EQ(err, parser_duplicated_field) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, DuplicatedKey_Nested) {
+        auto transaction =
+            R"({"account_number":"0","chain_id":"test-chain-1","fee":{"amount":[{"amount":"5","denom":"photon"}],"gas":"10000"},"memo":"testmemo","msgs":[{"inputs":[{"address":"cosmosaccaddr1d9h8qat5e4ehc5","coins":[{"amount":"10","amount":"99","denom":"atom"}]}],"outputs":[{"address":"cosmosaccaddr1da6hgur4wse3jx32","coins":[{"amount":"10","denom":"atom"}]}]}],"sequence":"1"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json);
+        EXPECT_EQ(err, parser_duplicated_field) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, SortedDictionary_PrefixKeys) {
+        auto transaction =
+            R"({"account_number":"0","chain_id":"test-chain-1","fee":{"amount":[{"amount":"5","denom":"photon"}],"gas":"10000"},"memo":"testmemo","msgs":[{"a":"1","ab":"2","b":"3"}],"sequence":"1"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json);
+        EXPECT_EQ(err, parser_ok) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, NotSortedDictionary_PrefixKeys) {
+        auto transaction =
+            R"({"account_number":"0","chain_id":"test-chain-1","fee":{"amount":[{"amount":"5","denom":"photon"}],"gas":"10000"},"memo":"testmemo","msgs":[{"ab":"1","a":"2"}],"sequence":"1"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json);
+        EXPECT_EQ(err, parser_json_is_not_sorted) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, SortedDictionary_LongKeys) {
+        // Keys longer than 255 bytes used to be reported as unsorted
+        auto transaction =
+            R"({"account_number":"0","chain_id":"test-chain-1","fee":{"amount":[{"amount":"5","denom":"photon"}],"gas":"10000"},"memo":"testmemo","msgs":[{"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa":"1","aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab":"2"}],"sequence":"1"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json);
+        EXPECT_EQ(err, parser_ok) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, Schema_MsgSend) {
+        auto transaction =
+            R"({"account_number":"0","chain_id":"secret-4","fee":{"amount":[{"amount":"5","denom":"uscrt"}],"gas":"10000"},"memo":"testmemo","msgs":[{"type":"cosmos-sdk/MsgSend","value":{"amount":[{"amount":"10","denom":"uscrt"}],"from_address":"secret1a","to_address":"secret1b"}}],"sequence":"1"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json);
+        EXPECT_EQ(err, parser_ok) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, Schema_MsgSend_AmountNotArray) {
+        auto transaction =
+            R"({"account_number":"0","chain_id":"secret-4","fee":{"amount":[{"amount":"5","denom":"uscrt"}],"gas":"10000"},"memo":"testmemo","msgs":[{"type":"cosmos-sdk/MsgSend","value":{"amount":{"amount":"10","denom":"uscrt"},"from_address":"secret1a","to_address":"secret1b"}}],"sequence":"1"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json);
+        EXPECT_EQ(err, parser_unexpected_type) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, Schema_MsgSend_BadCoin) {
+        auto transaction =
+            R"({"account_number":"0","chain_id":"secret-4","fee":{"amount":[{"amount":"5","denom":"uscrt"}],"gas":"10000"},"memo":"testmemo","msgs":[{"type":"cosmos-sdk/MsgSend","value":{"amount":[{"amount":"10","coin":"uscrt"}],"from_address":"secret1a","to_address":"secret1b"}}],"sequence":"1"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json);
+        EXPECT_EQ(err, parser_unexpected_field) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, Schema_MsgDelegate_MissingValidator) {
+        auto transaction =
+            R"({"account_number":"0","chain_id":"secret-4","fee":{"amount":[{"amount":"5","denom":"uscrt"}],"gas":"10000"},"memo":"testmemo","msgs":[{"type":"cosmos-sdk/MsgDelegate","value":{"amount":{"amount":"10","denom":"uscrt"},"delegator_address":"secret1a"}}],"sequence":"1"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json);
+        EXPECT_EQ(err, parser_missing_field) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, Schema_MsgExecuteContract_MissingContract) {
+        auto transaction =
+            R"({"account_number":"0","chain_id":"secret-4","fee":{"amount":[{"amount":"5","denom":"uscrt"}],"gas":"10000"},"memo":"testmemo","msgs":[{"type":"wasm/MsgExecuteContract","value":{"msg":"AAAA","sender":"secret1a","sent_funds":[]}}],"sequence":"1"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json);
+        EXPECT_EQ(err, parser_missing_field) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, Schema_MsgExecuteContract_NullFunds) {
+        auto transaction =
+            R"({"account_number":"0","chain_id":"secret-4","fee":{"amount":[{"amount":"5","denom":"uscrt"}],"gas":"10000"},"memo":"testmemo","msgs":[{"type":"wasm/MsgExecuteContract","value":{"contract":"secret1c","msg":"AAAA","sender":"secret1a","sent_funds":null}}],"sequence":"1"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json);
+        EXPECT_EQ(err, parser_ok) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, Schema_MsgVote_NumericOption) {
+        auto transaction =
+            R"({"account_number":"0","chain_id":"secret-4","fee":{"amount":[{"amount":"5","denom":"uscrt"}],"gas":"10000"},"memo":"testmemo","msgs":[{"type":"cosmos-sdk/MsgVote","value":{"option":1,"proposal_id":"5","voter":"secret1a"}}],"sequence":"1"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json);
+        EXPECT_EQ(err, parser_ok) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, Schema_QueryPermit_TokensNotStrings) {
+        auto transaction =
+            R"({"account_number":"0","chain_id":"secret-4","fee":{"amount":[{"amount":"5","denom":"uscrt"}],"gas":"10000"},"memo":"testmemo","msgs":[{"type":"query_permit","value":{"allowed_tokens":[1],"permissions":["balance"],"permit_name":"test"}}],"sequence":"1"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json);
+        EXPECT_EQ(err, parser_unexpected_type) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, Schema_UnknownType) {
+        auto transaction =
+            R"({"account_number":"0","chain_id":"secret-4","fee":{"amount":[{"amount":"5","denom":"uscrt"}],"gas":"10000"},"memo":"testmemo","msgs":[{"type":"cosmos-sdk/MsgUnknown","value":{"anything":[1,2]}}],"sequence":"1"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json);
+        EXPECT_EQ(err, parser_ok) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
 // This json has been taken directly from goclient which uses cosmos to serialize a simple tx
 // This test is currently failing the validation.
 // We are reviewing the validation code and cosmos serialization to find the culprit.
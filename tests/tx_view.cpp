@@ -0,0 +1,156 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include "testcases.h"
+#include "common.h"
+#include <tx_view.hpp>
+#include <app_mode.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <fmt/core.h>
+
+namespace {
+    // Same lines as dumpUI
+    std::vector<std::string> formatItems(secret::TxView &view) {
+        std::vector<std::string> answer;
+        for (const auto &item : view) {
+            std::string line = fmt::format("{} | {}", item.index, item.key);
+            if (item.pageCount > 1) {
+                line += fmt::format(" [{}/{}]", item.page + 1, item.pageCount);
+            }
+            line += " : ";
+            line += item.error == secret::TxError::ok ? item.value : secret::describe(item.error);
+            if (line.back() == ' ') {
+                line.pop_back();
+            }
+            answer.push_back(line);
+        }
+        return answer;
+    }
+
+    std::vector<testcase_t> validTestcases(bool expert) {
+        std::vector<testcase_t> answer;
+        for (const auto &tc : GetJsonTestCases("testcases/manual.json")) {
+            if (tc.expert == expert && tc.parsingErr == "No error" && tc.validationErr == "No error") {
+                answer.push_back(tc);
+            }
+        }
+        return answer;
+    }
+
+    TEST(TxView, ItemsMatchDumpUI) {
+        for (const bool expert : {false, true}) {
+            app_mode_set_expert(expert);
+            secret::TxView view;
+            for (const auto &tc : validTestcases(expert)) {
+                ASSERT_EQ(view.parse(tc.tx), secret::TxError::ok) << tc.description;
+                EXPECT_EQ(formatItems(view), tc.expected) << tc.description;
+            }
+        }
+        app_mode_set_expert(false);
+    }
+
+    TEST(TxView, ModeIsPerView) {
+        // The app setting is ignored once a view selects its mode
+        app_mode_set_expert(false);
+        secret::TxView normal;
+        secret::TxView expert;
+        normal.setExpert(false);
+        expert.setExpert(true);
+
+        for (const bool mode : {false, true}) {
+            for (const auto &tc : validTestcases(mode)) {
+                secret::TxView &view = mode ? expert : normal;
+                ASSERT_EQ(view.parse(tc.tx), secret::TxError::ok) << tc.description;
+                EXPECT_EQ(formatItems(view), tc.expected) << tc.description;
+            }
+        }
+    }
+
+    TEST(TxView, ParseErrorIsTyped) {
+        const std::string tx = R"({"account_number":"0", "chain_id":"secret-4"})";
+
+        secret::TxView view;
+        EXPECT_EQ(view.parse(tx), secret::TxError::json_contains_whitespace);
+        EXPECT_EQ(secret::describe(secret::TxError::json_contains_whitespace), "JSON Contains whitespace in the corpus");
+        EXPECT_EQ(view.numItems(), 0);
+        EXPECT_TRUE(view.begin() == view.end());
+    }
+
+    TEST(TxView, PagesFollowPageLength) {
+        const auto testcases = validTestcases(false);
+        ASSERT_FALSE(testcases.empty());
+        app_mode_set_expert(false);
+
+        secret::TxView view(40, 10);
+        for (const auto &tc : testcases) {
+            ASSERT_EQ(view.parse(tc.tx), secret::TxError::ok);
+            for (const auto &item : view) {
+                EXPECT_EQ(item.error, secret::TxError::ok);
+                EXPECT_LT(item.value.size(), 10u);
+                EXPECT_LT(item.page, item.pageCount);
+            }
+        }
+    }
+
+    // Timing only, not run by default: unittests --gtest_also_run_disabled_tests --gtest_filter='*Benchmark*'
+    TEST(TxView, DISABLED_BenchmarkAgainstDumpUI) {
+        constexpr size_t ROUNDS = 200;
+        const auto testcases = validTestcases(false);
+        app_mode_set_expert(false);
+
+        size_t dumpUIBytes = 0;
+        const auto dumpUIStart = std::chrono::steady_clock::now();
+        for (size_t round = 0; round < ROUNDS; round++) {
+            for (const auto &tc : testcases) {
+                parser_context_t ctx;
+                parser_initContext(&ctx);
+                parser_parse(&ctx, (const uint8_t *) tc.tx.c_str(), tc.tx.size());
+                parser_validate(&ctx);
+                // Page by page, as TxView renders (dumpUI goes through parser_renderAll)
+                for (const auto &line : dumpUIByItem(&ctx, 40, 40)) {
+                    dumpUIBytes += line.size();
+                }
+            }
+        }
+        const auto dumpUITime = std::chrono::steady_clock::now() - dumpUIStart;
+
+        size_t viewBytes = 0;
+        secret::TxView view;
+        const auto viewStart = std::chrono::steady_clock::now();
+        for (size_t round = 0; round < ROUNDS; round++) {
+            for (const auto &tc : testcases) {
+                view.parse(tc.tx);
+                for (const auto &item : view) {
+                    viewBytes += item.key.size() + item.value.size();
+                }
+            }
+        }
+        const auto viewTime = std::chrono::steady_clock::now() - viewStart;
+
+        const auto perDoc = [&](std::chrono::steady_clock::duration d) {
+            return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() /
+                   (double) (ROUNDS * testcases.size()) / 1000.0;
+        };
+        printf("%-8s %12s %10s\n", "", "us per doc", "bytes");
+        printf("%-8s %12.2f %10zu\n", "dumpUI", perDoc(dumpUITime), dumpUIBytes / ROUNDS);
+        printf("%-8s %12.2f %10zu\n", "TxView", perDoc(viewTime), viewBytes / ROUNDS);
+
+        EXPECT_GT(viewBytes, 0u);
+    }
+}
@@ -28,6 +28,7 @@ using ::testing::Values;
 
 void validate_testcase(const testcase_t &tc) {
     parser_context_t ctx;
+    parser_initContext(&ctx);
     parser_error_t err;
 
     const auto *buffer = (const uint8_t *) tc.tx.c_str();
@@ -45,6 +46,7 @@ void validate_testcase(const testcase_t &tc) {
 
 void check_testcase(const testcase_t &tc) {
     parser_context_t ctx;
+    parser_initContext(&ctx);
     parser_error_t err;
 
     app_mode_set_expert(tc.expert);
@@ -73,6 +75,60 @@ void check_testcase(const testcase_t &tc) {
     }
 }
 
+void measure_testcase(const testcase_t &tc) {
+    parser_context_t ctx;
+    parser_initContext(&ctx);
+    parser_error_t err;
+
+    app_mode_set_expert(tc.expert);
+
+    const auto *buffer = (const uint8_t *) tc.tx.c_str();
+    size_t bufferLen = tc.tx.size();
+
+    err = parser_parse(&ctx, buffer, bufferLen);
+    ASSERT_EQ(parser_getErrorDescription(err), tc.parsingErr) << "Parsing error mismatch";
+
+    if (err != parser_ok)
+        return;
+
+    uint8_t numItems = 0;
+    err = parser_getNumItems(&ctx, &numItems);
+    ASSERT_EQ(err, parser_ok);
+
+    for (uint8_t idx = 0; idx < numItems; idx++) {
+        char key[40];
+        char value[40];
+        uint8_t renderedPageCount = 0;
+        uint8_t measuredPageCount = 0;
+
+        const parser_error_t errMeasured = parser_getItem(&ctx, idx, nullptr, 0, nullptr, sizeof(value),
+                                                          0, &measuredPageCount);
+        const parser_error_t errRendered = parser_getItem(&ctx, idx, key, sizeof(key), value, sizeof(value),
+                                                          0, &renderedPageCount);
+
+        EXPECT_EQ(errMeasured, errRendered) << "Item " << (int) idx;
+        if (errRendered == parser_ok) {
+            EXPECT_EQ(measuredPageCount, renderedPageCount) << "Item " << (int) idx;
+        }
+    }
+}
+
+void render_all_testcase(const testcase_t &tc) {
+    parser_context_t ctx;
+    parser_initContext(&ctx);
+
+    app_mode_set_expert(tc.expert);
+
+    const auto *buffer = (const uint8_t *) tc.tx.c_str();
+    if (parser_parse(&ctx, buffer, tc.tx.size()) != parser_ok)
+        return;
+
+    // A single walk shows the same pages as item by item queries, whatever the page width
+    for (const uint16_t pageWidth : {17, 40, 100}) {
+        EXPECT_EQ(dumpUI(&ctx, 40, pageWidth), dumpUIByItem(&ctx, 40, pageWidth)) << "Page width " << pageWidth;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
@@ -100,3 +156,7 @@ INSTANTIATE_TEST_SUITE_P ( // NOLINT(cert-err58-cpp)
 TEST_P(JsonTests, ValidateTestcase) { validate_testcase(GetParam()); }
 
 TEST_P(JsonTests, CheckUIOutput) { check_testcase(GetParam()); }
+
+TEST_P(JsonTests, MeasuredPageCount) { measure_testcase(GetParam()); }
+
+TEST_P(JsonTests, RenderAllMatchesGetItem) { render_all_testcase(GetParam()); }
@@ -0,0 +1,390 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// Fleet throughput harness. Runs DEVICES simulated devices (see sim_fleet.h), one thread each, which
+// take requests from a shared queue until REQUESTS are served. Reports throughput and latency
+// percentiles per message type, as shown in the review.
+//
+//   apdu-fleet [-d DEVICES] [-n REQUESTS] [-a MS[:MAX_MS]] [-m MIX] [-e] [-j] [-M MODULE] [INPUT...]
+//
+// INPUT is a trace, a sign doc (*.json) or a directory of sign docs, as in apdu-replay. Requests are
+// drawn at random from the inputs and from the synthetic mix, e.g. -m send=4,delegate=2,ibc=1,wasm=1
+// (kinds: send, delegate, ibc, wasm, address). Without inputs the mix defaults to the four sign kinds.
+//
+//   -a  the user takes MS milliseconds to approve a review, or between MS and MAX_MS
+//   -e  expert mode
+//   -j  prints the summary as one JSON line
+
+#include "apdu_trace.h"
+#include "doc_files.h"
+#include "sim_fleet.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef APDU_SIM_DEVICE_MODULE
+#define APDU_SIM_DEVICE_MODULE "libapdu_sim_device.so"
+#endif
+
+namespace {
+    const char *HRP = "secret";
+    const char *SIGNER = "secret1w0ajvgl3fqm7wm3aqhhwdn8jpl8hu6lc8q7sw6";
+    const char *VALIDATOR = "secretvaloper1grgelyng2v6v3t8z87wu3sxgt9m5s03xfytvz7";
+    const char *CONTRACT = "secret1k0jntykt7e4g3y88ltc60czgjuqdy4c9e8fzek";
+    // Variants of each synthetic kind, so amounts and sequences differ
+    const size_t SYNTHETIC_VARIANTS = 16;
+
+    struct Request {
+        std::vector<tools::Exchange> trace;
+        double weight;
+    };
+
+    struct Sample {
+        std::string type;
+        uint64_t latencyNs;
+        uint64_t deviceNs;
+        bool failed;
+    };
+
+    std::string coin(size_t amount) {
+        return R"({"amount":")" + std::to_string(amount) + R"(","denom":"uscrt"})";
+    }
+
+    // Canonical Amino JSON: sorted keys, no whitespace
+    std::string signDoc(const std::string &msg, size_t variant) {
+        return R"({"account_number":"108","chain_id":"secret-4","fee":{"amount":[)" + coin(5000) +
+               R"(],"gas":"200000"},"memo":"","msgs":[)" + msg + R"(],"sequence":")" +
+               std::to_string(variant) + R"("})";
+    }
+
+    bool syntheticMsg(const std::string &kind, size_t variant, std::string *msg) {
+        const size_t amount = 1000000 + 1111 * variant;
+        if (kind == "send") {
+            *msg = R"({"type":"cosmos-sdk/MsgSend","value":{"amount":[)" + coin(amount) +
+                   R"(],"from_address":")" + SIGNER +
+                   R"(","to_address":"secret102hty0jv2s29lyc4u0tv97z9v298e24t3vwtpl"}})";
+        } else if (kind == "delegate") {
+            *msg = R"({"type":"cosmos-sdk/MsgDelegate","value":{"amount":)" + coin(amount) +
+                   R"(,"delegator_address":")" + SIGNER + R"(","validator_address":")" + VALIDATOR + R"("}})";
+        } else if (kind == "ibc") {
+            *msg = R"({"type":"cosmos-sdk/MsgTransfer","value":{"receiver":"cosmos1w0ajvgl3fqm7wm3aqhhwdn8jpl8hu6lcqz0zqs",)"
+                   R"("sender":")" + std::string(SIGNER) +
+                   R"(","source_channel":"channel-0","source_port":"transfer",)"
+                   R"("timeout_height":{"revision_height":")" + std::to_string(5000000 + variant) +
+                   R"(","revision_number":"4"},"timeout_timestamp":"0","token":)" + coin(amount) + "}}";
+        } else if (kind == "wasm") {
+            // Encrypted payloads are opaque, their length is what matters
+            const std::string payload(320 + 16 * variant, 'A');
+            *msg = R"({"type":"wasm/MsgExecuteContract","value":{"contract":")" + std::string(CONTRACT) +
+                   R"(","msg":")" + payload + R"(","sender":")" + SIGNER + R"(","sent_funds":[]}})";
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // "send=4,delegate=2"
+    bool addMix(const std::string &mix, std::vector<Request> *requests) {
+        size_t start = 0;
+        while (start < mix.size()) {
+            size_t end = mix.find(',', start);
+            if (end == std::string::npos) {
+                end = mix.size();
+            }
+            const std::string item = mix.substr(start, end - start);
+            const size_t eq = item.find('=');
+            const std::string kind = item.substr(0, eq);
+            const double weight = eq == std::string::npos ? 1.0 : strtod(item.c_str() + eq + 1, nullptr);
+            if (weight <= 0) {
+                return false;
+            }
+
+            for (size_t v = 0; v < SYNTHETIC_VARIANTS; v++) {
+                Request request{{}, weight / SYNTHETIC_VARIANTS};
+                std::string msg;
+                if (kind == "address") {
+                    request.trace.push_back(tools::addressExchange(HRP, 0, static_cast<uint32_t>(v)));
+                } else if (syntheticMsg(kind, v, &msg)) {
+                    request.trace = tools::signTrace(signDoc(msg, v));
+                } else {
+                    return false;
+                }
+                requests->push_back(request);
+            }
+            start = end + 1;
+        }
+        return true;
+    }
+
+    bool addInput(const std::string &path, std::vector<Request> *requests, std::string *error) {
+        if (path.size() < 5 || path.compare(path.size() - 5, 5, ".json") != 0) {
+            Request request{{}, 1.0};
+            if (!tools::loadTrace(path, &request.trace, error)) {
+                return false;
+            }
+            requests->push_back(request);
+            return true;
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            *error = "cannot read " + path;
+            return false;
+        }
+        const std::string doc((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        requests->push_back(Request{tools::signTrace(doc), 1.0});
+        return true;
+    }
+
+    // Message types as the user sees them
+    std::string requestType(const sim::Replay &replay) {
+        std::vector<std::string> types;
+        for (const auto &page : replay.pages) {
+            const size_t key = page.find(" | ");
+            const size_t sep = page.find(" : ");
+            if (key == std::string::npos || sep == std::string::npos ||
+                page.compare(key + 3, sep - key - 3, "Type") != 0) {
+                continue;
+            }
+            const std::string type = page.substr(sep + 3);
+            if (std::find(types.begin(), types.end(), type) == types.end()) {
+                types.push_back(type);
+            }
+        }
+
+        if (types.empty()) {
+            if (!replay.pages.empty()) {
+                return "Other";
+            }
+            return replay.stageNs[sim_stage_address].empty() ? "No review" : "Address";
+        }
+        std::string joined;
+        for (const auto &type : types) {
+            joined += (joined.empty() ? "" : " + ") + type;
+        }
+        return joined;
+    }
+
+    bool failed(const std::vector<tools::Exchange> &trace, const sim::Replay &replay) {
+        if (replay.exception != 0 || replay.replies.size() != trace.size()) {
+            return true;
+        }
+        for (size_t i = 0; i < trace.size(); i++) {
+            if (trace[i].hasReply ? replay.replies[i] != trace[i].reply
+                                  : tools::statusWord(replay.replies[i]) != 0x9000) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    double percentileMs(const std::vector<uint64_t> &sorted, double p) {
+        const auto idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+        return static_cast<double>(sorted[idx]) / 1e6;
+    }
+
+    void usage(const char *name) {
+        fprintf(stderr, "usage: %s [-d DEVICES] [-n REQUESTS] [-a MS[:MAX_MS]] [-m MIX] [-e] [-j] [-M MODULE] [INPUT...]\n",
+                name);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t numDevices = std::max(1u, std::thread::hardware_concurrency());
+    size_t numRequests = 1000;
+    double approveMinMs = 0;
+    double approveMaxMs = 0;
+    std::string mix;
+    std::string module = APDU_SIM_DEVICE_MODULE;
+    bool json = false;
+    sim_device_config_t config{};
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        const std::string opt = argv[i];
+        if (opt == "-e") {
+            config.expert = true;
+        } else if (opt == "-j") {
+            json = true;
+        } else if (opt == "-d" && i + 1 < argc) {
+            numDevices = strtoul(argv[++i], nullptr, 10);
+        } else if (opt == "-n" && i + 1 < argc) {
+            numRequests = strtoul(argv[++i], nullptr, 10);
+        } else if (opt == "-a" && i + 1 < argc) {
+            char *end = nullptr;
+            approveMinMs = strtod(argv[++i], &end);
+            approveMaxMs = *end == ':' ? strtod(end + 1, nullptr) : approveMinMs;
+        } else if (opt == "-m" && i + 1 < argc) {
+            mix = argv[++i];
+        } else if (opt == "-M" && i + 1 < argc) {
+            module = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (numDevices == 0 || numRequests == 0 || approveMinMs < 0 || approveMaxMs < approveMinMs) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<Request> requests;
+    for (; i < argc; i++) {
+        std::vector<std::string> paths;
+        std::string error;
+        if (!tools::collectDocs(argv[i], &paths)) {
+            fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[i]);
+            return 2;
+        }
+        for (const auto &path : paths) {
+            if (!addInput(path, &requests, &error)) {
+                fprintf(stderr, "%s: %s\n", argv[0], error.c_str());
+                return 2;
+            }
+        }
+    }
+    if (mix.empty() && requests.empty()) {
+        mix = "send,delegate,ibc,wasm";
+    }
+    if (!addMix(mix, &requests)) {
+        fprintf(stderr, "%s: invalid mix %s\n", argv[0], mix.c_str());
+        return 2;
+    }
+
+    sim::Fleet fleet;
+    std::string error;
+    if (!fleet.load(module, numDevices, &error)) {
+        fprintf(stderr, "%s: %s\n", argv[0], error.c_str());
+        return 2;
+    }
+
+    std::vector<double> weights;
+    for (const auto &request : requests) {
+        weights.push_back(request.weight);
+    }
+
+    std::atomic<size_t> next{0};
+    std::vector<std::vector<Sample>> samples(numDevices);
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t d = 0; d < numDevices; d++) {
+        threads.emplace_back([&, d] {
+            std::mt19937 rng(static_cast<uint32_t>(d + 1));
+            std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+            std::uniform_real_distribution<double> delayMs(approveMinMs, approveMaxMs);
+
+            while (next.fetch_add(1) < numRequests) {
+                const auto &request = requests[pick(rng)];
+                sim::Replay replay;
+                if (approveMaxMs > 0) {
+                    const double ms = delayMs(rng);
+                    replay.approve = [ms] {
+                        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(ms));
+                        return true;
+                    };
+                }
+
+                const auto begin = std::chrono::steady_clock::now();
+                sim::replayOn(fleet.device(d), request.trace, config, &replay);
+                const auto end = std::chrono::steady_clock::now();
+
+                uint64_t deviceNs = 0;
+                for (const auto &stage : replay.stageNs) {
+                    for (const auto ns : stage) {
+                        deviceNs += ns;
+                    }
+                }
+                samples[d].push_back(Sample{
+                        requestType(replay),
+                        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()),
+                        deviceNs,
+                        failed(request.trace, replay)});
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    struct Totals {
+        std::vector<uint64_t> latencyNs;
+        std::vector<uint64_t> deviceNs;
+        size_t failed = 0;
+    };
+    std::map<std::string, Totals> byType;
+    Totals all;
+    for (const auto &device : samples) {
+        for (const auto &sample : device) {
+            for (Totals *totals : {&byType[sample.type], &all}) {
+                totals->latencyNs.push_back(sample.latencyNs);
+                totals->deviceNs.push_back(sample.deviceNs);
+                totals->failed += sample.failed ? 1 : 0;
+            }
+        }
+    }
+
+    if (json) {
+        printf(R"({"devices":%zu,"requests":%zu,"seconds":%.3f,"failed":%zu,"types":{)",
+               numDevices, all.latencyNs.size(), seconds, all.failed);
+    } else {
+        printf("%zu devices, %zu requests in %.3f s, %zu failed\n",
+               numDevices, all.latencyNs.size(), seconds, all.failed);
+        printf("%-32s %7s %6s %9s %9s %9s %9s %9s %11s %11s\n", "type", "count", "failed", "req/s",
+               "p50 ms", "p90 ms", "p99 ms", "max ms", "dev p50 ms", "dev p99 ms");
+    }
+
+    bool first = true;
+    const auto print = [&](const std::string &type, Totals *totals) {
+        std::sort(totals->latencyNs.begin(), totals->latencyNs.end());
+        std::sort(totals->deviceNs.begin(), totals->deviceNs.end());
+        const double rate = static_cast<double>(totals->latencyNs.size()) / seconds;
+        if (json) {
+            printf(R"(%s"%s":{"count":%zu,"failed":%zu,"per_s":%.1f,"p50_ms":%.3f,"p90_ms":%.3f,"p99_ms":%.3f,)"
+                   R"("max_ms":%.3f,"device_p50_ms":%.3f,"device_p99_ms":%.3f})",
+                   first ? "" : ",", type.c_str(), totals->latencyNs.size(), totals->failed, rate,
+                   percentileMs(totals->latencyNs, 0.50), percentileMs(totals->latencyNs, 0.90),
+                   percentileMs(totals->latencyNs, 0.99), percentileMs(totals->latencyNs, 1.0),
+                   percentileMs(totals->deviceNs, 0.50), percentileMs(totals->deviceNs, 0.99));
+        } else {
+            printf("%-32s %7zu %6zu %9.1f %9.3f %9.3f %9.3f %9.3f %11.3f %11.3f\n",
+                   type.c_str(), totals->latencyNs.size(), totals->failed, rate,
+                   percentileMs(totals->latencyNs, 0.50), percentileMs(totals->latencyNs, 0.90),
+                   percentileMs(totals->latencyNs, 0.99), percentileMs(totals->latencyNs, 1.0),
+                   percentileMs(totals->deviceNs, 0.50), percentileMs(totals->deviceNs, 0.99));
+        }
+        first = false;
+    };
+    for (auto &entry : byType) {
+        print(entry.first, &entry.second);
+    }
+    print("All", &all);
+    if (json) {
+        printf("}}\n");
+    }
+
+    return all.failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// Replays APDU traces through the simulated device (tools/sim) and reports the time spent in
+// each stage of the command path: chunk ingestion, parse, review, sign.
+//
+//   apdu-replay [-n REPEAT] [-e] [-r] [-j] [-o OUT] TRACE...
+//
+// TRACE is a trace file (see apdu_trace.h) or a sign doc (*.json), which is sent as an address
+// request followed by a sign request. Replies recorded in the trace are compared with the ones of
+// the app. -o writes the traces back with the replies seen, -j prints the summary as one JSON line
+// to keep track of it per commit.
+//
+//   -n  replays each trace REPEAT times, each time in a new session
+//   -e  expert mode
+//   -r  the user rejects every review
+
+#include "apdu_trace.h"
+#include "sim_replay.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+    const char *HRP = "secret";
+
+    bool loadInput(const std::string &path, std::vector<tools::Exchange> *trace, std::string *error) {
+        if (path.size() < 5 || path.compare(path.size() - 5, 5, ".json") != 0) {
+            return tools::loadTrace(path, trace, error);
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            *error = "cannot read " + path;
+            return false;
+        }
+        const std::string doc((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        trace->push_back(tools::addressExchange(HRP));
+        const auto sign = tools::signTrace(doc);
+        trace->insert(trace->end(), sign.begin(), sign.end());
+        return true;
+    }
+
+    double percentile(const std::vector<uint64_t> &sorted, double p) {
+        const auto idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+        return static_cast<double>(sorted[idx]) / 1000.0;
+    }
+
+    void usage(const char *name) {
+        fprintf(stderr, "usage: %s [-n REPEAT] [-e] [-r] [-j] [-o OUT] TRACE...\n", name);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t repeat = 1;
+    bool json = false;
+    bool reject = false;
+    sim_device_config_t config{};
+    const char *out = nullptr;
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        const std::string opt = argv[i];
+        if (opt == "-e") {
+            config.expert = true;
+        } else if (opt == "-r") {
+            reject = true;
+        } else if (opt == "-j") {
+            json = true;
+        } else if (opt == "-n" && i + 1 < argc) {
+            repeat = strtoul(argv[++i], nullptr, 10);
+        } else if (opt == "-o" && i + 1 < argc) {
+            out = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (i >= argc || repeat == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<std::vector<tools::Exchange>> traces;
+    for (; i < argc; i++) {
+        std::vector<tools::Exchange> trace;
+        std::string error;
+        if (!loadInput(argv[i], &trace, &error)) {
+            fprintf(stderr, "%s: %s\n", argv[0], error.c_str());
+            return 2;
+        }
+        traces.push_back(trace);
+    }
+
+    std::array<std::vector<uint64_t>, SIM_STAGE_COUNT> stageNs;
+    size_t commands = 0;
+    size_t mismatches = 0;
+    bool failed = false;
+    std::ofstream recorded;
+    if (out != nullptr) {
+        recorded.open(out);
+    }
+
+    for (auto &trace : traces) {
+        for (size_t r = 0; r < repeat; r++) {
+            sim::Replay replay;
+            if (reject) {
+                replay.approve = [] { return false; };
+            }
+            sim::replay(trace, config, &replay);
+            if (replay.exception != 0) {
+                fprintf(stderr, "%s: exception 0x%04x escaped the app\n", argv[0], replay.exception);
+                failed = true;
+            }
+
+            commands += trace.size();
+            for (size_t c = 0; c < trace.size(); c++) {
+                const bool answered = c < replay.replies.size();
+                if (trace[c].hasReply && (!answered || replay.replies[c] != trace[c].reply)) {
+                    if (mismatches == 0) {
+                        fprintf(stderr, "command %zu: expected %s, got %s\n", c,
+                                tools::toHex(trace[c].reply.data(), trace[c].reply.size()).c_str(),
+                                answered ? tools::toHex(replay.replies[c].data(), replay.replies[c].size()).c_str()
+                                         : "no reply");
+                    }
+                    mismatches++;
+                }
+            }
+            for (uint8_t s = 0; s < SIM_STAGE_COUNT; s++) {
+                stageNs[s].insert(stageNs[s].end(), replay.stageNs[s].begin(), replay.stageNs[s].end());
+            }
+
+            if (recorded.is_open() && r + 1 == repeat) {
+                for (size_t c = 0; c < trace.size() && c < replay.replies.size(); c++) {
+                    trace[c].reply = replay.replies[c];
+                    trace[c].hasReply = true;
+                }
+                tools::writeTrace(recorded, trace);
+            }
+        }
+    }
+
+    if (json) {
+        printf("{\"commands\":%zu,\"mismatches\":%zu,\"stages\":{", commands, mismatches);
+    } else {
+        printf("%zu commands, %zu mismatches\n", commands, mismatches);
+        printf("%-8s %8s %10s %10s %10s %10s\n", "stage", "count", "total ms", "p50 us", "p99 us", "max us");
+    }
+    bool first = true;
+    for (uint8_t s = 0; s < SIM_STAGE_COUNT; s++) {
+        auto &ns = stageNs[s];
+        if (ns.empty()) {
+            continue;
+        }
+        std::sort(ns.begin(), ns.end());
+        double total = 0;
+        for (const auto v : ns) {
+            total += static_cast<double>(v);
+        }
+        const char *name = sim_stage_name(static_cast<sim_stage_e>(s));
+        if (json) {
+            printf("%s\"%s\":{\"count\":%zu,\"total_ms\":%.3f,\"p50_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f}",
+                   first ? "" : ",", name, ns.size(), total / 1e6,
+                   percentile(ns, 0.50), percentile(ns, 0.99), static_cast<double>(ns.back()) / 1000.0);
+        } else {
+            printf("%-8s %8zu %10.3f %10.1f %10.1f %10.1f\n", name, ns.size(), total / 1e6,
+                   percentile(ns, 0.50), percentile(ns, 0.99), static_cast<double>(ns.back()) / 1000.0);
+        }
+        first = false;
+    }
+    if (json) {
+        printf("}}\n");
+    }
+
+    return failed || mismatches > 0 ? 1 : 0;
+}
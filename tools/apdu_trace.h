@@ -0,0 +1,184 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// APDU traces, in the format of the ledgerjs record store:
+//
+//   # comment
+//   => 5502000014...        command
+//   <= ...9000              expected reply (optional)
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace tools {
+
+struct Exchange {
+    std::vector<uint8_t> command;
+    std::vector<uint8_t> reply;
+    bool hasReply = false;
+};
+
+constexpr uint8_t APDU_CLA = 0x55;
+constexpr uint8_t APDU_INS_SIGN = 0x02;
+constexpr uint8_t APDU_INS_GET_ADDR = 0x04;
+constexpr uint8_t APDU_INS_SIGN_BATCH = 0x08;
+constexpr size_t APDU_CHUNK_SIZE = 250;
+/// P2 of sign chunks (PAYLOAD_ENCODING_* in app_main.h)
+constexpr uint8_t APDU_ENCODING_JSON = 0x00;
+constexpr uint8_t APDU_ENCODING_PROTOBUF = 0x02;
+
+inline bool parseHex(const std::string &hex, std::vector<uint8_t> *out) {
+    out->clear();
+    int high = -1;
+    for (const char c : hex) {
+        int nibble;
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = c - 'A' + 10;
+        } else if (c == ' ' || c == '\t' || c == '\r') {
+            continue;
+        } else {
+            return false;
+        }
+        if (high < 0) {
+            high = nibble;
+        } else {
+            out->push_back(static_cast<uint8_t>(high << 4 | nibble));
+            high = -1;
+        }
+    }
+    return high < 0;
+}
+
+inline std::string toHex(const uint8_t *data, size_t len) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    for (size_t i = 0; i < len; i++) {
+        hex += digits[data[i] >> 4];
+        hex += digits[data[i] & 0xF];
+    }
+    return hex;
+}
+
+/// Reads a trace. On failure, error says which line is wrong
+inline bool loadTrace(const std::string &path, std::vector<Exchange> *trace, std::string *error) {
+    std::ifstream file(path);
+    if (!file) {
+        *error = "cannot read " + path;
+        return false;
+    }
+
+    std::string line;
+    size_t lineNo = 0;
+    while (std::getline(file, line)) {
+        lineNo++;
+        const size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+        const std::string marker = line.substr(start, 2);
+        std::vector<uint8_t> bytes;
+        const bool command = marker == "=>";
+        if ((!command && marker != "<=") || !parseHex(line.substr(start + 2), &bytes)) {
+            *error = path + ":" + std::to_string(lineNo) + ": expected => or <= followed by hex";
+            return false;
+        }
+        if (command) {
+            trace->push_back(Exchange{bytes, {}, false});
+        } else if (trace->empty() || trace->back().hasReply) {
+            *error = path + ":" + std::to_string(lineNo) + ": reply without a command";
+            return false;
+        } else {
+            trace->back().reply = bytes;
+            trace->back().hasReply = true;
+        }
+    }
+    return true;
+}
+
+inline void writeTrace(std::ostream &out, const std::vector<Exchange> &trace) {
+    for (const auto &exchange : trace) {
+        out << "=> " << toHex(exchange.command.data(), exchange.command.size()) << "\n";
+        if (exchange.hasReply) {
+            out << "<= " << toHex(exchange.reply.data(), exchange.reply.size()) << "\n";
+        }
+    }
+}
+
+inline std::vector<uint8_t> apdu(uint8_t ins, uint8_t p1, uint8_t p2, const uint8_t *data, size_t len) {
+    std::vector<uint8_t> command(5 + len);
+    command[0] = APDU_CLA;
+    command[1] = ins;
+    command[2] = p1;
+    command[3] = p2;
+    command[4] = static_cast<uint8_t>(len);
+    if (len > 0) {
+        std::copy(data, data + len, command.begin() + 5);
+    }
+    return command;
+}
+
+/// 44'/529'/account'/0/index, little endian as the device reads it
+inline std::vector<uint8_t> hdPath(uint32_t account, uint32_t index) {
+    const uint32_t path[5] = {0x80000000u | 44, 0x80000000u | 529, 0x80000000u | account, 0, index};
+    std::vector<uint8_t> bytes(sizeof(path));
+    for (size_t i = 0; i < bytes.size(); i++) {
+        bytes[i] = static_cast<uint8_t>(path[i / 4] >> (8 * (i % 4)));
+    }
+    return bytes;
+}
+
+/// Commands of a sign request: init with the path, then the document in chunks. Every chunk carries
+/// the payload encoding (P2) of the init chunk, Amino JSON by default
+inline std::vector<Exchange> signTrace(const std::string &doc, uint32_t account = 0, uint32_t index = 0,
+                                       uint8_t encoding = APDU_ENCODING_JSON) {
+    std::vector<Exchange> trace;
+    const auto path = hdPath(account, index);
+    trace.push_back(Exchange{apdu(APDU_INS_SIGN, 0, encoding, path.data(), path.size()), {}, false});
+    for (size_t offset = 0; offset < doc.size() || offset == 0; offset += APDU_CHUNK_SIZE) {
+        const size_t len = std::min(APDU_CHUNK_SIZE, doc.size() - offset);
+        const uint8_t p1 = offset + len >= doc.size() ? 2 : 1;
+        trace.push_back(Exchange{apdu(APDU_INS_SIGN, p1, encoding,
+                                      reinterpret_cast<const uint8_t *>(doc.data()) + offset, len), {}, false});
+    }
+    return trace;
+}
+
+/// Address request for the same path, without confirmation
+inline Exchange addressExchange(const std::string &hrp, uint32_t account = 0, uint32_t index = 0) {
+    std::vector<uint8_t> data = {static_cast<uint8_t>(hrp.size())};
+    data.insert(data.end(), hrp.begin(), hrp.end());
+    const auto path = hdPath(account, index);
+    data.insert(data.end(), path.begin(), path.end());
+    return Exchange{apdu(APDU_INS_GET_ADDR, 0, 0, data.data(), data.size()), {}, false};
+}
+
+/// Status word at the end of a reply
+inline uint16_t statusWord(const std::vector<uint8_t> &reply) {
+    if (reply.size() < 2) {
+        return 0;
+    }
+    return static_cast<uint16_t>(reply[reply.size() - 2] << 8 | reply.back());
+}
+
+}
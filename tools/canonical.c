@@ -0,0 +1,277 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "canonical.h"
+#include <zxmacros.h>
+#include "tx_stream_check.h"
+
+typedef struct {
+    const char *in;
+    const jsmntok_t *tokens;
+    uint16_t numTokens;
+
+    uint16_t *next;         // token following the subtree of each value
+    uint16_t *keys;         // keys of the objects being written, innermost last
+    uint16_t keysUsed;
+
+    char *out;
+    uint16_t outSize;
+    uint16_t outLen;
+} canonical_ctx_t;
+
+void canonical_arena_init(canonical_arena_t *arena, uint8_t *buffer, size_t size) {
+    arena->buffer = buffer;
+    arena->size = size;
+    arena->used = 0;
+}
+
+static void *arena_alloc(canonical_arena_t *arena, size_t size, size_t align) {
+    const uintptr_t base = (uintptr_t) arena->buffer;
+    const uintptr_t start = (base + arena->used + align - 1) & ~(uintptr_t) (align - 1);
+    if (start + size > base + arena->size) {
+        return NULL;
+    }
+    arena->used = start + size - base;
+    return (void *) start;
+}
+
+// Same ordering as compare_keys in tx_validate.c
+static int8_t compare_keys(const canonical_ctx_t *c, uint16_t first, uint16_t second) {
+    const jsmntok_t *a = &c->tokens[first];
+    const jsmntok_t *b = &c->tokens[second];
+    const int32_t aLen = a->end - a->start;
+    const int32_t bLen = b->end - b->start;
+    const int32_t common = aLen < bLen ? aLen : bLen;
+
+    const int cmp = MEMCMP(c->in + a->start, c->in + b->start, common);
+    if (cmp != 0) {
+        return cmp < 0 ? -1 : 1;
+    }
+    if (aLen == bLen) {
+        return 0;
+    }
+    return aLen < bLen ? -1 : 1;
+}
+
+// Checks the token tree and records where each value ends, so keys can be visited in any order
+static parser_error_t measure(canonical_ctx_t *c, uint16_t idx, uint8_t depth) {
+    if (idx >= c->numTokens) {
+        return parser_json_unexpected_error;
+    }
+    const jsmntok_t *tok = &c->tokens[idx];
+    uint16_t child = idx + 1;
+
+    switch (tok->type) {
+        case JSMN_OBJECT:
+        case JSMN_ARRAY:
+            // Same limit as tx_stream_check
+            if (depth >= STREAM_CHECK_MAX_DEPTH) {
+                return parser_json_too_deep;
+            }
+            for (int16_t i = 0; i < tok->size; i++) {
+                if (tok->type == JSMN_OBJECT) {
+                    // A key must be a string followed by its value
+                    if (child >= c->numTokens ||
+                        c->tokens[child].type != JSMN_STRING || c->tokens[child].size != 1) {
+                        return parser_unexpected_characters;
+                    }
+                    child++;
+                }
+                CHECK_PARSER_ERR(measure(c, child, depth + 1))
+                child = c->next[child];
+            }
+            break;
+        case JSMN_STRING:
+        case JSMN_PRIMITIVE:
+            if (tok->size != 0) {
+                return parser_unexpected_characters;
+            }
+            break;
+        default:
+            return parser_json_unexpected_error;
+    }
+
+    c->next[idx] = child;
+    return parser_ok;
+}
+
+static parser_error_t put(canonical_ctx_t *c, const char *data, uint16_t len) {
+    if (len > c->outSize - c->outLen) {
+        return parser_unexpected_buffer_end;
+    }
+    MEMCPY(c->out + c->outLen, data, len);
+    c->outLen += len;
+    return parser_ok;
+}
+
+static parser_error_t put_char(canonical_ctx_t *c, char ch) {
+    return put(c, &ch, 1);
+}
+
+static parser_error_t put_token(canonical_ctx_t *c, uint16_t idx) {
+    const jsmntok_t *tok = &c->tokens[idx];
+    const uint16_t len = (uint16_t) (tok->end - tok->start);
+    if (tok->type != JSMN_STRING) {
+        return put(c, c->in + tok->start, len);
+    }
+    // Token bounds exclude the quotes
+    return put(c, c->in + tok->start - 1, len + 2);
+}
+
+static parser_error_t emit(canonical_ctx_t *c, uint16_t idx);
+
+static parser_error_t emit_object(canonical_ctx_t *c, uint16_t idx) {
+    const uint16_t numKeys = (uint16_t) c->tokens[idx].size;
+    uint16_t *keys = c->keys + c->keysUsed;
+
+    // Insertion sort, objects in a sign doc are small
+    uint16_t key = idx + 1;
+    for (uint16_t i = 0; i < numKeys; i++) {
+        uint16_t j = i;
+        while (j > 0) {
+            const int8_t cmp = compare_keys(c, keys[j - 1], key);
+            if (cmp == 0) {
+                return parser_duplicated_field;
+            }
+            if (cmp < 0) {
+                break;
+            }
+            keys[j] = keys[j - 1];
+            j--;
+        }
+        keys[j] = key;
+        key = c->next[key + 1];
+    }
+
+    c->keysUsed += numKeys;
+    CHECK_PARSER_ERR(put_char(c, '{'))
+    for (uint16_t i = 0; i < numKeys; i++) {
+        if (i > 0) {
+            CHECK_PARSER_ERR(put_char(c, ','))
+        }
+        CHECK_PARSER_ERR(put_token(c, keys[i]))
+        CHECK_PARSER_ERR(put_char(c, ':'))
+        CHECK_PARSER_ERR(emit(c, keys[i] + 1))
+    }
+    c->keysUsed -= numKeys;
+    return put_char(c, '}');
+}
+
+static parser_error_t emit(canonical_ctx_t *c, uint16_t idx) {
+    const jsmntok_t *tok = &c->tokens[idx];
+    switch (tok->type) {
+        case JSMN_OBJECT:
+            return emit_object(c, idx);
+        case JSMN_ARRAY: {
+            CHECK_PARSER_ERR(put_char(c, '['))
+            uint16_t element = idx + 1;
+            for (int16_t i = 0; i < tok->size; i++) {
+                if (i > 0) {
+                    CHECK_PARSER_ERR(put_char(c, ','))
+                }
+                CHECK_PARSER_ERR(emit(c, element))
+                element = c->next[element];
+            }
+            return put_char(c, ']');
+        }
+        default:
+            return put_token(c, idx);
+    }
+}
+
+static parser_error_t tokenize(canonical_arena_t *arena, const char *in, uint16_t inLen,
+                               jsmntok_t **tokens, uint16_t *numTokens) {
+    // Whatever is left once the token array is reserved goes to next[] and keys[]
+    const size_t perToken = sizeof(jsmntok_t) + 2 * sizeof(uint16_t);
+    size_t maxTokens = (arena->size - arena->used) / perToken;
+    if (maxTokens > UINT16_MAX) {
+        maxTokens = UINT16_MAX;
+    }
+    while (maxTokens > 0) {
+        *tokens = arena_alloc(arena, maxTokens * sizeof(jsmntok_t), _Alignof(jsmntok_t));
+        if (*tokens != NULL) {
+            break;
+        }
+        // Alignment padding did not fit
+        maxTokens--;
+    }
+    if (maxTokens == 0) {
+        return parser_json_too_many_tokens;
+    }
+
+    jsmn_parser parser;
+    jsmn_init(&parser);
+    const int num = jsmn_parse(&parser, in, inLen, *tokens, (unsigned int) maxTokens);
+
+    // Same mapping as json_parse
+    switch (num) {
+        case JSMN_ERROR_NOMEM:
+            return parser_json_too_many_tokens;
+        case JSMN_ERROR_INVAL:
+            return parser_unexpected_characters;
+        case JSMN_ERROR_PART:
+            return parser_json_incomplete_json;
+        default:
+            break;
+    }
+    if (num < 0) {
+        return parser_json_unexpected_error;
+    }
+    if (num == 0) {
+        return parser_json_zero_tokens;
+    }
+    *numTokens = (uint16_t) num;
+    return parser_ok;
+}
+
+parser_error_t canonicalize_doc(canonical_arena_t *arena,
+                                const char *in, uint16_t inLen,
+                                char *out, uint16_t outSize, uint16_t *outLen) {
+    *outLen = 0;
+    if (inLen > CANONICAL_MAX_INPUT_LEN) {
+        return parser_value_out_of_range;
+    }
+
+    canonical_ctx_t c;
+    MEMZERO(&c, sizeof(c));
+    c.in = in;
+    c.out = out;
+    c.outSize = outSize;
+
+    arena->used = 0;
+    jsmntok_t *tokens = NULL;
+    CHECK_PARSER_ERR(tokenize(arena, in, inLen, &tokens, &c.numTokens))
+    c.tokens = tokens;
+    c.next = arena_alloc(arena, c.numTokens * sizeof(uint16_t), sizeof(uint16_t));
+    c.keys = arena_alloc(arena, c.numTokens * sizeof(uint16_t), sizeof(uint16_t));
+    if (c.next == NULL || c.keys == NULL) {
+        return parser_json_too_many_tokens;
+    }
+
+    // contains_whitespace expects the root to be a container, and a sign doc is an object
+    if (tokens[0].type != JSMN_OBJECT) {
+        return parser_unexpected_type;
+    }
+    CHECK_PARSER_ERR(measure(&c, 0, 0))
+    if (c.next[0] != c.numTokens) {
+        // More than one value at the root
+        return parser_unexpected_characters;
+    }
+
+    CHECK_PARSER_ERR(emit(&c, 0))
+    *outLen = c.outLen;
+    return parser_ok;
+}
@@ -0,0 +1,62 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <jsmn.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "common/parser_common.h"
+
+// Token offsets are signed 16 bits in jsmn
+#define CANONICAL_MAX_INPUT_LEN     INT16_MAX
+
+// Per token: the token itself, where its subtree ends and room to sort keys
+#define CANONICAL_ARENA_SIZE(MAX_TOKENS) \
+    ((size_t) (MAX_TOKENS) * (sizeof(jsmntok_t) + 2 * sizeof(uint16_t)) + sizeof(jsmntok_t))
+
+/// Scratch memory provided by the caller, reused from one doc to the next
+typedef struct {
+    uint8_t *buffer;
+    size_t size;
+    size_t used;
+} canonical_arena_t;
+
+void canonical_arena_init(canonical_arena_t *arena, uint8_t *buffer, size_t size);
+
+/// Writes a JSON doc in the form tx_validate accepts: no whitespace between tokens, and the
+/// keys of every object sorted the way dictionaries_sorted compares them. Strings and
+/// primitives, escapes included, are copied byte for byte.
+/// The output is at most one byte per token longer than the input, as jsmn lets values go
+/// without a separator
+/// \param arena tokens that do not fit are reported as parser_json_too_many_tokens
+/// \param in
+/// \param inLen
+/// \param out
+/// \param outSize
+/// \param outLen
+/// \return parser_duplicated_field when an object has the same key twice, parser_unexpected_type
+///         when the root is not an object, or the json_parse error
+parser_error_t canonicalize_doc(canonical_arena_t *arena,
+                                const char *in, uint16_t inLen,
+                                char *out, uint16_t outSize, uint16_t *outLen);
+
+#ifdef __cplusplus
+}
+#endif
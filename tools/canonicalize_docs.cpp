@@ -0,0 +1,177 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// Rewrites sign docs in the form the device accepts: no whitespace between tokens and
+// sorted keys.
+//
+//   canonicalize-docs [--check | --in-place] [PATH...]
+//
+// Without PATH, a doc is read from stdin. Otherwise every doc is written to stdout, one per
+// line, or back to its file with --in-place. --check only lists the docs that are not
+// canonical. Exits with 0 when every doc could be canonicalized (and already was, for --check)
+
+#include "canonical.h"
+#include "doc_files.h"
+#include <common/parser.h>
+#include <json/json_parser.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+    enum class Mode { print, check, inPlace };
+
+    /// Arena and output buffer, reused for every doc
+    class Canonicalizer {
+    public:
+        // Docs the device would reject for their token count are rejected here as well
+        Canonicalizer() : arena_(CANONICAL_ARENA_SIZE(MAX_NUMBER_OF_TOKENS)), out_(CANONICAL_MAX_INPUT_LEN + MAX_NUMBER_OF_TOKENS) {
+            canonical_arena_init(&arena_ctx_, arena_.data(), arena_.size());
+        }
+
+        parser_error_t run(const std::string &doc, std::string_view *out) {
+            if (doc.size() > CANONICAL_MAX_INPUT_LEN) {
+                return parser_value_out_of_range;
+            }
+            uint16_t outLen = 0;
+            const parser_error_t err = canonicalize_doc(&arena_ctx_, doc.data(), static_cast<uint16_t>(doc.size()),
+                                                    out_.data(), static_cast<uint16_t>(out_.size()), &outLen);
+            *out = std::string_view(out_.data(), outLen);
+            return err;
+        }
+
+    private:
+        std::vector<uint8_t> arena_;
+        std::vector<char> out_;
+        canonical_arena_t arena_ctx_{};
+    };
+
+    bool readFile(const std::string &path, std::string *doc) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        doc->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    bool writeFile(const std::string &path, std::string_view doc) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(doc.data(), static_cast<std::streamsize>(doc.size()));
+        return static_cast<bool>(file);
+    }
+
+    void usage(const char *name) {
+        fprintf(stderr, "usage: %s [--check | --in-place] [PATH...]\n", name);
+    }
+}
+
+int main(int argc, char **argv) {
+    Mode mode = Mode::print;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--check") {
+            mode = Mode::check;
+        } else if (arg == "--in-place") {
+            mode = Mode::inPlace;
+        } else if (!arg.empty() && arg[0] == '-') {
+            usage(argv[0]);
+            return 2;
+        } else if (!tools::collectDocs(arg, &paths)) {
+            fprintf(stderr, "%s: cannot read %s\n", argv[0], arg.c_str());
+            return 2;
+        }
+    }
+
+    Canonicalizer canonicalizer;
+    std::string doc;
+    std::string_view out;
+
+    if (paths.empty()) {
+        if (mode == Mode::inPlace) {
+            usage(argv[0]);
+            return 2;
+        }
+        doc.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+        const parser_error_t err = canonicalizer.run(doc, &out);
+        if (err != parser_ok) {
+            fprintf(stderr, "FAIL <stdin>: %s\n", parser_getErrorDescription(err));
+            return 1;
+        }
+        if (mode == Mode::check) {
+            return out == doc ? 0 : 1;
+        }
+        fwrite(out.data(), 1, out.size(), stdout);
+        return 0;
+    }
+
+    size_t failed = 0;
+    size_t changed = 0;
+    size_t bytes = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto &path : paths) {
+        if (!readFile(path, &doc)) {
+            failed++;
+            fprintf(stderr, "FAIL %s: cannot read file\n", path.c_str());
+            continue;
+        }
+        bytes += doc.size();
+        const parser_error_t err = canonicalizer.run(doc, &out);
+        if (err != parser_ok) {
+            failed++;
+            fprintf(stderr, "FAIL %s: %s\n", path.c_str(), parser_getErrorDescription(err));
+            continue;
+        }
+        if (out != doc) {
+            changed++;
+        }
+
+        switch (mode) {
+            case Mode::print:
+                fwrite(out.data(), 1, out.size(), stdout);
+                fputc('\n', stdout);
+                break;
+            case Mode::check:
+                if (out != doc) {
+                    printf("%s\n", path.c_str());
+                }
+                break;
+            case Mode::inPlace:
+                if (out != doc && !writeFile(path, out)) {
+                    failed++;
+                    fprintf(stderr, "FAIL %s: cannot write file\n", path.c_str());
+                }
+                break;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    fprintf(stderr, "%zu docs, %zu changed, %zu failed\n", paths.size(), changed, failed);
+    fprintf(stderr, "%.3f s, %.0f docs/s, %.2f MB/s\n",
+            seconds, (double) paths.size() / seconds, (double) bytes / seconds / 1e6);
+
+    if (mode == Mode::check && changed > 0) {
+        return 1;
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// What a sign doc goes through on each device: the largest doc it takes, how it reads Amino JSON
+// and how wide a review page is. Mirrors app/src/common/tx.c, json_parser.h and the zxlib view
+
+#include <tx_view.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace tools {
+
+struct DeviceTarget {
+    const char *name;
+    size_t maxDocSize;          // FLASH_BUFFER_SIZE
+    parser_engine_e engine;     // JSON_STREAMING_DEFAULT
+    uint16_t keyLen;            // MAX_CHARS_PER_KEY_LINE
+    uint16_t pageLen;           // MAX_CHARS_PER_VALUE1_LINE
+};
+
+constexpr DeviceTarget DEVICE_TARGETS[] = {
+        {"nanos", 8192, parser_engine_streaming, 64, 2 * 17 + 1},
+        {"nanox", 16384, parser_engine_tokens, 64, 4096},
+};
+
+/// Used when no target is given
+constexpr const DeviceTarget &DEFAULT_TARGET = DEVICE_TARGETS[1];
+
+/// nullptr for an unknown name
+inline const DeviceTarget *findTarget(const char *name) {
+    for (const auto &target : DEVICE_TARGETS) {
+        if (strcmp(target.name, name) == 0) {
+            return &target;
+        }
+    }
+    return nullptr;
+}
+
+/// A view that pages items and reads JSON the way the target does
+inline secret::TxView makeView(const DeviceTarget &target) {
+    secret::TxView view(target.keyLen, target.pageLen);
+    view.setEngine(target.engine);
+    return view;
+}
+
+}
@@ -0,0 +1,49 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace tools {
+
+/// Adds a sign doc, or every *.json file under a directory (sorted), to paths
+inline bool collectDocs(const std::string &arg, std::vector<std::string> *paths) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (fs::is_directory(arg, ec)) {
+        std::vector<std::string> found;
+        for (const auto &entry : fs::recursive_directory_iterator(arg, ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".json") {
+                found.push_back(entry.path().string());
+            }
+        }
+        // Stable output regardless of the file system
+        std::sort(found.begin(), found.end());
+        paths->insert(paths->end(), found.begin(), found.end());
+        return !ec;
+    }
+    if (!fs::exists(arg, ec)) {
+        return false;
+    }
+    paths->push_back(arg);
+    return true;
+}
+
+}
@@ -0,0 +1,204 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// Load generator for preflight-server. Sends the given sign docs round robin and reports
+// latency percentiles and throughput.
+//
+//   preflight-load [-c CONNECTIONS] [-d DEPTH] [-n REQUESTS] SOCKET PATH...
+//
+// DEPTH is the number of pipelined requests in flight per connection
+
+#include "doc_files.h"
+#include "preflight_protocol.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        std::vector<double> latencyUs;
+        size_t rejected = 0;
+        bool failed = false;
+    };
+
+    int connectTo(const char *path) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void run(const char *path, const std::vector<std::string> *docs, size_t offset,
+             size_t requests, size_t depth, Stats *stats) {
+        const int fd = connectTo(path);
+        if (fd < 0) {
+            stats->failed = true;
+            return;
+        }
+
+        std::vector<Clock::time_point> sentAt(requests);
+        stats->latencyUs.reserve(requests);
+        preflight::FrameReader frames;
+        std::string out;
+        size_t sent = 0;
+        size_t received = 0;
+
+        while (received < requests) {
+            // Keep the pipeline full, in a single write
+            out.clear();
+            while (sent < requests && sent - received < depth) {
+                preflight::appendFrame(&out, static_cast<uint32_t>(sent), (*docs)[(offset + sent) % docs->size()]);
+                sentAt[sent] = Clock::now();
+                sent++;
+            }
+            if (!out.empty() && !preflight::writeAll(fd, out.data(), out.size())) {
+                stats->failed = true;
+                break;
+            }
+
+            if (!frames.fill(fd)) {
+                stats->failed = true;
+                break;
+            }
+            uint32_t id = 0;
+            std::string payload;
+            while (frames.next(&id, &payload)) {
+                const auto now = Clock::now();
+                if (id >= sent) {
+                    stats->failed = true;
+                    break;
+                }
+                stats->latencyUs.push_back(std::chrono::duration<double, std::micro>(now - sentAt[id]).count());
+                if (payload.rfind("status\tnormal\tNo error\n", 0) != 0) {
+                    stats->rejected++;
+                }
+                received++;
+            }
+            if (stats->failed || frames.broken()) {
+                stats->failed = true;
+                break;
+            }
+        }
+        close(fd);
+    }
+
+    double percentile(const std::vector<double> &sorted, double p) {
+        const auto idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+        return sorted[idx];
+    }
+
+    void usage(const char *name) {
+        fprintf(stderr, "usage: %s [-c CONNECTIONS] [-d DEPTH] [-n REQUESTS] SOCKET PATH...\n", name);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t connections = 4;
+    size_t depth = 8;
+    size_t requests = 10000;
+    int i = 1;
+    for (; i + 1 < argc && argv[i][0] == '-'; i += 2) {
+        const std::string opt = argv[i];
+        const size_t value = strtoul(argv[i + 1], nullptr, 10);
+        if (opt == "-c") {
+            connections = value;
+        } else if (opt == "-d") {
+            depth = value;
+        } else if (opt == "-n") {
+            requests = value;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (argc - i < 2 || connections == 0 || depth == 0 || requests == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    const char *socketPath = argv[i++];
+
+    std::vector<std::string> paths;
+    for (; i < argc; i++) {
+        if (!tools::collectDocs(argv[i], &paths)) {
+            fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[i]);
+            return 2;
+        }
+    }
+    std::vector<std::string> docs;
+    for (const auto &p : paths) {
+        std::ifstream file(p, std::ios::binary);
+        docs.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    if (docs.empty()) {
+        fprintf(stderr, "%s: no sign docs\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<Stats> stats(connections);
+    std::vector<std::thread> threads;
+    const auto start = Clock::now();
+    for (size_t c = 0; c < connections; c++) {
+        // Requests are split evenly, the first connections take the remainder
+        const size_t share = requests / connections + (c < requests % connections ? 1 : 0);
+        threads.emplace_back(run, socketPath, &docs, c * docs.size() / connections, share, depth, &stats[c]);
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> latency;
+    size_t rejected = 0;
+    bool failed = false;
+    for (const auto &s : stats) {
+        latency.insert(latency.end(), s.latencyUs.begin(), s.latencyUs.end());
+        rejected += s.rejected;
+        failed |= s.failed;
+    }
+    if (failed) {
+        fprintf(stderr, "%s: connection to %s failed\n", argv[0], socketPath);
+    }
+    if (latency.empty()) {
+        return 1;
+    }
+    std::sort(latency.begin(), latency.end());
+
+    printf("%zu requests, %zu rejected, %zu connections, depth %zu\n",
+           latency.size(), rejected, connections, depth);
+    printf("%.0f req/s, latency p50 %.1f us, p99 %.1f us, max %.1f us\n",
+           (double) latency.size() / seconds,
+           percentile(latency, 0.50), percentile(latency, 0.99), latency.back());
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,138 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// Pre-flight protocol, over a Unix stream socket.
+//
+// Requests and responses are frames:
+//   [LEN (4)] [ID (4)] [PAYLOAD (LEN - 4)]      big endian
+// A request payload is a sign doc. Requests can be pipelined: responses carry the ID
+// of their request and may come back in any order.
+//
+// A response payload has one line per entry, fields separated by tabs:
+//   status  MODE  ERROR                                 (once per mode, "No error" when valid)
+//   item    MODE  IDX  PAGE  PAGE_COUNT  KEY  VALUE    (valid docs only, one per page)
+//   error   MODE  IDX  PAGE  ERROR                      (page that could not be rendered)
+// MODE is "normal" and then "expert". Items never contain tabs or line breaks
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unistd.h>
+
+namespace preflight {
+
+constexpr uint32_t MAX_FRAME_LEN = 1u << 20u;
+constexpr size_t FRAME_HEADER_LEN = 8;
+
+inline void putU32(char *p, uint32_t v) {
+    p[0] = static_cast<char>(v >> 24u);
+    p[1] = static_cast<char>(v >> 16u);
+    p[2] = static_cast<char>(v >> 8u);
+    p[3] = static_cast<char>(v);
+}
+
+inline uint32_t getU32(const char *p) {
+    const auto *u = reinterpret_cast<const uint8_t *>(p);
+    return (uint32_t(u[0]) << 24u) | (uint32_t(u[1]) << 16u) | (uint32_t(u[2]) << 8u) | uint32_t(u[3]);
+}
+
+/// Appends a frame to out
+inline void appendFrame(std::string *out, uint32_t id, std::string_view payload) {
+    char header[FRAME_HEADER_LEN];
+    putU32(header, static_cast<uint32_t>(payload.size() + 4));
+    putU32(header + 4, id);
+    out->append(header, sizeof(header));
+    out->append(payload);
+}
+
+inline bool writeAll(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        const ssize_t n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/// Collects bytes read from a socket and splits them into frames
+class FrameReader {
+public:
+    /// Reads whatever is available (blocking until something is). False on EOF or error
+    bool fill(int fd) {
+        char chunk[64 * 1024];
+        ssize_t n;
+        do {
+            n = read(fd, chunk, sizeof(chunk));
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) {
+            return false;
+        }
+        buffer_.append(chunk, static_cast<size_t>(n));
+        return true;
+    }
+
+    /// Takes the next complete frame. False when more bytes are needed
+    bool next(uint32_t *id, std::string *payload) {
+        const size_t avail = buffer_.size() - pos_;
+        if (avail < FRAME_HEADER_LEN) {
+            compact();
+            return false;
+        }
+        const uint32_t len = getU32(buffer_.data() + pos_);
+        if (len < 4 || len > MAX_FRAME_LEN) {
+            // see broken()
+            return false;
+        }
+        if (avail < 4 + static_cast<size_t>(len)) {
+            compact();
+            return false;
+        }
+        *id = getU32(buffer_.data() + pos_ + 4);
+        payload->assign(buffer_, pos_ + FRAME_HEADER_LEN, len - 4);
+        pos_ += 4 + len;
+        return true;
+    }
+
+    /// A frame header announces a length that can never be valid
+    bool broken() const {
+        if (buffer_.size() - pos_ < 4) {
+            return false;
+        }
+        const uint32_t len = getU32(buffer_.data() + pos_);
+        return len < 4 || len > MAX_FRAME_LEN;
+    }
+
+private:
+    void compact() {
+        buffer_.erase(0, pos_);
+        pos_ = 0;
+    }
+
+    std::string buffer_;
+    size_t pos_ = 0;
+};
+
+}
@@ -0,0 +1,233 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// Tells what the device will show for a sign doc, in normal and expert mode, and whether
+// it will be rejected. See preflight_protocol.h
+//
+//   preflight-server [-j THREADS] [--target nanos|nanox] SOCKET
+//
+// Docs are reviewed with the size limit, JSON engine and page width of the target (nanox by default)
+
+#include <tx_view.hpp>
+#include "device_target.h"
+#include "preflight_protocol.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    // Jobs a worker takes at once
+    constexpr size_t WORKER_BATCH = 16;
+
+    struct Connection {
+        explicit Connection(int fd) : fd(fd) {}
+
+        ~Connection() { close(fd); }
+
+        const int fd;
+        std::mutex writeMutex;
+    };
+
+    struct Job {
+        std::shared_ptr<Connection> conn;
+        uint32_t id;
+        std::string doc;
+    };
+
+    class JobQueue {
+    public:
+        void push(std::vector<Job> *jobs) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (auto &job : *jobs) {
+                    jobs_.push_back(std::move(job));
+                }
+            }
+            jobs->clear();
+            cv_.notify_all();
+        }
+
+        void pop(std::vector<Job> *jobs) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return !jobs_.empty(); });
+            while (!jobs_.empty() && jobs->size() < WORKER_BATCH) {
+                jobs->push_back(std::move(jobs_.front()));
+                jobs_.pop_front();
+            }
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<Job> jobs_;
+    };
+
+    void render(secret::TxView &view, size_t maxDocSize, const char *mode, const std::string &doc,
+                std::string *out) {
+        std::string_view status;
+        secret::TxError err = secret::TxError::ok;
+        if (doc.size() > maxDocSize) {
+            status = "Sign doc is too large";
+        } else {
+            err = view.parse(doc);
+            status = secret::describe(err);
+        }
+
+        out->append("status\t").append(mode).append("\t").append(status).append("\n");
+        if (err != secret::TxError::ok || doc.size() > maxDocSize) {
+            return;
+        }
+
+        for (const auto &item : view) {
+            const std::string position = std::string(mode) + "\t" + std::to_string(item.index) + "\t" +
+                                         std::to_string(item.page);
+            if (item.error != secret::TxError::ok) {
+                out->append("error\t").append(position).append("\t").append(secret::describe(item.error));
+            } else {
+                out->append("item\t").append(position).append("\t").append(std::to_string(item.pageCount))
+                        .append("\t").append(item.key).append("\t").append(item.value);
+            }
+            out->append("\n");
+        }
+    }
+
+    // Parser states stay warm across requests, one per mode
+    void worker(JobQueue *queue, const tools::DeviceTarget *target) {
+        secret::TxView normal = tools::makeView(*target);
+        secret::TxView expert = tools::makeView(*target);
+        normal.setExpert(false);
+        expert.setExpert(true);
+
+        std::vector<Job> jobs;
+        std::string payload;
+        std::string frames;
+        while (true) {
+            queue->pop(&jobs);
+            for (size_t i = 0; i < jobs.size(); i++) {
+                payload.clear();
+                render(normal, target->maxDocSize, "normal", jobs[i].doc, &payload);
+                render(expert, target->maxDocSize, "expert", jobs[i].doc, &payload);
+                preflight::appendFrame(&frames, jobs[i].id, payload);
+
+                // One write for all the responses of a connection in this batch
+                if (i + 1 == jobs.size() || jobs[i + 1].conn != jobs[i].conn) {
+                    std::lock_guard<std::mutex> lock(jobs[i].conn->writeMutex);
+                    preflight::writeAll(jobs[i].conn->fd, frames.data(), frames.size());
+                    frames.clear();
+                }
+            }
+            jobs.clear();
+        }
+    }
+
+    // Every frame available is queued in a single batch
+    void reader(std::shared_ptr<Connection> conn, JobQueue *queue) {
+        preflight::FrameReader frames;
+        std::vector<Job> batch;
+        while (frames.fill(conn->fd)) {
+            Job job{conn, 0, {}};
+            while (frames.next(&job.id, &job.doc)) {
+                batch.push_back(std::move(job));
+                job = Job{conn, 0, {}};
+            }
+            if (frames.broken()) {
+                fprintf(stderr, "dropping connection: bad frame\n");
+                break;
+            }
+            queue->push(&batch);
+        }
+        shutdown(conn->fd, SHUT_RD);
+    }
+
+    const char *socketPath = nullptr;
+
+    void onSignal(int) {
+        unlink(socketPath);
+        _exit(0);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    const tools::DeviceTarget *target = &tools::DEFAULT_TARGET;
+    int i = 1;
+    if (i + 1 < argc && std::string(argv[i]) == "-j") {
+        numThreads = strtoul(argv[i + 1], nullptr, 10);
+        i += 2;
+    }
+    if (i + 1 < argc && std::string(argv[i]) == "--target") {
+        target = tools::findTarget(argv[i + 1]);
+        i += 2;
+    }
+    if (i + 1 != argc || numThreads == 0 || target == nullptr) {
+        fprintf(stderr, "usage: %s [-j THREADS] [--target nanos|nanox] SOCKET\n", argv[0]);
+        return 2;
+    }
+    socketPath = argv[i];
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "%s: socket path is too long\n", argv[0]);
+        return 2;
+    }
+    strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path) - 1);
+
+    const int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath);
+    if (listenFd < 0 ||
+        bind(listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        listen(listenFd, SOMAXCONN) != 0) {
+        perror(argv[0]);
+        return 1;
+    }
+
+    // Clients going away are noticed when writing
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    JobQueue queue;
+    for (size_t t = 0; t < numThreads; t++) {
+        std::thread(worker, &queue, target).detach();
+    }
+    fprintf(stderr, "listening on %s, %zu threads, %s\n", socketPath, numThreads, target->name);
+
+    while (true) {
+        const int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror(argv[0]);
+            return 1;
+        }
+        std::thread(reader, std::make_shared<Connection>(fd), &queue).detach();
+    }
+}
@@ -0,0 +1,96 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// Software versions of the cx calls made by the app: SHA-256, RIPEMD-160 and secp256k1 ECDSA
+
+#include "os.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CX_LAST                     (1 << 0)
+#define CX_RND_RFC6979              (3 << 9)
+
+#define CX_SHA256_SIZE              32
+#define CX_RIPEMD160_SIZE           20
+
+#define CX_ECCINFO_PARITY_ODD       1
+#define CX_ECCINFO_xGTn             2
+
+typedef enum {
+    CX_RIPEMD160 = 1,
+    CX_SHA256 = 3,
+} cx_md_t;
+
+typedef enum {
+    CX_CURVE_SECP256K1 = 0x21,
+} cx_curve_t;
+
+#define CX_CURVE_256K1              CX_CURVE_SECP256K1
+
+typedef struct {
+    cx_md_t algo;
+} cx_hash_t;
+
+typedef struct {
+    cx_hash_t header;
+    uint32_t blocks;
+    uint8_t block[64];
+    uint8_t blockLen;
+    uint32_t state[5];
+    uint64_t length;
+} cx_ripemd160_t;
+
+typedef struct {
+    cx_curve_t curve;
+    size_t d_len;
+    uint8_t d[32];
+} cx_ecfp_private_key_t;
+
+typedef struct {
+    cx_curve_t curve;
+    size_t W_len;
+    uint8_t W[65];
+} cx_ecfp_public_key_t;
+
+int cx_ripemd160_init(cx_ripemd160_t *hash);
+
+/// Only RIPEMD-160 contexts are supported
+int cx_hash(cx_hash_t *hash, int mode, const unsigned char *in, unsigned int len,
+            unsigned char *out, unsigned int out_len);
+
+int cx_hash_sha256(const unsigned char *in, unsigned int len, unsigned char *out, unsigned int out_len);
+
+int cx_ecfp_init_private_key(cx_curve_t curve, const unsigned char *rawkey, unsigned int key_len,
+                             cx_ecfp_private_key_t *pvkey);
+
+int cx_ecfp_init_public_key(cx_curve_t curve, const unsigned char *rawkey, unsigned int key_len,
+                            cx_ecfp_public_key_t *key);
+
+/// Public key of pvkey, uncompressed. A new private key is never generated (keepprivate is required)
+int cx_ecfp_generate_pair(cx_curve_t curve, cx_ecfp_public_key_t *pubkey,
+                          cx_ecfp_private_key_t *privkey, int keepprivate);
+
+/// Deterministic (RFC 6979) DER signature with a low S, as the device returns it
+int cx_ecdsa_sign(const cx_ecfp_private_key_t *pvkey, int mode, cx_md_t hashID,
+                  const unsigned char *hash, unsigned int hash_len,
+                  unsigned char *sig, unsigned int sig_len, unsigned int *info);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,159 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// Host stand-in for the parts of the BOLOS SDK the app uses (see sim_device.h)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <zxmacros.h>
+
+#ifndef PIC
+#define PIC(x) (x)
+#endif
+#ifndef NV_VOLATILE
+#define NV_VOLATILE volatile
+#endif
+#ifndef MEMCPY_NV
+#define MEMCPY_NV(dst, src, len) memcpy((void *) (dst), (src), (len))
+#endif
+
+#define TARGET_ID                   0x33000004
+
+////////////////////////////////////////////////
+// Exceptions, same layout as the SDK: a stack of setjmp contexts
+
+typedef unsigned short exception_t;
+
+typedef struct try_context_s {
+    jmp_buf jmp_buf;
+    struct try_context_s *previous;
+    exception_t ex;
+} try_context_t;
+
+try_context_t *try_context_get(void);
+
+try_context_t *try_context_set(try_context_t *context);
+
+__attribute__((noreturn)) void os_longjmp(unsigned int exception);
+
+#define EXCEPTION                   1
+#define INVALID_PARAMETER           2
+#define EXCEPTION_OVERFLOW          3
+#define EXCEPTION_SECURITY          4
+#define INVALID_CRC                 5
+#define INVALID_CHECKSUM            6
+#define INVALID_COUNTER             7
+#define NOT_SUPPORTED               8
+#define INVALID_STATE               9
+#define TIMEOUT                     10
+#define EXCEPTION_PIC               11
+#define EXCEPTION_APPEXIT           12
+#define EXCEPTION_IO_OVERFLOW       13
+#define EXCEPTION_IO_HEADER         14
+#define EXCEPTION_IO_STATE          15
+#define EXCEPTION_IO_RESET          16
+#define EXCEPTION_CXPORT            17
+#define EXCEPTION_SYSTEM            18
+
+#define BEGIN_TRY                                                   \
+    {                                                               \
+        try_context_t __try0;
+
+#define TRY                                                         \
+        __try0.previous = try_context_get();                        \
+        __try0.ex = (exception_t) setjmp(__try0.jmp_buf);           \
+        if (__try0.ex == 0) {                                       \
+            try_context_set(&__try0);
+
+#define CATCH(x)                                                    \
+            goto __FINALLY0;                                        \
+        } else if (__try0.ex == (x)) {                              \
+            __try0.ex = 0;                                          \
+            try_context_set(__try0.previous);
+
+#define CATCH_OTHER(e)                                              \
+            goto __FINALLY0;                                        \
+        } else {                                                    \
+            exception_t e;                                          \
+            e = __try0.ex;                                          \
+            __try0.ex = 0;                                          \
+            (void) e;                                               \
+            try_context_set(__try0.previous);
+
+#define FINALLY                                                     \
+            goto __FINALLY0;                                        \
+        }                                                           \
+        __FINALLY0:                                                 \
+        if (try_context_get() == &__try0) {                         \
+            try_context_set(__try0.previous);                       \
+        }
+
+#define END_TRY                                                     \
+        if (__try0.ex != 0) {                                       \
+            os_longjmp(__try0.ex);                                  \
+        }                                                           \
+    }
+
+#define THROW(x) os_longjmp(x)
+
+////////////////////////////////////////////////
+// APDU exchange
+
+#define IO_APDU_BUFFER_SIZE         (5 + 255)
+
+#define CHANNEL_APDU                0
+#define CHANNEL_KEYBOARD            1
+#define CHANNEL_SPI                 2
+
+#define IO_RESET_AFTER_REPLIED      0x80
+#define IO_RECEIVE_DATA             0x40
+#define IO_RETURN_AFTER_TX          0x20
+#define IO_ASYNCH_REPLY             0x10
+#define IO_FLAGS                    0xF8
+
+extern unsigned char G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+
+/// Sends tx_len bytes of G_io_apdu_buffer and waits for the next command, see sim_device_run
+unsigned short io_exchange(unsigned char channel_and_flags, unsigned short tx_len);
+
+////////////////////////////////////////////////
+// System
+
+#define BOLOS_UX_OK                 0xAA
+
+unsigned int os_global_pin_is_validated(void);
+
+unsigned int os_version(unsigned char *version, unsigned int maxlength);
+
+unsigned int os_seph_version(unsigned char *version, unsigned int maxlength);
+
+void reset(void);
+
+/// BIP32 derivation from the seed of the simulated device (see sim_device_config_t)
+void os_perso_derive_node_bip32(unsigned int curve,
+                                const unsigned int *path, unsigned int pathLength,
+                                unsigned char *privateKey, unsigned char *chain);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,29 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// UX events only drive the screen, which the simulator replaces with sim_view.c
+
+#define IS_UX_ALLOWED                       1
+
+#define UX_ALLOWED                          1
+#define UX_DISPLAYED()                      1
+#define UX_REDISPLAY()
+#define UX_DISPLAYED_EVENT()
+#define UX_DEFAULT_EVENT()
+#define UX_FINGER_EVENT(seph_packet)
+#define UX_BUTTON_PUSH_EVENT(seph_packet)
+#define UX_TICKER_EVENT(seph_packet, callback)
@@ -0,0 +1,48 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// Same calls as the zxlib view. Reviews are answered by the simulated user, see sim_device.h
+
+#include <stdint.h>
+#include "zxerror.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef zxerr_t (*viewfunc_getNumItems_t)(uint8_t *num_items);
+
+typedef zxerr_t (*viewfunc_getItem_t)(int8_t displayIdx,
+                                      char *outKey, uint16_t outKeyLen,
+                                      char *outVal, uint16_t outValLen,
+                                      uint8_t pageIdx, uint8_t *pageCount);
+
+typedef void (*viewfunc_accept_t)();
+
+void view_init();
+
+void view_idle_show(uint8_t item_idx, char *statusString);
+
+void view_review_init(viewfunc_getItem_t viewfuncGetItem,
+                      viewfunc_getNumItems_t viewfuncGetNumItems,
+                      viewfunc_accept_t viewfuncAccept);
+
+void view_review_show(unsigned int requireReply);
+
+#ifdef __cplusplus
+}
+#endif
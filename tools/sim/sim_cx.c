@@ -0,0 +1,864 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// Software crypto for the simulator. Straightforward and NOT constant time: never use it with real keys
+
+#include "sim_internal.h"
+
+#include <cx.h>
+
+#include "sha256.h"
+
+////////////////////////////////////////////////
+// SHA-512, HMAC and PBKDF2 (BIP32 and BIP39)
+
+#define SHA512_DIGEST_SIZE 64u
+
+typedef struct {
+    uint64_t state[8];
+    uint64_t length;
+    uint8_t block[128];
+    uint8_t blockLen;
+} sha512_ctx_t;
+
+static const uint64_t sha512_k[80] = {
+        0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+        0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+        0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+        0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+        0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+        0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+        0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+        0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+        0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+        0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+        0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+        0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+        0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+        0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+        0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+        0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+        0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+        0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+        0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+        0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL,
+};
+
+#define ROR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+static void sha512_block(sha512_ctx_t *ctx, const uint8_t *block) {
+    uint64_t w[80];
+    for (uint8_t i = 0; i < 16; i++) {
+        w[i] = 0;
+        for (uint8_t j = 0; j < 8; j++) {
+            w[i] = (w[i] << 8) | block[i * 8 + j];
+        }
+    }
+    for (uint8_t i = 16; i < 80; i++) {
+        const uint64_t s0 = ROR64(w[i - 15], 1) ^ ROR64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+        const uint64_t s1 = ROR64(w[i - 2], 19) ^ ROR64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint64_t v[8];
+    MEMCPY(v, ctx->state, sizeof(v));
+    for (uint8_t i = 0; i < 80; i++) {
+        const uint64_t s1 = ROR64(v[4], 14) ^ ROR64(v[4], 18) ^ ROR64(v[4], 41);
+        const uint64_t ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+        const uint64_t t1 = v[7] + s1 + ch + sha512_k[i] + w[i];
+        const uint64_t s0 = ROR64(v[0], 28) ^ ROR64(v[0], 34) ^ ROR64(v[0], 39);
+        const uint64_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+        MEMMOVE(v + 1, v, 7 * sizeof(uint64_t));
+        v[4] += t1;
+        v[0] = t1 + s0 + maj;
+    }
+    for (uint8_t i = 0; i < 8; i++) {
+        ctx->state[i] += v[i];
+    }
+}
+
+static void sha512_init(sha512_ctx_t *ctx) {
+    static const uint64_t iv[8] = {
+            0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+            0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL,
+    };
+    MEMZERO(ctx, sizeof(*ctx));
+    MEMCPY(ctx->state, iv, sizeof(iv));
+}
+
+static void sha512_update(sha512_ctx_t *ctx, const uint8_t *data, size_t dataLen) {
+    ctx->length += dataLen;
+    while (dataLen > 0) {
+        size_t n = sizeof(ctx->block) - ctx->blockLen;
+        if (n > dataLen) {
+            n = dataLen;
+        }
+        MEMCPY(ctx->block + ctx->blockLen, data, n);
+        ctx->blockLen += n;
+        data += n;
+        dataLen -= n;
+        if (ctx->blockLen == sizeof(ctx->block)) {
+            sha512_block(ctx, ctx->block);
+            ctx->blockLen = 0;
+        }
+    }
+}
+
+static void sha512_final(sha512_ctx_t *ctx, uint8_t *digest) {
+    const uint64_t bits = ctx->length * 8;
+    uint8_t pad[144] = {0x80};
+    const size_t padLen = (ctx->blockLen < 112 ? 112 : 240) - ctx->blockLen;
+    // Lengths above 2^64 bits are not needed, the upper half of the 128 bit length stays zero
+    for (uint8_t i = 0; i < 8; i++) {
+        pad[padLen + 8 + i] = (uint8_t) (bits >> (56 - 8 * i));
+    }
+    sha512_update(ctx, pad, padLen + 16);
+    for (uint8_t i = 0; i < SHA512_DIGEST_SIZE; i++) {
+        digest[i] = (uint8_t) (ctx->state[i / 8] >> (56 - 8 * (i % 8)));
+    }
+}
+
+static void hmac_sha512(const uint8_t *key, size_t keyLen,
+                        const uint8_t *data, size_t dataLen,
+                        uint8_t *mac) {
+    uint8_t pad[128] = {0};
+    if (keyLen > sizeof(pad)) {
+        sha512_ctx_t ctx;
+        sha512_init(&ctx);
+        sha512_update(&ctx, key, keyLen);
+        sha512_final(&ctx, pad);
+    } else {
+        MEMCPY(pad, key, keyLen);
+    }
+
+    uint8_t inner[SHA512_DIGEST_SIZE];
+    sha512_ctx_t ctx;
+    for (uint8_t i = 0; i < sizeof(pad); i++) {
+        pad[i] ^= 0x36;
+    }
+    sha512_init(&ctx);
+    sha512_update(&ctx, pad, sizeof(pad));
+    sha512_update(&ctx, data, dataLen);
+    sha512_final(&ctx, inner);
+
+    for (uint8_t i = 0; i < sizeof(pad); i++) {
+        pad[i] ^= 0x36 ^ 0x5c;
+    }
+    sha512_init(&ctx);
+    sha512_update(&ctx, pad, sizeof(pad));
+    sha512_update(&ctx, inner, sizeof(inner));
+    sha512_final(&ctx, mac);
+}
+
+// HMAC-SHA256 over the concatenation of up to three parts (RFC 6979)
+static void hmac_sha256(const uint8_t *key, size_t keyLen,
+                        const uint8_t *a, size_t aLen,
+                        const uint8_t *b, size_t bLen,
+                        const uint8_t *c, size_t cLen,
+                        uint8_t *mac) {
+    uint8_t pad[64] = {0};
+    MEMCPY(pad, key, keyLen);
+
+    uint8_t inner[SHA256_DIGEST_SIZE];
+    sha256_ctx_t ctx;
+    for (uint8_t i = 0; i < sizeof(pad); i++) {
+        pad[i] ^= 0x36;
+    }
+    sha256_init(&ctx);
+    sha256_update(&ctx, pad, sizeof(pad));
+    sha256_update(&ctx, a, aLen);
+    sha256_update(&ctx, b, bLen);
+    sha256_update(&ctx, c, cLen);
+    sha256_final(&ctx, inner);
+
+    for (uint8_t i = 0; i < sizeof(pad); i++) {
+        pad[i] ^= 0x36 ^ 0x5c;
+    }
+    sha256_init(&ctx);
+    sha256_update(&ctx, pad, sizeof(pad));
+    sha256_update(&ctx, inner, sizeof(inner));
+    sha256_final(&ctx, mac);
+}
+
+// PBKDF2-HMAC-SHA512 with 2048 iterations and a 64 byte output, as in BIP39
+static void bip39_seed(const char *mnemonic, uint8_t *seed) {
+    const uint8_t salt[] = {'m', 'n', 'e', 'm', 'o', 'n', 'i', 'c', 0, 0, 0, 1};
+    uint8_t u[SHA512_DIGEST_SIZE];
+    hmac_sha512((const uint8_t *) mnemonic, strlen(mnemonic), salt, sizeof(salt), u);
+    MEMCPY(seed, u, sizeof(u));
+    for (uint16_t i = 1; i < 2048; i++) {
+        hmac_sha512((const uint8_t *) mnemonic, strlen(mnemonic), u, sizeof(u), u);
+        for (uint8_t j = 0; j < sizeof(u); j++) {
+            seed[j] ^= u[j];
+        }
+    }
+}
+
+////////////////////////////////////////////////
+// RIPEMD-160
+
+static const uint8_t rmd_r[2][80] = {
+        {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+         7, 4, 13, 1, 10, 6, 15, 3, 12, 0, 9, 5, 2, 14, 11, 8,
+         3, 10, 14, 4, 9, 15, 8, 1, 2, 7, 0, 6, 13, 11, 5, 12,
+         1, 9, 11, 10, 0, 8, 12, 4, 13, 3, 7, 15, 14, 5, 6, 2,
+         4, 0, 5, 9, 7, 12, 2, 10, 14, 1, 3, 8, 11, 6, 15, 13},
+        {5, 14, 7, 0, 9, 2, 11, 4, 13, 6, 15, 8, 1, 10, 3, 12,
+         6, 11, 3, 7, 0, 13, 5, 10, 14, 15, 8, 12, 4, 9, 1, 2,
+         15, 5, 1, 3, 7, 14, 6, 9, 11, 8, 12, 2, 10, 0, 4, 13,
+         8, 6, 4, 1, 3, 11, 15, 0, 5, 12, 2, 13, 9, 7, 10, 14,
+         12, 15, 10, 4, 1, 5, 8, 7, 6, 2, 13, 14, 0, 3, 9, 11},
+};
+
+static const uint8_t rmd_s[2][80] = {
+        {11, 14, 15, 12, 5, 8, 7, 9, 11, 13, 14, 15, 6, 7, 9, 8,
+         7, 6, 8, 13, 11, 9, 7, 15, 7, 12, 15, 9, 11, 7, 13, 12,
+         11, 13, 6, 7, 14, 9, 13, 15, 14, 8, 13, 6, 5, 12, 7, 5,
+         11, 12, 14, 15, 14, 15, 9, 8, 9, 14, 5, 6, 8, 6, 5, 12,
+         9, 15, 5, 11, 6, 8, 13, 12, 5, 12, 13, 14, 11, 8, 5, 6},
+        {8, 9, 9, 11, 13, 15, 15, 5, 7, 7, 8, 11, 14, 14, 12, 6,
+         9, 13, 15, 7, 12, 8, 9, 11, 7, 7, 12, 7, 6, 15, 13, 11,
+         9, 7, 15, 11, 8, 6, 6, 14, 12, 13, 5, 14, 13, 13, 7, 5,
+         15, 5, 8, 11, 14, 14, 6, 14, 6, 9, 12, 9, 12, 5, 15, 8,
+         8, 5, 12, 9, 12, 5, 14, 6, 8, 13, 6, 5, 15, 13, 11, 11},
+};
+
+static const uint32_t rmd_k[2][5] = {
+        {0x00000000, 0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xA953FD4E},
+        {0x50A28BE6, 0x5C4DD124, 0x6D703EF3, 0x7A6D76E9, 0x00000000},
+};
+
+#define ROL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+__Z_INLINE uint32_t rmd_f(uint8_t round, uint32_t x, uint32_t y, uint32_t z) {
+    switch (round) {
+        case 0:
+            return x ^ y ^ z;
+        case 1:
+            return (x & y) | (~x & z);
+        case 2:
+            return (x | ~y) ^ z;
+        case 3:
+            return (x & z) | (y & ~z);
+        default:
+            return x ^ (y | ~z);
+    }
+}
+
+static void ripemd160_block(cx_ripemd160_t *ctx, const uint8_t *block) {
+    uint32_t x[16];
+    for (uint8_t i = 0; i < 16; i++) {
+        x[i] = (uint32_t) block[4 * i] | ((uint32_t) block[4 * i + 1] << 8) |
+               ((uint32_t) block[4 * i + 2] << 16) | ((uint32_t) block[4 * i + 3] << 24);
+    }
+
+    uint32_t v[2][5];
+    for (uint8_t line = 0; line < 2; line++) {
+        MEMCPY(v[line], ctx->state, sizeof(ctx->state));
+        for (uint8_t j = 0; j < 80; j++) {
+            // The right line uses the rounds in reverse order
+            const uint8_t round = line == 0 ? j / 16 : 4 - j / 16;
+            uint32_t t = v[line][0] + rmd_f(round, v[line][1], v[line][2], v[line][3]) +
+                         x[rmd_r[line][j]] + rmd_k[line][j / 16];
+            t = ROL32(t, rmd_s[line][j]) + v[line][4];
+            v[line][0] = v[line][4];
+            v[line][4] = v[line][3];
+            v[line][3] = ROL32(v[line][2], 10);
+            v[line][2] = v[line][1];
+            v[line][1] = t;
+        }
+    }
+
+    const uint32_t t = ctx->state[1] + v[0][2] + v[1][3];
+    ctx->state[1] = ctx->state[2] + v[0][3] + v[1][4];
+    ctx->state[2] = ctx->state[3] + v[0][4] + v[1][0];
+    ctx->state[3] = ctx->state[4] + v[0][0] + v[1][1];
+    ctx->state[4] = ctx->state[0] + v[0][1] + v[1][2];
+    ctx->state[0] = t;
+}
+
+static void ripemd160_update(cx_ripemd160_t *ctx, const uint8_t *data, size_t dataLen) {
+    ctx->length += dataLen;
+    while (dataLen > 0) {
+        size_t n = sizeof(ctx->block) - ctx->blockLen;
+        if (n > dataLen) {
+            n = dataLen;
+        }
+        MEMCPY(ctx->block + ctx->blockLen, data, n);
+        ctx->blockLen += n;
+        data += n;
+        dataLen -= n;
+        if (ctx->blockLen == sizeof(ctx->block)) {
+            ripemd160_block(ctx, ctx->block);
+            ctx->blockLen = 0;
+            ctx->blocks++;
+        }
+    }
+}
+
+static void ripemd160_final(cx_ripemd160_t *ctx, uint8_t *digest) {
+    const uint64_t bits = ctx->length * 8;
+    uint8_t pad[72] = {0x80};
+    const size_t padLen = (ctx->blockLen < 56 ? 56 : 120) - ctx->blockLen;
+    for (uint8_t i = 0; i < 8; i++) {
+        pad[padLen + i] = (uint8_t) (bits >> (8 * i));
+    }
+    ripemd160_update(ctx, pad, padLen + 8);
+    for (uint8_t i = 0; i < CX_RIPEMD160_SIZE; i++) {
+        digest[i] = (uint8_t) (ctx->state[i / 4] >> (8 * (i % 4)));
+    }
+}
+
+int cx_ripemd160_init(cx_ripemd160_t *hash) {
+    static const uint32_t iv[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    MEMZERO(hash, sizeof(*hash));
+    hash->header.algo = CX_RIPEMD160;
+    MEMCPY(hash->state, iv, sizeof(iv));
+    return CX_RIPEMD160;
+}
+
+int cx_hash(cx_hash_t *hash, int mode, const unsigned char *in, unsigned int len,
+            unsigned char *out, unsigned int out_len) {
+    if (hash->algo != CX_RIPEMD160) {
+        THROW(INVALID_PARAMETER);
+    }
+    cx_ripemd160_t *ctx = (cx_ripemd160_t *) hash;
+    ripemd160_update(ctx, in, len);
+    if ((mode & CX_LAST) == 0) {
+        return 0;
+    }
+    if (out_len < CX_RIPEMD160_SIZE) {
+        THROW(INVALID_PARAMETER);
+    }
+    ripemd160_final(ctx, out);
+    return CX_RIPEMD160_SIZE;
+}
+
+int cx_hash_sha256(const unsigned char *in, unsigned int len, unsigned char *out, unsigned int out_len) {
+    if (out_len < CX_SHA256_SIZE) {
+        THROW(INVALID_PARAMETER);
+    }
+    sha256_digest(in, len, out);
+    return CX_SHA256_SIZE;
+}
+
+////////////////////////////////////////////////
+// Arithmetic modulo m = 2^256 - c, on little endian 32 bit limbs
+
+#define LIMBS 8
+
+typedef struct {
+    uint32_t m[LIMBS];
+    uint32_t c[5];
+    uint8_t cLen;
+} modulus_t;
+
+static const modulus_t secp256k1_p = {
+        {0xFFFFFC2F, 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF},
+        {0x000003D1, 0x00000001},
+        2,
+};
+
+static const modulus_t secp256k1_n = {
+        {0xD0364141, 0xBFD25E8C, 0xAF48A03B, 0xBAAEDCE6, 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF},
+        {0x2FC9BEBF, 0x402DA173, 0x50B75FC4, 0x45512319, 0x00000001},
+        5,
+};
+
+typedef struct {
+    uint32_t x[LIMBS];
+    uint32_t y[LIMBS];
+} point_t;
+
+static const point_t secp256k1_g = {
+        {0x16F81798, 0x59F2815B, 0x2DCE28D9, 0x029BFCDB, 0xCE870B07, 0x55A06295, 0xF9DCBBAC, 0x79BE667E},
+        {0xFB10D4B8, 0x9C47D08F, 0xA6855419, 0xFD17B448, 0x0E1108A8, 0x5DA4FBFC, 0x26A3C465, 0x483ADA77},
+};
+
+static void num_from_bytes(uint32_t *r, const uint8_t *in) {
+    for (uint8_t i = 0; i < LIMBS; i++) {
+        const uint8_t *p = in + 4 * (LIMBS - 1 - i);
+        r[i] = ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+    }
+}
+
+static void num_to_bytes(uint8_t *out, const uint32_t *a) {
+    for (uint8_t i = 0; i < LIMBS; i++) {
+        uint8_t *p = out + 4 * (LIMBS - 1 - i);
+        p[0] = (uint8_t) (a[i] >> 24);
+        p[1] = (uint8_t) (a[i] >> 16);
+        p[2] = (uint8_t) (a[i] >> 8);
+        p[3] = (uint8_t) a[i];
+    }
+}
+
+static int8_t num_cmp(const uint32_t *a, const uint32_t *b) {
+    for (int8_t i = LIMBS - 1; i >= 0; i--) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static bool num_is_zero(const uint32_t *a) {
+    for (uint8_t i = 0; i < LIMBS; i++) {
+        if (a[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// r = a - b, returns the borrow
+static uint32_t num_sub(uint32_t *r, const uint32_t *a, const uint32_t *b) {
+    uint64_t borrow = 0;
+    for (uint8_t i = 0; i < LIMBS; i++) {
+        const uint64_t d = (uint64_t) a[i] - b[i] - borrow;
+        r[i] = (uint32_t) d;
+        borrow = (d >> 32) & 1;
+    }
+    return (uint32_t) borrow;
+}
+
+// r = a + b, returns the carry
+static uint32_t num_add(uint32_t *r, const uint32_t *a, const uint32_t *b) {
+    uint64_t carry = 0;
+    for (uint8_t i = 0; i < LIMBS; i++) {
+        carry += (uint64_t) a[i] + b[i];
+        r[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+    return (uint32_t) carry;
+}
+
+static void mod_add(uint32_t *r, const uint32_t *a, const uint32_t *b, const modulus_t *mod) {
+    const uint32_t carry = num_add(r, a, b);
+    if (carry != 0 || num_cmp(r, mod->m) >= 0) {
+        num_sub(r, r, mod->m);
+    }
+}
+
+static void mod_sub(uint32_t *r, const uint32_t *a, const uint32_t *b, const modulus_t *mod) {
+    if (num_sub(r, a, b) != 0) {
+        num_add(r, r, mod->m);
+    }
+}
+
+// Reduces t (len limbs) folding the limbs above 2^256 with 2^256 = c
+static void mod_reduce(uint32_t *r, const uint32_t *t, uint8_t len, const modulus_t *mod) {
+    uint32_t acc[2 * LIMBS + 6];
+    MEMZERO(acc, sizeof(acc));
+    MEMCPY(acc, t, len * sizeof(uint32_t));
+
+    while (len > LIMBS) {
+        uint32_t next[2 * LIMBS + 6];
+        MEMZERO(next, sizeof(next));
+        MEMCPY(next, acc, LIMBS * sizeof(uint32_t));
+        uint8_t nextLen = LIMBS;
+        for (uint8_t i = 0; i < len - LIMBS; i++) {
+            uint64_t carry = 0;
+            uint8_t j = 0;
+            for (; j < mod->cLen; j++) {
+                carry += (uint64_t) acc[LIMBS + i] * mod->c[j] + next[i + j];
+                next[i + j] = (uint32_t) carry;
+                carry >>= 32;
+            }
+            for (; carry != 0; j++) {
+                carry += next[i + j];
+                next[i + j] = (uint32_t) carry;
+                carry >>= 32;
+            }
+            if (i + j > nextLen) {
+                nextLen = i + j;
+            }
+        }
+        while (nextLen > LIMBS && next[nextLen - 1] == 0) {
+            nextLen--;
+        }
+        MEMCPY(acc, next, sizeof(acc));
+        len = nextLen;
+    }
+
+    while (num_cmp(acc, mod->m) >= 0) {
+        num_sub(acc, acc, mod->m);
+    }
+    MEMCPY(r, acc, LIMBS * sizeof(uint32_t));
+}
+
+static void mod_mul(uint32_t *r, const uint32_t *a, const uint32_t *b, const modulus_t *mod) {
+    uint32_t t[2 * LIMBS] = {0};
+    for (uint8_t i = 0; i < LIMBS; i++) {
+        uint64_t carry = 0;
+        for (uint8_t j = 0; j < LIMBS; j++) {
+            carry += (uint64_t) a[i] * b[j] + t[i + j];
+            t[i + j] = (uint32_t) carry;
+            carry >>= 32;
+        }
+        t[i + LIMBS] = (uint32_t) carry;
+    }
+    mod_reduce(r, t, 2 * LIMBS, mod);
+}
+
+// a^(m-2), m is prime
+static void mod_inv(uint32_t *r, const uint32_t *a, const modulus_t *mod) {
+    const uint32_t two[LIMBS] = {2};
+    uint32_t e[LIMBS];
+    num_sub(e, mod->m, two);
+
+    uint32_t acc[LIMBS] = {1};
+    for (int16_t bit = 255; bit >= 0; bit--) {
+        mod_mul(acc, acc, acc, mod);
+        if ((e[bit / 32] >> (bit % 32)) & 1) {
+            mod_mul(acc, acc, a, mod);
+        }
+    }
+    MEMCPY(r, acc, sizeof(acc));
+}
+
+////////////////////////////////////////////////
+// secp256k1 points, jacobian coordinates while multiplying
+
+typedef struct {
+    uint32_t x[LIMBS];
+    uint32_t y[LIMBS];
+    uint32_t z[LIMBS];
+} jacobian_t;
+
+#define FE_MUL(r, a, b) mod_mul((r), (a), (b), &secp256k1_p)
+#define FE_ADD(r, a, b) mod_add((r), (a), (b), &secp256k1_p)
+#define FE_SUB(r, a, b) mod_sub((r), (a), (b), &secp256k1_p)
+
+static void point_double(jacobian_t *p) {
+    if (num_is_zero(p->z) || num_is_zero(p->y)) {
+        MEMZERO(p, sizeof(*p));
+        return;
+    }
+
+    uint32_t a[LIMBS], b[LIMBS], c[LIMBS], d[LIMBS], e[LIMBS], f[LIMBS], t[LIMBS];
+    FE_MUL(a, p->x, p->x);
+    FE_MUL(b, p->y, p->y);
+    FE_MUL(c, b, b);
+    // d = 2 * ((x + b)^2 - a - c)
+    FE_ADD(t, p->x, b);
+    FE_MUL(d, t, t);
+    FE_SUB(d, d, a);
+    FE_SUB(d, d, c);
+    FE_ADD(d, d, d);
+    // e = 3a, f = e^2
+    FE_ADD(e, a, a);
+    FE_ADD(e, e, a);
+    FE_MUL(f, e, e);
+
+    // z3 = 2yz
+    FE_MUL(t, p->y, p->z);
+    FE_ADD(p->z, t, t);
+    // x3 = f - 2d
+    FE_SUB(p->x, f, d);
+    FE_SUB(p->x, p->x, d);
+    // y3 = e(d - x3) - 8c
+    FE_SUB(t, d, p->x);
+    FE_MUL(p->y, e, t);
+    FE_ADD(c, c, c);
+    FE_ADD(c, c, c);
+    FE_ADD(c, c, c);
+    FE_SUB(p->y, p->y, c);
+}
+
+// p += q
+static void point_add_affine(jacobian_t *p, const point_t *q) {
+    if (num_is_zero(p->z)) {
+        MEMCPY(p->x, q->x, sizeof(p->x));
+        MEMCPY(p->y, q->y, sizeof(p->y));
+        MEMZERO(p->z, sizeof(p->z));
+        p->z[0] = 1;
+        return;
+    }
+
+    uint32_t z1z1[LIMBS], u2[LIMBS], s2[LIMBS], h[LIMBS], r[LIMBS], hh[LIMBS], hhh[LIMBS], v[LIMBS], t[LIMBS];
+    FE_MUL(z1z1, p->z, p->z);
+    FE_MUL(u2, q->x, z1z1);
+    FE_MUL(t, p->z, z1z1);
+    FE_MUL(s2, q->y, t);
+    FE_SUB(h, u2, p->x);
+    FE_SUB(r, s2, p->y);
+    if (num_is_zero(h)) {
+        if (num_is_zero(r)) {
+            point_double(p);
+        } else {
+            MEMZERO(p, sizeof(*p));
+        }
+        return;
+    }
+
+    FE_MUL(hh, h, h);
+    FE_MUL(hhh, h, hh);
+    FE_MUL(v, p->x, hh);
+    // x3 = r^2 - hhh - 2v
+    FE_MUL(p->x, r, r);
+    FE_SUB(p->x, p->x, hhh);
+    FE_SUB(p->x, p->x, v);
+    FE_SUB(p->x, p->x, v);
+    // y3 = r(v - x3) - y1 hhh
+    FE_SUB(t, v, p->x);
+    FE_MUL(t, r, t);
+    FE_MUL(hhh, p->y, hhh);
+    FE_SUB(p->y, t, hhh);
+    // z3 = z1 h
+    FE_MUL(p->z, p->z, h);
+}
+
+// k * G in affine coordinates, k is in [1, n-1]
+static void point_mul_g(point_t *r, const uint32_t *k) {
+    jacobian_t acc;
+    MEMZERO(&acc, sizeof(acc));
+    for (int16_t bit = 255; bit >= 0; bit--) {
+        point_double(&acc);
+        if ((k[bit / 32] >> (bit % 32)) & 1) {
+            point_add_affine(&acc, &secp256k1_g);
+        }
+    }
+
+    uint32_t zinv[LIMBS], zinv2[LIMBS], zinv3[LIMBS];
+    mod_inv(zinv, acc.z, &secp256k1_p);
+    FE_MUL(zinv2, zinv, zinv);
+    FE_MUL(zinv3, zinv2, zinv);
+    FE_MUL(r->x, acc.x, zinv2);
+    FE_MUL(r->y, acc.y, zinv3);
+}
+
+static void point_compress(uint8_t *out, const point_t *p) {
+    out[0] = (p->y[0] & 1) ? 0x03 : 0x02;
+    num_to_bytes(out + 1, p->x);
+}
+
+////////////////////////////////////////////////
+// Keys
+
+static char sim_cx_mnemonic[256];
+static uint8_t sim_cx_master_key[32];
+static uint8_t sim_cx_master_chain[32];
+
+void sim_cx_init(const char *mnemonic) {
+    // Stretching the mnemonic is slow, it is only done when it changes
+    if (strncmp(sim_cx_mnemonic, mnemonic, sizeof(sim_cx_mnemonic)) == 0 && sim_cx_mnemonic[0] != 0) {
+        return;
+    }
+    snprintf(sim_cx_mnemonic, sizeof(sim_cx_mnemonic), "%s", mnemonic);
+
+    uint8_t seed[SHA512_DIGEST_SIZE];
+    uint8_t node[SHA512_DIGEST_SIZE];
+    bip39_seed(mnemonic, seed);
+    const char *key = "Bitcoin seed";
+    hmac_sha512((const uint8_t *) key, strlen(key), seed, sizeof(seed), node);
+    MEMCPY(sim_cx_master_key, node, 32);
+    MEMCPY(sim_cx_master_chain, node + 32, 32);
+}
+
+void os_perso_derive_node_bip32(unsigned int curve,
+                                const unsigned int *path, unsigned int pathLength,
+                                unsigned char *privateKey, unsigned char *chain) {
+    if (curve != CX_CURVE_SECP256K1) {
+        THROW(INVALID_PARAMETER);
+    }
+
+    uint32_t k[LIMBS];
+    uint8_t c[32];
+    num_from_bytes(k, sim_cx_master_key);
+    MEMCPY(c, sim_cx_master_chain, sizeof(c));
+
+    for (unsigned int i = 0; i < pathLength; i++) {
+        // [0x00][key] for hardened children, [compressed public key] otherwise, then the index
+        uint8_t data[33 + 4];
+        if (path[i] & 0x80000000u) {
+            data[0] = 0;
+            num_to_bytes(data + 1, k);
+        } else {
+            point_t pub;
+            point_mul_g(&pub, k);
+            point_compress(data, &pub);
+        }
+        data[33] = (uint8_t) (path[i] >> 24);
+        data[34] = (uint8_t) (path[i] >> 16);
+        data[35] = (uint8_t) (path[i] >> 8);
+        data[36] = (uint8_t) path[i];
+
+        uint8_t node[SHA512_DIGEST_SIZE];
+        hmac_sha512(c, sizeof(c), data, sizeof(data), node);
+        uint32_t tweak[LIMBS];
+        num_from_bytes(tweak, node);
+        mod_reduce(tweak, tweak, LIMBS, &secp256k1_n);
+        mod_add(k, k, tweak, &secp256k1_n);
+        MEMCPY(c, node + 32, sizeof(c));
+    }
+
+    num_to_bytes(privateKey, k);
+    if (chain != NULL) {
+        MEMCPY(chain, c, sizeof(c));
+    }
+}
+
+int cx_ecfp_init_private_key(cx_curve_t curve, const unsigned char *rawkey, unsigned int key_len,
+                             cx_ecfp_private_key_t *pvkey) {
+    if (curve != CX_CURVE_SECP256K1 || key_len != sizeof(pvkey->d)) {
+        THROW(INVALID_PARAMETER);
+    }
+    pvkey->curve = curve;
+    pvkey->d_len = key_len;
+    MEMCPY(pvkey->d, rawkey, key_len);
+    return (int) key_len;
+}
+
+int cx_ecfp_init_public_key(cx_curve_t curve, const unsigned char *rawkey, unsigned int key_len,
+                            cx_ecfp_public_key_t *key) {
+    if (key_len > sizeof(key->W)) {
+        THROW(INVALID_PARAMETER);
+    }
+    MEMZERO(key, sizeof(*key));
+    key->curve = curve;
+    key->W_len = key_len;
+    if (key_len > 0) {
+        MEMCPY(key->W, rawkey, key_len);
+    }
+    return (int) key_len;
+}
+
+int cx_ecfp_generate_pair(cx_curve_t curve, cx_ecfp_public_key_t *pubkey,
+                          cx_ecfp_private_key_t *privkey, int keepprivate) {
+    if (curve != CX_CURVE_SECP256K1 || !keepprivate) {
+        THROW(INVALID_PARAMETER);
+    }
+
+    uint32_t d[LIMBS];
+    point_t pub;
+    num_from_bytes(d, privkey->d);
+    point_mul_g(&pub, d);
+
+    pubkey->curve = curve;
+    pubkey->W_len = 65;
+    pubkey->W[0] = 0x04;
+    num_to_bytes(pubkey->W + 1, pub.x);
+    num_to_bytes(pubkey->W + 33, pub.y);
+    return 0;
+}
+
+// Appends a DER integer, returns its length
+static uint8_t der_integer(uint8_t *out, const uint32_t *a) {
+    uint8_t raw[33];
+    raw[0] = 0;
+    num_to_bytes(raw + 1, a);
+    uint8_t start = 1;
+    while (start < 32 && raw[start] == 0) {
+        start++;
+    }
+    // Keep it positive
+    if (raw[start] & 0x80) {
+        start--;
+    }
+    const uint8_t len = (uint8_t) (sizeof(raw) - start);
+    out[0] = 0x02;
+    out[1] = len;
+    MEMCPY(out + 2, raw + start, len);
+    return (uint8_t) (len + 2);
+}
+
+int cx_ecdsa_sign(const cx_ecfp_private_key_t *pvkey, int mode, cx_md_t hashID,
+                  const unsigned char *hash, unsigned int hash_len,
+                  unsigned char *sig, unsigned int sig_len, unsigned int *info) {
+    if (pvkey->curve != CX_CURVE_SECP256K1 || hashID != CX_SHA256 || hash_len != CX_SHA256_SIZE ||
+        (mode & CX_RND_RFC6979) != CX_RND_RFC6979) {
+        THROW(INVALID_PARAMETER);
+    }
+
+    uint32_t d[LIMBS], z[LIMBS];
+    num_from_bytes(d, pvkey->d);
+    num_from_bytes(z, hash);
+    mod_reduce(z, z, LIMBS, &secp256k1_n);
+
+    // RFC 6979 section 3.2 with HMAC-SHA256
+    uint8_t x[32], h1[32];
+    num_to_bytes(x, d);
+    num_to_bytes(h1, z);
+    uint8_t v[32], k[32];
+    const uint8_t zero = 0;
+    const uint8_t one = 1;
+    MEMSET(v, 0x01, sizeof(v));
+    MEMZERO(k, sizeof(k));
+    uint8_t data[32 + 1 + 32];
+    MEMCPY(data, v, 32);
+    data[32] = zero;
+    MEMCPY(data + 33, x, 32);
+    hmac_sha256(k, sizeof(k), data, sizeof(data), h1, sizeof(h1), NULL, 0, k);
+    hmac_sha256(k, sizeof(k), v, sizeof(v), NULL, 0, NULL, 0, v);
+    MEMCPY(data, v, 32);
+    data[32] = one;
+    hmac_sha256(k, sizeof(k), data, sizeof(data), h1, sizeof(h1), NULL, 0, k);
+    hmac_sha256(k, sizeof(k), v, sizeof(v), NULL, 0, NULL, 0, v);
+
+    uint32_t r[LIMBS], s[LIMBS];
+    *info = 0;
+    while (true) {
+        hmac_sha256(k, sizeof(k), v, sizeof(v), NULL, 0, NULL, 0, v);
+        uint32_t nonce[LIMBS];
+        num_from_bytes(nonce, v);
+
+        if (!num_is_zero(nonce) && num_cmp(nonce, secp256k1_n.m) < 0) {
+            point_t point;
+            point_mul_g(&point, nonce);
+            mod_reduce(r, point.x, LIMBS, &secp256k1_n);
+
+            // s = (z + r d) / k
+            uint32_t t[LIMBS];
+            mod_mul(t, r, d, &secp256k1_n);
+            mod_add(t, t, z, &secp256k1_n);
+            mod_inv(s, nonce, &secp256k1_n);
+            mod_mul(s, s, t, &secp256k1_n);
+
+            if (!num_is_zero(r) && !num_is_zero(s)) {
+                *info = (point.y[0] & 1) ? CX_ECCINFO_PARITY_ODD : 0;
+                if (num_cmp(point.x, secp256k1_n.m) >= 0) {
+                    *info |= CX_ECCINFO_xGTn;
+                }
+                break;
+            }
+        }
+
+        hmac_sha256(k, sizeof(k), v, sizeof(v), &zero, 1, NULL, 0, k);
+        hmac_sha256(k, sizeof(k), v, sizeof(v), NULL, 0, NULL, 0, v);
+    }
+
+    // Low S, which flips the parity of R
+    uint32_t half[LIMBS];
+    for (uint8_t i = 0; i < LIMBS; i++) {
+        half[i] = (secp256k1_n.m[i] >> 1) | (i + 1 < LIMBS ? secp256k1_n.m[i + 1] << 31 : 0);
+    }
+    if (num_cmp(s, half) > 0) {
+        num_sub(s, secp256k1_n.m, s);
+        *info ^= CX_ECCINFO_PARITY_ODD;
+    }
+
+    uint8_t der[2 + 2 * 35];
+    uint8_t len = 2;
+    len += der_integer(der + len, r);
+    len += der_integer(der + len, s);
+    der[0] = 0x30;
+    der[1] = (uint8_t) (len - 2);
+    if (sig_len < len) {
+        THROW(INVALID_PARAMETER);
+    }
+    MEMCPY(sig, der, len);
+    return len;
+}
@@ -0,0 +1,73 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// Native APDU simulator. apdu_handler.c, app_main.c and tx.c are built for the host against a thin
+// stand-in for the BOLOS SDK (include/): exceptions on setjmp, an in-memory APDU buffer,
+// software SHA-256, RIPEMD-160 and secp256k1, and a review that is answered by the host.
+//
+// The app keeps its state in globals, so there is a single device per process, or per loaded copy (sim_fleet.h)
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Mnemonic of the Zemu tests
+#define SIM_DEFAULT_MNEMONIC "equip will roof matter pink blind book anxiety banner elbow sun young"
+
+typedef enum {
+    sim_stage_ingest = 0,   ///< init and chunks before the last one
+    sim_stage_parse,        ///< last chunk: parse, validation and indexing, up to the review
+    sim_stage_review,       ///< every page of every item is rendered
+    sim_stage_sign,         ///< from the approval to the reply, signing included
+    sim_stage_address,      ///< address derivation
+    sim_stage_other,
+    SIM_STAGE_COUNT
+} sim_stage_e;
+
+typedef struct {
+    const char *mnemonic;   ///< NULL for SIM_DEFAULT_MNEMONIC
+    bool expert;            ///< starts the app in expert mode
+    uint16_t keyLen;        ///< review buffers, 0 for the defaults (64 and 40)
+    uint16_t valueLen;
+} sim_device_config_t;
+
+typedef struct {
+    void *ctx;
+    /// Copies the next command to apdu and returns its length. 0 ends the session
+    uint16_t (*next)(void *ctx, uint8_t *apdu, uint16_t apduMax);
+    /// Reply to the last command, status word included
+    void (*reply)(void *ctx, const uint8_t *reply, uint16_t replyLen);
+    /// Optional. Every page shown in a review
+    void (*page)(void *ctx, uint8_t itemIdx, const char *key, const char *value);
+    /// Optional. Called once the user went through the whole review. NULL approves everything
+    bool (*approve)(void *ctx);
+    /// Optional. Time spent by the app in a stage of the current command
+    void (*stage)(void *ctx, sim_stage_e stage, uint64_t ns);
+} sim_host_t;
+
+/// Starts the app and serves commands from host until host->next returns 0
+/// \return 0 when the session ended, otherwise the exception that escaped the app
+int sim_device_run(const sim_device_config_t *config, const sim_host_t *host);
+
+const char *sim_stage_name(sim_stage_e stage);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,108 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// Several simulated devices in one process. The app keeps its state in globals, so each device is
+// a copy of the apdu_sim_device module loaded from its own file: the dynamic loader gives every copy
+// its own globals, and the module is linked with -Bsymbolic so a copy only ever calls itself.
+// Devices can then run on different threads
+
+#include "sim_replay.h"
+
+#include <dlfcn.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+class Fleet {
+public:
+    Fleet() = default;
+    Fleet(const Fleet &) = delete;
+    Fleet &operator=(const Fleet &) = delete;
+
+    ~Fleet() {
+        for (void *handle : handles) {
+            dlclose(handle);
+        }
+    }
+
+    /// Loads `count` copies of the module
+    bool load(const std::string &module, size_t count, std::string *error) {
+        std::ifstream in(module, std::ios::binary);
+        const std::string image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (!in || image.empty()) {
+            *error = "cannot read " + module;
+            return false;
+        }
+
+        const char *tmp = getenv("TMPDIR");
+        std::string dir = std::string(tmp != nullptr ? tmp : "/tmp") + "/apdu-fleet-XXXXXX";
+        if (mkdtemp(&dir[0]) == nullptr) {
+            *error = "cannot create a directory for the copies of " + module;
+            return false;
+        }
+
+        bool ok = true;
+        for (size_t i = 0; i < count && ok; i++) {
+            const std::string path = dir + "/device-" + std::to_string(i) + ".so";
+            std::ofstream out(path, std::ios::binary);
+            out.write(image.data(), static_cast<std::streamsize>(image.size()));
+            out.close();
+            ok = out.good() && add(path, error);
+            // The mapping stays once loaded
+            unlink(path.c_str());
+        }
+        rmdir(dir.c_str());
+        return ok;
+    }
+
+    size_t size() const {
+        return runs.size();
+    }
+
+    DeviceRun device(size_t idx) const {
+        return runs[idx];
+    }
+
+private:
+    std::vector<void *> handles;
+    std::vector<DeviceRun> runs;
+
+    bool add(const std::string &path, std::string *error) {
+        void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (handle == nullptr) {
+            *error = dlerror();
+            return false;
+        }
+        handles.push_back(handle);
+
+        void *run = dlsym(handle, "sim_device_run");
+        if (run == nullptr) {
+            *error = path + ": sim_device_run not found";
+            return false;
+        }
+        runs.push_back(reinterpret_cast<DeviceRun>(run));
+        return true;
+    }
+};
+
+}
@@ -0,0 +1,47 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// Internal calls between the parts of the simulator
+
+#include "sim_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Derives the master node from the mnemonic (BIP39 without passphrase)
+void sim_cx_init(const char *mnemonic);
+
+/// Clears the review and its callbacks
+void sim_view_reset(void);
+
+/// Lets the simulated user go through the pending review and answer it
+void sim_view_answer(void);
+
+const sim_device_config_t *sim_config(void);
+
+const sim_host_t *sim_host(void);
+
+/// Starts measuring a stage, ending the current one
+void sim_stage_begin(sim_stage_e stage);
+
+/// Reports the time spent in the current stage, if any
+void sim_stage_end(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,226 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "sim_internal.h"
+
+#include <os.h>
+#include <os_io_seproxyhal.h>
+#include <time.h>
+
+#include "app_main.h"
+#include "app_mode.h"
+#include "batch.h"
+#include "parser_impl.h"
+#include "view.h"
+
+// Value of setjmp when the host ends the session, above any exception
+#define SIM_SESSION_END 0x10000
+
+unsigned char G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+
+static try_context_t *sim_try_context;
+static jmp_buf sim_exit;
+
+static sim_device_config_t sim_device_config;
+static const sim_host_t *sim_device_host;
+
+static sim_stage_e sim_stage_current;
+static bool sim_stage_open;
+static uint64_t sim_stage_start;
+
+static const char *const sim_stage_names[SIM_STAGE_COUNT] = {
+        "ingest",
+        "parse",
+        "review",
+        "sign",
+        "address",
+        "other",
+};
+
+__Z_INLINE uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+// Stage of a command, before the app looks at it
+static sim_stage_e classify(const uint8_t *apdu, uint16_t len) {
+    if (len < APDU_MIN_LENGTH) {
+        return sim_stage_other;
+    }
+    const uint8_t payloadType = apdu[OFFSET_PAYLOAD_TYPE];
+    switch (apdu[OFFSET_INS]) {
+        case INS_SIGN_SECP256K1:
+            return payloadType == 2 || payloadType == 4 ? sim_stage_parse : sim_stage_ingest;
+        case INS_SIGN_BATCH_SECP256K1:
+            if (payloadType == 3) {
+                return sim_stage_parse;
+            }
+            return payloadType == 4 ? sim_stage_sign : sim_stage_ingest;
+        case INS_GET_ADDR_SECP256K1:
+        case INS_GET_ADDR_BATCH_SECP256K1:
+            return sim_stage_address;
+        default:
+            return sim_stage_other;
+    }
+}
+
+const char *sim_stage_name(sim_stage_e stage) {
+    return stage < SIM_STAGE_COUNT ? sim_stage_names[stage] : "?";
+}
+
+const sim_device_config_t *sim_config(void) {
+    return &sim_device_config;
+}
+
+const sim_host_t *sim_host(void) {
+    return sim_device_host;
+}
+
+void sim_stage_begin(sim_stage_e stage) {
+    sim_stage_end();
+    sim_stage_current = stage;
+    sim_stage_open = true;
+    sim_stage_start = now_ns();
+}
+
+void sim_stage_end(void) {
+    if (!sim_stage_open) {
+        return;
+    }
+    sim_stage_open = false;
+    if (sim_device_host->stage != NULL) {
+        sim_device_host->stage(sim_device_host->ctx, sim_stage_current, now_ns() - sim_stage_start);
+    }
+}
+
+////////////////////////////////////////////////
+
+try_context_t *try_context_get(void) {
+    return sim_try_context;
+}
+
+try_context_t *try_context_set(try_context_t *context) {
+    try_context_t *previous = sim_try_context;
+    sim_try_context = context;
+    return previous;
+}
+
+void os_longjmp(unsigned int exception) {
+    if (sim_try_context == NULL) {
+        // The device would reset, the session ends instead
+        longjmp(sim_exit, (int) exception);
+    }
+    longjmp(sim_try_context->jmp_buf, (int) exception);
+}
+
+unsigned short io_exchange(unsigned char channel_and_flags, unsigned short tx_len) {
+    if (tx_len > 0 && (channel_and_flags & IO_ASYNCH_REPLY) == 0) {
+        sim_stage_end();
+        sim_device_host->reply(sim_device_host->ctx, G_io_apdu_buffer, tx_len);
+    }
+    if (channel_and_flags & IO_RETURN_AFTER_TX) {
+        return 0;
+    }
+    if (channel_and_flags & IO_ASYNCH_REPLY) {
+        // The reply is sent from the review callbacks
+        sim_view_answer();
+    }
+
+    MEMZERO(G_io_apdu_buffer, sizeof(G_io_apdu_buffer));
+    const uint16_t rx = sim_device_host->next(sim_device_host->ctx, G_io_apdu_buffer, sizeof(G_io_apdu_buffer));
+    if (rx == 0) {
+        longjmp(sim_exit, SIM_SESSION_END);
+    }
+    sim_stage_begin(classify(G_io_apdu_buffer, rx));
+    return rx > sizeof(G_io_apdu_buffer) ? sizeof(G_io_apdu_buffer) : rx;
+}
+
+unsigned int os_global_pin_is_validated(void) {
+    return BOLOS_UX_OK;
+}
+
+unsigned int os_version(unsigned char *version, unsigned int maxlength) {
+    return (unsigned int) snprintf((char *) version, maxlength, "sim");
+}
+
+unsigned int os_seph_version(unsigned char *version, unsigned int maxlength) {
+    return os_version(version, maxlength);
+}
+
+void reset(void) {
+    os_longjmp(EXCEPTION_IO_RESET);
+}
+
+void io_seproxyhal_init(void) {}
+
+void io_seproxyhal_general_status(void) {}
+
+unsigned int io_seproxyhal_spi_is_status_sent(void) {
+    return 1;
+}
+
+void io_seproxyhal_spi_send(const unsigned char *buffer, unsigned short length) {
+    UNUSED(buffer);
+    UNUSED(length);
+}
+
+unsigned short io_seproxyhal_spi_recv(unsigned char *buffer, unsigned short maxlength, unsigned int flags) {
+    UNUSED(buffer);
+    UNUSED(maxlength);
+    UNUSED(flags);
+    return 0;
+}
+
+void USB_power(unsigned char enabled) {
+    UNUSED(enabled);
+}
+
+////////////////////////////////////////////////
+
+int sim_device_run(const sim_device_config_t *config, const sim_host_t *host) {
+    sim_device_config = *config;
+    if (sim_device_config.mnemonic == NULL) {
+        sim_device_config.mnemonic = SIM_DEFAULT_MNEMONIC;
+    }
+    if (sim_device_config.keyLen == 0) {
+        sim_device_config.keyLen = 64;
+    }
+    if (sim_device_config.valueLen == 0) {
+        sim_device_config.valueLen = 40;
+    }
+    sim_device_host = host;
+    sim_stage_open = false;
+    sim_try_context = NULL;
+    sim_cx_init(sim_device_config.mnemonic);
+
+    // A session is a restarted app, nothing is left from the previous one
+    parser_tx_obj.parsed.valid = false;
+    batch_reset();
+
+    // Same as main.c
+    view_init();
+    const int code = setjmp(sim_exit);
+    if (code == 0) {
+        app_init();
+        app_mode_set_expert(sim_device_config.expert);
+        app_main();
+    }
+
+    sim_try_context = NULL;
+    sim_device_host = NULL;
+    return code == SIM_SESSION_END ? 0 : code;
+}
@@ -0,0 +1,96 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// Runs an APDU trace through the simulated device (see sim_device.h)
+
+#include "apdu_trace.h"
+#include "sim_device.h"
+
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+/// Entry point of a device: sim_device_run, or the same function in a loaded copy (see sim_fleet.h)
+typedef int (*DeviceRun)(const sim_device_config_t *config, const sim_host_t *host);
+
+struct Replay {
+    /// Called once each review has been shown, returns whether to approve. Empty approves
+    std::function<bool()> approve;
+    /// Reply of every command, in order
+    std::vector<std::vector<uint8_t>> replies;
+    /// Review pages as "idx | key : value"
+    std::vector<std::string> pages;
+    /// Time spent in each stage, one entry per command or review
+    std::array<std::vector<uint64_t>, SIM_STAGE_COUNT> stageNs;
+    /// Exception that escaped the app, 0 if none
+    int exception = 0;
+};
+
+namespace detail {
+    struct Session {
+        const std::vector<tools::Exchange> *trace;
+        size_t next;
+        Replay *replay;
+    };
+
+    inline uint16_t next(void *ctx, uint8_t *apdu, uint16_t apduMax) {
+        auto *session = static_cast<Session *>(ctx);
+        if (session->next >= session->trace->size()) {
+            return 0;
+        }
+        const auto &command = (*session->trace)[session->next++].command;
+        const size_t len = std::min<size_t>(command.size(), apduMax);
+        std::copy(command.begin(), command.begin() + len, apdu);
+        return static_cast<uint16_t>(len);
+    }
+
+    inline void reply(void *ctx, const uint8_t *data, uint16_t len) {
+        static_cast<Session *>(ctx)->replay->replies.emplace_back(data, data + len);
+    }
+
+    inline void page(void *ctx, uint8_t itemIdx, const char *key, const char *value) {
+        static_cast<Session *>(ctx)->replay->pages.push_back(
+                std::to_string(itemIdx) + " | " + key + " : " + value);
+    }
+
+    inline bool approve(void *ctx) {
+        const auto &approve = static_cast<Session *>(ctx)->replay->approve;
+        return !approve || approve();
+    }
+
+    inline void stage(void *ctx, sim_stage_e stage, uint64_t ns) {
+        static_cast<Session *>(ctx)->replay->stageNs[stage].push_back(ns);
+    }
+}
+
+/// Sends every command of the trace to a freshly started app on the given device
+inline void replayOn(DeviceRun run, const std::vector<tools::Exchange> &trace, const sim_device_config_t &config,
+                     Replay *replay) {
+    detail::Session session{&trace, 0, replay};
+    const sim_host_t host = {&session, detail::next, detail::reply, detail::page, detail::approve, detail::stage};
+    replay->exception = run(&config, &host);
+}
+
+/// Same as replayOn, on the device linked in
+inline void replay(const std::vector<tools::Exchange> &trace, const sim_device_config_t &config, Replay *replay) {
+    replayOn(sim_device_run, trace, config, replay);
+}
+
+}
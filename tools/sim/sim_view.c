@@ -0,0 +1,107 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "sim_internal.h"
+
+#include <stdlib.h>
+
+#include "actions.h"
+#include "view.h"
+
+static viewfunc_getItem_t view_getItem;
+static viewfunc_getNumItems_t view_getNumItems;
+static viewfunc_accept_t view_accept;
+static bool view_pending;
+
+void sim_view_reset(void) {
+    view_getItem = NULL;
+    view_getNumItems = NULL;
+    view_accept = NULL;
+    view_pending = false;
+}
+
+void view_init() {
+    sim_view_reset();
+}
+
+void view_idle_show(uint8_t item_idx, char *statusString) {
+    UNUSED(item_idx);
+    UNUSED(statusString);
+}
+
+void view_review_init(viewfunc_getItem_t viewfuncGetItem,
+                      viewfunc_getNumItems_t viewfuncGetNumItems,
+                      viewfunc_accept_t viewfuncAccept) {
+    view_getItem = viewfuncGetItem;
+    view_getNumItems = viewfuncGetNumItems;
+    view_accept = viewfuncAccept;
+}
+
+void view_review_show(unsigned int requireReply) {
+    UNUSED(requireReply);
+    sim_stage_end();
+    view_pending = true;
+}
+
+// Goes through every page like the user would. Items that cannot be shown end the review
+static bool show_all_pages(char *key, char *value) {
+    const sim_device_config_t *config = sim_config();
+    const sim_host_t *host = sim_host();
+
+    uint8_t numItems = 0;
+    if (view_getNumItems(&numItems) != zxerr_ok) {
+        return false;
+    }
+
+    for (uint8_t idx = 0; idx < numItems; idx++) {
+        uint8_t pageCount = 1;
+        for (uint8_t page = 0; page < pageCount; page++) {
+            if (view_getItem((int8_t) idx, key, config->keyLen, value, config->valueLen, page, &pageCount) != zxerr_ok) {
+                return false;
+            }
+            if (host->page != NULL) {
+                host->page(host->ctx, idx, key, value);
+            }
+        }
+    }
+    return true;
+}
+
+void sim_view_answer(void) {
+    if (!view_pending) {
+        return;
+    }
+    view_pending = false;
+
+    const sim_device_config_t *config = sim_config();
+    const sim_host_t *host = sim_host();
+    char *key = calloc(config->keyLen, 1);
+    char *value = calloc(config->valueLen, 1);
+
+    sim_stage_begin(sim_stage_review);
+    const bool shown = key != NULL && value != NULL && show_all_pages(key, value);
+    sim_stage_end();
+    free(key);
+    free(value);
+
+    const bool approved = shown && (host->approve == NULL || host->approve(host->ctx));
+    sim_stage_begin(sim_stage_sign);
+    if (approved) {
+        view_accept();
+    } else {
+        app_reject();
+    }
+}
@@ -0,0 +1,270 @@
+/*******************************************************************************
+*   (c) 2022 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// Checks that sign docs are accepted and can be fully rendered, in parallel.
+//
+//   validate-docs [-j THREADS] [--target nanos|nanox] [--expert] [--quiet] PATH...
+//
+// PATH is a sign doc or a directory, searched recursively for *.json files. Docs are checked
+// against the size limit, JSON engine and page width of the target (nanox by default).
+// Exits with 0 when every doc is valid, 1 otherwise
+
+#include <tx_view.hpp>
+#include "device_target.h"
+#include "doc_files.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    /// Read-only mapping of a whole file
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string &path) {
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return;
+            }
+            struct stat st{};
+            if (fstat(fd, &st) == 0) {
+                size_ = static_cast<size_t>(st.st_size);
+                ok_ = true;
+                if (size_ > 0) {
+                    void *p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (p == MAP_FAILED) {
+                        ok_ = false;
+                    } else {
+                        data_ = static_cast<const uint8_t *>(p);
+                    }
+                }
+            }
+            close(fd);
+        }
+
+        ~MappedFile() {
+            if (data_ != nullptr) {
+                munmap(const_cast<uint8_t *>(data_), size_);
+            }
+        }
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        bool ok() const { return ok_; }
+
+        const uint8_t *data() const { return data_; }
+
+        size_t size() const { return size_; }
+
+    private:
+        const uint8_t *data_ = nullptr;
+        size_t size_ = 0;
+        bool ok_ = false;
+    };
+
+    struct Result {
+        const char *error = nullptr;     // nullptr when valid
+        size_t bytes = 0;
+        uint32_t items = 0;
+        uint32_t pages = 0;
+    };
+
+    Result validate(secret::TxView &view, size_t maxDocSize, const std::string &path) {
+        Result result;
+        const MappedFile file(path);
+        if (!file.ok()) {
+            result.error = "cannot read file";
+            return result;
+        }
+        result.bytes = file.size();
+        if (file.size() > maxDocSize) {
+            result.error = "too large";
+            return result;
+        }
+
+        const secret::TxError err = view.parse(file.data(), file.size());
+        if (err != secret::TxError::ok) {
+            result.error = parser_getErrorDescription(static_cast<parser_error_t>(err));
+            return result;
+        }
+
+        result.items = view.numItems();
+        for (const auto &item : view) {
+            if (item.error != secret::TxError::ok) {
+                result.error = parser_getErrorDescription(static_cast<parser_error_t>(item.error));
+                return result;
+            }
+            result.pages++;
+        }
+        return result;
+    }
+
+    /// Per worker queue. The owner takes from the front, idle workers steal from the back
+    class WorkQueue {
+    public:
+        void push(size_t idx) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            items_.push_back(idx);
+        }
+
+        bool pop(size_t *idx) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (items_.empty()) {
+                return false;
+            }
+            *idx = items_.front();
+            items_.pop_front();
+            return true;
+        }
+
+        bool steal(size_t *idx) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (items_.empty()) {
+                return false;
+            }
+            *idx = items_.back();
+            items_.pop_back();
+            return true;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::deque<size_t> items_;
+    };
+
+    void validateAll(const std::vector<std::string> &paths, std::vector<Result> *results,
+                     size_t numThreads, const tools::DeviceTarget &target, bool expert) {
+        std::vector<WorkQueue> queues(numThreads);
+        // Contiguous ranges, neighbouring files tend to be alike
+        for (size_t i = 0; i < paths.size(); i++) {
+            queues[i * numThreads / paths.size()].push(i);
+        }
+
+        // No work is added once started: when every queue is empty, all is done
+        const auto worker = [&](size_t id) {
+            secret::TxView view = tools::makeView(target);
+            view.setExpert(expert);
+            size_t idx = 0;
+            while (true) {
+                bool found = queues[id].pop(&idx);
+                for (size_t k = 1; !found && k < numThreads; k++) {
+                    found = queues[(id + k) % numThreads].steal(&idx);
+                }
+                if (!found) {
+                    return;
+                }
+                (*results)[idx] = validate(view, target.maxDocSize, paths[idx]);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t id = 1; id < numThreads; id++) {
+            threads.emplace_back(worker, id);
+        }
+        worker(0);
+        for (auto &t : threads) {
+            t.join();
+        }
+    }
+
+    void usage(const char *name) {
+        fprintf(stderr, "usage: %s [-j THREADS] [--target nanos|nanox] [--expert] [--quiet] PATH...\n", name);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    bool quiet = false;
+    bool expert = false;
+    const tools::DeviceTarget *target = &tools::DEFAULT_TARGET;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            numThreads = strtoul(argv[++i], nullptr, 10);
+            if (numThreads == 0) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (arg == "--target" && i + 1 < argc) {
+            target = tools::findTarget(argv[++i]);
+            if (target == nullptr) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (arg == "--quiet") {
+            quiet = true;
+        } else if (arg == "--expert") {
+            expert = true;
+        } else if (!arg.empty() && arg[0] == '-') {
+            usage(argv[0]);
+            return 2;
+        } else if (!tools::collectDocs(arg, &paths)) {
+            fprintf(stderr, "%s: cannot read %s\n", argv[0], arg.c_str());
+            return 2;
+        }
+    }
+    if (paths.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+    numThreads = std::min(numThreads, paths.size());
+
+    std::vector<Result> results(paths.size());
+    const auto start = std::chrono::steady_clock::now();
+    validateAll(paths, &results, numThreads, *target, expert);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t failed = 0;
+    size_t bytes = 0;
+    uint64_t pages = 0;
+    for (size_t i = 0; i < paths.size(); i++) {
+        const Result &r = results[i];
+        bytes += r.bytes;
+        pages += r.pages;
+        if (r.error != nullptr) {
+            failed++;
+            printf("FAIL %s: %s\n", paths[i].c_str(), r.error);
+        } else if (!quiet) {
+            printf("OK   %s: %u items, %u pages\n", paths[i].c_str(), r.items, r.pages);
+        }
+    }
+
+    fprintf(stderr, "%zu docs, %zu valid, %zu invalid, %zu threads\n",
+            paths.size(), paths.size() - failed, failed, numThreads);
+    fprintf(stderr, "%.3f s, %.0f docs/s, %.2f MB/s, %.0f pages/s\n",
+            seconds,
+            (double) paths.size() / seconds,
+            (double) bytes / seconds / 1e6,
+            (double) pages / seconds);
+
+    return failed == 0 ? 0 : 1;
+}